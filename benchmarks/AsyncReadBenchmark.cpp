@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "engine/core/Services.h"
+#include "engine/platform/shared/CxxThreadManager.h"
+#include "engine/platform/shared/IoUringFileReader.h"
+#include "engine/platform/shared/StdIoFileSystem.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t FILE_COUNT = 256;
+    const size_t FILE_SIZE = 256 * 1024;
+
+    std::string gDirectory;
+
+    std::string fileName(size_t index)
+    {
+        return "file" + std::to_string(index) + ".bin";
+    }
+
+    void writeFiles()
+    {
+        std::vector<uint8_t> data(FILE_SIZE);
+        for (size_t i = 0; i < FILE_COUNT; i++) {
+            memset(data.data(), int(i), data.size());
+            std::string path = gDirectory + "/" + fileName(i);
+            FILE* file = fopen(path.c_str(), "wb");
+            if (!file || fwrite(data.data(), 1, data.size(), file) != data.size()) {
+                fprintf(stderr, "Unable to write \"%s\".\n", path.c_str());
+                exit(EXIT_FAILURE);
+            }
+            fclose(file);
+        }
+    }
+
+    // Evicts the files from the page cache, so that every run really goes to the disk.
+    void dropCaches()
+    {
+        for (size_t i = 0; i < FILE_COUNT; i++) {
+            std::string path = gDirectory + "/" + fileName(i);
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                continue;
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+
+    // Copies the contents out, as a decoder would consume them.
+    void consume(IFile* file)
+    {
+        if (!file) {
+            fprintf(stderr, "Read has failed.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        size_t size = size_t(file->size());
+        std::vector<uint8_t> buffer(size);
+        if (const uint8_t* data = file->mappedData())
+            memcpy(buffer.data(), data, size);
+        else if (file->read(buffer.data(), size) != size) {
+            fprintf(stderr, "Read has failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        Benchmark::keep(buffer[size / 2]);
+    }
+
+    void readSynchronously()
+    {
+        for (size_t i = 0; i < FILE_COUNT; i++)
+            consume(Services::fileSystem()->openFile(fileName(i)).get());
+    }
+
+    void readAsynchronously(IAsyncFileReader& reader)
+    {
+        std::atomic<size_t> remaining(FILE_COUNT);
+        std::vector<IAsyncFileReader::Request> requests(FILE_COUNT);
+        for (size_t i = 0; i < FILE_COUNT; i++) {
+            requests[i].fileName = fileName(i);
+            requests[i].callback = [&remaining](const FilePtr& file) {
+                consume(file.get());
+                --remaining;
+            };
+        }
+
+        reader.submit(std::move(requests));
+        while (remaining.load() != 0)
+            std::this_thread::yield();
+    }
+
+    // Unlike Benchmark::measure(), the page cache is dropped before every run and the time to do so is excluded.
+    double run(const std::string& name, size_t iterations, const std::function<void()>& body, double baseline)
+    {
+        double best = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < iterations; i++) {
+            dropCaches();
+            auto start = Benchmark::Clock::now();
+            body();
+            std::chrono::duration<double, std::milli> elapsed = Benchmark::Clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+
+        Benchmark::report(name, best, baseline);
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 5);
+
+    char directory[] = "/tmp/b3d-async-read-XXXXXX";
+    if (!mkdtemp(directory)) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+    gDirectory = directory;
+    writeFiles();
+
+    auto threadManager = std::make_shared<CxxThreadManager>();
+    Services::setThreadManager(threadManager);
+    auto fileSystem = std::make_shared<StdIoFileSystem>(gDirectory);
+    Services::setFileSystem(fileSystem);
+
+    printf("%u files of %u KiB each, cold page cache.\n", unsigned(FILE_COUNT), unsigned(FILE_SIZE / 1024));
+
+    double baseline = run("synchronous, one file at a time", iterations, &readSynchronously, 0.0);
+    {
+        ThreadedFileReader reader;
+        run("ThreadedFileReader, one batch", iterations, [&reader]() { readAsynchronously(reader); }, baseline);
+    }
+    if (auto reader = IoUringFileReader::create(gDirectory, fileSystem))
+        run("IoUringFileReader, one batch", iterations, [&reader]() { readAsynchronously(*reader); }, baseline);
+    else
+        printf("io_uring is not supported by the running kernel.\n");
+
+    threadManager->stopWorkerThreads();
+    Services::setFileSystem(nullptr);
+    Services::setThreadManager(nullptr);
+
+    for (size_t i = 0; i < FILE_COUNT; i++)
+        unlink((gDirectory + "/" + fileName(i)).c_str());
+    rmdir(directory);
+    return 0;
+}
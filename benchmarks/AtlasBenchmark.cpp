@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "tests/common/NullRenderer.h"
+#include "engine/core/ResourceManager.h"
+#include "engine/core/Services.h"
+#include "engine/image/Image.h"
+#include "engine/render/AtlasTexture.h"
+#include "engine/render/Canvas.h"
+#include <memory>
+#include <vector>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t ICON_COUNT = 256;
+    const size_t ICON_SIZE = 32;
+    const size_t QUADS_PER_FRAME = 5000;
+
+    // Distinct icons, as a UI made of buttons, glyphs and badges would use.
+    std::vector<TexturePtr> makeIcons(const TextureAtlasPtr& atlas)
+    {
+        std::vector<TexturePtr> icons;
+        std::vector<uint8_t> pixels(ICON_SIZE * ICON_SIZE * 4);
+        for (size_t i = 0; i < ICON_COUNT; i++) {
+            std::fill(pixels.begin(), pixels.end(), uint8_t(i));
+            Image image(PixelFormat::RGBA32, ICON_SIZE, ICON_SIZE);
+            image.setData(pixels);
+
+            auto texture = std::make_shared<AtlasTexture>(atlas);
+            texture->upload(image);
+            icons.emplace_back(texture);
+        }
+        return icons;
+    }
+
+    // Draws one frame of quads that cycle through all icons, the worst case for a renderer that has to switch
+    // textures between quads.
+    void drawFrame(Canvas& canvas, const std::vector<TexturePtr>& icons)
+    {
+        const Quad texCoords = Quad::fromZeroToOne();
+        for (size_t i = 0; i < QUADS_PER_FRAME; i++) {
+            float x = float((i % 40) * ICON_SIZE);
+            float y = float((i / 40) % 30 * ICON_SIZE);
+            Quad quad = Quad::fromTopLeftAndSize(x, y, float(ICON_SIZE), float(ICON_SIZE));
+            canvas.drawTexturedQuad(quad, texCoords, icons[i % icons.size()]);
+        }
+        canvas.flush(false);
+    }
+
+    double run(const std::string& name, size_t iterations, const TextureAtlasPtr& atlas,
+        const std::shared_ptr<Test::NullRenderer>& renderer, double baseline)
+    {
+        std::vector<TexturePtr> icons = makeIcons(atlas);
+        Canvas canvas(renderer);
+
+        renderer->resetCounters();
+        drawFrame(canvas, icons);
+        size_t drawCalls = renderer->drawCalls();
+
+        double milliseconds = Benchmark::measure(iterations, [&canvas, &icons]() {
+            drawFrame(canvas, icons);
+        });
+
+        char suffix[64];
+        snprintf(suffix, sizeof(suffix), ", %u draw calls", unsigned(drawCalls));
+        Benchmark::report(name + suffix, milliseconds, baseline);
+        return milliseconds;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 20);
+
+    auto renderer = std::make_shared<Test::NullRenderer>();
+    Services::setRendererResourceFactory(renderer);
+    Services::setResourceManager(std::make_shared<ResourceManager>());
+
+    printf("%u quads per frame using %u different %ux%u textures.\n",
+        unsigned(QUADS_PER_FRAME), unsigned(ICON_COUNT), unsigned(ICON_SIZE), unsigned(ICON_SIZE));
+
+    double baseline = run("standalone textures", iterations, nullptr, renderer, 0.0);
+    auto atlas = std::make_shared<TextureAtlas>(ICON_SIZE, TextureAtlas::INITIAL_PAGE_SIZE * 4, 1);
+    run("texture atlas", iterations, atlas, renderer, baseline);
+
+    Services::setResourceManager(nullptr);
+    Services::setRendererResourceFactory(nullptr);
+    return 0;
+}
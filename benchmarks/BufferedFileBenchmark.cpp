@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "engine/core/Services.h"
+#include "engine/mesh/RawMeshData.h"
+#include "engine/platform/shared/StdIoFile.h"
+#include "engine/utility/BufferedFile.h"
+#include <atomic>
+
+using namespace B3D;
+namespace B3D { void init_plugins(); }
+
+namespace
+{
+    const char* const MESH = "girl/girl.obj";
+
+    std::atomic<size_t> gReadCalls(0);
+    std::atomic<size_t> gSizeCalls(0);
+    std::atomic<size_t> gSeekCalls(0);
+    size_t gBytesRead;
+
+    // Counts the calls that reach the stdio file, i.e. the ones that may cost a system call.
+    class CountingFile : public IFile
+    {
+    public:
+        explicit CountingFile(const FilePtr& file) : mFile(file) {}
+
+        const std::string& name() const override { return mFile->name(); }
+        uint64_t size() override { ++gSizeCalls; return mFile->size(); }
+        uint64_t position() override { return mFile->position(); }
+        bool seek(uint64_t pos) override { ++gSeekCalls; return mFile->seek(pos); }
+        size_t read(void* buffer, size_t bytes) override { ++gReadCalls; return mFile->read(buffer, bytes); }
+
+    private:
+        FilePtr mFile;
+
+        B3D_DISABLE_COPY(CountingFile);
+    };
+
+    // Opens files from the sample data directory through stdio, with or without a read-ahead buffer in front.
+    class SampleFileSystem : public IFileSystem
+    {
+    public:
+        explicit SampleFileSystem(size_t readAheadSize) : mReadAheadSize(readAheadSize) {}
+
+        bool fileExists(const std::string& name) override
+        {
+            FILE* file = fopen(path(name).c_str(), "rb");
+            if (file)
+                fclose(file);
+            return file != nullptr;
+        }
+
+        FilePtr openFile(const std::string& name) override
+        {
+            FILE* file = fopen(path(name).c_str(), "rb");
+            if (!file)
+                return nullptr;
+
+            if (mReadAheadSize == 0)
+                return std::make_shared<CountingFile>(std::make_shared<StdIoFile>(file, name));
+
+            // Same setup as StdIoFileSystem: the read-ahead buffer replaces the stdio one.
+            setvbuf(file, nullptr, _IONBF, 0);
+            auto counting = std::make_shared<CountingFile>(std::make_shared<StdIoFile>(file, name));
+            return std::make_shared<BufferedFile>(counting, mReadAheadSize);
+        }
+
+    private:
+        size_t mReadAheadSize;
+
+        static std::string path(const std::string& name) { return std::string(B3D_SAMPLE_DATA_PATH) + "/" + name; }
+    };
+
+    void importMesh()
+    {
+        if (!RawMeshData::fromFile(MESH, false)) {
+            fprintf(stderr, "Unable to load \"%s\" from \"%s\".\n", MESH, B3D_SAMPLE_DATA_PATH);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Reads the file in chunks of 1 to 48 bytes and asks for its size now and then, which is the pattern libpng
+    // and libjpeg produce through their IFile callbacks.
+    void readInSmallChunks()
+    {
+        FilePtr file = Services::fileSystem()->openFile(MESH);
+        uint8_t buffer[48];
+        size_t chunk = 0;
+        gBytesRead = 0;
+        while (size_t bytesRead = file->read(buffer, 1 + chunk++ % sizeof(buffer))) {
+            gBytesRead += bytesRead;
+            if (chunk % 64 == 0)
+                gBytesRead += size_t(file->size() & 1);
+        }
+        Benchmark::keep(gBytesRead);
+    }
+
+    double run(const std::string& name, size_t iterations, size_t readAheadSize, void (*body)(), double baseline)
+    {
+        Services::setFileSystem(std::make_shared<SampleFileSystem>(readAheadSize));
+
+        double milliseconds = Benchmark::measure(iterations, body);
+
+        gReadCalls = gSizeCalls = gSeekCalls = 0;
+        body();
+        char calls[128];
+        snprintf(calls, sizeof(calls), "    stdio file calls per run: %u read, %u size, %u seek\n",
+            unsigned(gReadCalls.load()), unsigned(gSizeCalls.load()), unsigned(gSeekCalls.load()));
+
+        Benchmark::report(name, milliseconds, baseline);
+        printf("%s", calls);
+
+        Services::setFileSystem(nullptr);
+        return milliseconds;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 20);
+
+    init_plugins();
+
+    // The OBJ importer fetches each file with a single read, so it mostly gains from the cached size.
+    printf("AssImp import of %s through IFile.\n", MESH);
+    double baseline = run("unbuffered IFile", iterations, 0, &importMesh, 0.0);
+    run("BufferedFile 4 KiB", iterations, 4 * 1024, &importMesh, baseline);
+    run("BufferedFile 64 KiB (default)", iterations, BufferedFile::DEFAULT_BUFFER_SIZE, &importMesh, baseline);
+
+    printf("%s read in chunks of 1-48 bytes.\n", MESH);
+    baseline = run("unbuffered IFile", iterations, 0, &readInSmallChunks, 0.0);
+    run("BufferedFile 4 KiB", iterations, 4 * 1024, &readInSmallChunks, baseline);
+    run("BufferedFile 64 KiB (default)", iterations, BufferedFile::DEFAULT_BUFFER_SIZE, &readInSmallChunks,
+        baseline);
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "tests/common/JpegEncoder.h"
+#include "engine/platform/shared/MmapFile.h"
+#include "engine/platform/shared/StdIoFile.h"
+#include "engine/utility/FileUtils.h"
+#include "plugins/image/jpeg/JpegImageLoader.h"
+#include <unistd.h>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t LARGE_FILE_SIZE = 64 * 1024 * 1024;
+    const size_t PAGE_SIZE = 4096;
+
+    std::string gDirectory;
+    std::vector<uint8_t> gPixels;
+    size_t gChecksum;
+
+    FilePtr openStdIo(const std::string& name)
+    {
+        std::string path = gDirectory + "/" + name;
+        return std::make_shared<StdIoFile>(fopen(path.c_str(), "rb"), path);
+    }
+
+    FilePtr openMapped(const std::string& name)
+    {
+        return MmapFile::open(gDirectory + "/" + name, name);
+    }
+
+    void writeFile(const std::string& name, const std::vector<uint8_t>& data)
+    {
+        std::string path = gDirectory + "/" + name;
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file || fwrite(data.data(), 1, data.size(), file) != data.size()) {
+            fprintf(stderr, "Unable to write \"%s\".\n", path.c_str());
+            exit(EXIT_FAILURE);
+        }
+        fclose(file);
+    }
+
+    // Reads one byte per page, so that mapped files are really paged in.
+    void touch(const char* data, size_t size)
+    {
+        for (size_t i = 0; i < size; i += PAGE_SIZE)
+            gChecksum += size_t(data[i]);
+        Benchmark::keep(gChecksum);
+    }
+
+    void decodeJpeg(IFile* file)
+    {
+        JpegImageLoader loader;
+        bool success = file && loader.decodeImage(file, ImageLoadHint(),
+            [](PixelFormat format, size_t width, size_t height, size_t& stride) -> uint8_t* {
+                stride = width * bytesPerPixel(format);
+                gPixels.resize(stride * height);
+                return gPixels.data();
+            });
+        if (!success) {
+            fprintf(stderr, "Unable to decode the benchmark image.\n");
+            exit(EXIT_FAILURE);
+        }
+        Benchmark::keep(gPixels);
+    }
+
+    double run(const std::string& name, size_t iterations, const std::function<void()>& body, double baseline)
+    {
+        return Benchmark::runInChildProcess([&name, iterations, &body, baseline]() {
+            double milliseconds = Benchmark::measure(iterations, body);
+            Benchmark::report(name + ", peak RSS " + std::to_string(Benchmark::peakResidentMiB()) + " MiB",
+                milliseconds, baseline);
+            return milliseconds;
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 5);
+
+    char directory[] = "/tmp/b3d-file-mapping-XXXXXX";
+    if (!mkdtemp(directory)) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+    gDirectory = directory;
+
+    std::vector<uint8_t> data = Test::makeTestPixels(LARGE_FILE_SIZE / 4, 1, 4);
+    writeFile("large.bin", data);
+
+    Test::JpegEncodeOptions options;
+    options.width = 4096;
+    options.height = 4096;
+    data = Test::encodeJpeg(options);
+    writeFile("large.jpg", data);
+    data = std::vector<uint8_t>();
+
+    // Mapped pages count as resident too, but they are clean and backed by the file, so the kernel can drop them
+    // under memory pressure instead of swapping.
+    printf("Files are in the page cache; the time is spent copying and mapping.\n");
+
+    double baseline = run("64 MiB file, stdio + loadFile", iterations, []() {
+        std::vector<char> contents = FileUtils::loadFile(openStdIo("large.bin"));
+        touch(contents.data(), contents.size());
+    }, 0.0);
+    run("64 MiB file, mmap + mapFile", iterations, []() {
+        FileUtils::FileContents contents = FileUtils::mapFile(openMapped("large.bin"));
+        touch(contents.data(), contents.size());
+    }, baseline);
+
+    baseline = run("4096x4096 JPEG, stdio", iterations, []() { decodeJpeg(openStdIo("large.jpg").get()); }, 0.0);
+    run("4096x4096 JPEG, mmap", iterations, []() { decodeJpeg(openMapped("large.jpg").get()); }, baseline);
+
+    unlink((gDirectory + "/large.bin").c_str());
+    unlink((gDirectory + "/large.jpg").c_str());
+    rmdir(directory);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "tests/common/JpegEncoder.h"
+#include "tests/common/TestUtils.h"
+#include "plugins/image/jpeg/JpegImageLoader.h"
+#include <thread>
+
+using namespace B3D;
+
+namespace
+{
+    std::vector<uint8_t> gPixels;
+
+    void decode(const std::vector<uint8_t>& data, const ImageLoadHint& hint)
+    {
+        MemoryFile file("benchmark.jpg", std::vector<uint8_t>(data));
+        JpegImageLoader loader;
+        bool success = loader.decodeImage(&file, hint,
+            [](PixelFormat format, size_t width, size_t height, size_t& stride) -> uint8_t* {
+                stride = width * bytesPerPixel(format);
+                gPixels.resize(stride * height);
+                return gPixels.data();
+            });
+        if (!success) {
+            fprintf(stderr, "Unable to decode the benchmark image.\n");
+            exit(EXIT_FAILURE);
+        }
+        Benchmark::keep(gPixels);
+    }
+
+    // Decoding without a thread manager is serial and serves as the baseline for every worker count.
+    void run(const char* name, const std::vector<uint8_t>& data, const ImageLoadHint& hint, size_t iterations)
+    {
+        size_t maxWorkers = std::max(size_t(std::thread::hardware_concurrency()), size_t(1));
+
+        double serial = Benchmark::measure(iterations, [&data, &hint]() { decode(data, hint); });
+        Benchmark::report(std::string(name) + ", serial", serial);
+
+        for (size_t workers = 1; ; workers = std::min(workers * 2, maxWorkers)) {
+            Test::Environment environment(workers);
+            double banded = Benchmark::measure(iterations, [&data, &hint]() { decode(data, hint); });
+            Benchmark::report(std::string(name) + ", " + std::to_string(workers) + " worker(s)", banded, serial);
+            if (workers == maxWorkers)
+                break;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 5);
+
+    Test::JpegEncodeOptions options;
+    options.width = 4096;
+    options.height = 4096;
+    options.restartInRows = 1;
+    std::vector<uint8_t> data = Test::encodeJpeg(options);
+    printf("4096x4096 4:2:0 JPEG with a restart marker on every MCU row, %u bytes.\n", unsigned(data.size()));
+
+    run("full size", data, ImageLoadHint(), iterations);
+    run("full size, fast", data, ImageLoadHint(0, DecodeQuality::Fast), iterations);
+    run("scaled to 1024", data, ImageLoadHint(1024), iterations);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "engine/core/Services.h"
+#include "engine/image/Image.h"
+#include "engine/mesh/RawMeshData.h"
+#include "engine/platform/shared/CxxThreadManager.h"
+#include "engine/platform/shared/StdIoFileSystem.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace B3D;
+namespace B3D { void init_plugins(); }
+
+namespace
+{
+    const char* const IMAGES[] = {
+        "girl/12c14c70.png",
+        "girl/12dbd6d0.png",
+        "girl/13932ef0.png",
+        "girl/16c2e0d0.png",
+        "girl/16cecd10.png",
+        "girl/19d89130.png",
+    };
+
+    const char* const MESH = "girl/girl.obj";
+
+    // Decodes every image and the mesh of the sample `girl` model as separate background tasks, the way
+    // ResourceManager's load stage does, and waits for all of them.
+    void loadAssets(CxxThreadManager& threadManager)
+    {
+        std::atomic<size_t> remaining(sizeof(IMAGES) / sizeof(IMAGES[0]) + 1);
+        std::atomic<bool> failed(false);
+
+        threadManager.performInBackgroundThread([&remaining, &failed]() {
+            if (!RawMeshData::fromFile(MESH, false))
+                failed.store(true);
+            --remaining;
+        });
+
+        for (const char* image : IMAGES) {
+            threadManager.performInBackgroundThread([image, &remaining, &failed]() {
+                if (!Image::fromFile(image))
+                    failed.store(true);
+                --remaining;
+            });
+        }
+
+        while (remaining.load() != 0)
+            std::this_thread::yield();
+
+        if (failed.load()) {
+            fprintf(stderr, "Unable to load the sample assets from \"%s\".\n", B3D_SAMPLE_DATA_PATH);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 5);
+    size_t maxWorkers = ThreadPool::defaultWorkerCount();
+
+    init_plugins();
+    Services::setFileSystem(std::make_shared<StdIoFileSystem>(B3D_SAMPLE_DATA_PATH));
+
+    double baseline = 0.0;
+    for (size_t workers = 1; ; workers = std::min(workers * 2, maxWorkers)) {
+        auto threadManager = std::make_shared<CxxThreadManager>(workers);
+        Services::setThreadManager(threadManager);
+
+        double milliseconds = Benchmark::measure(iterations, [&threadManager]() { loadAssets(*threadManager); });
+        if (baseline == 0.0)
+            baseline = milliseconds;
+        Benchmark::report("girl, " + std::to_string(workers) + " worker(s)", milliseconds, baseline);
+
+        threadManager->stopWorkerThreads();
+        Services::setThreadManager(nullptr);
+        if (workers == maxWorkers)
+            break;
+    }
+
+    Services::setFileSystem(nullptr);
+    return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "engine/core/Services.h"
+#include "engine/image/Image.h"
+#include "engine/platform/shared/CxxThreadManager.h"
+#include <vector>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t IMAGE_SIZE = 4096;
+
+    std::vector<uint8_t> gLevels[2];
+
+    // Straightforward 2x2 box filter, one channel at a time, as a reference for the SIMD kernels.
+    void buildScalarChain(const uint8_t* pixels, size_t size)
+    {
+        const uint8_t* previous = pixels;
+        for (size_t level = 0; size > 1; size /= 2, level ^= 1) {
+            size_t half = size / 2;
+            std::vector<uint8_t>& current = gLevels[level];
+            current.resize(half * half * 4);
+            for (size_t y = 0; y < half; y++) {
+                const uint8_t* row0 = previous + (2 * y) * size * 4;
+                const uint8_t* row1 = row0 + size * 4;
+                uint8_t* out = &current[y * half * 4];
+                for (size_t x = 0; x < half * 4; x++) {
+                    const uint8_t* a = row0 + (x / 4) * 8 + x % 4;
+                    const uint8_t* b = row1 + (x / 4) * 8 + x % 4;
+                    out[x] = uint8_t((a[0] + a[4] + b[0] + b[4] + 2) / 4);
+                }
+            }
+            previous = current.data();
+        }
+        Benchmark::keep(gLevels);
+    }
+
+    double run(const std::string& name, size_t iterations, Image& image, DownsampleFilter filter, bool gammaCorrect,
+        double baseline)
+    {
+        double milliseconds = Benchmark::measure(iterations, [&image, filter, gammaCorrect]() {
+            if (!image.generateMipmaps(filter, gammaCorrect)) {
+                fprintf(stderr, "Unable to generate mipmaps.\n");
+                exit(EXIT_FAILURE);
+            }
+        });
+        Benchmark::report(name, milliseconds, baseline);
+        return milliseconds;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 5);
+
+    std::vector<uint8_t> pixels(IMAGE_SIZE * IMAGE_SIZE * 4);
+    uint32_t seed = 12345;
+    for (auto& value : pixels) {
+        seed = seed * 1103515245 + 12345;
+        value = uint8_t(seed >> 16);
+    }
+
+    Image image(PixelFormat::RGBA32, IMAGE_SIZE, IMAGE_SIZE);
+    image.setData(pixels);
+    printf("Full mipmap chain for a %ux%u RGBA32 image.\n", unsigned(IMAGE_SIZE), unsigned(IMAGE_SIZE));
+
+    double baseline = Benchmark::measure(iterations, [&pixels]() { buildScalarChain(pixels.data(), IMAGE_SIZE); });
+    Benchmark::report("box, scalar reference", baseline);
+
+    // Without a thread manager every level is built on the calling thread.
+    run("box, inline", iterations, image, DownsampleFilter::Box, false, baseline);
+    run("box, gamma-correct, inline", iterations, image, DownsampleFilter::Box, true, baseline);
+    run("Kaiser, inline", std::min(iterations, size_t(2)), image, DownsampleFilter::Kaiser, false, baseline);
+
+    size_t workers = ThreadPool::defaultWorkerCount();
+    auto threadManager = std::make_shared<CxxThreadManager>(workers);
+    Services::setThreadManager(threadManager);
+
+    std::string suffix = ", " + std::to_string(workers) + " worker(s)";
+    run("box" + suffix, iterations, image, DownsampleFilter::Box, false, baseline);
+    run("box, gamma-correct" + suffix, iterations, image, DownsampleFilter::Box, true, baseline);
+    run("Kaiser" + suffix, std::min(iterations, size_t(2)), image, DownsampleFilter::Kaiser, false, baseline);
+
+    threadManager->stopWorkerThreads();
+    Services::setThreadManager(nullptr);
+    return 0;
+}
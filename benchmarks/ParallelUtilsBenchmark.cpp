@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "tests/common/TestUtils.h"
+#include "engine/math/BoundingBox.h"
+#include "engine/mesh/RawMeshData.h"
+#include "engine/platform/shared/CxxThreadManager.h"
+#include <random>
+#include <vector>
+
+using namespace B3D;
+namespace B3D { void init_plugins(); }
+
+namespace
+{
+    const size_t POINT_COUNT = 8 * 1024 * 1024;
+    const size_t MESH_OBJECT_COUNT = 4;
+    const size_t MESH_GRID_SIZE = 250;      // Vertices per side; 62500 vertices per object fit into one element
+
+    BoundingBox gBoundingBox;
+    RawMeshDataPtr gMesh;
+
+    // Flat grids with texture coordinates and normals, split into objects that each become one mesh element.
+    std::string makeObjFile()
+    {
+        std::string obj;
+        size_t base = 1;
+        char line[128];
+        for (size_t object = 0; object < MESH_OBJECT_COUNT; object++) {
+            snprintf(line, sizeof(line), "o part%u\n", unsigned(object));
+            obj += line;
+
+            for (size_t y = 0; y < MESH_GRID_SIZE; y++) {
+                for (size_t x = 0; x < MESH_GRID_SIZE; x++) {
+                    float u = float(x) / float(MESH_GRID_SIZE - 1), v = float(y) / float(MESH_GRID_SIZE - 1);
+                    snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\nvn 0 0 1\n",
+                        u * 10.0f, v * 10.0f, float(object), u, v);
+                    obj += line;
+                }
+            }
+
+            for (size_t y = 0; y + 1 < MESH_GRID_SIZE; y++) {
+                for (size_t x = 0; x + 1 < MESH_GRID_SIZE; x++) {
+                    size_t i = base + y * MESH_GRID_SIZE + x, j = i + MESH_GRID_SIZE;
+                    snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n",
+                        unsigned(i), unsigned(i), unsigned(i), unsigned(i + 1), unsigned(i + 1), unsigned(i + 1),
+                        unsigned(j + 1), unsigned(j + 1), unsigned(j + 1), unsigned(j), unsigned(j), unsigned(j));
+                    obj += line;
+                }
+            }
+
+            base += MESH_GRID_SIZE * MESH_GRID_SIZE;
+        }
+        return obj;
+    }
+
+    // Runs `body` inline first (no thread manager, as before ParallelUtils), then with 1, 2, 4... background
+    // workers up to the hardware concurrency.
+    void runWithWorkers(const std::string& name, size_t iterations, const std::function<void()>& body)
+    {
+        double baseline = Benchmark::measure(iterations, body);
+        Benchmark::report(name + ", inline", baseline);
+
+        size_t maxWorkers = ThreadPool::defaultWorkerCount();
+        for (size_t workers = 1; ; workers = std::min(workers * 2, maxWorkers)) {
+            auto threadManager = std::make_shared<CxxThreadManager>(workers);
+            Services::setThreadManager(threadManager);
+
+            double milliseconds = Benchmark::measure(iterations, body);
+            Benchmark::report(name + ", " + std::to_string(workers) + " worker(s)", milliseconds, baseline);
+
+            threadManager->stopWorkerThreads();
+            Services::setThreadManager(nullptr);
+            if (workers == maxWorkers)
+                break;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 5);
+
+    std::vector<glm::vec3> points(POINT_COUNT);
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+    for (auto& point : points)
+        point = glm::vec3(distribution(random), distribution(random), distribution(random));
+
+    printf("BoundingBox::initFromPoints over %u points.\n", unsigned(POINT_COUNT));
+    runWithWorkers("bounding box", iterations, [&points]() {
+        gBoundingBox.initFromPoints(points);
+        Benchmark::keep(gBoundingBox);
+    });
+
+    init_plugins();
+    auto fileSystem = std::make_shared<Test::MemoryFileSystem>();
+    fileSystem->add("grid.obj", makeObjFile());
+    Services::setFileSystem(fileSystem);
+
+    // The vertex copy is only a part of the import; parsing and AssImp post-processing stay serial.
+    printf("AssImp import of %u objects with %u vertices each.\n",
+        unsigned(MESH_OBJECT_COUNT), unsigned(MESH_GRID_SIZE * MESH_GRID_SIZE));
+    runWithWorkers("obj import", iterations, []() {
+        gMesh = RawMeshData::fromFile("grid.obj", false);
+        if (!gMesh || gMesh->elements().size() != MESH_OBJECT_COUNT) {
+            fprintf(stderr, "Unable to import the generated mesh.\n");
+            exit(EXIT_FAILURE);
+        }
+    });
+
+    gMesh.reset();
+    Services::setFileSystem(nullptr);
+    return 0;
+}
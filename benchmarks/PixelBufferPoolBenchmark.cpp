@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "engine/core/Services.h"
+#include "engine/image/Image.h"
+#include "engine/image/PixelBufferPool.h"
+#include "engine/platform/shared/StdIoFileSystem.h"
+#include <atomic>
+#include <new>
+
+using namespace B3D;
+namespace B3D { void init_plugins(); }
+
+namespace
+{
+    const size_t ROUNDS = 20;
+
+    const char* const IMAGES[] = {
+        "girl/12c14c70.png",
+        "girl/12dbd6d0.png",
+        "girl/13932ef0.png",
+        "girl/16c2e0d0.png",
+        "girl/16cecd10.png",
+        "girl/19d89130.png",
+        "loading/ProgressBar.png",
+    };
+
+    std::atomic<size_t> gAllocations(0);
+}
+
+// Counts every allocation in the process, including the pixel buffers the pool takes from the heap.
+void* operator new(size_t size)
+{
+    ++gAllocations;
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+    // Decodes every sample image ROUNDS times and drops each one right away, as happens when a texture has been
+    // uploaded.
+    void loadImages()
+    {
+        for (size_t round = 0; round < ROUNDS; round++) {
+            for (const char* name : IMAGES) {
+                ImagePtr image = Image::fromFile(name);
+                if (!image) {
+                    fprintf(stderr, "Unable to load \"%s\" from \"%s\".\n", name, B3D_SAMPLE_DATA_PATH);
+                    exit(EXIT_FAILURE);
+                }
+                Benchmark::keep(image);
+            }
+        }
+    }
+
+    // With no retention budget, every image takes a fresh buffer from the heap and frees it again, as the
+    // loaders did before the pool.
+    double run(const std::string& name, size_t iterations, bool pooled, double baseline)
+    {
+        return Benchmark::runInChildProcess([&name, iterations, pooled, baseline]() {
+            init_plugins();
+            Services::setFileSystem(std::make_shared<StdIoFileSystem>(B3D_SAMPLE_DATA_PATH));
+            if (!pooled)
+                PixelBufferPool::setRetentionBudget(0);
+
+            double milliseconds = Benchmark::measure(iterations, &loadImages);
+
+            size_t allocationsBefore = gAllocations.load();
+            PixelBufferPool::Stats statsBefore = PixelBufferPool::stats();
+            loadImages();
+            PixelBufferPool::Stats stats = PixelBufferPool::stats();
+            size_t allocations = gAllocations.load() - allocationsBefore;
+
+            char suffix[160];
+            snprintf(suffix, sizeof(suffix), ": %u allocs, %u pixel buffers allocated, %u reused, peak RSS %ld MiB",
+                unsigned(allocations), unsigned(stats.allocations - statsBefore.allocations),
+                unsigned(stats.reuses - statsBefore.reuses), Benchmark::peakResidentMiB());
+            Benchmark::report(name, milliseconds, baseline);
+            printf("    %s%s\n", name.c_str(), suffix);
+
+            Services::setFileSystem(nullptr);
+            return milliseconds;
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 3);
+    const size_t imageCount = sizeof(IMAGES) / sizeof(IMAGES[0]);
+
+    printf("%u rounds of decoding %u sample images; counts are for one pass after warm-up.\n",
+        unsigned(ROUNDS), unsigned(imageCount));
+
+    double baseline = run("unpooled", iterations, false, 0.0);
+    run("pooled, default budget", iterations, true, baseline);
+
+    return 0;
+}
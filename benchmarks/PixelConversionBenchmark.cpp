@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "engine/image/PixelConversion.h"
+#include <cstring>
+#include <vector>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t IMAGE_SIZE = 2048;
+    const size_t PIXEL_COUNT = IMAGE_SIZE * IMAGE_SIZE;
+
+    using InstructionSet = PixelConversion::InstructionSet;
+
+    struct Operation
+    {
+        const char* name;
+        PixelFormat source;
+        PixelFormat target;     // Same as `source` for in-place operations
+        void (*inPlace)(uint8_t* pixels, PixelFormat format, size_t count);
+    };
+
+    const Operation OPERATIONS[] = {
+        { "RGB24 -> RGBA32", PixelFormat::RGB24, PixelFormat::RGBA32, nullptr },
+        { "RGBA32 -> RGB24", PixelFormat::RGBA32, PixelFormat::RGB24, nullptr },
+        { "Luminance8 -> RGBA32", PixelFormat::Luminance8, PixelFormat::RGBA32, nullptr },
+        { "LuminanceAlpha16 -> RGBA32", PixelFormat::LuminanceAlpha16, PixelFormat::RGBA32, nullptr },
+        { "RGBA32 -> RGB565", PixelFormat::RGBA32, PixelFormat::RGB565, nullptr },
+        { "RGBA32 -> RGBA4444", PixelFormat::RGBA32, PixelFormat::RGBA4444, nullptr },
+        { "premultiply alpha", PixelFormat::RGBA32, PixelFormat::RGBA32, &PixelConversion::premultiplyAlpha },
+        { "swap red and blue", PixelFormat::RGBA32, PixelFormat::RGBA32, &PixelConversion::swapRedBlue },
+        { "sRGB -> linear", PixelFormat::RGBA32, PixelFormat::RGBA32, &PixelConversion::srgbToLinear },
+    };
+
+    // Varied pixels with every alpha value, so that premultiplication does not take shortcuts.
+    std::vector<uint8_t> makePixels(size_t bytesPerPixel)
+    {
+        std::vector<uint8_t> pixels(PIXEL_COUNT * bytesPerPixel);
+        uint32_t seed = 12345;
+        for (auto& value : pixels) {
+            seed = seed * 1103515245 + 12345;
+            value = uint8_t(seed >> 16);
+        }
+        return pixels;
+    }
+
+    // Instruction sets to compare, from the scalar reference up to the best one the CPU supports.
+    std::vector<InstructionSet> instructionSets()
+    {
+        InstructionSet best = PixelConversion::instructionSet();
+        std::vector<InstructionSet> result{ InstructionSet::Scalar };
+        if (best == InstructionSet::NEON)
+            result.emplace_back(best);
+        else {
+            for (int isa = int(InstructionSet::SSE2); isa <= int(best); isa++)
+                result.emplace_back(InstructionSet(isa));
+        }
+        return result;
+    }
+
+    // Returns the converted pixels, so that every kernel can be checked against the scalar reference.
+    std::vector<uint8_t> run(const Operation& operation, InstructionSet isa, const std::vector<uint8_t>& source,
+        size_t iterations, double baseline, double* result)
+    {
+        PixelConversion::limitInstructionSet(isa);
+
+        std::vector<uint8_t> target(PIXEL_COUNT * bytesPerPixel(operation.target));
+        double milliseconds = Benchmark::measure(iterations, [&operation, &source, &target]() {
+            if (!operation.inPlace)
+                PixelConversion::convert(source.data(), operation.source, target.data(), operation.target, PIXEL_COUNT);
+            else {
+                memcpy(target.data(), source.data(), target.size());
+                operation.inPlace(target.data(), operation.target, PIXEL_COUNT);
+            }
+        });
+
+        char name[128];
+        snprintf(name, sizeof(name), "%s, %s, %.0f Mpx/s", operation.name, PixelConversion::instructionSetName(isa),
+            double(PIXEL_COUNT) / (milliseconds * 1000.0));
+        Benchmark::report(name, milliseconds, baseline);
+
+        *result = milliseconds;
+        return target;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 10);
+
+    printf("%ux%u pixels; in-place operations include a copy of the source.\n",
+        unsigned(IMAGE_SIZE), unsigned(IMAGE_SIZE));
+
+    int failures = 0;
+    for (const auto& operation : OPERATIONS) {
+        std::vector<uint8_t> source = makePixels(bytesPerPixel(operation.source));
+
+        double baseline = 0.0;
+        std::vector<uint8_t> reference;
+        for (InstructionSet isa : instructionSets()) {
+            double milliseconds = 0.0;
+            std::vector<uint8_t> pixels = run(operation, isa, source, iterations, baseline, &milliseconds);
+            if (isa == InstructionSet::Scalar) {
+                baseline = milliseconds;
+                reference = std::move(pixels);
+            } else if (pixels != reference) {
+                fprintf(stderr, "%s: %s result differs from the scalar reference.\n",
+                    operation.name, PixelConversion::instructionSetName(isa));
+                ++failures;
+            }
+        }
+    }
+
+    // NEON is the highest value, so this lifts the limit again
+    PixelConversion::limitInstructionSet(InstructionSet::NEON);
+    return (failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "engine/platform/shared/CxxThreadManager.h"
+#include "engine/utility/ProducerConsumerQueue.h"
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t PRODUCER_COUNT = 8;
+    const size_t TASKS_PER_PRODUCER = 100000;
+
+    std::atomic<size_t> gAllocations(0);
+}
+
+// Counts every allocation in the process, so that the benchmark can show how many each task costs.
+void* operator new(size_t size)
+{
+    ++gAllocations;
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+    // Render thread queue as it was before the lock-free ring: a mutex-protected deque of std::function that is
+    // drained one item at a time.
+    class LegacyRenderQueue
+    {
+    public:
+        void performInRenderThread(std::function<void()>&& action) { mQueue.enqueue(std::move(action)); }
+
+        void flushRenderThreadQueue()
+        {
+            std::function<void()> action;
+            while (mQueue.tryDequeue(action)) {
+                action();
+                action = nullptr;
+            }
+        }
+
+    private:
+        ProducerConsumerQueue<std::function<void()>> mQueue;
+    };
+
+    // Runs PRODUCER_COUNT threads that post `post(producer, counter)` TASKS_PER_PRODUCER times each while the
+    // calling thread plays the render thread and flushes the queue until every task has run.
+    template <typename QUEUE, typename POST> void run(const std::string& name, size_t iterations, POST post,
+        double baseline, double* result = nullptr)
+    {
+        size_t allocations = 0;
+        double milliseconds = Benchmark::measure(iterations, [&post, &allocations]() {
+            QUEUE queue;
+            std::atomic<size_t> executed(0);
+            size_t allocationsBefore = gAllocations.load();
+
+            std::vector<std::thread> producers;
+            for (size_t i = 0; i < PRODUCER_COUNT; i++) {
+                producers.emplace_back([&queue, &executed, &post]() {
+                    for (size_t j = 0; j < TASKS_PER_PRODUCER; j++)
+                        post(queue, executed);
+                });
+            }
+
+            while (executed.load() != PRODUCER_COUNT * TASKS_PER_PRODUCER)
+                queue.flushRenderThreadQueue();
+            for (auto& producer : producers)
+                producer.join();
+
+            allocations = gAllocations.load() - allocationsBefore;
+        });
+
+        char allocationsPerTask[64];
+        snprintf(allocationsPerTask, sizeof(allocationsPerTask), ", %.2f allocs/task",
+            double(allocations) / double(PRODUCER_COUNT * TASKS_PER_PRODUCER));
+        Benchmark::report(name + allocationsPerTask, milliseconds, baseline);
+        if (result)
+            *result = milliseconds;
+    }
+
+    // Only the render thread queue of the manager is exercised, so a single background thread is enough.
+    class RenderQueue : public CxxThreadManager
+    {
+    public:
+        RenderQueue() : CxxThreadManager(1) {}
+    };
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 5);
+    printf("%u producers posting %u tasks each.\n", unsigned(PRODUCER_COUNT), unsigned(TASKS_PER_PRODUCER));
+
+    // A GL handle, as captured by the destructors of GPU objects.
+    double baseline = 0.0;
+    run<LegacyRenderQueue>("handle, legacy queue", iterations, [](LegacyRenderQueue& queue, std::atomic<size_t>& n) {
+        unsigned handle = 1;
+        queue.performInRenderThread([handle, &n]() { n += handle; });
+    }, 0.0, &baseline);
+    run<RenderQueue>("handle, std::function", iterations, [](RenderQueue& queue, std::atomic<size_t>& n) {
+        unsigned handle = 1;
+        queue.performInRenderThread(std::function<void()>([handle, &n]() { n += handle; }));
+    }, baseline);
+    run<RenderQueue>("handle, in place", iterations, [](RenderQueue& queue, std::atomic<size_t>& n) {
+        unsigned handle = 1;
+        queue.performInRenderThread([handle, &n]() { n += handle; });
+    }, baseline);
+
+    // A shared pointer, as captured by resource load completions.
+    auto resource = std::make_shared<size_t>(1);
+    run<LegacyRenderQueue>("shared_ptr, legacy queue", iterations,
+        [&resource](LegacyRenderQueue& queue, std::atomic<size_t>& n) {
+            queue.performInRenderThread([resource, &n]() { n += *resource; });
+        }, 0.0, &baseline);
+    run<RenderQueue>("shared_ptr, std::function", iterations, [&resource](RenderQueue& queue, std::atomic<size_t>& n) {
+        queue.performInRenderThread(std::function<void()>([resource, &n]() { n += *resource; }));
+    }, baseline);
+    run<RenderQueue>("shared_ptr, in place", iterations, [&resource](RenderQueue& queue, std::atomic<size_t>& n) {
+        queue.performInRenderThread([resource, &n]() { n += *resource; });
+    }, baseline);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "tests/common/TestUtils.h"
+#include "engine/material/ShaderLoader.h"
+#include "engine/utility/FileUtils.h"
+#include <memory>
+#include <vector>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t INCLUDE_COUNT = 64;
+    const size_t LINES_PER_INCLUDE = 200;
+
+    size_t gLineCount;
+
+    // Shader loader as it was before line views: every file is split into a vector of strings first, and every
+    // line is copied once more while comments are stripped.
+    class LegacyShaderLoader
+    {
+    public:
+        bool loadFile(const std::string& fileName, std::vector<std::string>* what = nullptr)
+        {
+            return loadMemory(FileUtils::loadFileLines(fileName, true), what);
+        }
+
+        const std::vector<std::string>& vertexSource() const { return mVertex; }
+
+    private:
+        std::vector<std::string> mVertex;
+        std::vector<std::string> mFragment;
+
+        bool loadMemory(std::vector<std::string>&& lines, std::vector<std::string>* what)
+        {
+            bool success = true;
+            for (auto& line : lines) {
+                size_t index = line.find("//");
+                if (index != std::string::npos) {
+                    bool endsWithLF = (line.length() > 1 && line[line.length() - 1] == '\n');
+                    line = line.substr(0, index);
+                    if (endsWithLF)
+                        line += '\n';
+                }
+
+                if (*line.c_str() == '%') {
+                    if (line == "%vertex\n")
+                        what = &mVertex;
+                    else if (line == "%fragment\n")
+                        what = &mFragment;
+                    else if (line.substr(0, 9) == "%include ") {
+                        std::string name = line.substr(9);
+                        name.resize(name.length() - 1);
+                        success = loadFile(name, what) && success;
+                    }
+                    continue;
+                }
+
+                if (what)
+                    what->emplace_back(std::move(line));
+                else {
+                    mVertex.emplace_back(line);
+                    mFragment.emplace_back(std::move(line));
+                }
+            }
+            return success;
+        }
+    };
+
+    // A shader built from many small files, as uber shaders with per-feature snippets are.
+    void addShaderFiles(Test::MemoryFileSystem& fileSystem)
+    {
+        std::string main = "varying vec2 vTexCoord;     // shared by both stages\n%vertex\n";
+        for (size_t i = 0; i < INCLUDE_COUNT; i++) {
+            std::string name = "feature" + std::to_string(i) + ".glsl";
+            main += "%include " + name + "\n";
+
+            std::string include;
+            for (size_t j = 0; j < LINES_PER_INCLUDE; j++) {
+                include += "    vec4 value" + std::to_string(j) + " = texture2D(uTexture, vTexCoord * "
+                    + std::to_string(j) + ".0);    // sample #" + std::to_string(j) + "\n";
+            }
+            fileSystem.add(name, include);
+        }
+        main += "void main() {}\n%fragment\nvoid main() {}\n";
+        fileSystem.add("main.glsl", main);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 20);
+
+    auto fileSystem = std::make_shared<Test::MemoryFileSystem>();
+    addShaderFiles(*fileSystem);
+    Services::setFileSystem(fileSystem);
+
+    printf("Shader with %u includes of %u lines each.\n", unsigned(INCLUDE_COUNT), unsigned(LINES_PER_INCLUDE));
+
+    double baseline = Benchmark::measure(iterations, []() {
+        LegacyShaderLoader loader;
+        loader.loadFile("main.glsl");
+        gLineCount = loader.vertexSource().size();
+        Benchmark::keep(gLineCount);
+    });
+    Benchmark::report("legacy loader", baseline);
+
+    double milliseconds = Benchmark::measure(iterations, []() {
+        ShaderLoader loader;
+        loader.loadFile("main.glsl");
+        gLineCount = loader.vertexSource().size();
+        Benchmark::keep(gLineCount);
+    });
+    Benchmark::report("ShaderLoader", milliseconds, baseline);
+
+    Services::setFileSystem(nullptr);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmarks/common/BenchmarkUtils.h"
+#include "tests/common/NullRenderer.h"
+#include "engine/core/ResourceManager.h"
+#include "engine/core/Services.h"
+#include "engine/font/Font.h"
+#include "engine/image/Image.h"
+#include "engine/render/Canvas.h"
+#include <memory>
+#include <vector>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t LABEL_COUNTS[] = { 1000, 5000 };
+    const size_t GLYPH_WIDTH = 9;
+    const size_t GLYPH_HEIGHT = 16;
+    const size_t BAKED_LABEL_WIDTH = 256;
+
+    // Fixed-size printable ASCII glyphs with a simple coverage pattern, so that the benchmark needs no font files.
+    class BoxGlyphSource : public IGlyphSource
+    {
+    public:
+        float lineHeight() const override { return float(GLYPH_HEIGHT + 2); }
+        float baseline() const override { return float(GLYPH_HEIGHT - 3); }
+
+        bool glyphMetrics(uint32_t codepoint, GlyphMetrics& metrics) override
+        {
+            if (codepoint < 32 || codepoint > 126)
+                return false;
+            metrics.offset = glm::vec2(0.0f, 1.0f);
+            metrics.size = glm::vec2(float(GLYPH_WIDTH), float(GLYPH_HEIGHT));
+            metrics.advance = float(GLYPH_WIDTH + 1);
+            return true;
+        }
+
+        float kerning(uint32_t first, uint32_t second) override
+        {
+            return ((first == 'A' && second == 'V') || (first == 'T' && second == 'o') ? -1.0f : 0.0f);
+        }
+
+        ImagePtr rasterizeGlyph(uint32_t codepoint) override
+        {
+            std::vector<uint8_t> coverage(GLYPH_WIDTH * GLYPH_HEIGHT);
+            for (size_t i = 0; i < coverage.size(); i++)
+                coverage[i] = uint8_t((i * codepoint) & 0xFF);
+
+            auto image = std::make_shared<Image>(PixelFormat::Luminance8, GLYPH_WIDTH, GLYPH_HEIGHT);
+            image->setData(coverage);
+            return image;
+        }
+    };
+
+    std::vector<std::string> makeLabels(size_t count)
+    {
+        std::vector<std::string> labels;
+        for (size_t i = 0; i < count; i++)
+            labels.emplace_back("Label #" + std::to_string(i) + " AV To score " + std::to_string(i * 37 % 10000));
+        return labels;
+    }
+
+    glm::vec2 labelPosition(size_t index)
+    {
+        return glm::vec2(float(index % 8 * BAKED_LABEL_WIDTH), float(index / 8 % 64 * GLYPH_HEIGHT));
+    }
+
+    // What teams did before: every string baked into a texture of its own and drawn as a sprite.
+    void drawBakedFrame(Canvas& canvas, const std::vector<TexturePtr>& textures)
+    {
+        const Quad texCoords = Quad::fromZeroToOne();
+        for (size_t i = 0; i < textures.size(); i++) {
+            glm::vec2 position = labelPosition(i);
+            Quad quad = Quad::fromTopLeftAndSize(position.x, position.y, float(BAKED_LABEL_WIDTH), float(GLYPH_HEIGHT));
+            canvas.drawTexturedQuad(quad, texCoords, textures[i]);
+        }
+        canvas.flush(false);
+    }
+
+    void drawTextFrame(Canvas& canvas, const FontPtr& font, const std::vector<std::string>& labels)
+    {
+        for (size_t i = 0; i < labels.size(); i++)
+            canvas.drawText(labelPosition(i), font, labels[i]);
+        canvas.flush(false);
+    }
+
+    double run(const std::string& name, size_t iterations, Test::NullRenderer& renderer,
+        const std::function<void()>& drawFrame, double baseline)
+    {
+        auto start = Benchmark::Clock::now();
+        renderer.resetCounters();
+        drawFrame();
+        std::chrono::duration<double, std::milli> firstFrame = Benchmark::Clock::now() - start;
+        size_t drawCalls = renderer.drawCalls();
+
+        double milliseconds = Benchmark::measure(iterations, drawFrame);
+
+        Benchmark::report(name + ", " + std::to_string(drawCalls) + " draw calls", milliseconds, baseline);
+        printf("    first frame (text layout and glyph uploads): %.3f ms\n", firstFrame.count());
+        return milliseconds;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = Benchmark::iterations(argc, argv, 20);
+
+    auto renderer = std::make_shared<Test::NullRenderer>();
+    Services::setRendererResourceFactory(renderer);
+    Services::setResourceManager(std::make_shared<ResourceManager>());
+
+    // The null renderer makes draw calls free, so the CPU time of the baked baseline leaves out driver overhead.
+    printf("Labels like \"Label #123 AV To score 4551\", %ux%u px glyphs; time per frame.\n",
+        unsigned(GLYPH_WIDTH), unsigned(GLYPH_HEIGHT));
+
+    for (size_t labelCount : LABEL_COUNTS) {
+        std::vector<std::string> labels = makeLabels(labelCount);
+        std::string count = std::to_string(labelCount) + " labels";
+
+        {
+            std::vector<TexturePtr> textures;
+            for (size_t i = 0; i < labelCount; i++)
+                textures.emplace_back(renderer->createTexture());
+
+            Canvas canvas(renderer);
+            double baseline = run(count + ", baked", iterations, *renderer,
+                [&canvas, &textures]() { drawBakedFrame(canvas, textures); }, 0.0);
+
+            auto font = std::make_shared<Font>();
+            font->setGlyphSource(std::unique_ptr<IGlyphSource>(new BoxGlyphSource));
+            FontPtr fontPtr = font;
+            run(count + ", glyph texture", iterations, *renderer,
+                [&canvas, &fontPtr, &labels]() { drawTextFrame(canvas, fontPtr, labels); }, baseline);
+        }
+    }
+
+    Services::setResourceManager(nullptr);
+    Services::setRendererResourceFactory(nullptr);
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <string>
+
+#if defined(B3D_PLATFORM_LINUX) || defined(B3D_PLATFORM_OSX)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace B3D
+{
+    namespace Benchmark
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Number of timed runs: the first command line argument if present, `defaultCount` otherwise.
+        inline size_t iterations(int argc, char** argv, size_t defaultCount)
+        {
+            if (argc > 1) {
+                long count = strtol(argv[1], nullptr, 10);
+                if (count > 0)
+                    return size_t(count);
+            }
+            return defaultCount;
+        }
+
+        // Runs `body` once to warm up caches and pools, then `count` more times. Returns the fastest run in
+        // milliseconds, which is the least disturbed by the rest of the system.
+        inline double measure(size_t count, const std::function<void()>& body)
+        {
+            body();
+
+            double best = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < count; i++) {
+                auto start = Clock::now();
+                body();
+                std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+                best = std::min(best, elapsed.count());
+            }
+            return best;
+        }
+
+        // Prints one result line; with a baseline the speedup relative to it is printed as well.
+        inline void report(const std::string& name, double milliseconds, double baseline = 0.0)
+        {
+            if (baseline > 0.0)
+                printf("%-48s %10.3f ms  %6.2fx\n", name.c_str(), milliseconds, baseline / milliseconds);
+            else
+                printf("%-48s %10.3f ms\n", name.c_str(), milliseconds);
+            fflush(stdout);
+        }
+
+      #if defined(B3D_PLATFORM_LINUX) || defined(B3D_PLATFORM_OSX)
+        // Highest resident set size of the calling process so far.
+        inline long peakResidentMiB()
+        {
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+          #ifdef B3D_PLATFORM_OSX
+            return long(usage.ru_maxrss / (1024 * 1024));
+          #else
+            return long(usage.ru_maxrss / 1024);
+          #endif
+        }
+
+        // Runs `body` in a child process and returns its result. Peak RSS can only grow during the lifetime of a
+        // process, so cases that report it need a process of their own.
+        inline double runInChildProcess(const std::function<double()>& body)
+        {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                perror("pipe");
+                exit(EXIT_FAILURE);
+            }
+
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                exit(EXIT_FAILURE);
+            }
+
+            if (pid == 0) {
+                close(fds[0]);
+                double result = body();
+                fflush(stdout);
+                ssize_t written = write(fds[1], &result, sizeof(result));
+                _exit(written == ssize_t(sizeof(result)) ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+
+            close(fds[1]);
+            double result = 0.0;
+            ssize_t bytesRead = read(fds[0], &result, sizeof(result));
+            close(fds[0]);
+
+            int status = 0;
+            waitpid(pid, &status, 0);
+            if (bytesRead != ssize_t(sizeof(result)) || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+                fprintf(stderr, "Child process has failed.\n");
+                exit(EXIT_FAILURE);
+            }
+
+            return result;
+        }
+      #endif
+
+        inline const void* volatile& sink()
+        {
+            static const void* volatile pointer;
+            return pointer;
+        }
+
+        // Keeps the compiler from optimizing away a result nobody looks at.
+        template <typename TYPE> void keep(const TYPE& value)
+        {
+            sink() = &value;
+        }
+    }
+}
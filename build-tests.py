@@ -0,0 +1,48 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+
+import argparse
+import os
+import subprocess
+import sys
+
+scriptPath = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(scriptPath, 'tools', 'common', 'python'))
+from bombyx3d.Builder import Builder
+
+parser = argparse.ArgumentParser()
+parser.add_argument('-o', '--output', help='Path to the build directory')
+parser.add_argument('-c', '--configuration', help='Value for CMAKE_BUILD_TYPE',
+    choices=['Debug', 'Release', 'RelWithDebInfo', 'MinSizeRel'], default='Release')
+args = parser.parse_args()
+
+builder = Builder()
+builder.cmakeBuildType = args.configuration
+builder.defaultOutputDirectoryName = 'cmake-tests-build'
+builder.projectPath = os.path.join(scriptPath, 'tests')
+if args.output:
+    builder.outputPath = os.path.abspath(args.output)
+builder.build()
+
+# Builder.build() leaves us in the build directory.
+sys.exit(subprocess.call(['ctest', '--output-on-failure', '-C', args.configuration]))
@@ -40,7 +40,7 @@ macro(_b3d_generate_plugins_initializer target)
     set(string "${string}    }\n")
     set(string "${string}}\n")
 
-    set(filename "${CMAKE_CURRENT_BINARY_DIR}/bombyx3d-startup.cpp")
+    set(filename "${CMAKE_CURRENT_BINARY_DIR}/bombyx3d-startup-${target}.cpp")
     if(NOT EXISTS "${filename}")
         file(WRITE "${filename}" "${string}")
     else()
@@ -0,0 +1,610 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "DecodedAssetCache.h"
+#include "engine/core/Log.h"
+#include "engine/core/Services.h"
+#include "engine/mesh/VertexFormat.h"
+#include "engine/utility/MemoryFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+namespace B3D
+{
+    namespace
+    {
+        const char MAGIC[4] = { 'B', '3', 'D', 'C' };
+        const size_t PAYLOAD_ALIGNMENT = 16;
+
+        // Larger dimensions in an entry are treated as corruption; this also keeps imageDataSize() from overflowing.
+        const uint32_t MAX_IMAGE_DIMENSION = 65536;
+
+        enum : uint32_t
+        {
+            KIND_IMAGE = 1,
+            KIND_MESH = 2,
+        };
+
+        struct Header
+        {
+            char magic[4];
+            uint32_t kind;
+            uint32_t version;
+            uint32_t reserved;
+            uint64_t sourceSize;
+            uint64_t sourceHash;
+        };
+
+        static_assert(sizeof(Header) % PAYLOAD_ALIGNMENT == 0, "Cache entry header breaks payload alignment.");
+
+        uint32_t kindVersion(uint32_t kind)
+        {
+            return (kind == KIND_IMAGE ? DecodedAssetCache::IMAGE_VERSION : DecodedAssetCache::MESH_VERSION);
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        class Hasher
+        {
+        public:
+            Hasher() : mHash(0xcbf29ce484222325ull) {}
+
+            void add(const uint8_t* data, size_t size)
+            {
+                while (size >= 8) {
+                    uint64_t word;
+                    memcpy(&word, data, 8);
+                    mix(word);
+                    data += 8;
+                    size -= 8;
+                }
+                if (size > 0) {
+                    uint64_t word = 0;
+                    memcpy(&word, data, size);
+                    mix(word ^ (uint64_t(size) << 56));
+                }
+            }
+
+            uint64_t result() const
+            {
+                uint64_t h = mHash;
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdull;
+                h ^= h >> 33;
+                return h;
+            }
+
+        private:
+            uint64_t mHash;
+
+            void mix(uint64_t word) { mHash = (mHash ^ word) * 0x100000001b3ull; mHash ^= mHash >> 29; }
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        class Writer
+        {
+        public:
+            std::vector<uint8_t> data;
+
+            template <typename TYPE> void put(const TYPE& value) { put(&value, sizeof(value)); }
+            void put(const void* p, size_t size)
+            {
+                const uint8_t* bytes = static_cast<const uint8_t*>(p);
+                data.insert(data.end(), bytes, bytes + size);
+            }
+            void putString(const std::string& str) { put(uint32_t(str.length())); put(str.data(), str.length()); }
+            void putBox(const BoundingBox& box) { put(box.min); put(box.max); }
+            void align() { data.resize((data.size() + PAYLOAD_ALIGNMENT - 1) & ~(PAYLOAD_ALIGNMENT - 1)); }
+        };
+
+        class Reader
+        {
+        public:
+            Reader(const uint8_t* data, size_t size) : mData(data), mSize(size), mOffset(0), mFailed(false) {}
+
+            bool failed() const { return mFailed; }
+            size_t offset() const { return mOffset; }
+
+            template <typename TYPE> TYPE get() { TYPE value = TYPE(); get(&value, sizeof(value)); return value; }
+            void get(void* p, size_t size)
+            {
+                const uint8_t* bytes = skip(size);
+                if (bytes)
+                    memcpy(p, bytes, size);
+            }
+            std::string getString()
+            {
+                uint32_t length = get<uint32_t>();
+                const uint8_t* bytes = skip(length);
+                return (bytes ? std::string(reinterpret_cast<const char*>(bytes), length) : std::string());
+            }
+            BoundingBox getBox()
+            {
+                glm::vec3 min = get<glm::vec3>();
+                glm::vec3 max = get<glm::vec3>();
+                return BoundingBox(min, max);
+            }
+            void align() { mOffset = std::min(mSize, (mOffset + PAYLOAD_ALIGNMENT - 1) & ~(PAYLOAD_ALIGNMENT - 1)); }
+
+            const uint8_t* skip(size_t size)
+            {
+                if (mFailed || size > mSize - mOffset) {
+                    mFailed = true;
+                    return nullptr;
+                }
+                const uint8_t* bytes = mData + mOffset;
+                mOffset += size;
+                return bytes;
+            }
+
+        private:
+            const uint8_t* mData;
+            size_t mSize;
+            size_t mOffset;
+            bool mFailed;
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        class CachedVertexFormat : public IVertexFormatAttributeList
+        {
+        public:
+            explicit CachedVertexFormat(size_t stride, size_t attributeCount)
+                : mStride(stride)
+            {
+                // Attributes point into the names, so neither vector may reallocate.
+                mNames.reserve(attributeCount);
+                mAttributes.reserve(attributeCount);
+            }
+
+            void addAttribute(std::string&& name, VertexAttributeType type, size_t offset, bool normalize)
+            {
+                mNames.emplace_back(std::move(name));
+                mAttributes.emplace_back(mNames.back().c_str(), type, offset, normalize);
+            }
+
+            size_t stride() const override { return mStride; }
+            size_t attributeCount() const override { return mAttributes.size(); }
+            const VertexFormatAttribute<>& attribute(size_t index) const override { return mAttributes[index]; }
+
+        private:
+            size_t mStride;
+            std::vector<std::string> mNames;
+            std::vector<VertexFormatAttribute<>> mAttributes;
+        };
+
+        class CachedMeshElementData : public IRawMeshElementData
+        {
+        public:
+            std::string name_;
+            std::string materialName_;
+            PrimitiveType primitiveType_;
+            BoundingBox boundingBox_;
+            std::unique_ptr<CachedVertexFormat> vertexFormat_;
+            size_t vertexBufferOffset_;
+            size_t vertexBufferSize_;
+            size_t firstIndex_;
+            size_t indexCount_;
+
+            const std::string& name() const override { return name_; }
+            const std::string& materialName() const override { return materialName_; }
+            PrimitiveType primitiveType() const override { return primitiveType_; }
+            const BoundingBox& boundingBox() const override { return boundingBox_; }
+            const IVertexFormatAttributeList* vertexFormat() const override { return vertexFormat_.get(); }
+            size_t vertexBufferOffset() const override { return vertexBufferOffset_; }
+            size_t vertexBufferSize() override { return vertexBufferSize_; }
+            size_t firstIndex() const override { return firstIndex_; }
+            size_t indexCount() override { return indexCount_; }
+        };
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    DecodedAssetCache::DecodedAssetCache(const std::string& directory, size_t capacity)
+        : mDirectory(directory)
+        , mCapacity(capacity)
+        , mTotalSize(0)
+        , mUseCounter(0)
+        , mHits(0)
+        , mMisses(0)
+        , mStores(0)
+    {
+        loadIndex();
+    }
+
+    DecodedAssetCache::~DecodedAssetCache()
+    {
+        saveIndex();
+        B3D_LOGI("Decoded asset cache: " << mHits.load() << " hits, " << mMisses.load() << " misses, "
+            << mStores.load() << " stores; " << mEntries.size() << " entries, " << mTotalSize << " bytes.");
+    }
+
+    bool DecodedAssetCache::imageKey(IFile* source, Key& key, const std::string& variant)
+    {
+        return makeKey(source, KIND_IMAGE, variant, key);
+    }
+
+    bool DecodedAssetCache::meshKey(IFile* source, Key& key)
+    {
+        return makeKey(source, KIND_MESH, std::string(), key);
+    }
+
+    ImagePtr DecodedAssetCache::loadImage(const Key& key)
+    {
+        const uint8_t* payload;
+        size_t payloadSize;
+        FilePtr file = openEntry(key, payload, payloadSize);
+        if (!file)
+            return nullptr;
+
+        Reader reader(payload, payloadSize);
+        uint32_t format = reader.get<uint32_t>();
+        uint32_t levelCount = reader.get<uint32_t>();
+        if (reader.failed() || format >= uint32_t(PixelFormat::Count) || levelCount == 0 || levelCount > 32) {
+            B3D_LOGW("Ignoring invalid cache entry \"" << file->name() << "\".");
+            ++mMisses;
+            return nullptr;
+        }
+
+        std::shared_ptr<Image> image;
+        for (uint32_t i = 0; i < levelCount; i++) {
+            uint32_t width = reader.get<uint32_t>();
+            uint32_t height = reader.get<uint32_t>();
+            uint64_t dataSize = reader.get<uint64_t>();
+            reader.align();
+            const uint8_t* pixels = reader.skip(size_t(dataSize));
+            if (reader.failed() || width == 0 || height == 0
+                    || width > MAX_IMAGE_DIMENSION || height > MAX_IMAGE_DIMENSION
+                    || dataSize < imageDataSize(PixelFormat(format), width, height)) {
+                B3D_LOGW("Ignoring invalid cache entry \"" << file->name() << "\".");
+                ++mMisses;
+                return nullptr;
+            }
+
+            auto level = std::make_shared<Image>(PixelFormat(format), width, height);
+            level->setExternalData(pixels, size_t(dataSize), file);
+            if (!image)
+                image = level;
+            else
+                image->addMipLevel(level);
+        }
+
+        ++mHits;
+        return image;
+    }
+
+    void DecodedAssetCache::storeImage(const Key& key, const IImage& image)
+    {
+        Writer writer;
+        writer.put(uint32_t(image.pixelFormat()));
+        writer.put(uint32_t(image.mipLevelCount()));
+        for (size_t i = 0; i < image.mipLevelCount(); i++) {
+            const IImage& level = image.mipLevel(i);
+            writer.put(uint32_t(level.width()));
+            writer.put(uint32_t(level.height()));
+            writer.put(uint64_t(level.dataSize()));
+            writer.align();
+            writer.put(level.data(), level.dataSize());
+        }
+        writeEntry(key, writer.data);
+    }
+
+    RawMeshDataPtr DecodedAssetCache::loadMesh(const Key& key)
+    {
+        const uint8_t* payload;
+        size_t payloadSize;
+        FilePtr file = openEntry(key, payload, payloadSize);
+        if (!file)
+            return nullptr;
+
+        auto mesh = std::make_shared<RawMeshData>();
+
+        Reader reader(payload, payloadSize);
+        mesh->setBoundingBox(reader.getBox());
+        uint64_t vertexDataSize = reader.get<uint64_t>();
+        uint64_t indexCount = reader.get<uint64_t>();
+        uint32_t elementCount = reader.get<uint32_t>();
+
+        for (uint32_t i = 0; i < elementCount && !reader.failed(); i++) {
+            std::unique_ptr<CachedMeshElementData> element(new CachedMeshElementData);
+            element->name_ = reader.getString();
+            element->materialName_ = reader.getString();
+            element->primitiveType_ = PrimitiveType(reader.get<uint32_t>());
+            element->boundingBox_ = reader.getBox();
+            element->vertexBufferOffset_ = size_t(reader.get<uint64_t>());
+            element->vertexBufferSize_ = size_t(reader.get<uint64_t>());
+            element->firstIndex_ = size_t(reader.get<uint64_t>());
+            element->indexCount_ = size_t(reader.get<uint64_t>());
+
+            // The renderer trusts these ranges, so they have to lie within the buffers stored below.
+            if (element->vertexBufferOffset_ > vertexDataSize
+                    || element->vertexBufferSize_ > vertexDataSize - element->vertexBufferOffset_
+                    || element->firstIndex_ > indexCount || element->indexCount_ > indexCount - element->firstIndex_)
+                break;
+
+            uint32_t stride = reader.get<uint32_t>();
+            uint32_t attributeCount = reader.get<uint32_t>();
+            if (attributeCount > payloadSize)
+                break;
+            element->vertexFormat_.reset(new CachedVertexFormat(stride, attributeCount));
+            for (uint32_t j = 0; j < attributeCount && !reader.failed(); j++) {
+                std::string name = reader.getString();
+                auto type = VertexAttributeType(reader.get<uint32_t>());
+                size_t offset = size_t(reader.get<uint64_t>());
+                bool normalize = reader.get<uint32_t>() != 0;
+                element->vertexFormat_->addAttribute(std::move(name), type, offset, normalize);
+            }
+
+            mesh->addElement(std::move(element));
+        }
+
+        reader.align();
+        const uint8_t* vertices = reader.skip(size_t(vertexDataSize));
+        reader.align();
+        const uint8_t* indices = reader.skip(size_t(indexCount * sizeof(uint16_t)));
+        if (reader.failed() || mesh->elements().size() != elementCount) {
+            B3D_LOGW("Ignoring invalid cache entry \"" << file->name() << "\".");
+            ++mMisses;
+            return nullptr;
+        }
+
+        mesh->setExternalData(vertices, size_t(vertexDataSize),
+            reinterpret_cast<const uint16_t*>(indices), size_t(indexCount), file);
+
+        ++mHits;
+        return mesh;
+    }
+
+    void DecodedAssetCache::storeMesh(const Key& key, const IRawMeshData& mesh)
+    {
+        Writer writer;
+        writer.putBox(mesh.boundingBox());
+        writer.put(uint64_t(mesh.vertexDataSize()));
+        writer.put(uint64_t(mesh.indexCount()));
+        writer.put(uint32_t(mesh.elements().size()));
+
+        for (const auto& element : mesh.elements()) {
+            writer.putString(element->name());
+            writer.putString(element->materialName());
+            writer.put(uint32_t(element->primitiveType()));
+            writer.putBox(element->boundingBox());
+            writer.put(uint64_t(element->vertexBufferOffset()));
+            writer.put(uint64_t(element->vertexBufferSize()));
+            writer.put(uint64_t(element->firstIndex()));
+            writer.put(uint64_t(element->indexCount()));
+
+            const IVertexFormatAttributeList* format = element->vertexFormat();
+            writer.put(uint32_t(format->stride()));
+            writer.put(uint32_t(format->attributeCount()));
+            for (size_t i = 0; i < format->attributeCount(); i++) {
+                const auto& attribute = format->attribute(i);
+                writer.putString(attribute.name);
+                writer.put(uint32_t(attribute.type));
+                writer.put(uint64_t(attribute.offset));
+                writer.put(uint32_t(attribute.normalize ? 1 : 0));
+            }
+        }
+
+        writer.align();
+        writer.put(mesh.vertexData(), mesh.vertexDataSize());
+        writer.align();
+        writer.put(mesh.indexData(), mesh.indexCount() * sizeof(uint16_t));
+
+        writeEntry(key, writer.data);
+    }
+
+    bool DecodedAssetCache::makeKey(IFile* source, uint32_t kind, const std::string& variant, Key& key)
+    {
+        if (!source)
+            return false;
+
+        Hasher hasher;
+        uint64_t size = source->size();
+
+        const uint8_t* mapped = source->mappedData();
+        if (mapped)
+            hasher.add(mapped, size_t(size));
+        else {
+            uint8_t buffer[65536];
+            uint64_t remaining = size;
+            if (!source->seek(0))
+                return false;
+            while (remaining > 0) {
+                size_t bytesRead = source->read(buffer, size_t(std::min<uint64_t>(remaining, sizeof(buffer))));
+                if (bytesRead == 0)
+                    break;
+                hasher.add(buffer, bytesRead);
+                remaining -= bytesRead;
+            }
+            if (!source->seek(0) || remaining != 0)
+                return false;
+        }
+
+        Hasher nameHasher;
+        const std::string& name = source->name();
+        nameHasher.add(reinterpret_cast<const uint8_t*>(name.data()), name.length());
+        nameHasher.add(reinterpret_cast<const uint8_t*>(variant.data()), variant.length());
+
+        char entryName[32];
+        snprintf(entryName, sizeof(entryName), "%016llx.%s",
+            (unsigned long long)nameHasher.result(), (kind == KIND_IMAGE ? "image" : "mesh"));
+
+        key.entryName = entryName;
+        key.kind = kind;
+        key.sourceSize = size;
+        key.sourceHash = hasher.result();
+
+        return true;
+    }
+
+    FilePtr DecodedAssetCache::openEntry(const Key& key, const uint8_t*& payload, size_t& payloadSize)
+    {
+        {
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+            auto it = mEntries.find(key.entryName);
+            if (it == mEntries.end()) {
+                ++mMisses;
+                return nullptr;
+            }
+            it->second.lastUse = ++mUseCounter;
+        }
+
+        std::string path = mDirectory + '/' + key.entryName;
+        FilePtr file = (Services::fileSystem()->fileExists(path) ? Services::fileSystem()->openFile(path) : nullptr);
+
+        // Entries that are not memory mapped are read into memory once, so that the result can reference them
+        // in the same way.
+        if (file && !file->mappedData()) {
+            std::vector<uint8_t> buffer(static_cast<size_t>(file->size()));
+            if (file->read(buffer.data(), buffer.size()) != buffer.size())
+                file.reset();
+            else
+                file = std::make_shared<MemoryFile>(file->name(), std::move(buffer));
+        }
+
+        size_t size = (file ? size_t(file->size()) : 0);
+        if (size < sizeof(Header)) {
+            ++mMisses;
+            return nullptr;
+        }
+
+        const uint8_t* data = file->mappedData();
+        Header header;
+        memcpy(&header, data, sizeof(Header));
+
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.kind != key.kind
+                || header.version != kindVersion(key.kind) || header.sourceSize != key.sourceSize
+                || header.sourceHash != key.sourceHash) {
+            ++mMisses;
+            return nullptr;
+        }
+
+        payload = data + sizeof(Header);
+        payloadSize = size - sizeof(Header);
+        return file;
+    }
+
+    void DecodedAssetCache::writeEntry(const Key& key, const std::vector<uint8_t>& data)
+    {
+        Header header;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.kind = key.kind;
+        header.version = kindVersion(key.kind);
+        header.reserved = 0;
+        header.sourceSize = key.sourceSize;
+        header.sourceHash = key.sourceHash;
+
+        std::string path = mDirectory + '/' + key.entryName;
+        std::string tempPath = path + ".tmp";
+
+        // Entries are written under a temporary name first, so that a partially written entry is never read.
+        FILE* file = fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            B3D_LOGW("Unable to create cache entry \"" << tempPath << "\": " << strerror(errno));
+            return;
+        }
+
+        bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+        if (success && !data.empty())
+            success = fwrite(data.data(), data.size(), 1, file) == 1;
+        if (fclose(file) != 0)
+            success = false;
+
+        if (success) {
+            remove(path.c_str());
+            success = rename(tempPath.c_str(), path.c_str()) == 0;
+        }
+
+        if (!success) {
+            B3D_LOGW("Unable to write cache entry \"" << path << "\": " << strerror(errno));
+            remove(tempPath.c_str());
+            return;
+        }
+
+        ++mStores;
+
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
+        Entry& entry = mEntries[key.entryName];
+        mTotalSize -= entry.size;
+        entry.size = sizeof(header) + data.size();
+        entry.lastUse = ++mUseCounter;
+        mTotalSize += entry.size;
+        trim();
+    }
+
+    void DecodedAssetCache::trim()
+    {
+        while (mTotalSize > mCapacity && !mEntries.empty()) {
+            auto oldest = std::min_element(mEntries.begin(), mEntries.end(),
+                [](const std::pair<const std::string, Entry>& a, const std::pair<const std::string, Entry>& b) {
+                    return a.second.lastUse < b.second.lastUse;
+                });
+
+            std::string path = mDirectory + '/' + oldest->first;
+            remove(path.c_str());
+
+            mTotalSize -= oldest->second.size;
+            mEntries.erase(oldest);
+        }
+    }
+
+    void DecodedAssetCache::loadIndex()
+    {
+        std::string path = mDirectory + "/index";
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+            return;
+
+        char name[64];
+        unsigned long long size, lastUse;
+        while (fscanf(file, "%63s %llu %llu", name, &size, &lastUse) == 3) {
+            Entry& entry = mEntries[name];
+            mTotalSize -= entry.size;
+            entry.size = uint64_t(size);
+            entry.lastUse = uint64_t(lastUse);
+            mTotalSize += entry.size;
+            mUseCounter = std::max(mUseCounter, entry.lastUse);
+        }
+
+        fclose(file);
+        trim();
+    }
+
+    void DecodedAssetCache::saveIndex()
+    {
+        std::string path = mDirectory + "/index";
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) {
+            B3D_LOGW("Unable to write cache index \"" << path << "\": " << strerror(errno));
+            return;
+        }
+
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
+        for (const auto& it : mEntries)
+            fprintf(file, "%s %llu %llu\n", it.first.c_str(), (unsigned long long)it.second.size,
+                (unsigned long long)it.second.lastUse);
+
+        fclose(file);
+    }
+}
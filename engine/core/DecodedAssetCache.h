@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/io/IFile.h"
+#include "engine/image/Image.h"
+#include "engine/mesh/RawMeshData.h"
+#include <unordered_map>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+namespace B3D
+{
+    // On-disk cache of decoded images and imported meshes. Entries are keyed by the source file name, the
+    // content hash of the source and the version of the decoded format, and are mapped back without copying where
+    // the file system supports it. The least recently used entries are removed once the cache outgrows its capacity.
+    class DecodedAssetCache
+    {
+    public:
+        // Bump these whenever the output of the image decoders or mesh importers changes.
+        static const uint32_t IMAGE_VERSION = 2;
+        static const uint32_t MESH_VERSION = 1;
+
+        struct Key
+        {
+            std::string entryName;
+            uint32_t kind = 0;
+            uint64_t sourceSize = 0;
+            uint64_t sourceHash = 0;
+        };
+
+        // Entries are read through the file system and written with stdio, so the directory should be given
+        // relative to the working directory, which is where the file system is rooted on desktop platforms.
+        // The directory must exist.
+        DecodedAssetCache(const std::string& directory, size_t capacity);
+        ~DecodedAssetCache();
+
+        // Hashes the contents of the source; the file is rewound afterwards. Returns false if it can't be read.
+        // Images decoded with different load hints are stored separately under their variant names.
+        bool imageKey(IFile* source, Key& key, const std::string& variant = std::string());
+        bool meshKey(IFile* source, Key& key);
+
+        ImagePtr loadImage(const Key& key);
+        void storeImage(const Key& key, const IImage& image);
+
+        RawMeshDataPtr loadMesh(const Key& key);
+        void storeMesh(const Key& key, const IRawMeshData& mesh);
+
+        uint64_t hits() const { return mHits.load(); }
+        uint64_t misses() const { return mMisses.load(); }
+
+    private:
+        struct Entry
+        {
+            uint64_t size = 0;
+            uint64_t lastUse = 0;
+        };
+
+        std::string mDirectory;
+        size_t mCapacity;
+        std::mutex mMutex;
+        std::unordered_map<std::string, Entry> mEntries;
+        uint64_t mTotalSize;
+        uint64_t mUseCounter;
+        std::atomic<uint64_t> mHits;
+        std::atomic<uint64_t> mMisses;
+        std::atomic<uint64_t> mStores;
+
+        bool makeKey(IFile* source, uint32_t kind, const std::string& variant, Key& key);
+        FilePtr openEntry(const Key& key, const uint8_t*& payload, size_t& payloadSize);
+        void writeEntry(const Key& key, const std::vector<uint8_t>& data);
+        void trim();
+        void loadIndex();
+        void saveIndex();
+
+        B3D_DISABLE_COPY(DecodedAssetCache);
+    };
+
+    using DecodedAssetCachePtr = std::shared_ptr<DecodedAssetCache>;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "FilePreloader.h"
+#include "engine/core/Services.h"
+
+namespace B3D
+{
+    FilePreloader::FilePreloader()
+    {
+    }
+
+    FilePreloader::~FilePreloader()
+    {
+    }
+
+    size_t FilePreloader::preload(const std::vector<std::string>& fileNames, TaskPriority priority)
+    {
+        const auto& reader = Services::asyncFileReader();
+        if (!reader)
+            return 0;
+
+        std::weak_ptr<FilePreloader> weakThis = shared_from_this();
+        std::vector<IAsyncFileReader::Request> requests;
+        requests.reserve(fileNames.size());
+
+        {
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+            for (const auto& fileName : fileNames) {
+                auto& entry = mEntries[fileName];
+                if (entry)
+                    continue;
+
+                entry = std::make_shared<Entry>();
+                std::shared_ptr<Entry> sharedEntry = entry;
+
+                IAsyncFileReader::Request request;
+                request.fileName = fileName;
+                request.priority = priority;
+                // Loaders may already be blocked in openFile() on every background thread.
+                request.invokeOnIoThread = true;
+                request.callback = [weakThis, sharedEntry](const FilePtr& file) {
+                    auto self = weakThis.lock();
+                    if (!self)
+                        return;
+                    std::lock_guard<decltype(self->mMutex)> lock(self->mMutex);
+                    sharedEntry->file = file;
+                    sharedEntry->complete = true;
+                    self->mCondition.notify_all();
+                };
+                requests.emplace_back(std::move(request));
+            }
+        }
+
+        size_t count = requests.size();
+        if (count != 0)
+            reader->submit(std::move(requests));
+
+        return count;
+    }
+
+    FilePtr FilePreloader::openFile(const std::string& fileName)
+    {
+        FilePtr file;
+        {
+            std::unique_lock<decltype(mMutex)> lock(mMutex);
+            auto it = mEntries.find(fileName);
+            if (it != mEntries.end()) {
+                std::shared_ptr<Entry> entry = std::move(it->second);
+                mEntries.erase(it);
+                mCondition.wait(lock, [&entry]() { return entry->complete; });
+                file = std::move(entry->file);
+            }
+        }
+
+        if (!file)
+            file = Services::fileSystem()->openFile(fileName);
+
+        return file;
+    }
+
+    void FilePreloader::discard(const std::vector<std::string>& fileNames)
+    {
+        std::vector<std::shared_ptr<Entry>> entries;
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
+        for (const auto& fileName : fileNames) {
+            auto it = mEntries.find(fileName);
+            if (it != mEntries.end()) {
+                entries.emplace_back(std::move(it->second));
+                mEntries.erase(it);
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/core/ITaskGroup.h"
+#include "engine/interfaces/io/IFile.h"
+#include <condition_variable>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace B3D
+{
+    // Holds files read in advance through the asynchronous file reader until their loaders pick them up.
+    class FilePreloader : public std::enable_shared_from_this<FilePreloader>
+    {
+    public:
+        FilePreloader();
+        ~FilePreloader();
+
+        // Submits all reads as a single batch. Returns the number of files actually scheduled.
+        size_t preload(const std::vector<std::string>& fileNames, TaskPriority priority);
+
+        // Hands over a preloaded file, waiting for its read to complete if necessary. Files that have not been
+        // preloaded, or could not be read, are opened through the file system.
+        FilePtr openFile(const std::string& fileName);
+
+        // Drops preloaded files that were never requested.
+        void discard(const std::vector<std::string>& fileNames);
+
+    private:
+        struct Entry
+        {
+            FilePtr file;
+            bool complete = false;
+        };
+
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::unordered_map<std::string, std::shared_ptr<Entry>> mEntries;
+
+        B3D_DISABLE_COPY(FilePreloader);
+    };
+
+    using FilePreloaderPtr = std::shared_ptr<FilePreloader>;
+}
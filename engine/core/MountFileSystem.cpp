@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "MountFileSystem.h"
+#include "engine/core/Log.h"
+#include <algorithm>
+
+namespace B3D
+{
+    MountFileSystem::MountFileSystem()
+        : mMounts(std::make_shared<MountList>())
+    {
+    }
+
+    MountFileSystem::~MountFileSystem()
+    {
+    }
+
+    void MountFileSystem::mount(const FileSystemPtr& fileSystem)
+    {
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
+        auto newMounts = std::make_shared<MountList>(*mMounts);
+        newMounts->emplace_back(fileSystem);
+        mMounts = std::move(newMounts);
+    }
+
+    void MountFileSystem::unmount(const FileSystemPtr& fileSystem)
+    {
+        // The removed file system is released after the mutex.
+        std::shared_ptr<const MountList> oldMounts;
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
+        auto newMounts = std::make_shared<MountList>(*mMounts);
+        newMounts->erase(std::remove(newMounts->begin(), newMounts->end(), fileSystem), newMounts->end());
+        oldMounts = std::move(mMounts);
+        mMounts = std::move(newMounts);
+    }
+
+    FileSystemPtr MountFileSystem::resolve(const std::string& name)
+    {
+        std::shared_ptr<const MountList> mounts = snapshot();
+        for (auto it = mounts->rbegin(); it != mounts->rend(); ++it) {
+            if ((*it)->fileExists(name))
+                return *it;
+        }
+        return nullptr;
+    }
+
+    bool MountFileSystem::fileExists(const std::string& name)
+    {
+        return resolve(name) != nullptr;
+    }
+
+    FilePtr MountFileSystem::openFile(const std::string& name)
+    {
+        FileSystemPtr fileSystem = resolve(name);
+        if (fileSystem)
+            return fileSystem->openFile(name);
+
+        B3D_LOGE("Unable to open file \"" << name << "\": file not found.");
+        return nullptr;
+    }
+
+    std::shared_ptr<const MountFileSystem::MountList> MountFileSystem::snapshot()
+    {
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
+        return mMounts;
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/io/IFileSystem.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace B3D
+{
+    // Stack of file systems searched from the most recently mounted one down. Mounting a directory of loose
+    // files over an archive lets patched files override the packed ones.
+    class MountFileSystem : public IFileSystem
+    {
+    public:
+        MountFileSystem();
+        ~MountFileSystem();
+
+        void mount(const FileSystemPtr& fileSystem);
+        void unmount(const FileSystemPtr& fileSystem);
+
+        // Returns the mounted file system that the file would be opened from, or nullptr if there is none.
+        FileSystemPtr resolve(const std::string& name);
+
+        bool fileExists(const std::string& name) override;
+        FilePtr openFile(const std::string& name) override;
+
+    private:
+        using MountList = std::vector<FileSystemPtr>;
+
+        // Replaced as a whole on (un)mount. Lookups only hold the mutex while they copy the pointer, so that a slow
+        // file system never blocks the others.
+        std::mutex mMutex;
+        std::shared_ptr<const MountList> mMounts;
+
+        std::shared_ptr<const MountList> snapshot();
+
+        B3D_DISABLE_COPY(MountFileSystem);
+    };
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/core/ResourceFuture.h"
+#include <unordered_map>
+#include <functional>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+namespace B3D
+{
+    // Thread-safe map from file name to a weakly referenced resource and its load state. The map is split into
+    // shards selected by the hash of the key, so that concurrent lookups of different keys rarely contend.
+    template <typename TYPE> class ResourceCache
+    {
+    public:
+        static const size_t SHARD_COUNT = 16;
+
+        ResourceCache() : mHits(0), mMisses(0) {}
+        ~ResourceCache() {}
+
+        // If there is no live resource for the key, `create(resource, state)` is called while the shard is locked
+        // and its results are published, so that concurrent requests for the same key share a single load. Failed
+        // or cancelled loads are never reused, so that the next request retries them.
+        // Returns true when `create` has been called.
+        template <typename CREATE>
+        bool findOrCreate(const std::string& key, std::shared_ptr<TYPE>& resource, ResourceLoadStatePtr& state,
+            CREATE&& create)
+        {
+            Shard& shard = mShards[std::hash<std::string>()(key) % SHARD_COUNT];
+            std::lock_guard<decltype(shard.mutex)> lock(shard.mutex);
+
+            Entry& entry = shard.entries[key];
+            resource = entry.resource.lock();
+            if (resource && !hasFailed(entry)) {
+                state = entry.state;
+                ++mHits;
+                return false;
+            }
+
+            ++mMisses;
+            create(resource, state);
+            entry.resource = resource;
+            entry.state = state;
+            return true;
+        }
+
+        // Returns true if there is a live, not failed resource for the key. Does not count as a cache access.
+        bool contains(const std::string& key)
+        {
+            Shard& shard = mShards[std::hash<std::string>()(key) % SHARD_COUNT];
+            std::lock_guard<decltype(shard.mutex)> lock(shard.mutex);
+
+            auto it = shard.entries.find(key);
+            return it != shard.entries.end() && !it->second.resource.expired() && !hasFailed(it->second);
+        }
+
+        uint64_t hits() const { return mHits.load(); }
+        uint64_t misses() const { return mMisses.load(); }
+
+    private:
+        struct Entry
+        {
+            std::weak_ptr<TYPE> resource;
+            ResourceLoadStatePtr state;
+        };
+
+        struct Shard
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, Entry> entries;
+        };
+
+        static bool hasFailed(const Entry& entry) { return entry.state->isReady() && !entry.state->succeeded(); }
+
+        Shard mShards[SHARD_COUNT];
+        std::atomic<uint64_t> mHits;
+        std::atomic<uint64_t> mMisses;
+
+        B3D_DISABLE_COPY(ResourceCache);
+    };
+}
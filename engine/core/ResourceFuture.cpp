@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "ResourceFuture.h"
+#include "engine/core/Services.h"
+
+namespace B3D
+{
+    ResourceLoadState::ResourceLoadState()
+        : mReady(false)
+        , mSucceeded(false)
+    {
+    }
+
+    ResourceLoadState::~ResourceLoadState()
+    {
+    }
+
+    std::shared_ptr<ResourceLoadState> ResourceLoadState::completed(bool success)
+    {
+        auto state = std::make_shared<ResourceLoadState>();
+        state->mSucceeded.store(success);
+        state->mReady.store(true);
+        return state;
+    }
+
+    void ResourceLoadState::then(std::function<void()>&& action)
+    {
+        {
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+            if (!mReady.load()) {
+                mContinuations.emplace_back(std::move(action));
+                return;
+            }
+        }
+
+        Services::threadManager()->performInRenderThread(std::move(action));
+    }
+
+    void ResourceLoadState::complete(bool success)
+    {
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+            mSucceeded.store(success);
+            mReady.store(true);
+            continuations.swap(mContinuations);
+        }
+
+        if (!continuations.empty()) {
+            Services::threadManager()->performInRenderThread([continuations]() {
+                for (const auto& continuation : continuations)
+                    continuation();
+            });
+        }
+    }
+
+    ResourceFutureBase whenAll(const std::vector<ResourceFutureBase>& futures)
+    {
+        struct Context
+        {
+            ResourceLoadStatePtr state;
+            std::atomic<size_t> pending;
+            std::atomic<bool> succeeded;
+        };
+
+        auto context = std::make_shared<Context>();
+        context->state = std::make_shared<ResourceLoadState>();
+        context->pending.store(futures.size() + 1);
+        context->succeeded.store(true);
+
+        auto onComplete = [context]() {
+            if (--context->pending == 0)
+                context->state->complete(context->succeeded.load());
+        };
+
+        for (const auto& future : futures) {
+            const ResourceLoadStatePtr& state = future.state();
+            if (state->isReady()) {
+                if (!state->succeeded())
+                    context->succeeded.store(false);
+                --context->pending;
+                continue;
+            }
+
+            state->then([context, state, onComplete]() {
+                if (!state->succeeded())
+                    context->succeeded.store(false);
+                onComplete();
+            });
+        }
+
+        onComplete();
+
+        return ResourceFutureBase(context->state);
+    }
+}
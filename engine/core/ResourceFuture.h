@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include <functional>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+namespace B3D
+{
+    class ResourceLoadState
+    {
+    public:
+        ResourceLoadState();
+        ~ResourceLoadState();
+
+        static std::shared_ptr<ResourceLoadState> completed(bool success);
+
+        bool isReady() const { return mReady.load(); }
+        bool succeeded() const { return mSucceeded.load(); }
+
+        // Continuations always run on the render thread.
+        void then(std::function<void()>&& action);
+
+        void complete(bool success);
+
+    private:
+        std::mutex mMutex;
+        std::vector<std::function<void()>> mContinuations;
+        std::atomic<bool> mReady;
+        std::atomic<bool> mSucceeded;
+
+        B3D_DISABLE_COPY(ResourceLoadState);
+    };
+
+    using ResourceLoadStatePtr = std::shared_ptr<ResourceLoadState>;
+
+    class ResourceFutureBase
+    {
+    public:
+        ResourceFutureBase() : mState(ResourceLoadState::completed(false)) {}
+        explicit ResourceFutureBase(const ResourceLoadStatePtr& state) : mState(state) {}
+
+        bool isReady() const { return mState->isReady(); }
+        bool succeeded() const { return mState->succeeded(); }
+
+        void then(const std::function<void()>& action) const { mState->then(std::function<void()>(action)); }
+
+        const ResourceLoadStatePtr& state() const { return mState; }
+
+    protected:
+        ResourceLoadStatePtr mState;
+    };
+
+    template <typename RESOURCEPTR> class ResourceFuture : public ResourceFutureBase
+    {
+    public:
+        ResourceFuture() = default;
+        ResourceFuture(const RESOURCEPTR& resource, const ResourceLoadStatePtr& state)
+            : ResourceFutureBase(state), mResource(resource) {}
+
+        // Returns the placeholder immediately; it is fully loaded once isReady() returns true.
+        const RESOURCEPTR& get() const { return mResource; }
+
+        void then(const std::function<void(const RESOURCEPTR&)>& action) const
+        {
+            RESOURCEPTR resource = mResource;
+            mState->then([resource, action]() { action(resource); });
+        }
+
+    private:
+        RESOURCEPTR mResource;
+    };
+
+    ResourceFutureBase whenAll(const std::vector<ResourceFutureBase>& futures);
+}
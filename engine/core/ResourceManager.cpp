@@ -22,6 +22,7 @@
 #include "ResourceManager.h"
 #include "engine/core/Log.h"
 #include "engine/core/Services.h"
+#include "engine/font/Font.h"
 #include "engine/material/Material.h"
 #include "engine/image/Image.h"
 #include "engine/image/SpriteSheet.h"
@@ -30,7 +31,10 @@
 #include "engine/interfaces/render/lowlevel/IRenderer.h"
 #include "engine/interfaces/core/IThreadManager.h"
 #include "engine/material/ShaderLoader.h"
+#include "engine/render/AtlasTexture.h"
 #include <glm/glm.hpp>
+#include <cassert>
+#include <cctype>
 
 namespace B3D
 {
@@ -41,81 +45,292 @@ namespace B3D
         public:
             typedef RESOURCEPTR ResourcePtr;
             std::string fileName;
+            FilePreloaderPtr preloader;
+            DecodedAssetCachePtr decodedAssetCache;
+            std::shared_ptr<const TextureOptions> textureOptions;
+            TextureAtlasPtr textureAtlas;
+            ImageLoadHint imageLoadHint;
+            bool async = false;
 
             virtual ~ResourceLoader() = default;
 
+            // load() runs on a background thread for asynchronous loads and is where a loader requests the
+            // resources it depends on; setup() always runs on the thread that owns the renderer.
             virtual RESOURCEPTR create() = 0;
-            virtual bool load() = 0;
+            virtual bool load(const RESOURCEPTR& resource) = 0;
             virtual void setup(const RESOURCEPTR& resource, bool async) = 0;
+
+            FilePtr openFile() const { return preloader->openFile(fileName); }
         };
 
         ////////////////////////////////////////////////////////////////////////////////////////////
 
-        template <typename LOADER>
-        void loadResourceSync(typename LOADER::ResourcePtr& resource, const std::string& fileName)
+        // Collects load states of the resources requested while a loader loads and sets up its resource, so that
+        // the resource is only reported as ready once everything it depends on is ready too.
+        thread_local std::vector<ResourceFutureBase>* gDependencies;
+
+        class DependencyCollector
+        {
+        public:
+            DependencyCollector() : mPrevious(gDependencies) { gDependencies = &mDependencies; }
+            ~DependencyCollector() { gDependencies = mPrevious; }
+
+            const std::vector<ResourceFutureBase>& dependencies() const { return mDependencies; }
+            std::vector<ResourceFutureBase>& dependencies() { return mDependencies; }
+
+        private:
+            std::vector<ResourceFutureBase> mDependencies;
+            std::vector<ResourceFutureBase>* mPrevious;
+
+            B3D_DISABLE_COPY(DependencyCollector);
+        };
+
+        void completeAfterDependencies(const ResourceLoadStatePtr& state,
+            const std::vector<ResourceFutureBase>& dependencies)
+        {
+            ResourceFutureBase all = whenAll(dependencies);
+            if (all.isReady())
+                state->complete(all.succeeded());
+            else
+                all.then([state, all]() { state->complete(all.succeeded()); });
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        // Resources loaded with a non-default image hint are cached (and recorded in manifests) under
+        // "<file name>#<max dimension>[,fast]", so that they never alias the full resolution version.
+        std::string imageVariant(const ImageLoadHint& hint)
         {
-            LOADER loader;
-            loader.fileName = std::move(fileName);
+            if (hint.isDefault())
+                return std::string();
 
-            resource = loader.create();
+            std::string variant = std::to_string(hint.maxDimension);
+            if (hint.quality == DecodeQuality::Fast)
+                variant += ",fast";
+            return variant;
+        }
 
-            if (loader.load())
-                loader.setup(resource, false);
+        std::string resourceKey(const std::string& fileName, const ImageLoadHint& hint)
+        {
+            std::string variant = imageVariant(hint);
+            return (variant.empty() ? fileName : fileName + '#' + variant);
+        }
+
+        void splitResourceKey(const std::string& key, std::string& fileName, ImageLoadHint& hint)
+        {
+            fileName = key;
+            hint = ImageLoadHint();
+
+            size_t pos = key.rfind('#');
+            if (pos == std::string::npos || pos + 1 >= key.length() || !isdigit((unsigned char)key[pos + 1]))
+                return;
+
+            size_t end = pos + 1;
+            size_t maxDimension = 0;
+            while (end < key.length() && isdigit((unsigned char)key[end]))
+                maxDimension = maxDimension * 10 + size_t(key[end++] - '0');
+
+            DecodeQuality quality = DecodeQuality::Accurate;
+            if (key.compare(end, std::string::npos, ",fast") == 0)
+                quality = DecodeQuality::Fast;
+            else if (end != key.length())
+                return;
+
+            fileName = key.substr(0, pos);
+            hint = ImageLoadHint(maxDimension, quality);
         }
 
         ////////////////////////////////////////////////////////////////////////////////////////////
 
+        // Materials, shaders and sprite sheets mostly reference other resources, so they are accounted for with
+        // a nominal size and their budget effectively limits the number of retained objects.
+        const size_t RETAINED_OBJECT_SIZE = 1024;
+
+        template <typename TYPE> size_t estimateObjectSize(const TYPE&)
+        {
+            return RETAINED_OBJECT_SIZE;
+        }
+
+        size_t estimateTextureSize(const ITexture& texture)
+        {
+            const glm::vec2& size = texture.size();
+            size_t bytes = imageDataSize(texture.pixelFormat(), size_t(size.x), size_t(size.y));
+            if (texture.mipLevelCount() > 1)
+                bytes += bytes / 3;
+            return bytes;
+        }
+
+        size_t estimateMeshSize(const IMesh& mesh)
+        {
+            return mesh.memoryUsage();
+        }
+
+        TextureAtlasPtr createTextureAtlas(const TextureOptions& options)
+        {
+            if (options.atlasMaxTextureSize == 0 || options.atlasPageCount == 0)
+                return nullptr;
+            return std::make_shared<TextureAtlas>(options.atlasMaxTextureSize, options.atlasPageSize,
+                options.atlasPageCount);
+        }
+
+        template <typename TYPE>
+        void fillCacheStats(ResourceCacheStats& stats, const ResourceCache<TYPE>& cache,
+            const ResourceRetentionCache<TYPE>& retention)
+        {
+            stats.hits = cache.hits();
+            stats.misses = cache.misses();
+            stats.evictions = retention.evictions();
+            stats.retainedCount = retention.retainedCount();
+            stats.retainedBytes = retention.retainedBytes();
+            stats.budgetBytes = retention.budget();
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        // Set while a group is being prefetched: only resources actually requested by the scene are recorded, so
+        // that entries which are no longer used drop out of the manifest.
+        thread_local bool gPrefetching;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
         template <typename LOADER>
-        void loadResourceAsync(typename LOADER::ResourcePtr& resource, const std::string& fileName,
-            const std::shared_ptr<ResourceManager::Counters>& counters)
+        void loadResourceSync(LOADER& loader, const typename LOADER::ResourcePtr& resource,
+            const ResourceLoadStatePtr& state)
         {
+            DependencyCollector collector;
+            if (!loader.load(resource)) {
+                state->complete(false);
+                return;
+            }
+
+            loader.setup(resource, false);
+            completeAfterDependencies(state, collector.dependencies());
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        template <typename LOADER>
+        void loadResourceAsync(const std::shared_ptr<LOADER>& loader, const typename LOADER::ResourcePtr& resource,
+            const ResourceLoadStatePtr& state, TaskPriority priority,
+            const std::shared_ptr<ResourceManager::Counters>& counters, const CancellationTokenPtr& cancellationToken)
+        {
+            using ResourceWeakPtr = std::weak_ptr<typename LOADER::ResourcePtr::element_type>;
+
             struct Context
             {
-                LOADER loader;
+                std::shared_ptr<LOADER> loader;
                 std::shared_ptr<ResourceManager::Counters> counters;
-                typename LOADER::ResourcePtr resource;
+                CancellationTokenPtr cancellationToken;
+                ResourceLoadStatePtr state;
+                ResourceWeakPtr resource;
+                std::vector<ResourceFutureBase> dependencies;
+                bool loaded = false;
+
+                // Only the placeholder returned to the caller keeps the resource alive; once every strong
+                // reference to it has gone the remaining stages are skipped.
+                typename LOADER::ResourcePtr lockResource() const
+                {
+                    if (cancellationToken->isCancelled())
+                        return nullptr;
+                    return resource.lock();
+                }
             };
 
             std::shared_ptr<Context> context = std::make_shared<Context>();
-            context->loader.fileName = std::move(fileName);
+            context->loader = loader;
             context->counters = counters;
-
-            resource = context->loader.create();
+            context->cancellationToken = cancellationToken;
+            context->state = state;
             context->resource = resource;
 
             context->counters->onBeginLoadResource();
-            Services::threadManager()->performInBackgroundThread([context]() {
-                if (!context->loader.load()) {
-                    context->counters->onEndLoadResource();
-                    return;
-                }
 
-                Services::threadManager()->performInRenderThread([context]() {
-                    context->loader.setup(context->resource, true);
-                    context->counters->onEndLoadResource();
-                });
+            TaskGroupPtr tasks = Services::threadManager()->createTaskGroup();
+            tasks->setPriority(priority);
+
+            TaskPtr loadTask = tasks->addTask(TaskThread::Background, [context]() {
+                auto res = context->lockResource();
+                if (res) {
+                    DependencyCollector collector;
+                    context->loaded = context->loader->load(res);
+                    context->dependencies.swap(collector.dependencies());
+                }
             });
+            tasks->addTask(TaskThread::Render, [context]() {
+                auto res = (context->loaded ? context->lockResource() : nullptr);
+                if (!res)
+                    context->state->complete(false);
+                else {
+                    DependencyCollector collector;
+                    context->loader->setup(res, true);
+                    collector.dependencies().insert(collector.dependencies().end(),
+                        context->dependencies.begin(), context->dependencies.end());
+                    completeAfterDependencies(context->state, collector.dependencies());
+                }
+                context->counters->onEndLoadResource();
+            }, { loadTask });
         }
 
         ////////////////////////////////////////////////////////////////////////////////////////////
 
-        template <typename LOADER, typename MAP>
-        typename LOADER::ResourcePtr getResource(MAP& map, const std::string& fileName, bool async,
-            const std::shared_ptr<ResourceManager::Counters>& counters)
+        template <typename LOADER, typename CACHE, typename RETENTION>
+        ResourceFuture<typename LOADER::ResourcePtr> getResource(CACHE& cache,
+            const std::shared_ptr<RETENTION>& retention, const std::string& fileName, bool async,
+            TaskPriority priority, const std::shared_ptr<ResourceManager::Counters>& counters,
+            const CancellationTokenPtr& cancellationToken, const FilePreloaderPtr& preloader,
+            const DecodedAssetCachePtr& decodedAssetCache, const std::shared_ptr<const TextureOptions>& textureOptions,
+            const TextureAtlasPtr& textureAtlas = nullptr, const ImageLoadHint& imageLoadHint = ImageLoadHint())
         {
-            auto& weakRef = map[fileName];
+            using ResourceWeakPtr = std::weak_ptr<typename LOADER::ResourcePtr::element_type>;
+
+            std::string key = resourceKey(fileName, imageLoadHint);
+
+            std::shared_ptr<LOADER> loader;
+            typename LOADER::ResourcePtr resource;
+            ResourceLoadStatePtr state;
+
+            cache.findOrCreate(key, resource, state,
+                [&loader, &fileName, async, &preloader, &decodedAssetCache, &textureOptions, &textureAtlas,
+                        &imageLoadHint](typename LOADER::ResourcePtr& res, ResourceLoadStatePtr& st) {
+                    loader = std::make_shared<LOADER>();
+                    loader->fileName = fileName;
+                    loader->preloader = preloader;
+                    loader->decodedAssetCache = decodedAssetCache;
+                    loader->textureOptions = textureOptions;
+                    loader->textureAtlas = textureAtlas;
+                    loader->imageLoadHint = imageLoadHint;
+                    loader->async = async;
+                    res = loader->create();
+                    st = std::make_shared<ResourceLoadState>();
+                });
 
-            typename LOADER::ResourcePtr resource = weakRef.lock();
-            if (resource)
-                return resource;
+            // The load itself is started outside of the cache lock: synchronous loads may request their
+            // dependencies from the same cache shard.
+            if (loader) {
+                if (!async)
+                    loadResourceSync(*loader, resource, state);
+                else
+                    loadResourceAsync(loader, resource, state, priority, counters, cancellationToken);
+
+                // Continuations run on the render thread, which is also where the resource has been set up. Only
+                // successfully loaded resources are retained: a retained placeholder would keep a cancelled load
+                // running after its last user has gone.
+                ResourceWeakPtr weakResource = resource;
+                state->then([retention, key, weakResource, state]() {
+                    auto res = weakResource.lock();
+                    if (res && state->succeeded()) {
+                        retention->touch(key, res);
+                        retention->updateSize(key, res);
+                    }
+                });
+            } else if (state->isReady() && state->succeeded())
+                retention->touch(key, resource);
 
-            if (!async)
-                loadResourceSync<LOADER>(resource, fileName);
-            else
-                loadResourceAsync<LOADER>(resource, fileName, counters);
+            ResourceFuture<typename LOADER::ResourcePtr> future(resource, state);
+            if (gDependencies)
+                gDependencies->emplace_back(future);
 
-            weakRef = resource;
-            return resource;
+            return future;
         }
     }
 
@@ -123,7 +338,24 @@ namespace B3D
 
     ResourceManager::ResourceManager()
         : mCounters(std::make_shared<Counters>())
+        , mPreloader(std::make_shared<FilePreloader>())
+        , mTextureOptions(std::make_shared<TextureOptions>())
+        , mTextureAtlas(createTextureAtlas(*mTextureOptions))
+        , mCancellationToken(std::make_shared<CancellationToken>())
+        , mRecording(false)
     {
+        mRetainedMaterials = std::make_shared<ResourceRetentionCache<IMaterial>>(
+            &estimateObjectSize<IMaterial>, size_t(DEFAULT_OBJECT_RETENTION_BUDGET));
+        mRetainedShaders = std::make_shared<ResourceRetentionCache<IShader>>(
+            &estimateObjectSize<IShader>, size_t(DEFAULT_OBJECT_RETENTION_BUDGET));
+        mRetainedTextures = std::make_shared<ResourceRetentionCache<ITexture>>(
+            &estimateTextureSize, size_t(DEFAULT_TEXTURE_RETENTION_BUDGET));
+        mRetainedSpriteSheets = std::make_shared<ResourceRetentionCache<ISpriteSheet>>(
+            &estimateObjectSize<ISpriteSheet>, size_t(DEFAULT_OBJECT_RETENTION_BUDGET));
+        mRetainedStaticMeshes = std::make_shared<ResourceRetentionCache<IMesh>>(
+            &estimateMeshSize, size_t(DEFAULT_MESH_RETENTION_BUDGET));
+        mRetainedFonts = std::make_shared<ResourceRetentionCache<IFont>>(
+            &estimateObjectSize<IFont>, size_t(DEFAULT_OBJECT_RETENTION_BUDGET));
     }
 
     ResourceManager::~ResourceManager()
@@ -142,6 +374,286 @@ namespace B3D
         return glm::clamp(float(complete) / float(total), 0.0f, 1.0f);
     }
 
+    void ResourceManager::cancelPendingLoads()
+    {
+        CancellationTokenPtr token = std::make_shared<CancellationToken>();
+        {
+            std::lock_guard<decltype(mSettingsMutex)> lock(mSettingsMutex);
+            mCancellationToken.swap(token);
+        }
+        token->cancel();
+    }
+
+    void ResourceManager::setRetentionBudget(ResourceType type, size_t bytes)
+    {
+        switch (type)
+        {
+        case ResourceType::Material: mRetainedMaterials->setBudget(bytes); return;
+        case ResourceType::Shader: mRetainedShaders->setBudget(bytes); return;
+        case ResourceType::Texture: mRetainedTextures->setBudget(bytes); return;
+        case ResourceType::SpriteSheet: mRetainedSpriteSheets->setBudget(bytes); return;
+        case ResourceType::StaticMesh: mRetainedStaticMeshes->setBudget(bytes); return;
+        case ResourceType::Font: mRetainedFonts->setBudget(bytes); return;
+        case ResourceType::Count: break;
+        }
+        assert(false);
+    }
+
+    void ResourceManager::releaseRetainedResources()
+    {
+        // Materials and sprite sheets reference textures and meshes reference materials, so dependent
+        // resources are released first.
+        mRetainedStaticMeshes->clear();
+        mRetainedMaterials->clear();
+        mRetainedSpriteSheets->clear();
+        mRetainedFonts->clear();
+        mRetainedShaders->clear();
+        mRetainedTextures->clear();
+    }
+
+    ResourceCacheStats ResourceManager::cacheStats(ResourceType type) const
+    {
+        ResourceCacheStats stats;
+        switch (type)
+        {
+        case ResourceType::Material: fillCacheStats(stats, mMaterials, *mRetainedMaterials); break;
+        case ResourceType::Shader: fillCacheStats(stats, mShaders, *mRetainedShaders); break;
+        case ResourceType::Texture: fillCacheStats(stats, mTextures, *mRetainedTextures); break;
+        case ResourceType::SpriteSheet: fillCacheStats(stats, mSpriteSheets, *mRetainedSpriteSheets); break;
+        case ResourceType::StaticMesh: fillCacheStats(stats, mStaticMeshes, *mRetainedStaticMeshes); break;
+        case ResourceType::Font: fillCacheStats(stats, mFonts, *mRetainedFonts); break;
+        case ResourceType::Count: assert(false); break;
+        }
+        return stats;
+    }
+
+    void ResourceManager::setManifestDirectory(const std::string& path)
+    {
+        std::lock_guard<decltype(mGroupsMutex)> lock(mGroupsMutex);
+        mManifestDirectory = path;
+    }
+
+    void ResourceManager::beginRecordingGroup(const std::string& group)
+    {
+        endRecordingGroup();
+
+        std::lock_guard<decltype(mGroupsMutex)> lock(mGroupsMutex);
+        mRecordingGroup = group;
+        mRecordingManifest = std::make_shared<ResourceManifest>();
+        mRecording = true;
+    }
+
+    void ResourceManager::endRecordingGroup()
+    {
+        std::lock_guard<decltype(mGroupsMutex)> lock(mGroupsMutex);
+        if (!mRecordingManifest)
+            return;
+
+        mRecording = false;
+        if (!mManifestDirectory.empty())
+            mRecordingManifest->save(manifestPath(mRecordingGroup));
+
+        mManifests[mRecordingGroup] = std::move(mRecordingManifest);
+        mRecordingManifest.reset();
+        mRecordingGroup.clear();
+    }
+
+    size_t ResourceManager::prefetchGroup(const std::string& group, TaskPriority priority)
+    {
+        ResourceManifestPtr manifest;
+        {
+            std::lock_guard<decltype(mGroupsMutex)> lock(mGroupsMutex);
+            auto it = mManifests.find(group);
+            if (it != mManifests.end())
+                manifest = it->second;
+            else if (!mManifestDirectory.empty()) {
+                manifest = std::make_shared<ResourceManifest>();
+                if (!manifest->load(manifestPath(group)))
+                    manifest.reset();
+                else
+                    mManifests[group] = manifest;
+            }
+        }
+
+        if (!manifest)
+            return 0;
+
+        B3D_LOGI("Prefetching " << manifest->entries().size() << " resources for group \"" << group << "\".");
+
+        // Reads for everything that is not in memory yet are submitted together, ahead of the loads themselves.
+        std::vector<std::string> fileNames;
+        for (const auto& entry : manifest->entries()) {
+            if (!isResourceLoaded(entry.type, entry.fileName)) {
+                std::string fileName;
+                ImageLoadHint hint;
+                splitResourceKey(entry.fileName, fileName, hint);
+                fileNames.emplace_back(std::move(fileName));
+            }
+        }
+        mPreloader->preload(fileNames, priority);
+
+        std::vector<std::shared_ptr<void>> resources;
+        resources.reserve(manifest->entries().size());
+
+        gPrefetching = true;
+        for (const auto& entry : manifest->entries()) {
+            switch (entry.type)
+            {
+            case ResourceType::Material: resources.emplace_back(getMaterial(entry.fileName, true, priority)); break;
+            case ResourceType::Shader: resources.emplace_back(getShader(entry.fileName, true, priority)); break;
+            case ResourceType::Texture: {
+                std::string fileName;
+                ImageLoadHint hint;
+                splitResourceKey(entry.fileName, fileName, hint);
+                resources.emplace_back(getTexture(fileName, hint, true, priority));
+                break;
+            }
+            case ResourceType::SpriteSheet:
+                resources.emplace_back(getSpriteSheet(entry.fileName, true, priority));
+                break;
+            case ResourceType::StaticMesh:
+                resources.emplace_back(getStaticMesh(entry.fileName, true, priority));
+                break;
+            case ResourceType::Font:
+                resources.emplace_back(getFont(entry.fileName, true, priority));
+                break;
+            case ResourceType::Count:
+                break;
+            }
+        }
+        gPrefetching = false;
+
+        std::lock_guard<decltype(mGroupsMutex)> lock(mGroupsMutex);
+        auto& pinned = mPinnedGroups[group];
+        pinned.insert(pinned.end(), resources.begin(), resources.end());
+        auto& preloaded = mPreloadedGroups[group];
+        preloaded.insert(preloaded.end(), fileNames.begin(), fileNames.end());
+
+        return resources.size();
+    }
+
+    void ResourceManager::releaseGroup(const std::string& group)
+    {
+        std::vector<std::shared_ptr<void>> resources;
+        std::vector<std::string> preloaded;
+        {
+            std::lock_guard<decltype(mGroupsMutex)> lock(mGroupsMutex);
+            auto it = mPinnedGroups.find(group);
+            if (it != mPinnedGroups.end()) {
+                resources.swap(it->second);
+                mPinnedGroups.erase(it);
+            }
+            auto jt = mPreloadedGroups.find(group);
+            if (jt != mPreloadedGroups.end()) {
+                preloaded.swap(jt->second);
+                mPreloadedGroups.erase(jt);
+            }
+        }
+
+        // Files of resources that were already loaded by someone else are never picked up by a loader.
+        mPreloader->discard(preloaded);
+    }
+
+    void ResourceManager::setDecodedAssetCache(const std::string& directory, size_t capacityBytes)
+    {
+        DecodedAssetCachePtr cache;
+        if (!directory.empty())
+            cache = std::make_shared<DecodedAssetCache>(directory, capacityBytes);
+
+        std::lock_guard<decltype(mSettingsMutex)> lock(mSettingsMutex);
+        mDecodedAssetCache.swap(cache);
+    }
+
+    void ResourceManager::setTextureOptions(const TextureOptions& options)
+    {
+        // The previous values are released after the mutex.
+        std::shared_ptr<const TextureOptions> ptr = std::make_shared<TextureOptions>(options);
+        TextureAtlasPtr atlas;
+
+        std::lock_guard<decltype(mSettingsMutex)> lock(mSettingsMutex);
+
+        // Textures that have already been packed stay in the pages of the previous atlas
+        if (mTextureOptions->atlasMaxTextureSize != options.atlasMaxTextureSize
+                || mTextureOptions->atlasPageSize != options.atlasPageSize
+                || mTextureOptions->atlasPageCount != options.atlasPageCount) {
+            atlas = createTextureAtlas(options);
+            mTextureAtlas.swap(atlas);
+        }
+
+        mTextureOptions.swap(ptr);
+    }
+
+    void ResourceManager::excludeFromTextureAtlas(const std::string& fileName)
+    {
+        std::lock_guard<decltype(mTextureAtlasMutex)> lock(mTextureAtlasMutex);
+        mTextureAtlasExclusions.insert(fileName);
+    }
+
+    TextureAtlasPtr ResourceManager::textureAtlasFor(const std::string& fileName)
+    {
+        {
+            std::lock_guard<decltype(mTextureAtlasMutex)> lock(mTextureAtlasMutex);
+            if (mTextureAtlasExclusions.find(fileName) != mTextureAtlasExclusions.end())
+                return nullptr;
+        }
+
+        std::lock_guard<decltype(mSettingsMutex)> lock(mSettingsMutex);
+        return mTextureAtlas;
+    }
+
+    DecodedAssetCachePtr ResourceManager::decodedAssetCache() const
+    {
+        std::lock_guard<decltype(mSettingsMutex)> lock(mSettingsMutex);
+        return mDecodedAssetCache;
+    }
+
+    std::shared_ptr<const TextureOptions> ResourceManager::textureOptions() const
+    {
+        std::lock_guard<decltype(mSettingsMutex)> lock(mSettingsMutex);
+        return mTextureOptions;
+    }
+
+    CancellationTokenPtr ResourceManager::cancellationToken() const
+    {
+        std::lock_guard<decltype(mSettingsMutex)> lock(mSettingsMutex);
+        return mCancellationToken;
+    }
+
+    void ResourceManager::recordResource(ResourceType type, const std::string& fileName)
+    {
+        if (!mRecording.load() || gPrefetching)
+            return;
+
+        std::lock_guard<decltype(mGroupsMutex)> lock(mGroupsMutex);
+        if (mRecordingManifest)
+            mRecordingManifest->add(type, fileName);
+    }
+
+    bool ResourceManager::isResourceLoaded(ResourceType type, const std::string& fileName)
+    {
+        switch (type)
+        {
+        case ResourceType::Material: return mMaterials.contains(fileName);
+        case ResourceType::Shader: return mShaders.contains(fileName);
+        case ResourceType::Texture: return mTextures.contains(fileName);
+        case ResourceType::SpriteSheet: return mSpriteSheets.contains(fileName);
+        case ResourceType::StaticMesh: return mStaticMeshes.contains(fileName);
+        case ResourceType::Font: return mFonts.contains(fileName);
+        case ResourceType::Count: break;
+        }
+        return true;
+    }
+
+    std::string ResourceManager::manifestPath(const std::string& group) const
+    {
+        std::string fileName = group;
+        for (char& ch : fileName) {
+            if (!isalnum((unsigned char)ch) && ch != '-' && ch != '.')
+                ch = '_';
+        }
+        return mManifestDirectory + '/' + fileName + ".manifest";
+    }
+
     ShaderPtr ResourceManager::compileShader(const std::vector<std::string>* source, const std::string& fileName)
     {
         auto& shader = mBuiltinShaders[source];
@@ -153,36 +665,50 @@ namespace B3D
     ////////////////
     // Material
 
-    MaterialPtr ResourceManager::getMaterial(const std::string& fileName, bool async)
+    MaterialPtr ResourceManager::getMaterial(const std::string& fileName, bool async, TaskPriority priority)
+    {
+        return loadMaterial(fileName, async, priority).get();
+    }
+
+    ResourceFuture<MaterialPtr> ResourceManager::loadMaterial(const std::string& fileName, bool async,
+        TaskPriority priority)
     {
         struct MaterialResourceLoader : public ResourceLoader<MaterialPtr>
         {
-            std::shared_ptr<Material> mMaterial;
-
             MaterialPtr create() override
             {
-                mMaterial = std::make_shared<Material>();
-                return mMaterial;
+                return std::make_shared<Material>();
             }
 
-            bool load() override
+            bool load(const MaterialPtr& material) override
             {
-                return mMaterial->load(fileName);
+                Material* m = static_cast<Material*>(material.get());
+                if (!m->load(openFile()))
+                    return false;
+                m->loadPendingResources(async);
+                return true;
             }
 
-            void setup(const MaterialPtr&, bool asynchronous) override
+            void setup(const MaterialPtr&, bool) override
             {
-                mMaterial->loadPendingResources(asynchronous);
             }
         };
 
-        return getResource<MaterialResourceLoader>(mMaterials, fileName, async, mCounters);
+        recordResource(ResourceType::Material, fileName);
+        return getResource<MaterialResourceLoader>(mMaterials, mRetainedMaterials, fileName, async, priority,
+            mCounters, cancellationToken(), mPreloader, decodedAssetCache(), textureOptions());
     }
 
     ////////////////
     // Shader
 
-    ShaderPtr ResourceManager::getShader(const std::string& fileName, bool async)
+    ShaderPtr ResourceManager::getShader(const std::string& fileName, bool async, TaskPriority priority)
+    {
+        return loadShader(fileName, async, priority).get();
+    }
+
+    ResourceFuture<ShaderPtr> ResourceManager::loadShader(const std::string& fileName, bool async,
+        TaskPriority priority)
     {
         struct ShaderResourceLoader : public ResourceLoader<ShaderPtr>, public ShaderLoader
         {
@@ -191,10 +717,10 @@ namespace B3D
                 return Services::rendererResourceFactory()->createShader();
             }
 
-            bool load() override
+            bool load(const ShaderPtr&) override
             {
                 B3D_LOGI("Loading shader \"" << fileName << "\".");
-                return ShaderLoader::loadFile(fileName);
+                return ShaderLoader::loadFile(openFile());
             }
 
             void setup(const ShaderPtr& shader, bool) override
@@ -205,13 +731,33 @@ namespace B3D
             }
         };
 
-        return getResource<ShaderResourceLoader>(mShaders, fileName, async, mCounters);
+        recordResource(ResourceType::Shader, fileName);
+        return getResource<ShaderResourceLoader>(mShaders, mRetainedShaders, fileName, async, priority,
+            mCounters, cancellationToken(), mPreloader, decodedAssetCache(), textureOptions());
     }
 
     ////////////////
     // Texture
 
-    TexturePtr ResourceManager::getTexture(const std::string& fileName, bool async)
+    TexturePtr ResourceManager::getTexture(const std::string& fileName, bool async, TaskPriority priority)
+    {
+        return loadTexture(fileName, ImageLoadHint(), async, priority).get();
+    }
+
+    TexturePtr ResourceManager::getTexture(const std::string& fileName, const ImageLoadHint& hint, bool async,
+        TaskPriority priority)
+    {
+        return loadTexture(fileName, hint, async, priority).get();
+    }
+
+    ResourceFuture<TexturePtr> ResourceManager::loadTexture(const std::string& fileName, bool async,
+        TaskPriority priority)
+    {
+        return loadTexture(fileName, ImageLoadHint(), async, priority);
+    }
+
+    ResourceFuture<TexturePtr> ResourceManager::loadTexture(const std::string& fileName, const ImageLoadHint& hint,
+        bool async, TaskPriority priority)
     {
         struct TextureResourceLoader : public ResourceLoader<TexturePtr>
         {
@@ -219,81 +765,220 @@ namespace B3D
 
             TexturePtr create() override
             {
+                if (textureAtlas) {
+                    return std::make_shared<AtlasTexture>(textureAtlas, textureOptions->generateMipmaps,
+                        textureOptions->filter, textureOptions->gammaCorrect);
+                }
                 return Services::rendererResourceFactory()->createTexture();
             }
 
-            bool load() override
+            bool load(const TexturePtr&) override
+            {
+                FilePtr file = openFile();
+
+                DecodedAssetCache::Key key;
+                bool cacheable = decodedAssetCache
+                    && decodedAssetCache->imageKey(file.get(), key, imageVariant(imageLoadHint));
+                if (cacheable) {
+                    mImage = decodedAssetCache->loadImage(key);
+                    if (mImage) {
+                        // Entries stored while mipmap generation was disabled only hold the base level.
+                        if (generateMipmaps())
+                            decodedAssetCache->storeImage(key, *mImage);
+                        return true;
+                    }
+                }
+
+                mImage = Image::fromFile(file, imageLoadHint);
+                if (!mImage || mImage->pixelFormat() == PixelFormat::Invalid)
+                    return false;
+
+                // Compressed containers are already in their final form and are not worth caching. If the GPU cannot
+                // sample them they are decoded here rather than on the render thread.
+                PixelFormat format = mImage->pixelFormat();
+                if (isCompressed(format)) {
+                    cacheable = false;
+                    if (!Services::rendererResourceFactory()->supportsPixelFormat(format)) {
+                        assert(dynamic_cast<Image*>(mImage.get()) != nullptr);
+                        if (!static_cast<Image*>(mImage.get())->convertTo(PixelFormat::RGBA32))
+                            B3D_LOGE("Unable to decode compressed texture \"" << file->name() << "\".");
+                    }
+                }
+
+                generateMipmaps();
+
+                if (cacheable)
+                    decodedAssetCache->storeImage(key, *mImage);
+
+                return true;
+            }
+
+            bool generateMipmaps()
             {
-                mImage = Image::fromFile(fileName);
-                return mImage && mImage->pixelFormat() != PixelFormat::Invalid;
+                if (!textureOptions->generateMipmaps || mImage->mipLevelCount() > 1)
+                    return false;
+                // Atlas pages have no mipmaps; AtlasTexture builds them itself if packing fails after all.
+                if (textureAtlas && textureAtlas->canPack(*mImage))
+                    return false;
+                if (mImage->width() <= 1 && mImage->height() <= 1)
+                    return false;
+
+                assert(dynamic_cast<Image*>(mImage.get()) != nullptr);
+                auto image = static_cast<Image*>(mImage.get());
+                return image->generateMipmaps(textureOptions->filter, textureOptions->gammaCorrect);
             }
 
             void setup(const TexturePtr& texture, bool) override
             {
+                // Hands the decoded pixels back to the buffer pool as soon as they are on the GPU.
                 texture->upload(*mImage);
+                mImage.reset();
             }
         };
 
-        return getResource<TextureResourceLoader>(mTextures, fileName, async, mCounters);
+        recordResource(ResourceType::Texture, resourceKey(fileName, hint));
+        return getResource<TextureResourceLoader>(mTextures, mRetainedTextures, fileName, async, priority,
+            mCounters, cancellationToken(), mPreloader, decodedAssetCache(), textureOptions(), textureAtlasFor(fileName), hint);
     }
 
     ////////////////
     // Sprite sheet
 
-    SpriteSheetPtr ResourceManager::getSpriteSheet(const std::string& fileName, bool async)
+    SpriteSheetPtr ResourceManager::getSpriteSheet(const std::string& fileName, bool async, TaskPriority priority)
+    {
+        return loadSpriteSheet(fileName, async, priority).get();
+    }
+
+    ResourceFuture<SpriteSheetPtr> ResourceManager::loadSpriteSheet(const std::string& fileName, bool async,
+        TaskPriority priority)
     {
         struct SpriteSheetResourceLoader : public ResourceLoader<SpriteSheetPtr>
         {
-            std::shared_ptr<SpriteSheet> mSpriteSheet;
-
             SpriteSheetPtr create() override
             {
-                mSpriteSheet = std::make_shared<SpriteSheet>();
-                return mSpriteSheet;
+                return std::make_shared<SpriteSheet>();
             }
 
-            bool load() override
+            bool load(const SpriteSheetPtr& spriteSheet) override
             {
-                return mSpriteSheet->load(fileName);
+                SpriteSheet* sheet = static_cast<SpriteSheet*>(spriteSheet.get());
+                if (!sheet->load(openFile()))
+                    return false;
+                sheet->loadPendingResources(async);
+                return true;
             }
 
-            void setup(const SpriteSheetPtr&, bool asynchronous) override
+            void setup(const SpriteSheetPtr&, bool) override
             {
-                mSpriteSheet->loadPendingResources(asynchronous);
             }
         };
 
-        return getResource<SpriteSheetResourceLoader>(mSpriteSheets, fileName, async, mCounters);
+        recordResource(ResourceType::SpriteSheet, fileName);
+        return getResource<SpriteSheetResourceLoader>(mSpriteSheets, mRetainedSpriteSheets, fileName, async, priority,
+            mCounters, cancellationToken(), mPreloader, decodedAssetCache(), textureOptions());
     }
 
     ////////////////
     // Static mesh
 
-    MeshPtr ResourceManager::getStaticMesh(const std::string& fileName, bool async)
+    MeshPtr ResourceManager::getStaticMesh(const std::string& fileName, bool async, TaskPriority priority)
+    {
+        return loadStaticMesh(fileName, async, priority).get();
+    }
+
+    ResourceFuture<MeshPtr> ResourceManager::loadStaticMesh(const std::string& fileName, bool async,
+        TaskPriority priority)
     {
         struct StaticMeshResourceLoader : public ResourceLoader<MeshPtr>
         {
-            std::shared_ptr<Mesh> mMesh;
             RawMeshDataPtr mMeshData;
+            std::vector<MaterialPtr> mMaterials;
 
             MeshPtr create() override
             {
-                mMesh = std::make_shared<Mesh>();
-                return mMesh;
+                return std::make_shared<Mesh>();
+            }
+
+            bool load(const MeshPtr&) override
+            {
+                if (!loadMeshData())
+                    return false;
+
+                // Materials start loading from here; Mesh::setData() then finds them in the cache.
+                for (const auto& element : mMeshData->elements())
+                    mMaterials.emplace_back(Services::resourceManager()->getMaterial(element->materialName(), async));
+
+                return true;
+            }
+
+            void setup(const MeshPtr& mesh, bool asynchronous) override
+            {
+                static_cast<Mesh*>(mesh.get())->setData(mMeshData, BufferUsage::Static, asynchronous);
+                mMaterials.clear();
+            }
+
+            bool loadMeshData()
+            {
+                FilePtr file = openFile();
+
+                DecodedAssetCache::Key key;
+                bool cacheable = decodedAssetCache && decodedAssetCache->meshKey(file.get(), key);
+                if (cacheable) {
+                    mMeshData = decodedAssetCache->loadMesh(key);
+                    if (mMeshData)
+                        return true;
+                }
+
+                mMeshData = RawMeshData::fromFile(file, false);
+                if (!mMeshData)
+                    return false;
+
+                if (cacheable && !mMeshData->elements().empty())
+                    decodedAssetCache->storeMesh(key, *mMeshData);
+
+                return true;
+            }
+        };
+
+        recordResource(ResourceType::StaticMesh, fileName);
+        return getResource<StaticMeshResourceLoader>(mStaticMeshes, mRetainedStaticMeshes, fileName, async, priority,
+            mCounters, cancellationToken(), mPreloader, decodedAssetCache(), textureOptions());
+    }
+
+    ////////////////
+    // Font
+
+    FontPtr ResourceManager::getFont(const std::string& fileName, bool async, TaskPriority priority)
+    {
+        return loadFont(fileName, async, priority).get();
+    }
+
+    ResourceFuture<FontPtr> ResourceManager::loadFont(const std::string& fileName, bool async, TaskPriority priority)
+    {
+        struct FontResourceLoader : public ResourceLoader<FontPtr>
+        {
+            Font mLoadedFont;
+
+            FontPtr create() override
+            {
+                return std::make_shared<Font>();
             }
 
-            bool load() override
+            bool load(const FontPtr&) override
             {
-                mMeshData = RawMeshData::fromFile(fileName, false);
-                return mMeshData != nullptr;
+                // Font pages are decoded here, but the font may already be drawn (as empty text) on the render
+                // thread, so it only receives the glyphs in setup().
+                return mLoadedFont.load(openFile());
             }
 
-            void setup(const MeshPtr&, bool asynchronous) override
+            void setup(const FontPtr& font, bool) override
             {
-                mMesh->setData(mMeshData, BufferUsage::Static, asynchronous);
+                static_cast<Font*>(font.get())->setGlyphSource(mLoadedFont.releaseGlyphSource());
             }
         };
 
-        return getResource<StaticMeshResourceLoader>(mStaticMeshes, fileName, async, mCounters);
+        recordResource(ResourceType::Font, fileName);
+        return getResource<FontResourceLoader>(mFonts, mRetainedFonts, fileName, async, priority,
+            mCounters, cancellationToken(), mPreloader, decodedAssetCache(), textureOptions());
     }
 }
@@ -22,11 +22,20 @@
 
 #pragma once
 #include "engine/core/macros.h"
+#include "engine/core/DecodedAssetCache.h"
+#include "engine/core/FilePreloader.h"
+#include "engine/core/ResourceCache.h"
+#include "engine/core/ResourceRetentionCache.h"
+#include "engine/core/ResourceManifest.h"
 #include "engine/interfaces/core/IResourceManager.h"
+#include "engine/render/TextureAtlas.h"
+#include "engine/utility/CancellationToken.h"
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <atomic>
+#include <mutex>
 
 namespace B3D
 {
@@ -44,29 +53,106 @@ namespace B3D
             void onEndLoadResource() { ++complete; --pending; }
         };
 
+        static const size_t DEFAULT_TEXTURE_RETENTION_BUDGET = 64 * 1024 * 1024;
+        static const size_t DEFAULT_MESH_RETENTION_BUDGET = 32 * 1024 * 1024;
+        static const size_t DEFAULT_OBJECT_RETENTION_BUDGET = 256 * 1024;
+
         ResourceManager();
         ~ResourceManager();
 
         bool resourcesAreLoading() const override;
         float resourceLoadProgress() const override;
 
+        void cancelPendingLoads() override;
+
+        void setRetentionBudget(ResourceType type, size_t bytes) override;
+        void releaseRetainedResources() override;
+        ResourceCacheStats cacheStats(ResourceType type) const override;
+
+        void setManifestDirectory(const std::string& path) override;
+        void beginRecordingGroup(const std::string& group) override;
+        void endRecordingGroup() override;
+        size_t prefetchGroup(const std::string& group, TaskPriority priority = TaskPriority::Critical) override;
+        void releaseGroup(const std::string& group) override;
+
+        void setDecodedAssetCache(const std::string& directory, size_t capacityBytes) override;
+        void setTextureOptions(const TextureOptions& options) override;
+        void excludeFromTextureAtlas(const std::string& fileName) override;
+
         ShaderPtr compileShader(const std::vector<std::string>* source,
             const std::string& fileName = "<builtin>") override;
 
-        MaterialPtr getMaterial(const std::string& fileName, bool async = true) override;
-        ShaderPtr getShader(const std::string& fileName, bool async = true) override;
-        TexturePtr getTexture(const std::string& fileName, bool async = true) override;
-        SpriteSheetPtr getSpriteSheet(const std::string& fileName, bool async = true) override;
-        MeshPtr getStaticMesh(const std::string& fileName, bool async = true) override;
+        MaterialPtr getMaterial(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        ShaderPtr getShader(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        TexturePtr getTexture(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        TexturePtr getTexture(const std::string& fileName, const ImageLoadHint& hint, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        SpriteSheetPtr getSpriteSheet(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        MeshPtr getStaticMesh(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        FontPtr getFont(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+
+        ResourceFuture<MaterialPtr> loadMaterial(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        ResourceFuture<ShaderPtr> loadShader(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        ResourceFuture<TexturePtr> loadTexture(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        ResourceFuture<TexturePtr> loadTexture(const std::string& fileName, const ImageLoadHint& hint,
+            bool async = true, TaskPriority priority = TaskPriority::Visible) override;
+        ResourceFuture<SpriteSheetPtr> loadSpriteSheet(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        ResourceFuture<MeshPtr> loadStaticMesh(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
+        ResourceFuture<FontPtr> loadFont(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) override;
 
     private:
-        std::unordered_map<std::string, std::weak_ptr<IMaterial>> mMaterials;
-        std::unordered_map<std::string, std::weak_ptr<IShader>> mShaders;
+        ResourceCache<IMaterial> mMaterials;
+        ResourceCache<IShader> mShaders;
         std::unordered_map<const void*, std::shared_ptr<IShader>> mBuiltinShaders;
-        std::unordered_map<std::string, std::weak_ptr<ITexture>> mTextures;
-        std::unordered_map<std::string, std::weak_ptr<ISpriteSheet>> mSpriteSheets;
-        std::unordered_map<std::string, std::weak_ptr<IMesh>> mStaticMeshes;
+        ResourceCache<ITexture> mTextures;
+        ResourceCache<ISpriteSheet> mSpriteSheets;
+        ResourceCache<IMesh> mStaticMeshes;
+        ResourceCache<IFont> mFonts;
+        std::shared_ptr<ResourceRetentionCache<IMaterial>> mRetainedMaterials;
+        std::shared_ptr<ResourceRetentionCache<IShader>> mRetainedShaders;
+        std::shared_ptr<ResourceRetentionCache<ITexture>> mRetainedTextures;
+        std::shared_ptr<ResourceRetentionCache<ISpriteSheet>> mRetainedSpriteSheets;
+        std::shared_ptr<ResourceRetentionCache<IMesh>> mRetainedStaticMeshes;
+        std::shared_ptr<ResourceRetentionCache<IFont>> mRetainedFonts;
         std::shared_ptr<Counters> mCounters;
+        FilePreloaderPtr mPreloader;
+        mutable std::mutex mSettingsMutex;
+        DecodedAssetCachePtr mDecodedAssetCache;
+        std::shared_ptr<const TextureOptions> mTextureOptions;
+        TextureAtlasPtr mTextureAtlas;
+        CancellationTokenPtr mCancellationToken;
+        std::mutex mTextureAtlasMutex;
+        std::unordered_set<std::string> mTextureAtlasExclusions;
+        std::mutex mGroupsMutex;
+        std::string mManifestDirectory;
+        std::string mRecordingGroup;
+        ResourceManifestPtr mRecordingManifest;
+        std::atomic<bool> mRecording;
+        std::unordered_map<std::string, ResourceManifestPtr> mManifests;
+        std::unordered_map<std::string, std::vector<std::shared_ptr<void>>> mPinnedGroups;
+        std::unordered_map<std::string, std::vector<std::string>> mPreloadedGroups;
+
+        void recordResource(ResourceType type, const std::string& fileName);
+        bool isResourceLoaded(ResourceType type, const std::string& fileName);
+        std::string manifestPath(const std::string& group) const;
+        TextureAtlasPtr textureAtlasFor(const std::string& fileName);
+
+        // Loads started on any thread take a copy of the current settings under mSettingsMutex.
+        DecodedAssetCachePtr decodedAssetCache() const;
+        std::shared_ptr<const TextureOptions> textureOptions() const;
+        CancellationTokenPtr cancellationToken() const;
 
         B3D_DISABLE_COPY(ResourceManager);
     };
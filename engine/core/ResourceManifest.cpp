@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "ResourceManifest.h"
+#include "engine/core/Log.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+namespace B3D
+{
+    namespace
+    {
+        const char* const TYPE_NAMES[] = {
+            "material",
+            "shader",
+            "texture",
+            "spritesheet",
+            "mesh",
+            "font",
+        };
+
+        static_assert(sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0]) == size_t(ResourceType::Count),
+            "TYPE_NAMES does not match ResourceType.");
+
+        bool typeFromName(const std::string& name, ResourceType& type)
+        {
+            for (size_t i = 0; i < size_t(ResourceType::Count); i++) {
+                if (name == TYPE_NAMES[i]) {
+                    type = ResourceType(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string entryKey(ResourceType type, const std::string& fileName)
+        {
+            std::string key = TYPE_NAMES[size_t(type)];
+            key += ' ';
+            key += fileName;
+            return key;
+        }
+    }
+
+    ResourceManifest::ResourceManifest()
+    {
+    }
+
+    ResourceManifest::~ResourceManifest()
+    {
+    }
+
+    void ResourceManifest::add(ResourceType type, const std::string& fileName)
+    {
+        if (mKeys.insert(entryKey(type, fileName)).second)
+            mEntries.emplace_back(Entry{ type, fileName });
+    }
+
+    bool ResourceManifest::load(const std::string& path)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+
+        std::string line;
+        for (;;) {
+            int ch = fgetc(file);
+            if (ch != '\n' && ch != '\r' && ch != EOF) {
+                line += char(ch);
+                continue;
+            }
+
+            size_t space = line.find(' ');
+            ResourceType type;
+            if (space != std::string::npos && typeFromName(line.substr(0, space), type))
+                add(type, line.substr(space + 1));
+            else if (!line.empty())
+                B3D_LOGW("Ignoring invalid line \"" << line << "\" in resource manifest \"" << path << "\".");
+            line.clear();
+
+            if (ch == EOF)
+                break;
+        }
+
+        bool success = !ferror(file);
+        if (!success)
+            B3D_LOGE("Unable to read resource manifest \"" << path << "\": " << strerror(errno));
+
+        fclose(file);
+        return success;
+    }
+
+    bool ResourceManifest::save(const std::string& path) const
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) {
+            B3D_LOGE("Unable to create resource manifest \"" << path << "\": " << strerror(errno));
+            return false;
+        }
+
+        for (const auto& entry : mEntries)
+            fprintf(file, "%s %s\n", TYPE_NAMES[size_t(entry.type)], entry.fileName.c_str());
+
+        bool success = (fclose(file) == 0);
+        if (!success)
+            B3D_LOGE("Unable to write resource manifest \"" << path << "\": " << strerror(errno));
+
+        return success;
+    }
+}
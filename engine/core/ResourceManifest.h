@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/core/IResourceManager.h"
+#include <unordered_set>
+#include <vector>
+#include <string>
+
+namespace B3D
+{
+    // List of the resources loaded for a scene or another named group of resources, in the order they have been
+    // requested. Stored as a text file with one "<type> <file name>" pair per line.
+    class ResourceManifest
+    {
+    public:
+        struct Entry
+        {
+            ResourceType type;
+            std::string fileName;
+        };
+
+        ResourceManifest();
+        ~ResourceManifest();
+
+        const std::vector<Entry>& entries() const { return mEntries; }
+        bool empty() const { return mEntries.empty(); }
+
+        void add(ResourceType type, const std::string& fileName);
+
+        bool load(const std::string& path);
+        bool save(const std::string& path) const;
+
+    private:
+        std::vector<Entry> mEntries;
+        std::unordered_set<std::string> mKeys;
+
+        B3D_DISABLE_COPY(ResourceManifest);
+    };
+
+    using ResourceManifestPtr = std::shared_ptr<ResourceManifest>;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include <unordered_map>
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <list>
+
+namespace B3D
+{
+    // Keeps strong references to the most recently used resources of a single type, so that resources released
+    // by their last user can be picked up again without reloading. Entries are ordered by last use, and the least
+    // recently used ones are dropped once the sum of their estimated sizes exceeds the budget.
+    template <typename TYPE> class ResourceRetentionCache
+    {
+    public:
+        using SizeFunction = size_t (*)(const TYPE& resource);
+
+        ResourceRetentionCache(SizeFunction sizeFunction, size_t budget)
+            : mSizeFunction(sizeFunction)
+            , mBudget(budget)
+            , mTotalSize(0)
+            , mEvictions(0)
+        {
+        }
+
+        ~ResourceRetentionCache() {}
+
+        void setBudget(size_t bytes)
+        {
+            std::vector<std::shared_ptr<TYPE>> evicted;
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+            mBudget = bytes;
+            trim(evicted);
+        }
+
+        // Moves the resource to the front of the list. Size of a new entry is unknown until updateSize() is called.
+        void touch(const std::string& key, const std::shared_ptr<TYPE>& resource)
+        {
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+            if (mBudget == 0)
+                return;
+
+            auto it = mIndex.find(key);
+            if (it == mIndex.end()) {
+                mEntries.emplace_front(Entry{ key, resource, 0 });
+                mIndex[key] = mEntries.begin();
+            } else {
+                mEntries.splice(mEntries.begin(), mEntries, it->second);
+                it->second->resource = resource;
+            }
+        }
+
+        // Should be called once the resource has been loaded, on the thread that has loaded it.
+        void updateSize(const std::string& key, const std::shared_ptr<TYPE>& resource)
+        {
+            size_t size = mSizeFunction(*resource);
+
+            std::vector<std::shared_ptr<TYPE>> evicted;
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+
+            auto it = mIndex.find(key);
+            if (it == mIndex.end() || it->second->resource != resource)
+                return;
+
+            mTotalSize = mTotalSize - it->second->size + size;
+            it->second->size = size;
+            trim(evicted);
+        }
+
+        void clear()
+        {
+            std::list<Entry> entries;
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+            mEvictions += mEntries.size();
+            entries.swap(mEntries);
+            mIndex.clear();
+            mTotalSize = 0;
+        }
+
+        size_t budget() const { std::lock_guard<decltype(mMutex)> lock(mMutex); return mBudget; }
+        size_t retainedCount() const { std::lock_guard<decltype(mMutex)> lock(mMutex); return mEntries.size(); }
+        size_t retainedBytes() const { std::lock_guard<decltype(mMutex)> lock(mMutex); return mTotalSize; }
+        uint64_t evictions() const { std::lock_guard<decltype(mMutex)> lock(mMutex); return mEvictions; }
+
+    private:
+        struct Entry
+        {
+            std::string key;
+            std::shared_ptr<TYPE> resource;
+            size_t size;
+        };
+
+        mutable std::mutex mMutex;
+        std::list<Entry> mEntries;
+        std::unordered_map<std::string, typename std::list<Entry>::iterator> mIndex;
+        SizeFunction mSizeFunction;
+        size_t mBudget;
+        size_t mTotalSize;
+        uint64_t mEvictions;
+
+        // Evicted resources are handed back to the caller, so that they are destroyed after the mutex is released.
+        void trim(std::vector<std::shared_ptr<TYPE>>& evicted)
+        {
+            while (!mEntries.empty() && (mTotalSize > mBudget || mBudget == 0)) {
+                Entry& entry = mEntries.back();
+                evicted.emplace_back(std::move(entry.resource));
+                mTotalSize -= entry.size;
+                mIndex.erase(entry.key);
+                mEntries.pop_back();
+                ++mEvictions;
+            }
+        }
+
+        B3D_DISABLE_COPY(ResourceRetentionCache);
+    };
+}
@@ -43,6 +43,11 @@ namespace B3D
         mInstance.mFileSystem = instance;
     }
 
+    void Services::setAsyncFileReader(const AsyncFileReaderPtr& instance)
+    {
+        mInstance.mAsyncFileReader = instance;
+    }
+
     void Services::setThreadManager(const ThreadManagerPtr& instance)
     {
         mInstance.mThreadManager = instance;
@@ -26,6 +26,7 @@
 #include "engine/interfaces/core/IResourceManager.h"
 #include "engine/interfaces/core/IThreadManager.h"
 #include "engine/interfaces/input/IInputManager.h"
+#include "engine/interfaces/io/IAsyncFileReader.h"
 #include "engine/interfaces/io/IFileSystem.h"
 #include "engine/interfaces/render/lowlevel/IRendererResourceFactory.h"
 #include "engine/interfaces/scene/ISceneManager.h"
@@ -37,6 +38,7 @@ namespace B3D
     public:
         static const LoggerPtr& logger() { return mInstance.mLogger; }
         static const FileSystemPtr& fileSystem() { return mInstance.mFileSystem; }
+        static const AsyncFileReaderPtr& asyncFileReader() { return mInstance.mAsyncFileReader; }
         static const ThreadManagerPtr& threadManager() { return mInstance.mThreadManager; }
         static const RendererResourceFactoryPtr& rendererResourceFactory() { return mInstance.mRendererResFactory; }
         static const ResourceManagerPtr& resourceManager() { return mInstance.mResourceManager; }
@@ -45,6 +47,7 @@ namespace B3D
 
         static void setLogger(const LoggerPtr& instance);
         static void setFileSystem(const FileSystemPtr& instance);
+        static void setAsyncFileReader(const AsyncFileReaderPtr& instance);
         static void setThreadManager(const ThreadManagerPtr& instance);
         static void setRendererResourceFactory(const RendererResourceFactoryPtr& instance);
         static void setResourceManager(const ResourceManagerPtr& instance);
@@ -56,6 +59,7 @@ namespace B3D
 
         LoggerPtr mLogger;
         FileSystemPtr mFileSystem;
+        AsyncFileReaderPtr mAsyncFileReader;
         ThreadManagerPtr mThreadManager;
         RendererResourceFactoryPtr mRendererResFactory;
         ResourceManagerPtr mResourceManager;
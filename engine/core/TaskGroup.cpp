@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TaskGroup.h"
+#include <cassert>
+
+namespace B3D
+{
+    class TaskGroup::Task : public ITask
+    {
+    public:
+        std::shared_ptr<TaskGroup> group;
+        std::function<void()> action;
+        std::atomic<size_t> unresolvedDependencies;
+        std::vector<std::shared_ptr<Task>> successors;
+        std::mutex mutex;
+
+        Task(TaskThread thread, std::function<void()>&& act)
+            : action(std::move(act))
+            , unresolvedDependencies(1)
+            , mThread(thread)
+            , mComplete(false)
+        {
+        }
+
+        TaskThread thread() const override { return mThread; }
+        bool isComplete() const override { return mComplete.load(); }
+
+        void markComplete() { mComplete.store(true); }
+
+    private:
+        TaskThread mThread;
+        std::atomic<bool> mComplete;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    TaskGroup::TaskGroup(IThreadManager* threadManager)
+        : mThreadManager(threadManager)
+        , mPriority(TaskPriority::Visible)
+        , mPendingTasks(0)
+    {
+        assert(mThreadManager != nullptr);
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+    }
+
+    TaskPtr TaskGroup::addTask(TaskThread thread, const std::function<void()>& action,
+        const std::vector<TaskPtr>& dependencies)
+    {
+        return addTask(thread, std::function<void()>(action), dependencies);
+    }
+
+    TaskPtr TaskGroup::addTask(TaskThread thread, std::function<void()>&& action,
+        const std::vector<TaskPtr>& dependencies)
+    {
+        assert(action != nullptr);
+
+        auto task = std::make_shared<Task>(thread, std::move(action));
+        task->group = shared_from_this();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ++mPendingTasks;
+        }
+
+        for (const auto& dependency : dependencies) {
+            assert(dynamic_cast<Task*>(dependency.get()) != nullptr);
+            Task* parent = static_cast<Task*>(dependency.get());
+
+            std::lock_guard<std::mutex> lock(parent->mutex);
+            if (!parent->isComplete()) {
+                ++task->unresolvedDependencies;
+                parent->successors.emplace_back(task);
+            }
+        }
+
+        if (--task->unresolvedDependencies == 0)
+            schedule(task);
+
+        return task;
+    }
+
+    void TaskGroup::setPriority(TaskPriority priority)
+    {
+        mPriority.store(priority);
+    }
+
+    size_t TaskGroup::pendingTaskCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mPendingTasks;
+    }
+
+    bool TaskGroup::isComplete() const
+    {
+        return pendingTaskCount() == 0;
+    }
+
+    void TaskGroup::wait()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (mPendingTasks != 0)
+            mCondition.wait(lock);
+    }
+
+    void TaskGroup::schedule(const std::shared_ptr<Task>& task)
+    {
+        auto action = [task]() {
+            task->action();
+            task->action = nullptr;
+            task->group->onTaskComplete(task);
+        };
+
+        switch (task->thread())
+        {
+        case TaskThread::Background:
+            mThreadManager->performInBackgroundThread(mPriority.load(), std::move(action));
+            return;
+        case TaskThread::Render:
+            mThreadManager->performInRenderThread(std::move(action));
+            return;
+        }
+
+        assert(false);
+    }
+
+    void TaskGroup::onTaskComplete(const std::shared_ptr<Task>& task)
+    {
+        std::vector<std::shared_ptr<Task>> successors;
+        {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            task->markComplete();
+            successors.swap(task->successors);
+        }
+
+        for (const auto& successor : successors) {
+            if (--successor->unresolvedDependencies == 0)
+                successor->group->schedule(successor);
+        }
+
+        std::shared_ptr<TaskGroup> self = std::move(task->group);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mPendingTasks == 0)
+            mCondition.notify_all();
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/core/ITaskGroup.h"
+#include "engine/interfaces/core/IThreadManager.h"
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace B3D
+{
+    class TaskGroup : public ITaskGroup, public std::enable_shared_from_this<TaskGroup>
+    {
+    public:
+        explicit TaskGroup(IThreadManager* threadManager);
+        ~TaskGroup();
+
+        TaskPtr addTask(TaskThread thread, const std::function<void()>& action,
+            const std::vector<TaskPtr>& dependencies = std::vector<TaskPtr>()) override;
+        TaskPtr addTask(TaskThread thread, std::function<void()>&& action,
+            const std::vector<TaskPtr>& dependencies = std::vector<TaskPtr>()) override;
+
+        void setPriority(TaskPriority priority) override;
+
+        size_t pendingTaskCount() const override;
+        bool isComplete() const override;
+
+        void wait() override;
+
+    private:
+        class Task;
+
+        IThreadManager* mThreadManager;
+        mutable std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::atomic<TaskPriority> mPriority;
+        size_t mPendingTasks;
+
+        void schedule(const std::shared_ptr<Task>& task);
+        void onTaskComplete(const std::shared_ptr<Task>& task);
+
+        B3D_DISABLE_COPY(TaskGroup);
+    };
+}
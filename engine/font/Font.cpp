@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "Font.h"
+#include "engine/core/Log.h"
+#include "engine/core/Services.h"
+#include "engine/image/Image.h"
+#include "engine/image/PixelConversion.h"
+#include "engine/utility/StringUtils.h"
+#include <algorithm>
+#include <cstring>
+
+namespace B3D
+{
+    std::vector<std::unique_ptr<IFontLoader>> Font::mFontLoaders;
+    std::mutex Font::mFontLoadersMutex;
+
+    static const size_t MISSING_GLYPH = size_t(-1);
+
+    Font::Font()
+        : mPageCount(0)
+    {
+    }
+
+    Font::~Font()
+    {
+    }
+
+    float Font::lineHeight() const
+    {
+        return (mGlyphSource ? mGlyphSource->lineHeight() : 0.0f);
+    }
+
+    float Font::baseline() const
+    {
+        return (mGlyphSource ? mGlyphSource->baseline() : 0.0f);
+    }
+
+    TextLayoutPtr Font::layoutText(const std::string& text)
+    {
+        if (!mGlyphSource)
+            return nullptr;
+
+        auto it = mLayouts.find(text);
+        if (it != mLayouts.end()) {
+            mLayoutsLru.splice(mLayoutsLru.begin(), mLayoutsLru, it->second.lruPosition);
+            return it->second.layout;
+        }
+
+        // Building the layout may start a new page, which drops the cached layouts
+        TextLayoutPtr layout = buildLayout(text);
+
+        if (mLayouts.size() >= LAYOUT_CACHE_SIZE) {
+            mLayouts.erase(mLayoutsLru.back());
+            mLayoutsLru.pop_back();
+        }
+
+        mLayoutsLru.push_front(text);
+        CachedLayout& cached = mLayouts[text];
+        cached.layout = layout;
+        cached.lruPosition = mLayoutsLru.begin();
+
+        return layout;
+    }
+
+    void Font::setGlyphSource(std::unique_ptr<IGlyphSource>&& source)
+    {
+        mGlyphSource = std::move(source);
+        mGlyphs.clear();
+        mLayouts.clear();
+        mLayoutsLru.clear();
+        mPage.reset();
+    }
+
+    std::unique_ptr<IGlyphSource> Font::releaseGlyphSource()
+    {
+        std::unique_ptr<IGlyphSource> source = std::move(mGlyphSource);
+        setGlyphSource(nullptr);
+        return source;
+    }
+
+    bool Font::load(const std::string& fileName)
+    {
+        return load(Services::fileSystem()->openFile(fileName).get());
+    }
+
+    bool Font::load(const FilePtr& file)
+    {
+        return load(file.get());
+    }
+
+    bool Font::load(IFile* file)
+    {
+        if (!file)
+            return false;
+
+        B3D_LOGI("Loading font \"" << file->name() << "\"");
+
+        IFontLoader* fontLoader = nullptr;
+        {
+            std::lock_guard<decltype(mFontLoadersMutex)> lock(mFontLoadersMutex);
+            for (const auto& loader : mFontLoaders) {
+                if (loader->canLoadFont(file)) {
+                    fontLoader = loader.get();
+                    break;
+                }
+            }
+        }
+
+        if (!fontLoader) {
+            B3D_LOGE("There is no loader able to read font \"" << file->name() << "\".");
+            return false;
+        }
+
+        return fontLoader->loadFont(file, this);
+    }
+
+    void Font::registerLoader(std::unique_ptr<IFontLoader>&& loader)
+    {
+        std::lock_guard<decltype(mFontLoadersMutex)> lock(mFontLoadersMutex);
+        mFontLoaders.emplace_back(std::move(loader));
+    }
+
+    const Font::Glyph* Font::glyph(uint32_t codepoint)
+    {
+        auto it = mGlyphs.find(codepoint);
+        if (it == mGlyphs.end()) {
+            Glyph glyph;
+            glyph.texCoords = glm::vec4(0.0f);
+            glyph.page = 0;
+            if (!mGlyphSource->glyphMetrics(codepoint, glyph.metrics))
+                glyph.page = MISSING_GLYPH;
+            it = mGlyphs.emplace(codepoint, glyph).first;
+        }
+
+        Glyph& glyph = it->second;
+        if (glyph.page == MISSING_GLYPH)
+            return nullptr;
+
+        if (glyph.page != mPageCount && !placeGlyph(codepoint, glyph)) {
+            // Drawn as blank space from now on
+            glyph.metrics.size = glm::vec2(0.0f);
+        }
+
+        return &glyph;
+    }
+
+    bool Font::placeGlyph(uint32_t codepoint, Glyph& glyph)
+    {
+        if (glyph.metrics.size.x <= 0.0f || glyph.metrics.size.y <= 0.0f)
+            return true;
+
+        ImagePtr image = mGlyphSource->rasterizeGlyph(codepoint);
+        if (!image || !image->data() || image->width() == 0 || image->height() == 0)
+            return false;
+
+        PixelFormat format = image->pixelFormat();
+        if (format != PixelFormat::Luminance8 && !PixelConversion::canConvert(format, PixelFormat::RGBA32))
+            return false;
+
+        size_t width = image->width();
+        size_t height = image->height();
+        size_t paddedWidth = width + 2 * GLYPH_PADDING;
+        size_t paddedHeight = height + 2 * GLYPH_PADDING;
+        if (paddedWidth > MAX_PAGE_SIZE || paddedHeight > MAX_PAGE_SIZE) {
+            B3D_LOGW("Glyph U+" << std::hex << codepoint << std::dec << " is too large for the glyph texture.");
+            return false;
+        }
+
+        size_t x = 0, y = 0;
+        while (!mPacker.insert(paddedWidth, paddedHeight, x, y))
+            createPage(std::min(mPacker.width() * 2, size_t(MAX_PAGE_SIZE)));
+
+        // Coverage is stored in the alpha channel of white pixels, so that the text color tints the glyph
+        Image pixels(PixelFormat::RGBA32, width, height);
+        pixels.setDataSize(width * height * 4);
+        if (format != PixelFormat::Luminance8)
+            PixelConversion::convert(image->data(), format, pixels.data(), PixelFormat::RGBA32, width * height);
+        else {
+            const uint8_t* src = image->data();
+            uint8_t* dst = pixels.data();
+            for (size_t i = 0; i < width * height; i++, dst += 4) {
+                dst[0] = dst[1] = dst[2] = 255;
+                dst[3] = src[i];
+            }
+        }
+
+        x += GLYPH_PADDING;
+        y += GLYPH_PADDING;
+        mPage->uploadRegion(x, y, pixels);
+
+        float pageSize = float(mPacker.width());
+        glyph.texCoords = glm::vec4(float(x), float(y), float(x + width), float(y + height)) / pageSize;
+        glyph.page = mPageCount;
+
+        return true;
+    }
+
+    void Font::createPage(size_t size)
+    {
+        Image pixels(PixelFormat::RGBA32, size, size);
+        pixels.setDataSize(size * size * 4);
+        memset(pixels.data(), 0, pixels.dataSize());
+
+        mPage = Services::rendererResourceFactory()->createTexture();
+        mPage->upload(pixels);
+        mPacker.reset(size, size);
+        ++mPageCount;
+
+        // Cached layouts refer to the previous page
+        mLayouts.clear();
+        mLayoutsLru.clear();
+    }
+
+    TextLayoutPtr Font::buildLayout(const std::string& text)
+    {
+        if (!mPage)
+            createPage(INITIAL_PAGE_SIZE);
+
+        float lineHeight = mGlyphSource->lineHeight();
+
+        for (int attempt = 0; ; attempt++) {
+            size_t page = mPageCount;
+
+            auto layout = std::make_shared<TextLayout>();
+            layout->glyphs.reserve(text.length());
+
+            glm::vec2 pen(0.0f);
+            float width = 0.0f;
+            uint32_t previous = 0;
+            bool restart = false;
+
+            StringView view(text);
+            for (size_t pos = 0; pos < view.size(); ) {
+                uint32_t codepoint = StringUtils::decodeUtf8(view, pos);
+                if (codepoint == '\n') {
+                    width = std::max(width, pen.x);
+                    pen = glm::vec2(0.0f, pen.y + lineHeight);
+                    previous = 0;
+                    continue;
+                }
+
+                const Glyph* glyph = this->glyph(codepoint);
+                if (!glyph)
+                    continue;
+
+                if (mPageCount != page) {
+                    // The page filled up while the string was laid out. Once more, all glyphs are placed on the new
+                    // page; the string has more glyphs than fit into a page if even that does not work.
+                    if (attempt == 0) {
+                        restart = true;
+                        break;
+                    }
+                    B3D_LOGW("Text is too large for the glyph texture of its font.");
+                    layout->glyphs.clear();
+                    page = mPageCount;
+                }
+
+                if (previous != 0)
+                    pen.x += mGlyphSource->kerning(previous, codepoint);
+                previous = codepoint;
+
+                const GlyphMetrics& metrics = glyph->metrics;
+                if (metrics.size.x > 0.0f && metrics.size.y > 0.0f) {
+                    glm::vec2 topLeft = pen + metrics.offset;
+                    glm::vec2 bottomRight = topLeft + metrics.size;
+
+                    TextLayout::Glyph quad;
+                    quad.rect = glm::vec4(topLeft, bottomRight);
+                    quad.texCoords = glyph->texCoords;
+                    layout->glyphs.emplace_back(quad);
+                }
+
+                pen.x += metrics.advance;
+            }
+
+            if (restart)
+                continue;
+
+            layout->size = glm::vec2(std::max(width, pen.x), pen.y + lineHeight);
+            layout->texture = mPage;
+            return layout;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/font/IFont.h"
+#include "engine/interfaces/font/IFontLoader.h"
+#include "engine/interfaces/font/IGlyphSource.h"
+#include "engine/interfaces/io/IFile.h"
+#include "engine/utility/SkylinePacker.h"
+#include <unordered_map>
+#include <mutex>
+#include <list>
+#include <vector>
+#include <memory>
+
+namespace B3D
+{
+    // Glyphs are rasterized into a single RGBA texture as they are first used, and uploaded with partial texture
+    // updates. A full texture is replaced with an empty one, twice the size until MAX_PAGE_SIZE is reached; layouts
+    // made before that keep the old texture alive and stay valid.
+    class Font : public IFont
+    {
+    public:
+        static const size_t INITIAL_PAGE_SIZE = 256;
+        static const size_t MAX_PAGE_SIZE = 1024;
+        static const size_t GLYPH_PADDING = 1;
+        static const size_t LAYOUT_CACHE_SIZE = 16384;
+
+        Font();
+        ~Font();
+
+        float lineHeight() const override;
+        float baseline() const override;
+
+        TextLayoutPtr layoutText(const std::string& text) override;
+
+        // The glyph source may only be replaced on the render thread.
+        void setGlyphSource(std::unique_ptr<IGlyphSource>&& source);
+        std::unique_ptr<IGlyphSource> releaseGlyphSource();
+
+        bool load(const std::string& fileName);
+        bool load(const FilePtr& file);
+        bool load(IFile* file);
+
+        static void registerLoader(std::unique_ptr<IFontLoader>&& loader);
+        template <typename TYPE, typename... ARGS> static void registerLoader(ARGS&&... args)
+            { registerLoader(std::unique_ptr<TYPE>(new TYPE(std::forward<ARGS>(args)...))); }
+
+    private:
+        struct Glyph
+        {
+            GlyphMetrics metrics;
+            glm::vec4 texCoords;
+            size_t page;
+        };
+
+        struct CachedLayout
+        {
+            TextLayoutPtr layout;
+            std::list<std::string>::iterator lruPosition;
+        };
+
+        static std::vector<std::unique_ptr<IFontLoader>> mFontLoaders;
+        static std::mutex mFontLoadersMutex;
+
+        std::unique_ptr<IGlyphSource> mGlyphSource;
+        std::unordered_map<uint32_t, Glyph> mGlyphs;
+        std::unordered_map<std::string, CachedLayout> mLayouts;
+        std::list<std::string> mLayoutsLru;
+        TexturePtr mPage;
+        SkylinePacker mPacker;
+        size_t mPageCount;
+
+        const Glyph* glyph(uint32_t codepoint);
+        bool placeGlyph(uint32_t codepoint, Glyph& glyph);
+        void createPage(size_t size);
+        TextLayoutPtr buildLayout(const std::string& text);
+
+        B3D_DISABLE_COPY(Font);
+    };
+}
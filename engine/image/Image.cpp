@@ -20,10 +20,14 @@
  * THE SOFTWARE.
  */
 #include "Image.h"
+#include "MipmapGenerator.h"
+#include "PixelConversion.h"
+#include "TextureCompression.h"
 #include "engine/interfaces/io/IFileSystem.h"
-#include "engine/interfaces/image/IImageLoader.h"
 #include "engine/core/Log.h"
 #include "engine/core/Services.h"
+#include <algorithm>
+#include <cassert>
 #include <cstring>
 
 namespace B3D
@@ -32,14 +36,20 @@ namespace B3D
     std::mutex Image::mImageLoadersMutex;
 
     Image::Image()
-        : mWidth(0)
+        : mDataSize(0)
+        , mExternalData(nullptr)
+        , mExternalDataSize(0)
+        , mWidth(0)
         , mHeight(0)
         , mPixelFormat(PixelFormat::Invalid)
     {
     }
 
     Image::Image(PixelFormat fmt, size_t w, size_t h)
-        : mWidth(w)
+        : mDataSize(0)
+        , mExternalData(nullptr)
+        , mExternalDataSize(0)
+        , mWidth(w)
         , mHeight(h)
         , mPixelFormat(fmt)
     {
@@ -57,54 +67,325 @@ namespace B3D
 
     void Image::setDataSize(size_t size)
     {
-        mData.resize(size);
+        detachExternalData();
+        if (size > mBuffer.capacity()) {
+            PixelBufferPool::Buffer buffer = PixelBufferPool::acquire(size);
+            if (mDataSize > 0)
+                memcpy(buffer.data(), mBuffer.data(), mDataSize);
+            mBuffer = std::move(buffer);
+        }
+        mDataSize = size;
     }
 
     void Image::setData(const void* pointer, size_t size)
     {
-        mData.resize(size);
-        memcpy(mData.data(), pointer, size);
+        releaseExternalData();
+        if (size > mBuffer.capacity())
+            mBuffer = PixelBufferPool::acquire(size);
+        mDataSize = size;
+        if (size > 0)
+            memcpy(mBuffer.data(), pointer, size);
     }
 
-    void Image::setData(const std::vector<uint8_t>& newData)
+    void Image::setExternalData(const uint8_t* pointer, size_t size, const std::shared_ptr<void>& owner)
     {
-        mData = newData;
+        mBuffer.release();
+        mDataSize = 0;
+        mExternalDataOwner = owner;
+        mExternalData = pointer;
+        mExternalDataSize = size;
     }
 
-    ImagePtr Image::fromFile(const std::string& name)
+    void Image::setBuffer(PixelBufferPool::Buffer&& buffer, size_t size)
     {
-        return fromFile(Services::fileSystem()->openFile(name).get());
+        assert(size <= buffer.capacity());
+        releaseExternalData();
+        mBuffer = std::move(buffer);
+        mDataSize = size;
     }
 
-    ImagePtr Image::fromFile(const FilePtr& file)
+    const IImage& Image::mipLevel(size_t level) const
     {
-        return fromFile(file.get());
+        assert(level <= mMipLevels.size());
+        return (level == 0 ? *this : *mMipLevels[level - 1]);
     }
 
-    ImagePtr Image::fromFile(IFile* file)
+    bool Image::generateMipmaps(DownsampleFilter filter, bool gammaCorrect)
     {
-        if (!file)
-            return std::make_shared<Image>();
+        if (mWidth * mHeight == 0 || dataSize() < mWidth * mHeight * bytesPerPixel(mPixelFormat))
+            return false;
 
-        B3D_LOGI("Loading image \"" << file->name() << "\"");
-
-        IImageLoader* imageLoader = nullptr;
+        // Packed formats are filtered in RGBA32 and converted back afterwards.
+        std::shared_ptr<Image> source;
+        switch (mPixelFormat)
         {
-            std::lock_guard<decltype(mImageLoadersMutex)> lock(mImageLoadersMutex);
-            for (const auto& loader : mImageLoaders) {
-                if (loader->canLoadImage(file)) {
-                    imageLoader = loader.get();
+        case PixelFormat::Luminance8:
+        case PixelFormat::LuminanceAlpha16:
+        case PixelFormat::RGB24:
+        case PixelFormat::RGBA32:
+            break;
+
+        case PixelFormat::RGB565:
+        case PixelFormat::RGBA4444:
+            source = std::make_shared<Image>(PixelFormat::RGBA32, mWidth, mHeight);
+            source->setDataSize(mWidth * mHeight * 4);
+            PixelConversion::convert(constData(), mPixelFormat, source->data(), PixelFormat::RGBA32, mWidth * mHeight);
+            break;
+
+        default:
+            return false;
+        }
+
+        mMipLevels.clear();
+        const IImage* previous = (source ? source.get() : this);
+        while (previous->width() > 1 || previous->height() > 1) {
+            std::shared_ptr<Image> level = MipmapGenerator::downsample(*previous, filter, gammaCorrect);
+            mMipLevels.emplace_back(level);
+            previous = level.get();
+        }
+
+        if (source) {
+            for (const auto& level : mMipLevels)
+                level->convertTo(mPixelFormat);
+        }
+
+        return true;
+    }
+
+    bool Image::convertTo(PixelFormat format)
+    {
+        if (format == mPixelFormat)
+            return true;
+        if (isCompressed(mPixelFormat) && !isCompressed(format))
+            return decompress() && convertTo(format);
+        if (!PixelConversion::canConvert(mPixelFormat, format))
+            return false;
+
+        size_t count = mWidth * mHeight;
+        size_t srcBpp = bytesPerPixel(mPixelFormat);
+        size_t dstBpp = bytesPerPixel(format);
+        if (dataSize() < count * srcBpp)
+            return false;
+
+        if (dstBpp <= srcBpp && !mExternalData) {
+            PixelConversion::convert(mBuffer.data(), mPixelFormat, mBuffer.data(), format, count);
+            mDataSize = count * dstBpp;
+        } else {
+            PixelBufferPool::Buffer converted = PixelBufferPool::acquire(count * dstBpp);
+            PixelConversion::convert(constData(), mPixelFormat, converted.data(), format, count);
+            setBuffer(std::move(converted), count * dstBpp);
+        }
+
+        for (const auto& level : mMipLevels)
+            level->convertTo(format);
+
+        mPixelFormat = format;
+        return true;
+    }
+
+    void Image::premultiplyAlpha()
+    {
+        PixelConversion::premultiplyAlpha(data(), mPixelFormat, pixelCount());
+        for (const auto& level : mMipLevels)
+            level->premultiplyAlpha();
+    }
+
+    void Image::convertSRGBToLinear()
+    {
+        PixelConversion::srgbToLinear(data(), mPixelFormat, pixelCount());
+        for (const auto& level : mMipLevels)
+            level->convertSRGBToLinear();
+    }
+
+    void Image::convertLinearToSRGB()
+    {
+        PixelConversion::linearToSRGB(data(), mPixelFormat, pixelCount());
+        for (const auto& level : mMipLevels)
+            level->convertLinearToSRGB();
+    }
+
+    bool Image::decompress()
+    {
+        if (!TextureCompression::canDecompress(mPixelFormat))
+            return false;
+
+        for (size_t i = 0; i < mipLevelCount(); i++) {
+            const IImage& level = mipLevel(i);
+            if (level.pixelFormat() != mPixelFormat
+                    || level.dataSize() < imageDataSize(mPixelFormat, level.width(), level.height()))
+                return false;
+        }
+
+        for (const auto& level : mMipLevels)
+            level->decompress();
+
+        PixelBufferPool::Buffer pixels = PixelBufferPool::acquire(mWidth * mHeight * 4);
+        TextureCompression::decompress(constData(), mPixelFormat, mWidth, mHeight, pixels.data());
+        setBuffer(std::move(pixels), mWidth * mHeight * 4);
+        mPixelFormat = PixelFormat::RGBA32;
+
+        return true;
+    }
+
+    bool Image::reduceToFit(size_t maxDimension)
+    {
+        if (maxDimension == 0)
+            return true;
+
+        // Packed formats are filtered in RGBA32, like in generateMipmaps().
+        PixelFormat format = mPixelFormat;
+        bool packed = (format == PixelFormat::RGB565 || format == PixelFormat::RGBA4444);
+        bool converted = false;
+
+        while (std::max(mWidth, mHeight) > maxDimension) {
+            std::shared_ptr<Image> next;
+            if (!mMipLevels.empty()) {
+                next = mMipLevels.front();
+                mMipLevels.erase(mMipLevels.begin());
+            } else {
+                if (isCompressed(mPixelFormat) || mWidth * mHeight == 0
+                        || dataSize() < mWidth * mHeight * bytesPerPixel(mPixelFormat))
                     break;
+                if (packed && !converted) {
+                    convertTo(PixelFormat::RGBA32);
+                    converted = true;
                 }
+                next = MipmapGenerator::downsample(*this, DownsampleFilter::Box, false);
             }
+
+            mWidth = next->mWidth;
+            mHeight = next->mHeight;
+            mBuffer = std::move(next->mBuffer);
+            mDataSize = next->mDataSize;
+            mExternalDataOwner = std::move(next->mExternalDataOwner);
+            mExternalData = next->mExternalData;
+            mExternalDataSize = next->mExternalDataSize;
         }
 
-        if (!imageLoader) {
-            B3D_LOGE("There is no loader able to read image \"" << file->name() << "\".");
+        if (converted)
+            convertTo(format);
+
+        return std::max(mWidth, mHeight) <= maxDimension;
+    }
+
+    size_t Image::pixelCount() const
+    {
+        size_t bpp = bytesPerPixel(mPixelFormat);
+        return (bpp == 0 ? 0 : std::min(mWidth * mHeight, dataSize() / bpp));
+    }
+
+    void Image::detachExternalData()
+    {
+        if (mExternalData) {
+            const uint8_t* pointer = mExternalData;
+            std::shared_ptr<void> owner = std::move(mExternalDataOwner);
+            setData(pointer, mExternalDataSize);
+        }
+    }
+
+    void Image::releaseExternalData()
+    {
+        mExternalDataOwner.reset();
+        mExternalData = nullptr;
+        mExternalDataSize = 0;
+    }
+
+    ImagePtr Image::fromFile(const std::string& name, const ImageLoadHint& hint)
+    {
+        return fromFile(Services::fileSystem()->openFile(name).get(), hint);
+    }
+
+    ImagePtr Image::fromFile(const FilePtr& file, const ImageLoadHint& hint)
+    {
+        return fromFile(file.get(), hint);
+    }
+
+    ImagePtr Image::fromFile(IFile* file, const ImageLoadHint& hint)
+    {
+        IImageLoader* loader = findLoader(file);
+        if (!loader)
             return std::make_shared<Image>();
+
+        ImagePtr image = loader->loadImage(file, hint);
+        if (hint.maxDimension != 0 && std::max(image->width(), image->height()) > hint.maxDimension) {
+            assert(dynamic_cast<Image*>(image.get()) != nullptr);
+            static_cast<Image*>(image.get())->reduceToFit(hint.maxDimension);
+        }
+
+        return image;
+    }
+
+    bool Image::decodeFile(IFile* file, const ImageDecodeTarget& target, const ImageLoadHint& hint)
+    {
+        IImageLoader* loader = findLoader(file);
+        if (!loader)
+            return false;
+
+        if (hint.maxDimension == 0)
+            return loader->decodeImage(file, hint, target);
+
+        // Images which the loader could not scale down enough are decoded into a temporary image first.
+        std::shared_ptr<Image> image;
+        auto reducingTarget = [&image, &target, &hint](PixelFormat format, size_t width, size_t height,
+                size_t& stride) -> uint8_t* {
+            if (std::max(width, height) <= hint.maxDimension)
+                return target(format, width, height, stride);
+            stride = width * bytesPerPixel(format);
+            image = std::make_shared<Image>(format, width, height);
+            image->setDataSize(stride * height);
+            return image->data();
+        };
+
+        if (!loader->decodeImage(file, hint, reducingTarget))
+            return false;
+        if (!image)
+            return true;
+
+        image->reduceToFit(hint.maxDimension);
+
+        size_t rowSize = image->width() * bytesPerPixel(image->pixelFormat());
+        size_t stride = rowSize;
+        uint8_t* pixels = target(image->pixelFormat(), image->width(), image->height(), stride);
+        if (!pixels)
+            return false;
+
+        for (size_t y = 0; y < image->height(); y++)
+            memcpy(pixels + y * stride, image->constData() + y * rowSize, rowSize);
+
+        return true;
+    }
+
+    ImagePtr Image::decodeWith(IImageLoader* loader, IFile* file, const ImageLoadHint& hint)
+    {
+        std::shared_ptr<Image> image;
+        auto target = [&image](PixelFormat format, size_t width, size_t height, size_t& stride) -> uint8_t* {
+            stride = width * bytesPerPixel(format);
+            image = std::make_shared<Image>(format, width, height);
+            image->setDataSize(stride * height);
+            return image->data();
+        };
+
+        if (!loader->decodeImage(file, hint, target) || !image)
+            return std::make_shared<Image>();
+
+        return image;
+    }
+
+    IImageLoader* Image::findLoader(IFile* file)
+    {
+        if (!file)
+            return nullptr;
+
+        B3D_LOGI("Loading image \"" << file->name() << "\"");
+
+        std::lock_guard<decltype(mImageLoadersMutex)> lock(mImageLoadersMutex);
+        for (const auto& loader : mImageLoaders) {
+            if (loader->canLoadImage(file))
+                return loader.get();
         }
 
-        return imageLoader->loadImage(file);
+        B3D_LOGE("There is no loader able to read image \"" << file->name() << "\".");
+        return nullptr;
     }
 
     void Image::registerLoader(std::unique_ptr<IImageLoader>&& loader)
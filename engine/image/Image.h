@@ -23,6 +23,8 @@
 #pragma once
 #include "engine/interfaces/io/IFile.h"
 #include "engine/interfaces/image/IImage.h"
+#include "engine/interfaces/image/IImageLoader.h"
+#include "engine/image/PixelBufferPool.h"
 #include <vector>
 #include <mutex>
 #include <cstdint>
@@ -30,8 +32,6 @@
 
 namespace B3D
 {
-    class IImageLoader;
-
     class Image : public IImage
     {
     public:
@@ -46,19 +46,55 @@ namespace B3D
         size_t height() const override { return mHeight; }
         void setDimensions(size_t w, size_t h = 1);
 
-        size_t dataSize() const override { return mData.size(); }
+        // Pixels live in a buffer borrowed from PixelBufferPool and returned to it when the image is destroyed.
+        // Growing the data keeps the existing bytes but leaves new ones uninitialized.
+        size_t dataSize() const override { return (mExternalData ? mExternalDataSize : mDataSize); }
         void setDataSize(size_t size);
 
-        uint8_t* data() { return mData.data(); }
-        const uint8_t* data() const override { return mData.data(); }
+        uint8_t* data() { detachExternalData(); return mBuffer.data(); }
+        const uint8_t* data() const override { return (mExternalData ? mExternalData : mBuffer.data()); }
 
         void setData(const void* pointer, size_t size);
-        void setData(const std::vector<uint8_t>& newData);
-        void setData(std::vector<uint8_t>&& newData) { mData = std::move(newData); }
+        void setData(const std::vector<uint8_t>& newData) { setData(newData.data(), newData.size()); }
+
+        // References pixels kept alive by the owner (e.g. a memory-mapped file) instead of holding a copy.
+        // The pixels are copied on the first non-const access.
+        void setExternalData(const uint8_t* pointer, size_t size, const std::shared_ptr<void>& owner);
+
+        size_t mipLevelCount() const override { return 1 + mMipLevels.size(); }
+        const IImage& mipLevel(size_t level) const override;
+
+        // Replaces existing mipmap levels with a full chain down to 1x1, built from the pixels of level 0. Returns
+        // false, leaving the image untouched, if it has no valid uncompressed format or not enough data.
+        bool generateMipmaps(DownsampleFilter filter = DownsampleFilter::Box, bool gammaCorrect = false);
+        void addMipLevel(const std::shared_ptr<Image>& level) { mMipLevels.emplace_back(level); }
+        void clearMipLevels() { mMipLevels.clear(); }
+
+        // Converts pixels of all mipmap levels to the given format, in place if the new format is not larger. Returns
+        // false if the image has no valid format or not enough data. Block-compressed images can be decoded (if
+        // TextureCompression supports the format), but not encoded.
+        bool convertTo(PixelFormat format);
+
+        void premultiplyAlpha();
+        void convertSRGBToLinear();
+        void convertLinearToSRGB();
 
-        static ImagePtr fromFile(const std::string& name);
-        static ImagePtr fromFile(const FilePtr& file);
-        static ImagePtr fromFile(IFile* file);
+        // Halves the image until neither side exceeds maxDimension (zero means no limit). Mipmap levels are used
+        // where present, so block-compressed images can only be reduced that way. Returns false if the image could
+        // not be reduced enough.
+        bool reduceToFit(size_t maxDimension);
+
+        static ImagePtr fromFile(const std::string& name, const ImageLoadHint& hint = ImageLoadHint());
+        static ImagePtr fromFile(const FilePtr& file, const ImageLoadHint& hint = ImageLoadHint());
+        static ImagePtr fromFile(IFile* file, const ImageLoadHint& hint = ImageLoadHint());
+
+        // Decodes the base level of an image file into memory supplied by the caller (see ImageDecodeTarget).
+        static bool decodeFile(IFile* file, const ImageDecodeTarget& target,
+            const ImageLoadHint& hint = ImageLoadHint());
+
+        // Implements IImageLoader::loadImage() for loaders which override decodeImage(): pixels are decoded
+        // straight into the image's pooled buffer.
+        static ImagePtr decodeWith(IImageLoader* loader, IFile* file, const ImageLoadHint& hint);
 
         static void registerLoader(std::unique_ptr<IImageLoader>&& loader);
         template <typename TYPE, typename... ARGS> static void registerLoader(ARGS&&... args)
@@ -68,7 +104,21 @@ namespace B3D
         static std::vector<std::unique_ptr<IImageLoader>> mImageLoaders;
         static std::mutex mImageLoadersMutex;
 
-        std::vector<uint8_t> mData;
+        static IImageLoader* findLoader(IFile* file);
+
+        size_t pixelCount() const;
+        bool decompress();
+        const uint8_t* constData() const { return data(); }
+        void setBuffer(PixelBufferPool::Buffer&& buffer, size_t size);
+        void detachExternalData();
+        void releaseExternalData();
+
+        PixelBufferPool::Buffer mBuffer;
+        size_t mDataSize;
+        std::vector<std::shared_ptr<Image>> mMipLevels;
+        std::shared_ptr<void> mExternalDataOwner;
+        const uint8_t* mExternalData;
+        size_t mExternalDataSize;
         size_t mWidth;
         size_t mHeight;
         PixelFormat mPixelFormat;
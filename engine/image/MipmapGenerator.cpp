@@ -0,0 +1,436 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "MipmapGenerator.h"
+#include "Image.h"
+#include "engine/utility/ParallelUtils.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B3D_MIPMAP_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM) || defined(_M_ARM64)
+#define B3D_MIPMAP_NEON
+#include <arm_neon.h>
+#endif
+
+namespace B3D
+{
+    namespace
+    {
+        const size_t PIXELS_PER_CHUNK = 65536;
+        const int MAX_TAPS = 8;
+        const int LINEAR_TO_SRGB_STEPS = 16384;
+
+        struct Taps
+        {
+            int first;
+            int count;
+            float weights[MAX_TAPS];
+        };
+
+        double besselI0(double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 32; k++) {
+                term *= (x * 0.5 / k) * (x * 0.5 / k);
+                sum += term;
+            }
+            return sum;
+        }
+
+        // Destination pixel x covers source pixels 2x and 2x + 1; taps are relative to 2x.
+        Taps makeTaps(DownsampleFilter filter)
+        {
+            Taps taps;
+            if (filter == DownsampleFilter::Box) {
+                taps.first = 0;
+                taps.count = 2;
+                taps.weights[0] = taps.weights[1] = 0.5f;
+                return taps;
+            }
+
+            const double PI = 3.14159265358979323846;
+            const double ALPHA = 4.0;
+            const double WIDTH = 2.0;
+
+            taps.first = -3;
+            taps.count = 8;
+            double total = 0.0;
+            double weights[MAX_TAPS];
+            for (int i = 0; i < taps.count; i++) {
+                double d = (taps.first + i - 0.5) * 0.5;    // distance in destination pixels
+                double t = d / WIDTH;
+                double sinc = std::sin(PI * d) / (PI * d);
+                double window = besselI0(ALPHA * std::sqrt(std::max(0.0, 1.0 - t * t))) / besselI0(ALPHA);
+                weights[i] = sinc * window;
+                total += weights[i];
+            }
+            for (int i = 0; i < taps.count; i++)
+                taps.weights[i] = float(weights[i] / total);
+
+            return taps;
+        }
+
+        struct TransferTables
+        {
+            float toFloat[256];
+            float srgbToLinear[256];
+            uint16_t srgbToLinearFixed[256];      // In LINEAR_TO_SRGB_STEPS units
+            uint8_t linearToSRGB[LINEAR_TO_SRGB_STEPS + 1];
+
+            TransferTables()
+            {
+                for (int i = 0; i < 256; i++) {
+                    double c = i / 255.0;
+                    toFloat[i] = float(c);
+                    srgbToLinear[i] = float(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+                    srgbToLinearFixed[i] = uint16_t(srgbToLinear[i] * LINEAR_TO_SRGB_STEPS + 0.5f);
+                }
+                for (int i = 0; i <= LINEAR_TO_SRGB_STEPS; i++) {
+                    double c = double(i) / LINEAR_TO_SRGB_STEPS;
+                    double srgb = (c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055);
+                    linearToSRGB[i] = uint8_t(srgb * 255.0 + 0.5);
+                }
+            }
+        };
+
+        const TransferTables& transferTables()
+        {
+            static const TransferTables tables;
+            return tables;
+        }
+
+        struct Level
+        {
+            const uint8_t* src;
+            uint8_t* dst;
+            size_t srcWidth;
+            size_t srcHeight;
+            size_t dstWidth;
+            size_t dstHeight;
+            size_t channels;
+        };
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Integer 2x2 box filter
+
+        void boxRowScalar(const Level& l, const uint8_t* row0, const uint8_t* row1, uint8_t* out, size_t x)
+        {
+            size_t ch = l.channels;
+            for (; x < l.dstWidth; x++) {
+                size_t x0 = 2 * x * ch;
+                size_t x1 = std::min(2 * x + 1, l.srcWidth - 1) * ch;
+                for (size_t c = 0; c < ch; c++)
+                    out[x * ch + c] = uint8_t((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+
+        // Returns the number of destination pixels processed.
+        size_t boxRowSIMD(const Level& l, const uint8_t* row0, const uint8_t* row1, uint8_t* out)
+        {
+            size_t x = 0;
+            if (l.srcWidth < 2)
+                return 0;
+
+          #if defined(B3D_MIPMAP_SSE2)
+            if (l.channels == 4) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i two = _mm_set1_epi16(2);
+                for (; x + 4 <= l.dstWidth; x += 4) {
+                    const uint8_t* a = row0 + 8 * x;
+                    const uint8_t* b = row1 + 8 * x;
+                    __m128 a0 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+                    __m128 a1 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16)));
+                    __m128 b0 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+                    __m128 b1 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16)));
+                    __m128i ea = _mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)));
+                    __m128i oa = _mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)));
+                    __m128i eb = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)));
+                    __m128i ob = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+                    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(ea, zero), _mm_unpacklo_epi8(oa, zero));
+                    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(ea, zero), _mm_unpackhi_epi8(oa, zero));
+                    lo = _mm_add_epi16(lo, _mm_add_epi16(_mm_unpacklo_epi8(eb, zero), _mm_unpacklo_epi8(ob, zero)));
+                    hi = _mm_add_epi16(hi, _mm_add_epi16(_mm_unpackhi_epi8(eb, zero), _mm_unpackhi_epi8(ob, zero)));
+                    lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+                    hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(lo, hi));
+                }
+            } else if (l.channels == 1) {
+                const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+                const __m128i two = _mm_set1_epi16(2);
+                for (; x + 16 <= l.dstWidth; x += 16) {
+                    const uint8_t* a = row0 + 2 * x;
+                    const uint8_t* b = row1 + 2 * x;
+                    __m128i sum[2];
+                    for (int i = 0; i < 2; i++) {
+                        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16 * i));
+                        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16 * i));
+                        __m128i sa = _mm_add_epi16(_mm_and_si128(va, lowBytes), _mm_srli_epi16(va, 8));
+                        __m128i sb = _mm_add_epi16(_mm_and_si128(vb, lowBytes), _mm_srli_epi16(vb, 8));
+                        sum[i] = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(sa, sb), two), 2);
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(sum[0], sum[1]));
+                }
+            }
+          #elif defined(B3D_MIPMAP_NEON)
+            if (l.channels == 4) {
+                for (; x + 8 <= l.dstWidth; x += 8) {
+                    uint8x16x4_t a = vld4q_u8(row0 + 8 * x);
+                    uint8x16x4_t b = vld4q_u8(row1 + 8 * x);
+                    uint8x8x4_t result;
+                    for (int c = 0; c < 4; c++)
+                        result.val[c] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[c]), b.val[c]), 2);
+                    vst4_u8(out + 4 * x, result);
+                }
+            } else if (l.channels == 1) {
+                for (; x + 8 <= l.dstWidth; x += 8) {
+                    uint16x8_t sum = vpadalq_u8(vpaddlq_u8(vld1q_u8(row0 + 2 * x)), vld1q_u8(row1 + 2 * x));
+                    vst1_u8(out + x, vrshrn_n_u16(sum, 2));
+                }
+            }
+          #endif
+
+            return x;
+        }
+
+        void boxRows(const Level& l, size_t firstRow, size_t lastRow)
+        {
+            size_t srcStride = l.srcWidth * l.channels;
+            size_t dstStride = l.dstWidth * l.channels;
+            for (size_t y = firstRow; y < lastRow; y++) {
+                const uint8_t* row0 = l.src + 2 * y * srcStride;
+                const uint8_t* row1 = l.src + std::min(2 * y + 1, l.srcHeight - 1) * srcStride;
+                uint8_t* out = l.dst + y * dstStride;
+                boxRowScalar(l, row0, row1, out, boxRowSIMD(l, row0, row1, out));
+            }
+        }
+
+        // Gamma-correct variant: color channels are averaged in fixed-point linear space, alpha as is.
+        template <size_t CH> void boxRowsGamma(const Level& l, size_t firstRow, size_t lastRow)
+        {
+            const TransferTables& tables = transferTables();
+            const uint16_t* toLinear = tables.srgbToLinearFixed;
+            const uint8_t* toSRGB = tables.linearToSRGB;
+            const size_t alphaChannel = (CH == 2 || CH == 4 ? CH - 1 : CH);
+
+            size_t srcStride = l.srcWidth * CH;
+            size_t dstStride = l.dstWidth * CH;
+            for (size_t y = firstRow; y < lastRow; y++) {
+                const uint8_t* row0 = l.src + 2 * y * srcStride;
+                const uint8_t* row1 = l.src + std::min(2 * y + 1, l.srcHeight - 1) * srcStride;
+                uint8_t* out = l.dst + y * dstStride;
+                for (size_t x = 0; x < l.dstWidth; x++) {
+                    size_t x0 = 2 * x * CH;
+                    size_t x1 = std::min(2 * x + 1, l.srcWidth - 1) * CH;
+                    for (size_t c = 0; c < CH; c++) {
+                        unsigned p0 = row0[x0 + c], p1 = row0[x1 + c], p2 = row1[x0 + c], p3 = row1[x1 + c];
+                        if (c == alphaChannel)
+                            out[x * CH + c] = uint8_t((p0 + p1 + p2 + p3 + 2) >> 2);
+                        else {
+                            unsigned sum = toLinear[p0] + toLinear[p1] + toLinear[p2] + toLinear[p3];
+                            out[x * CH + c] = toSRGB[(sum + 2) >> 2];
+                        }
+                    }
+                }
+            }
+        }
+
+        void boxRowsGamma(const Level& l, size_t firstRow, size_t lastRow)
+        {
+            switch (l.channels)
+            {
+            case 1: boxRowsGamma<1>(l, firstRow, lastRow); return;
+            case 2: boxRowsGamma<2>(l, firstRow, lastRow); return;
+            case 3: boxRowsGamma<3>(l, firstRow, lastRow); return;
+            case 4: boxRowsGamma<4>(l, firstRow, lastRow); return;
+            }
+            assert(false);
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Separable floating-point filter, used for the Kaiser filter. The inner loops are left to the compiler's
+        // auto-vectorizer: the taps are applied to rows that have been converted to linear floats once.
+
+        class FloatFilter
+        {
+        public:
+            FloatFilter(const Level& level, const Taps& taps, bool gammaCorrect)
+                : mLevel(level)
+                , mTaps(taps)
+                , mRowSize(level.dstWidth * level.channels)
+                , mSource((level.srcWidth + 2 * MAX_TAPS) * level.channels)
+                , mRows(size_t(MAX_TAPS) * mRowSize)
+                , mOutput(mRowSize)
+            {
+                const TransferTables& tables = transferTables();
+                size_t alphaChannel = (level.channels == 2 || level.channels == 4 ? level.channels - 1 : 4);
+                for (size_t c = 0; c < level.channels; c++) {
+                    bool linear = !gammaCorrect || c == alphaChannel;
+                    mToFloat[c] = (linear ? tables.toFloat : tables.srgbToLinear);
+                    mToSRGB[c] = (linear ? nullptr : tables.linearToSRGB);
+                }
+                for (int i = 0; i < MAX_TAPS; i++)
+                    mRowTags[i] = -1;
+            }
+
+            void filterRows(size_t firstRow, size_t lastRow)
+            {
+                switch (mLevel.channels)
+                {
+                case 1: filterRows<1>(firstRow, lastRow); return;
+                case 2: filterRows<2>(firstRow, lastRow); return;
+                case 3: filterRows<3>(firstRow, lastRow); return;
+                case 4: filterRows<4>(firstRow, lastRow); return;
+                }
+                assert(false);
+            }
+
+        private:
+            const Level& mLevel;
+            const Taps& mTaps;
+            size_t mRowSize;
+            std::vector<float> mSource;
+            std::vector<float> mRows;
+            std::vector<float> mOutput;
+            ptrdiff_t mRowTags[MAX_TAPS];
+            const float* mToFloat[4];
+            const uint8_t* mToSRGB[4];
+
+            template <size_t CH> void filterRows(size_t firstRow, size_t lastRow)
+            {
+                const Level& l = mLevel;
+                for (size_t y = firstRow; y < lastRow; y++) {
+                    std::fill(mOutput.begin(), mOutput.end(), 0.0f);
+                    for (int t = 0; t < mTaps.count; t++) {
+                        const float* row = horizontalRow<CH>(clampRow(2 * ptrdiff_t(y) + mTaps.first + t));
+                        float weight = mTaps.weights[t];
+                        float* output = mOutput.data();
+                        for (size_t i = 0; i < mRowSize; i++)
+                            output[i] += weight * row[i];
+                    }
+
+                    const float* output = mOutput.data();
+                    uint8_t* out = l.dst + y * mRowSize;
+                    for (size_t i = 0; i < mRowSize; i += CH) {
+                        for (size_t c = 0; c < CH; c++) {
+                            float value = std::min(std::max(output[i + c], 0.0f), 1.0f);
+                            if (mToSRGB[c])
+                                out[i + c] = mToSRGB[c][int(value * LINEAR_TO_SRGB_STEPS + 0.5f)];
+                            else
+                                out[i + c] = uint8_t(value * 255.0f + 0.5f);
+                        }
+                    }
+                }
+            }
+
+            ptrdiff_t clampRow(ptrdiff_t row) const
+            {
+                return std::min(std::max(row, ptrdiff_t(0)), ptrdiff_t(mLevel.srcHeight) - 1);
+            }
+
+            // Rows needed by a destination row are consecutive, so a ring of MAX_TAPS rows avoids filtering any
+            // source row twice while walking down the image.
+            template <size_t CH> const float* horizontalRow(ptrdiff_t srcRow)
+            {
+                size_t slot = size_t(srcRow) % MAX_TAPS;
+                float* row = &mRows[slot * mRowSize];
+                if (mRowTags[slot] == srcRow)
+                    return row;
+                mRowTags[slot] = srcRow;
+
+                // The source row is converted once and padded with copies of its edge pixels, so that the taps
+                // need neither table lookups nor clamping.
+                const Level& l = mLevel;
+                const uint8_t* src = l.src + size_t(srcRow) * l.srcWidth * CH;
+                float* source = mSource.data();
+                float* pixels = source + MAX_TAPS * CH;
+                for (size_t i = 0; i < l.srcWidth * CH; i += CH) {
+                    for (size_t c = 0; c < CH; c++)
+                        pixels[i + c] = mToFloat[c][src[i + c]];
+                }
+                const float* lastPixel = pixels + (l.srcWidth - 1) * CH;
+                for (size_t i = 0; i < MAX_TAPS * CH; i += CH) {
+                    for (size_t c = 0; c < CH; c++) {
+                        source[i + c] = pixels[c];
+                        pixels[l.srcWidth * CH + i + c] = lastPixel[c];
+                    }
+                }
+
+                const float* first = pixels + mTaps.first * ptrdiff_t(CH);
+                for (size_t x = 0; x < l.dstWidth; x++) {
+                    float acc[CH] = {};
+                    const float* p = first + 2 * x * CH;
+                    for (int t = 0; t < mTaps.count; t++) {
+                        for (size_t c = 0; c < CH; c++)
+                            acc[c] += mTaps.weights[t] * p[t * CH + c];
+                    }
+                    for (size_t c = 0; c < CH; c++)
+                        row[x * CH + c] = acc[c];
+                }
+
+                return row;
+            }
+        };
+    }
+
+    std::shared_ptr<Image> MipmapGenerator::downsample(const IImage& image, DownsampleFilter filter, bool gammaCorrect)
+    {
+        PixelFormat format = image.pixelFormat();
+        assert(format == PixelFormat::Luminance8 || format == PixelFormat::LuminanceAlpha16
+            || format == PixelFormat::RGB24 || format == PixelFormat::RGBA32);
+
+        Level level;
+        level.channels = bytesPerPixel(format);
+        level.srcWidth = image.width();
+        level.srcHeight = image.height();
+        level.dstWidth = std::max(size_t(1), level.srcWidth / 2);
+        level.dstHeight = std::max(size_t(1), level.srcHeight / 2);
+        level.src = image.data();
+        assert(image.dataSize() >= level.srcWidth * level.srcHeight * level.channels);
+
+        auto result = std::make_shared<Image>(format, level.dstWidth, level.dstHeight);
+        result->setDataSize(level.dstWidth * level.dstHeight * level.channels);
+        level.dst = result->data();
+
+        size_t grainSize = std::max(size_t(1), PIXELS_PER_CHUNK / level.dstWidth);
+        if (filter == DownsampleFilter::Box && !gammaCorrect) {
+            ParallelUtils::forEachChunk(0, level.dstHeight, grainSize, [&level](size_t, size_t first, size_t last) {
+                boxRows(level, first, last);
+            });
+        } else if (filter == DownsampleFilter::Box) {
+            ParallelUtils::forEachChunk(0, level.dstHeight, grainSize, [&level](size_t, size_t first, size_t last) {
+                boxRowsGamma(level, first, last);
+            });
+        } else {
+            Taps taps = makeTaps(filter);
+            ParallelUtils::forEachChunk(0, level.dstHeight, grainSize,
+                [&level, &taps, gammaCorrect](size_t, size_t first, size_t last) {
+                    FloatFilter(level, taps, gammaCorrect).filterRows(first, last);
+                });
+        }
+
+        return result;
+    }
+}
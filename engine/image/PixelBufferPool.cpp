@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "PixelBufferPool.h"
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace B3D
+{
+    namespace
+    {
+        const size_t MIN_CLASS_BITS = 8;
+        const size_t SUBCLASSES = 4;
+        const size_t DEFAULT_RETENTION_BUDGET = 32 * 1024 * 1024;
+
+        // Class 0 holds requests up to 2^MIN_CLASS_BITS bytes; each following power of two is split in four.
+        size_t sizeClass(size_t size, size_t& capacity)
+        {
+            const size_t minSize = size_t(1) << MIN_CLASS_BITS;
+            if (size <= minSize) {
+                capacity = minSize;
+                return 0;
+            }
+
+            size_t bits = MIN_CLASS_BITS;
+            while (bits + 1 < sizeof(size_t) * 8 && (size_t(1) << (bits + 1)) < size)
+                ++bits;
+
+            size_t base = size_t(1) << bits;
+            size_t step = base / SUBCLASSES;
+            size_t subclass = (size - base + step - 1) / step;
+            capacity = base + subclass * step;
+            return 1 + (bits - MIN_CLASS_BITS) * SUBCLASSES + (subclass - 1);
+        }
+
+        size_t classCapacity(size_t index)
+        {
+            if (index == 0)
+                return size_t(1) << MIN_CLASS_BITS;
+            size_t base = size_t(1) << (MIN_CLASS_BITS + (index - 1) / SUBCLASSES);
+            return base + ((index - 1) % SUBCLASSES + 1) * (base / SUBCLASSES);
+        }
+
+        struct Pool
+        {
+            std::mutex mutex;
+            std::vector<std::vector<uint8_t*>> freeLists;
+            size_t retentionBudget = DEFAULT_RETENTION_BUDGET;
+            PixelBufferPool::Stats stats = {};
+
+            // Largest buffers go first.
+            void freeRetained(size_t budget)
+            {
+                for (size_t i = freeLists.size(); i-- > 0 && stats.bytesRetained > budget; ) {
+                    auto& list = freeLists[i];
+                    while (!list.empty() && stats.bytesRetained > budget) {
+                        delete[] list.back();
+                        list.pop_back();
+                        stats.bytesRetained -= classCapacity(i);
+                    }
+                }
+            }
+        };
+
+        // Never destroyed, so that images released during static destruction can still return their buffers.
+        Pool& pool()
+        {
+            static Pool* instance = new Pool;
+            return *instance;
+        }
+    }
+
+    PixelBufferPool::Buffer::Buffer(Buffer&& other)
+        : mData(other.mData)
+        , mCapacity(other.mCapacity)
+    {
+        other.mData = nullptr;
+        other.mCapacity = 0;
+    }
+
+    PixelBufferPool::Buffer& PixelBufferPool::Buffer::operator=(Buffer&& other)
+    {
+        if (this != &other) {
+            release();
+            std::swap(mData, other.mData);
+            std::swap(mCapacity, other.mCapacity);
+        }
+        return *this;
+    }
+
+    void PixelBufferPool::Buffer::release()
+    {
+        if (!mData)
+            return;
+
+        size_t capacity;
+        size_t index = sizeClass(mCapacity, capacity);
+
+        Pool& p = pool();
+        {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            p.stats.bytesInUse -= mCapacity;
+            if (p.stats.bytesRetained + mCapacity <= p.retentionBudget) {
+                if (p.freeLists.size() <= index)
+                    p.freeLists.resize(index + 1);
+                p.freeLists[index].push_back(mData);
+                p.stats.bytesRetained += mCapacity;
+                mData = nullptr;
+            }
+        }
+
+        delete[] mData;
+        mData = nullptr;
+        mCapacity = 0;
+    }
+
+    PixelBufferPool::Buffer PixelBufferPool::acquire(size_t size)
+    {
+        if (size == 0)
+            return Buffer();
+
+        size_t capacity;
+        size_t index = sizeClass(size, capacity);
+
+        Pool& p = pool();
+        {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            p.stats.bytesInUse += capacity;
+            if (index < p.freeLists.size() && !p.freeLists[index].empty()) {
+                uint8_t* data = p.freeLists[index].back();
+                p.freeLists[index].pop_back();
+                p.stats.bytesRetained -= capacity;
+                ++p.stats.reuses;
+                return Buffer(data, capacity);
+            }
+            ++p.stats.allocations;
+            p.stats.peakBytes = std::max(p.stats.peakBytes, p.stats.bytesInUse + p.stats.bytesRetained);
+        }
+
+        return Buffer(new uint8_t[capacity], capacity);
+    }
+
+    void PixelBufferPool::setRetentionBudget(size_t bytes)
+    {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        p.retentionBudget = bytes;
+        p.freeRetained(bytes);
+    }
+
+    void PixelBufferPool::trim()
+    {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        p.freeRetained(0);
+    }
+
+    PixelBufferPool::Stats PixelBufferPool::stats()
+    {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        return p.stats;
+    }
+}
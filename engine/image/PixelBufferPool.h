@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace B3D
+{
+    // Reusable storage for decoded pixels. Requests are rounded up to size classes (four per power of two, so at most
+    // 25% is wasted) and released buffers are kept for the next request of the same class, which avoids churning
+    // large allocations when many images are decoded and uploaded one after another.
+    namespace PixelBufferPool
+    {
+        class Buffer
+        {
+        public:
+            Buffer() : mData(nullptr), mCapacity(0) {}
+            Buffer(Buffer&& other);
+            ~Buffer() { release(); }
+
+            Buffer& operator=(Buffer&& other);
+
+            uint8_t* data() const { return mData; }
+            size_t capacity() const { return mCapacity; }
+
+            // Returns the memory to the pool.
+            void release();
+
+        private:
+            uint8_t* mData;
+            size_t mCapacity;
+
+            Buffer(uint8_t* data, size_t capacity) : mData(data), mCapacity(capacity) {}
+
+            friend Buffer acquire(size_t size);
+
+            B3D_DISABLE_COPY(Buffer);
+        };
+
+        struct Stats
+        {
+            size_t allocations;         // Buffers allocated from the heap
+            size_t reuses;              // Requests served with a released buffer
+            size_t bytesInUse;
+            size_t bytesRetained;       // Released buffers kept for reuse
+            size_t peakBytes;           // Highest bytesInUse + bytesRetained
+        };
+
+        // All functions are thread safe. The returned buffer is uninitialized and has at least the requested size.
+        Buffer acquire(size_t size);
+
+        // Released buffers are kept as long as their total size stays within the budget (32 MB by default). Lowering
+        // the budget frees retained buffers right away; trim() frees all of them.
+        void setRetentionBudget(size_t bytes);
+        void trim();
+
+        Stats stats();
+    }
+}
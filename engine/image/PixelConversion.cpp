@@ -0,0 +1,845 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "PixelConversion.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B3D_PIXEL_CONVERSION_X86
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define B3D_TARGET(ISA)
+#else
+#include <cpuid.h>
+#define B3D_TARGET(ISA) __attribute__((target(ISA)))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM) || defined(_M_ARM64)
+#define B3D_PIXEL_CONVERSION_NEON
+#include <arm_neon.h>
+#endif
+
+namespace B3D
+{
+    namespace
+    {
+        using PixelConversion::InstructionSet;
+        using RowFunc = void (*)(const uint8_t* src, uint8_t* dst, size_t count);
+        using InPlaceFunc = void (*)(uint8_t* pixels, size_t count);
+
+        const size_t CHUNK_PIXELS = 256;
+        const size_t NUM_FORMATS = size_t(PixelFormat::Count);
+
+        // Rounded division by 255 of a product of two 8-bit values, identical to the SIMD kernels.
+        inline uint8_t mulDiv255(unsigned a, unsigned b)
+        {
+            unsigned t = a * b + 128;
+            return uint8_t((t + (t >> 8)) >> 8);
+        }
+
+        inline uint16_t load16(const uint8_t* p) { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+        inline void store16(uint8_t* p, uint16_t v) { memcpy(p, &v, sizeof(v)); }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Scalar reference kernels. All conversions go through RGBA32; the most common ones also have SIMD kernels.
+
+        void scalarL8ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, dst += 4) {
+                uint8_t l = src[i];
+                dst[0] = dst[1] = dst[2] = l;
+                dst[3] = 255;
+            }
+        }
+
+        void scalarLA16ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 2, dst += 4) {
+                uint8_t l = src[0], a = src[1];
+                dst[0] = dst[1] = dst[2] = l;
+                dst[3] = a;
+            }
+        }
+
+        void scalarRGB24ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 3, dst += 4) {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = 255;
+            }
+        }
+
+        void scalarRGB565ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 2, dst += 4) {
+                unsigned p = load16(src);
+                unsigned r = (p >> 11) & 0x1F, g = (p >> 5) & 0x3F, b = p & 0x1F;
+                dst[0] = uint8_t((r << 3) | (r >> 2));
+                dst[1] = uint8_t((g << 2) | (g >> 4));
+                dst[2] = uint8_t((b << 3) | (b >> 2));
+                dst[3] = 255;
+            }
+        }
+
+        void scalarRGBA4444ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 2, dst += 4) {
+                unsigned p = load16(src);
+                dst[0] = uint8_t(((p >> 12) & 0xF) * 0x11);
+                dst[1] = uint8_t(((p >> 8) & 0xF) * 0x11);
+                dst[2] = uint8_t(((p >> 4) & 0xF) * 0x11);
+                dst[3] = uint8_t((p & 0xF) * 0x11);
+            }
+        }
+
+        inline uint8_t luminance(const uint8_t* rgb)
+        {
+            return uint8_t((77u * rgb[0] + 150u * rgb[1] + 29u * rgb[2] + 128u) >> 8);
+        }
+
+        void scalarRGBA32ToL8(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 4)
+                dst[i] = luminance(src);
+        }
+
+        void scalarRGBA32ToLA16(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 4, dst += 2) {
+                uint8_t l = luminance(src), a = src[3];
+                dst[0] = l;
+                dst[1] = a;
+            }
+        }
+
+        void scalarRGBA32ToRGB24(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 4, dst += 3) {
+                uint8_t r = src[0], g = src[1], b = src[2];
+                dst[0] = r;
+                dst[1] = g;
+                dst[2] = b;
+            }
+        }
+
+        void scalarRGBA32ToRGB565(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 4, dst += 2)
+                store16(dst, uint16_t(((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3)));
+        }
+
+        void scalarRGBA32ToRGBA4444(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, src += 4, dst += 2) {
+                unsigned rg = ((src[0] & 0xF0) << 8) | ((src[1] & 0xF0) << 4);
+                store16(dst, uint16_t(rg | (src[2] & 0xF0) | (src[3] >> 4)));
+            }
+        }
+
+        void scalarL8ToRGB24(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, dst += 3)
+                dst[0] = dst[1] = dst[2] = src[i];
+        }
+
+        void scalarPremultiplyRGBA32(uint8_t* pixels, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, pixels += 4) {
+                unsigned a = pixels[3];
+                pixels[0] = mulDiv255(pixels[0], a);
+                pixels[1] = mulDiv255(pixels[1], a);
+                pixels[2] = mulDiv255(pixels[2], a);
+            }
+        }
+
+        void scalarPremultiplyLA16(uint8_t* pixels, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, pixels += 2)
+                pixels[0] = mulDiv255(pixels[0], pixels[1]);
+        }
+
+        void scalarSwapRedBlueRGBA32(uint8_t* pixels, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, pixels += 4)
+                std::swap(pixels[0], pixels[2]);
+        }
+
+        void scalarSwapRedBlueRGB24(uint8_t* pixels, size_t count)
+        {
+            for (size_t i = 0; i < count; i++, pixels += 3)
+                std::swap(pixels[0], pixels[2]);
+        }
+
+      #ifdef B3D_PIXEL_CONVERSION_X86
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // SSE2
+
+        void sse2L8ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            const __m128i alpha = _mm_set1_epi8(char(0xFF));
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, dst += 64) {
+                __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i ll0 = _mm_unpacklo_epi8(l, l), la0 = _mm_unpacklo_epi8(l, alpha);
+                __m128i ll1 = _mm_unpackhi_epi8(l, l), la1 = _mm_unpackhi_epi8(l, alpha);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(ll0, la0));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(ll0, la0));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), _mm_unpacklo_epi16(ll1, la1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), _mm_unpackhi_epi16(ll1, la1));
+            }
+            scalarL8ToRGBA32(src + i, dst, count - i);
+        }
+
+        void sse2LA16ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8, src += 16, dst += 32) {
+                __m128i la = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                __m128i l = _mm_and_si128(la, lowBytes);
+                __m128i ll = _mm_or_si128(l, _mm_slli_epi16(l, 8));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(ll, la));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(ll, la));
+            }
+            scalarLA16ToRGBA32(src, dst, count - i);
+        }
+
+        inline __m128i sse2Pack565(__m128i p)
+        {
+            __m128i r = _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF8)), 8);
+            __m128i g = _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xFC00)), 5);
+            __m128i b = _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF80000)), 19);
+            __m128i result = _mm_or_si128(_mm_or_si128(r, g), b);
+            // Sign-extend the low halves so that the saturating pack keeps all 16 bits.
+            return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+        }
+
+        inline __m128i sse2Pack4444(__m128i p)
+        {
+            __m128i r = _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF0)), 8);
+            __m128i g = _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF000)), 4);
+            __m128i b = _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF00000)), 16);
+            __m128i a = _mm_srli_epi32(p, 28);
+            __m128i result = _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+            return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+        }
+
+        void sse2RGBA32ToRGB565(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8, src += 32, dst += 16) {
+                __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+                __m128i packed = _mm_packs_epi32(sse2Pack565(p0), sse2Pack565(p1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), packed);
+            }
+            scalarRGBA32ToRGB565(src, dst, count - i);
+        }
+
+        void sse2RGBA32ToRGBA4444(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8, src += 32, dst += 16) {
+                __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+                __m128i packed = _mm_packs_epi32(sse2Pack4444(p0), sse2Pack4444(p1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), packed);
+            }
+            scalarRGBA32ToRGBA4444(src, dst, count - i);
+        }
+
+        // Multiplies 16-bit channels by the 16-bit alpha of their pixel, keeping alpha itself intact.
+        inline __m128i sse2Premultiply16(__m128i c)
+        {
+            __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+            return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+        }
+
+        void sse2PremultiplyRGBA32(uint8_t* pixels, size_t count)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i alphaMask = _mm_set1_epi32(int(0xFF000000));
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4, pixels += 16) {
+                __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+                __m128i lo = sse2Premultiply16(_mm_unpacklo_epi8(p, zero));
+                __m128i hi = sse2Premultiply16(_mm_unpackhi_epi8(p, zero));
+                __m128i result = _mm_packus_epi16(lo, hi);
+                result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, p));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), result);
+            }
+            scalarPremultiplyRGBA32(pixels, count - i);
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // SSSE3
+
+        B3D_TARGET("ssse3") void ssse3RGB24ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i alpha = _mm_set1_epi32(int(0xFF000000));
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, src += 48, dst += 64) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+                __m128i p0 = _mm_shuffle_epi8(a, shuffle);
+                __m128i p1 = _mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle);
+                __m128i p2 = _mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle);
+                __m128i p3 = _mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(p0, alpha));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_or_si128(p1, alpha));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), _mm_or_si128(p2, alpha));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), _mm_or_si128(p3, alpha));
+            }
+            scalarRGB24ToRGBA32(src, dst, count - i);
+        }
+
+        B3D_TARGET("ssse3") void ssse3RGBA32ToRGB24(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, src += 64, dst += 48) {
+                __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), shuffle);
+                __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16)), shuffle);
+                __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32)), shuffle);
+                __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48)), shuffle);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16),
+                    _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32),
+                    _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+            }
+            scalarRGBA32ToRGB24(src, dst, count - i);
+        }
+
+        B3D_TARGET("ssse3") void ssse3SwapRedBlueRGBA32(uint8_t* pixels, size_t count)
+        {
+            const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4, pixels += 16) {
+                __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), _mm_shuffle_epi8(p, shuffle));
+            }
+            scalarSwapRedBlueRGBA32(pixels, count - i);
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // AVX2. Shuffles between RGB24 and RGBA32 are not included: they are memory bound and gain nothing over SSSE3.
+
+        B3D_TARGET("avx2") inline __m256i avx2Premultiply16(__m256i c)
+        {
+            __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)),
+                _MM_SHUFFLE(3, 3, 3, 3));
+            __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(c, a), _mm256_set1_epi16(128));
+            return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+        }
+
+        B3D_TARGET("avx2") void avx2PremultiplyRGBA32(uint8_t* pixels, size_t count)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i alphaMask = _mm256_set1_epi32(int(0xFF000000));
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8, pixels += 32) {
+                __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels));
+                __m256i lo = avx2Premultiply16(_mm256_unpacklo_epi8(p, zero));
+                __m256i hi = avx2Premultiply16(_mm256_unpackhi_epi8(p, zero));
+                __m256i result = _mm256_blendv_epi8(_mm256_packus_epi16(lo, hi), p, alphaMask);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), result);
+            }
+            scalarPremultiplyRGBA32(pixels, count - i);
+        }
+
+        B3D_TARGET("avx2") void avx2SwapRedBlueRGBA32(uint8_t* pixels, size_t count)
+        {
+            const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8, pixels += 32) {
+                __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), _mm256_shuffle_epi8(p, shuffle));
+            }
+            scalarSwapRedBlueRGBA32(pixels, count - i);
+        }
+
+        InstructionSet detectInstructionSet()
+        {
+            int info[4] = { 0, 0, 0, 0 };
+          #ifdef _MSC_VER
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+            __cpuid(info, 1);
+          #else
+            int maxLeaf = int(__get_cpuid_max(0, nullptr));
+            unsigned a, b, c, d;
+            __cpuid(1, a, b, c, d);
+            info[0] = int(a), info[1] = int(b), info[2] = int(c), info[3] = int(d);
+          #endif
+
+            if (!(info[2] & (1 << 9)))
+                return InstructionSet::SSE2;
+
+            // AVX2 also requires the OS to save YMM registers (OSXSAVE + XCR0 bits 1 and 2).
+            bool osSavesYmm = false;
+            if ((info[2] & (1 << 27)) && (info[2] & (1 << 28))) {
+              #ifdef _MSC_VER
+                unsigned long long xcr0 = _xgetbv(0);
+              #else
+                unsigned eax, edx;
+                __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+                unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+              #endif
+                osSavesYmm = (xcr0 & 6) == 6;
+            }
+
+            if (osSavesYmm && maxLeaf >= 7) {
+              #ifdef _MSC_VER
+                __cpuidex(info, 7, 0);
+              #else
+                __cpuid_count(7, 0, a, b, c, d);
+                info[1] = int(b);
+              #endif
+                if (info[1] & (1 << 5))
+                    return InstructionSet::AVX2;
+            }
+
+            return InstructionSet::SSSE3;
+        }
+
+      #elif defined(B3D_PIXEL_CONVERSION_NEON)
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // NEON
+
+        void neonL8ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            size_t i = 0;
+            uint8x16x4_t p;
+            p.val[3] = vdupq_n_u8(255);
+            for (; i + 16 <= count; i += 16, dst += 64) {
+                p.val[0] = p.val[1] = p.val[2] = vld1q_u8(src + i);
+                vst4q_u8(dst, p);
+            }
+            scalarL8ToRGBA32(src + i, dst, count - i);
+        }
+
+        void neonLA16ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, src += 32, dst += 64) {
+                uint8x16x2_t la = vld2q_u8(src);
+                uint8x16x4_t p;
+                p.val[0] = p.val[1] = p.val[2] = la.val[0];
+                p.val[3] = la.val[1];
+                vst4q_u8(dst, p);
+            }
+            scalarLA16ToRGBA32(src, dst, count - i);
+        }
+
+        void neonRGB24ToRGBA32(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, src += 48, dst += 64) {
+                uint8x16x3_t rgb = vld3q_u8(src);
+                uint8x16x4_t p;
+                p.val[0] = rgb.val[0];
+                p.val[1] = rgb.val[1];
+                p.val[2] = rgb.val[2];
+                p.val[3] = vdupq_n_u8(255);
+                vst4q_u8(dst, p);
+            }
+            scalarRGB24ToRGBA32(src, dst, count - i);
+        }
+
+        void neonRGBA32ToRGB24(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, src += 64, dst += 48) {
+                uint8x16x4_t p = vld4q_u8(src);
+                uint8x16x3_t rgb;
+                rgb.val[0] = p.val[0];
+                rgb.val[1] = p.val[1];
+                rgb.val[2] = p.val[2];
+                vst3q_u8(dst, rgb);
+            }
+            scalarRGBA32ToRGB24(src, dst, count - i);
+        }
+
+        void neonRGBA32ToRGB565(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8, src += 32, dst += 16) {
+                uint8x8x4_t p = vld4_u8(src);
+                uint16x8_t result = vshll_n_u8(p.val[0], 8);
+                result = vsriq_n_u16(result, vshll_n_u8(p.val[1], 8), 5);
+                result = vsriq_n_u16(result, vshll_n_u8(p.val[2], 8), 11);
+                vst1q_u8(dst, vreinterpretq_u8_u16(result));
+            }
+            scalarRGBA32ToRGB565(src, dst, count - i);
+        }
+
+        void neonRGBA32ToRGBA4444(const uint8_t* src, uint8_t* dst, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8, src += 32, dst += 16) {
+                uint8x8x4_t p = vld4_u8(src);
+                uint16x8_t result = vshll_n_u8(p.val[0], 8);
+                result = vsriq_n_u16(result, vshll_n_u8(p.val[1], 8), 4);
+                result = vsriq_n_u16(result, vshll_n_u8(p.val[2], 8), 8);
+                result = vsriq_n_u16(result, vshll_n_u8(p.val[3], 8), 12);
+                vst1q_u8(dst, vreinterpretq_u8_u16(result));
+            }
+            scalarRGBA32ToRGBA4444(src, dst, count - i);
+        }
+
+        // Same rounding as mulDiv255(): (t + (t >> 8)) >> 8 with t = c * a + 128.
+        inline uint8x8_t neonMulDiv255(uint8x8_t c, uint8x8_t a)
+        {
+            uint16x8_t product = vmull_u8(c, a);
+            return vraddhn_u16(product, vrshrq_n_u16(product, 8));
+        }
+
+        inline uint8x16_t neonMulDiv255(uint8x16_t c, uint8x16_t a)
+        {
+            return vcombine_u8(neonMulDiv255(vget_low_u8(c), vget_low_u8(a)),
+                neonMulDiv255(vget_high_u8(c), vget_high_u8(a)));
+        }
+
+        void neonPremultiplyRGBA32(uint8_t* pixels, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, pixels += 64) {
+                uint8x16x4_t p = vld4q_u8(pixels);
+                p.val[0] = neonMulDiv255(p.val[0], p.val[3]);
+                p.val[1] = neonMulDiv255(p.val[1], p.val[3]);
+                p.val[2] = neonMulDiv255(p.val[2], p.val[3]);
+                vst4q_u8(pixels, p);
+            }
+            scalarPremultiplyRGBA32(pixels, count - i);
+        }
+
+        void neonPremultiplyLA16(uint8_t* pixels, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, pixels += 32) {
+                uint8x16x2_t p = vld2q_u8(pixels);
+                p.val[0] = neonMulDiv255(p.val[0], p.val[1]);
+                vst2q_u8(pixels, p);
+            }
+            scalarPremultiplyLA16(pixels, count - i);
+        }
+
+        void neonSwapRedBlueRGBA32(uint8_t* pixels, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, pixels += 64) {
+                uint8x16x4_t p = vld4q_u8(pixels);
+                std::swap(p.val[0], p.val[2]);
+                vst4q_u8(pixels, p);
+            }
+            scalarSwapRedBlueRGBA32(pixels, count - i);
+        }
+
+        void neonSwapRedBlueRGB24(uint8_t* pixels, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16, pixels += 48) {
+                uint8x16x3_t p = vld3q_u8(pixels);
+                std::swap(p.val[0], p.val[2]);
+                vst3q_u8(pixels, p);
+            }
+            scalarSwapRedBlueRGB24(pixels, count - i);
+        }
+
+      #endif
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Dispatch
+
+        struct Kernels
+        {
+            InstructionSet instructionSet;
+            RowFunc toRGBA32[NUM_FORMATS];
+            RowFunc fromRGBA32[NUM_FORMATS];
+            RowFunc l8ToRGB24;
+            InPlaceFunc premultiplyRGBA32;
+            InPlaceFunc premultiplyLA16;
+            InPlaceFunc swapRedBlueRGBA32;
+            InPlaceFunc swapRedBlueRGB24;
+        };
+
+        InstructionSet supportedInstructionSet()
+        {
+          #if defined(B3D_PIXEL_CONVERSION_X86)
+            static const InstructionSet detected = detectInstructionSet();
+            return detected;
+          #elif defined(B3D_PIXEL_CONVERSION_NEON)
+            return InstructionSet::NEON;
+          #else
+            return InstructionSet::Scalar;
+          #endif
+        }
+
+        void selectKernels(Kernels& k, InstructionSet maximum)
+        {
+            InstructionSet isa = supportedInstructionSet();
+            if (maximum < isa)
+                isa = (isa == InstructionSet::NEON ? InstructionSet::Scalar : maximum);
+
+            k.instructionSet = isa;
+            k.toRGBA32[size_t(PixelFormat::Luminance8)] = scalarL8ToRGBA32;
+            k.toRGBA32[size_t(PixelFormat::LuminanceAlpha16)] = scalarLA16ToRGBA32;
+            k.toRGBA32[size_t(PixelFormat::RGB24)] = scalarRGB24ToRGBA32;
+            k.toRGBA32[size_t(PixelFormat::RGBA32)] = nullptr;
+            k.toRGBA32[size_t(PixelFormat::RGB565)] = scalarRGB565ToRGBA32;
+            k.toRGBA32[size_t(PixelFormat::RGBA4444)] = scalarRGBA4444ToRGBA32;
+            k.fromRGBA32[size_t(PixelFormat::Luminance8)] = scalarRGBA32ToL8;
+            k.fromRGBA32[size_t(PixelFormat::LuminanceAlpha16)] = scalarRGBA32ToLA16;
+            k.fromRGBA32[size_t(PixelFormat::RGB24)] = scalarRGBA32ToRGB24;
+            k.fromRGBA32[size_t(PixelFormat::RGBA32)] = nullptr;
+            k.fromRGBA32[size_t(PixelFormat::RGB565)] = scalarRGBA32ToRGB565;
+            k.fromRGBA32[size_t(PixelFormat::RGBA4444)] = scalarRGBA32ToRGBA4444;
+            k.l8ToRGB24 = scalarL8ToRGB24;
+            k.premultiplyRGBA32 = scalarPremultiplyRGBA32;
+            k.premultiplyLA16 = scalarPremultiplyLA16;
+            k.swapRedBlueRGBA32 = scalarSwapRedBlueRGBA32;
+            k.swapRedBlueRGB24 = scalarSwapRedBlueRGB24;
+
+          #if defined(B3D_PIXEL_CONVERSION_X86)
+            if (isa >= InstructionSet::SSE2) {
+                k.toRGBA32[size_t(PixelFormat::Luminance8)] = sse2L8ToRGBA32;
+                k.toRGBA32[size_t(PixelFormat::LuminanceAlpha16)] = sse2LA16ToRGBA32;
+                k.fromRGBA32[size_t(PixelFormat::RGB565)] = sse2RGBA32ToRGB565;
+                k.fromRGBA32[size_t(PixelFormat::RGBA4444)] = sse2RGBA32ToRGBA4444;
+                k.premultiplyRGBA32 = sse2PremultiplyRGBA32;
+            }
+            if (isa >= InstructionSet::SSSE3) {
+                k.toRGBA32[size_t(PixelFormat::RGB24)] = ssse3RGB24ToRGBA32;
+                k.fromRGBA32[size_t(PixelFormat::RGB24)] = ssse3RGBA32ToRGB24;
+                k.swapRedBlueRGBA32 = ssse3SwapRedBlueRGBA32;
+            }
+            if (isa >= InstructionSet::AVX2) {
+                k.premultiplyRGBA32 = avx2PremultiplyRGBA32;
+                k.swapRedBlueRGBA32 = avx2SwapRedBlueRGBA32;
+            }
+          #elif defined(B3D_PIXEL_CONVERSION_NEON)
+            if (isa == InstructionSet::NEON) {
+                k.toRGBA32[size_t(PixelFormat::Luminance8)] = neonL8ToRGBA32;
+                k.toRGBA32[size_t(PixelFormat::LuminanceAlpha16)] = neonLA16ToRGBA32;
+                k.toRGBA32[size_t(PixelFormat::RGB24)] = neonRGB24ToRGBA32;
+                k.fromRGBA32[size_t(PixelFormat::RGB24)] = neonRGBA32ToRGB24;
+                k.fromRGBA32[size_t(PixelFormat::RGB565)] = neonRGBA32ToRGB565;
+                k.fromRGBA32[size_t(PixelFormat::RGBA4444)] = neonRGBA32ToRGBA4444;
+                k.premultiplyRGBA32 = neonPremultiplyRGBA32;
+                k.premultiplyLA16 = neonPremultiplyLA16;
+                k.swapRedBlueRGBA32 = neonSwapRedBlueRGBA32;
+                k.swapRedBlueRGB24 = neonSwapRedBlueRGB24;
+            }
+          #endif
+        }
+
+        Kernels& kernels()
+        {
+            static Kernels instance = []() {
+                Kernels k;
+                selectKernels(k, InstructionSet::NEON);
+                return k;
+            }();
+            return instance;
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // sRGB transfer function
+
+        struct SRGBTables
+        {
+            uint8_t toLinear[256];
+            uint8_t toSRGB[256];
+
+            SRGBTables()
+            {
+                for (int i = 0; i < 256; i++) {
+                    double c = i / 255.0;
+                    double linear = (c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+                    double srgb = (c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055);
+                    toLinear[i] = uint8_t(linear * 255.0 + 0.5);
+                    toSRGB[i] = uint8_t(srgb * 255.0 + 0.5);
+                }
+            }
+        };
+
+        const SRGBTables& srgbTables()
+        {
+            static const SRGBTables tables;
+            return tables;
+        }
+
+        // Table lookups do not vectorize well on any of the supported instruction sets, so this stays scalar.
+        void applyTable(uint8_t* pixels, size_t count, size_t stride, size_t channels, const uint8_t* table)
+        {
+            for (size_t i = 0; i < count; i++, pixels += stride) {
+                for (size_t j = 0; j < channels; j++)
+                    pixels[j] = table[pixels[j]];
+            }
+        }
+
+        // Applies an RGBA32 operation to pixels in a packed format by expanding them in small chunks.
+        template <typename FUNC> void applyViaRGBA32(uint8_t* pixels, PixelFormat format, size_t count, FUNC func)
+        {
+            const Kernels& k = kernels();
+            size_t bpp = bytesPerPixel(format);
+            uint8_t buffer[CHUNK_PIXELS * 4];
+            for (size_t i = 0; i < count; i += CHUNK_PIXELS) {
+                size_t n = std::min(CHUNK_PIXELS, count - i);
+                k.toRGBA32[size_t(format)](pixels + i * bpp, buffer, n);
+                func(buffer, n);
+                k.fromRGBA32[size_t(format)](buffer, pixels + i * bpp, n);
+            }
+        }
+    }
+
+    PixelConversion::InstructionSet PixelConversion::instructionSet()
+    {
+        return kernels().instructionSet;
+    }
+
+    const char* PixelConversion::instructionSetName(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+        case InstructionSet::Scalar: return "scalar";
+        case InstructionSet::SSE2: return "SSE2";
+        case InstructionSet::SSSE3: return "SSSE3";
+        case InstructionSet::AVX2: return "AVX2";
+        case InstructionSet::NEON: return "NEON";
+        }
+        return "unknown";
+    }
+
+    void PixelConversion::limitInstructionSet(InstructionSet maximum)
+    {
+        selectKernels(kernels(), maximum);
+    }
+
+    bool PixelConversion::canConvert(PixelFormat from, PixelFormat to)
+    {
+        return bytesPerPixel(from) != 0 && bytesPerPixel(to) != 0;
+    }
+
+    void PixelConversion::convert(const uint8_t* src, PixelFormat srcFormat, uint8_t* dst, PixelFormat dstFormat,
+        size_t count)
+    {
+        assert(canConvert(srcFormat, dstFormat));
+
+        size_t srcBpp = bytesPerPixel(srcFormat);
+        size_t dstBpp = bytesPerPixel(dstFormat);
+        assert(src != dst || dstBpp <= srcBpp);
+
+        const Kernels& k = kernels();
+        if (srcFormat == dstFormat) {
+            if (src != dst)
+                memmove(dst, src, count * srcBpp);
+        } else if (srcFormat == PixelFormat::RGBA32)
+            k.fromRGBA32[size_t(dstFormat)](src, dst, count);
+        else if (dstFormat == PixelFormat::RGBA32)
+            k.toRGBA32[size_t(srcFormat)](src, dst, count);
+        else if (srcFormat == PixelFormat::Luminance8 && dstFormat == PixelFormat::RGB24)
+            k.l8ToRGB24(src, dst, count);
+        else {
+            uint8_t buffer[CHUNK_PIXELS * 4];
+            for (size_t i = 0; i < count; i += CHUNK_PIXELS) {
+                size_t n = std::min(CHUNK_PIXELS, count - i);
+                k.toRGBA32[size_t(srcFormat)](src + i * srcBpp, buffer, n);
+                k.fromRGBA32[size_t(dstFormat)](buffer, dst + i * dstBpp, n);
+            }
+        }
+    }
+
+    void PixelConversion::premultiplyAlpha(uint8_t* pixels, PixelFormat format, size_t count)
+    {
+        const Kernels& k = kernels();
+        switch (format)
+        {
+        case PixelFormat::RGBA32: k.premultiplyRGBA32(pixels, count); return;
+        case PixelFormat::LuminanceAlpha16: k.premultiplyLA16(pixels, count); return;
+        case PixelFormat::RGBA4444: applyViaRGBA32(pixels, format, count, k.premultiplyRGBA32); return;
+        case PixelFormat::Luminance8:
+        case PixelFormat::RGB24:
+        case PixelFormat::RGB565:
+        default:
+            return;
+        }
+    }
+
+    void PixelConversion::swapRedBlue(uint8_t* pixels, PixelFormat format, size_t count)
+    {
+        const Kernels& k = kernels();
+        switch (format)
+        {
+        case PixelFormat::RGBA32: k.swapRedBlueRGBA32(pixels, count); return;
+        case PixelFormat::RGB24: k.swapRedBlueRGB24(pixels, count); return;
+        case PixelFormat::RGB565:
+        case PixelFormat::RGBA4444: applyViaRGBA32(pixels, format, count, k.swapRedBlueRGBA32); return;
+        case PixelFormat::Luminance8:
+        case PixelFormat::LuminanceAlpha16:
+        default:
+            return;
+        }
+    }
+
+    static void applyTransferFunction(uint8_t* pixels, PixelFormat format, size_t count, const uint8_t* table)
+    {
+        switch (format)
+        {
+        case PixelFormat::Luminance8: applyTable(pixels, count, 1, 1, table); return;
+        case PixelFormat::LuminanceAlpha16: applyTable(pixels, count, 2, 1, table); return;
+        case PixelFormat::RGB24: applyTable(pixels, count, 3, 3, table); return;
+        case PixelFormat::RGBA32: applyTable(pixels, count, 4, 3, table); return;
+        case PixelFormat::RGB565:
+        case PixelFormat::RGBA4444:
+            applyViaRGBA32(pixels, format, count, [table](uint8_t* rgba, size_t n) {
+                applyTable(rgba, n, 4, 3, table);
+            });
+            return;
+        default:
+            return;
+        }
+    }
+
+    void PixelConversion::srgbToLinear(uint8_t* pixels, PixelFormat format, size_t count)
+    {
+        applyTransferFunction(pixels, format, count, srgbTables().toLinear);
+    }
+
+    void PixelConversion::linearToSRGB(uint8_t* pixels, PixelFormat format, size_t count)
+    {
+        applyTransferFunction(pixels, format, count, srgbTables().toSRGB);
+    }
+}
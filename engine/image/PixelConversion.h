@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/interfaces/image/IImage.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace B3D
+{
+    namespace PixelConversion
+    {
+        enum class InstructionSet
+        {
+            Scalar = 0,
+            SSE2,
+            SSSE3,
+            AVX2,
+            NEON,
+        };
+
+        // Best instruction set supported by both the build and the CPU; kernels are selected on first use.
+        InstructionSet instructionSet();
+        const char* instructionSetName(InstructionSet instructionSet);
+
+        // Restricts kernel selection (e.g. to compare against the scalar implementation). Not thread safe: should
+        // only be called while no conversion is in progress.
+        void limitInstructionSet(InstructionSet maximum);
+
+        // Block-compressed formats are not supported here; see TextureCompression.
+        bool canConvert(PixelFormat from, PixelFormat to);
+
+        // Converts tightly packed pixels. Source and destination may be the same buffer if the destination format
+        // does not have more bytes per pixel than the source format.
+        void convert(const uint8_t* src, PixelFormat srcFormat, uint8_t* dst, PixelFormat dstFormat, size_t count);
+
+        // In-place operations on pixels in the given format. Formats without alpha (or without color, for
+        // swapRedBlue) are left untouched.
+        void premultiplyAlpha(uint8_t* pixels, PixelFormat format, size_t count);
+        void swapRedBlue(uint8_t* pixels, PixelFormat format, size_t count);
+        void srgbToLinear(uint8_t* pixels, PixelFormat format, size_t count);
+        void linearToSRGB(uint8_t* pixels, PixelFormat format, size_t count);
+    }
+}
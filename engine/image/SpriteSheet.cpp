@@ -101,6 +101,8 @@ namespace B3D
 
     void SpriteSheet::loadPendingResources(bool async)
     {
+        // Runs on the loading thread while the sheet may already be in use.
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
         for (auto& it : mSprites) {
             const auto& sprite = it.second;
             if (!sprite->texture && sprite->textureName) {
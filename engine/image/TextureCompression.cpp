@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TextureCompression.h"
+#include "engine/utility/ParallelUtils.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace B3D
+{
+    namespace
+    {
+        const size_t BLOCKS_PER_CHUNK = 4096;
+
+        // Decodes one 4x4 block into 16 RGBA32 pixels, stored row by row.
+        typedef void (*BlockDecoder)(const uint8_t* block, uint8_t* pixels);
+
+        inline uint8_t clamp255(int value)
+        {
+            return uint8_t(value < 0 ? 0 : (value > 255 ? 255 : value));
+        }
+
+        inline uint8_t extend4(unsigned value) { return uint8_t((value << 4) | value); }
+        inline uint8_t extend5(unsigned value) { return uint8_t((value << 3) | (value >> 2)); }
+        inline uint8_t extend6(unsigned value) { return uint8_t((value << 2) | (value >> 4)); }
+        inline uint8_t extend7(unsigned value) { return uint8_t((value << 1) | (value >> 6)); }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // BC1-BC3 (S3TC)
+
+        void decodeBC1Colors(const uint8_t* block, uint8_t* pixels, bool allowTransparency)
+        {
+            unsigned c0 = block[0] | (block[1] << 8);
+            unsigned c1 = block[2] | (block[3] << 8);
+
+            uint8_t colors[4][4];
+            colors[0][0] = extend5(c0 >> 11);
+            colors[0][1] = extend6((c0 >> 5) & 0x3f);
+            colors[0][2] = extend5(c0 & 0x1f);
+            colors[1][0] = extend5(c1 >> 11);
+            colors[1][1] = extend6((c1 >> 5) & 0x3f);
+            colors[1][2] = extend5(c1 & 0x1f);
+            colors[0][3] = colors[1][3] = colors[2][3] = colors[3][3] = 255;
+
+            if (c0 > c1 || !allowTransparency) {
+                for (int i = 0; i < 3; i++) {
+                    colors[2][i] = uint8_t((2 * colors[0][i] + colors[1][i]) / 3);
+                    colors[3][i] = uint8_t((colors[0][i] + 2 * colors[1][i]) / 3);
+                }
+            } else {
+                for (int i = 0; i < 3; i++) {
+                    colors[2][i] = uint8_t((colors[0][i] + colors[1][i]) / 2);
+                    colors[3][i] = 0;
+                }
+                colors[3][3] = 0;
+            }
+
+            uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32_t(block[7]) << 24);
+            for (int i = 0; i < 16; i++)
+                memcpy(pixels + 4 * i, colors[(indices >> (2 * i)) & 3], 4);
+        }
+
+        void decodeBC1(const uint8_t* block, uint8_t* pixels)
+        {
+            decodeBC1Colors(block, pixels, true);
+        }
+
+        void decodeBC2(const uint8_t* block, uint8_t* pixels)
+        {
+            decodeBC1Colors(block + 8, pixels, false);
+            for (int i = 0; i < 16; i++)
+                pixels[4 * i + 3] = extend4((block[i / 2] >> (4 * (i & 1))) & 0xf);
+        }
+
+        void decodeBC3(const uint8_t* block, uint8_t* pixels)
+        {
+            decodeBC1Colors(block + 8, pixels, false);
+
+            int a0 = block[0], a1 = block[1];
+            uint8_t alphas[8] = { uint8_t(a0), uint8_t(a1) };
+            if (a0 > a1) {
+                for (int i = 1; i < 7; i++)
+                    alphas[i + 1] = uint8_t(((7 - i) * a0 + i * a1) / 7);
+            } else {
+                for (int i = 1; i < 5; i++)
+                    alphas[i + 1] = uint8_t(((5 - i) * a0 + i * a1) / 5);
+                alphas[6] = 0;
+                alphas[7] = 255;
+            }
+
+            uint64_t indices = 0;
+            for (int i = 7; i >= 2; i--)
+                indices = (indices << 8) | block[i];
+            for (int i = 0; i < 16; i++)
+                pixels[4 * i + 3] = alphas[(indices >> (3 * i)) & 7];
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // ETC1, ETC2 and EAC
+
+        const int ETC_MODIFIERS[8][4] = {
+            { 2, 8, -2, -8 },
+            { 5, 17, -5, -17 },
+            { 9, 29, -9, -29 },
+            { 13, 42, -13, -42 },
+            { 18, 60, -18, -60 },
+            { 24, 80, -24, -80 },
+            { 33, 106, -33, -106 },
+            { 47, 183, -47, -183 },
+        };
+
+        const int ETC2_DISTANCES[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+        const int EAC_MODIFIERS[16][8] = {
+            { -3, -6, -9, -15, 2, 5, 8, 14 },
+            { -3, -7, -10, -13, 2, 6, 9, 12 },
+            { -2, -5, -8, -13, 1, 4, 7, 12 },
+            { -2, -4, -6, -13, 1, 3, 5, 12 },
+            { -3, -6, -8, -12, 2, 5, 7, 11 },
+            { -3, -7, -9, -11, 2, 6, 8, 10 },
+            { -4, -7, -8, -11, 3, 6, 7, 10 },
+            { -3, -5, -8, -11, 2, 4, 7, 10 },
+            { -2, -6, -8, -10, 1, 5, 7, 9 },
+            { -2, -5, -8, -10, 1, 4, 7, 9 },
+            { -2, -4, -8, -10, 1, 3, 7, 9 },
+            { -2, -5, -7, -10, 1, 4, 6, 9 },
+            { -3, -4, -7, -10, 2, 3, 6, 9 },
+            { -1, -2, -3, -10, 0, 1, 2, 9 },
+            { -4, -6, -8, -9, 3, 5, 7, 8 },
+            { -3, -5, -7, -9, 2, 4, 6, 8 },
+        };
+
+        // ETC blocks number their pixels column by column.
+        inline unsigned etcPixelIndex(uint32_t indices, int x, int y)
+        {
+            int i = x * 4 + y;
+            return ((indices >> (15 + i)) & 2) | ((indices >> i) & 1);
+        }
+
+        void decodeETCPaintColors(const uint8_t* block, uint8_t* pixels, const int paint[4][3])
+        {
+            uint32_t indices = (uint32_t(block[4]) << 24) | (block[5] << 16) | (block[6] << 8) | block[7];
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    const int* color = paint[etcPixelIndex(indices, x, y)];
+                    uint8_t* p = pixels + 4 * (y * 4 + x);
+                    p[0] = clamp255(color[0]);
+                    p[1] = clamp255(color[1]);
+                    p[2] = clamp255(color[2]);
+                    p[3] = 255;
+                }
+            }
+        }
+
+        void decodeETC2TMode(const uint8_t* b, uint8_t* pixels)
+        {
+            int c1[3] = { extend4(((b[0] >> 1) & 0xc) | (b[0] & 0x3)), extend4(b[1] >> 4), extend4(b[1] & 0xf) };
+            int c2[3] = { extend4(b[2] >> 4), extend4(b[2] & 0xf), extend4(b[3] >> 4) };
+            int d = ETC2_DISTANCES[((b[3] >> 1) & 0x6) | (b[3] & 0x1)];
+
+            int paint[4][3];
+            for (int i = 0; i < 3; i++) {
+                paint[0][i] = c1[i];
+                paint[1][i] = c2[i] + d;
+                paint[2][i] = c2[i];
+                paint[3][i] = c2[i] - d;
+            }
+            decodeETCPaintColors(b, pixels, paint);
+        }
+
+        void decodeETC2HMode(const uint8_t* b, uint8_t* pixels)
+        {
+            int c1[3] = {
+                extend4((b[0] >> 3) & 0xf),
+                extend4(((b[0] & 0x7) << 1) | ((b[1] >> 4) & 0x1)),
+                extend4((b[1] & 0x8) | ((b[1] & 0x3) << 1) | (b[2] >> 7)),
+            };
+            int c2[3] = {
+                extend4((b[2] >> 3) & 0xf),
+                extend4(((b[2] & 0x7) << 1) | (b[3] >> 7)),
+                extend4((b[3] >> 3) & 0xf),
+            };
+            int value1 = (c1[0] << 16) | (c1[1] << 8) | c1[2];
+            int value2 = (c2[0] << 16) | (c2[1] << 8) | c2[2];
+            int d = ETC2_DISTANCES[(b[3] & 0x4) | ((b[3] & 0x1) << 1) | (value1 >= value2 ? 1 : 0)];
+
+            int paint[4][3];
+            for (int i = 0; i < 3; i++) {
+                paint[0][i] = c1[i] + d;
+                paint[1][i] = c1[i] - d;
+                paint[2][i] = c2[i] + d;
+                paint[3][i] = c2[i] - d;
+            }
+            decodeETCPaintColors(b, pixels, paint);
+        }
+
+        void decodeETC2PlanarMode(const uint8_t* b, uint8_t* pixels)
+        {
+            int o[3] = {
+                extend6((b[0] >> 1) & 0x3f),
+                extend7(((b[0] & 0x1) << 6) | ((b[1] >> 1) & 0x3f)),
+                extend6(((b[1] & 0x1) << 5) | (b[2] & 0x18) | ((b[2] & 0x3) << 1) | (b[3] >> 7)),
+            };
+            int h[3] = {
+                extend6(((b[3] & 0x7c) >> 1) | (b[3] & 0x1)),
+                extend7((b[4] >> 1) & 0x7f),
+                extend6(((b[4] & 0x1) << 5) | ((b[5] >> 3) & 0x1f)),
+            };
+            int v[3] = {
+                extend6(((b[5] & 0x7) << 3) | ((b[6] >> 5) & 0x7)),
+                extend7(((b[6] & 0x1f) << 2) | ((b[7] >> 6) & 0x3)),
+                extend6(b[7] & 0x3f),
+            };
+
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    uint8_t* p = pixels + 4 * (y * 4 + x);
+                    for (int i = 0; i < 3; i++)
+                        p[i] = clamp255((x * (h[i] - o[i]) + y * (v[i] - o[i]) + 4 * o[i] + 2) >> 2);
+                    p[3] = 255;
+                }
+            }
+        }
+
+        // ETC2 reuses the differential mode encodings that overflow in ETC1 for its additional modes.
+        void decodeETC(const uint8_t* b, uint8_t* pixels, bool etc2)
+        {
+            static const int DELTAS[8] = { 0, 1, 2, 3, -4, -3, -2, -1 };
+
+            bool differential = (b[3] & 0x2) != 0;
+            int base[2][3];
+            if (!differential) {
+                for (int i = 0; i < 3; i++) {
+                    base[0][i] = extend4(b[i] >> 4);
+                    base[1][i] = extend4(b[i] & 0xf);
+                }
+            } else {
+                int second[3];
+                for (int i = 0; i < 3; i++)
+                    second[i] = (b[i] >> 3) + DELTAS[b[i] & 0x7];
+                if (etc2 && (second[0] < 0 || second[0] > 31)) {
+                    decodeETC2TMode(b, pixels);
+                    return;
+                }
+                if (etc2 && (second[1] < 0 || second[1] > 31)) {
+                    decodeETC2HMode(b, pixels);
+                    return;
+                }
+                if (etc2 && (second[2] < 0 || second[2] > 31)) {
+                    decodeETC2PlanarMode(b, pixels);
+                    return;
+                }
+                for (int i = 0; i < 3; i++) {
+                    base[0][i] = extend5(b[i] >> 3);
+                    base[1][i] = extend5(unsigned(second[i]) & 0x1f);
+                }
+            }
+
+            const int* modifiers[2] = { ETC_MODIFIERS[b[3] >> 5], ETC_MODIFIERS[(b[3] >> 2) & 0x7] };
+            bool flip = (b[3] & 0x1) != 0;
+            uint32_t indices = (uint32_t(b[4]) << 24) | (b[5] << 16) | (b[6] << 8) | b[7];
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    int subblock = (flip ? y >> 1 : x >> 1);
+                    int modifier = modifiers[subblock][etcPixelIndex(indices, x, y)];
+                    uint8_t* p = pixels + 4 * (y * 4 + x);
+                    p[0] = clamp255(base[subblock][0] + modifier);
+                    p[1] = clamp255(base[subblock][1] + modifier);
+                    p[2] = clamp255(base[subblock][2] + modifier);
+                    p[3] = 255;
+                }
+            }
+        }
+
+        void decodeEACAlpha(const uint8_t* b, uint8_t* pixels)
+        {
+            int base = b[0];
+            int multiplier = b[1] >> 4;
+            const int* modifiers = EAC_MODIFIERS[b[1] & 0xf];
+
+            uint64_t indices = 0;
+            for (int i = 2; i < 8; i++)
+                indices = (indices << 8) | b[i];
+
+            for (int x = 0; x < 4; x++) {
+                for (int y = 0; y < 4; y++) {
+                    unsigned index = unsigned(indices >> (45 - 3 * (x * 4 + y))) & 0x7;
+                    pixels[4 * (y * 4 + x) + 3] = clamp255(base + modifiers[index] * multiplier);
+                }
+            }
+        }
+
+        void decodeETC1(const uint8_t* block, uint8_t* pixels)
+        {
+            decodeETC(block, pixels, false);
+        }
+
+        void decodeETC2RGB(const uint8_t* block, uint8_t* pixels)
+        {
+            decodeETC(block, pixels, true);
+        }
+
+        void decodeETC2RGBA(const uint8_t* block, uint8_t* pixels)
+        {
+            decodeETC(block + 8, pixels, true);
+            decodeEACAlpha(block, pixels);
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        BlockDecoder blockDecoder(PixelFormat format)
+        {
+            switch (format)
+            {
+            case PixelFormat::ETC1: return decodeETC1;
+            case PixelFormat::ETC2_RGB8: return decodeETC2RGB;
+            case PixelFormat::ETC2_RGBA8: return decodeETC2RGBA;
+            case PixelFormat::BC1: return decodeBC1;
+            case PixelFormat::BC2: return decodeBC2;
+            case PixelFormat::BC3: return decodeBC3;
+            default: return nullptr;
+            }
+        }
+    }
+
+    bool TextureCompression::canDecompress(PixelFormat format)
+    {
+        return blockDecoder(format) != nullptr;
+    }
+
+    void TextureCompression::decompress(const uint8_t* src, PixelFormat format, size_t width, size_t height,
+        uint8_t* rgba)
+    {
+        BlockDecoder decoder = blockDecoder(format);
+        assert(decoder != nullptr);
+        assert(blockSize(format) == 4);
+
+        size_t blocksX = (width + 3) / 4;
+        size_t blocksY = (height + 3) / 4;
+        size_t blockBytes = bytesPerBlock(format);
+        size_t grainSize = std::max(size_t(1), BLOCKS_PER_CHUNK / std::max(size_t(1), blocksX));
+
+        ParallelUtils::forEachChunk(0, blocksY, grainSize, [=](size_t, size_t firstRow, size_t lastRow) {
+            uint8_t pixels[16 * 4];
+            for (size_t by = firstRow; by < lastRow; by++) {
+                size_t rows = std::min(size_t(4), height - by * 4);
+                for (size_t bx = 0; bx < blocksX; bx++) {
+                    decoder(src + (by * blocksX + bx) * blockBytes, pixels);
+                    size_t columns = std::min(size_t(4), width - bx * 4);
+                    for (size_t y = 0; y < rows; y++)
+                        memcpy(rgba + ((by * 4 + y) * width + bx * 4) * 4, pixels + y * 16, columns * 4);
+                }
+            }
+        });
+    }
+}
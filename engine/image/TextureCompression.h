@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/interfaces/image/IImage.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace B3D
+{
+    namespace TextureCompression
+    {
+        // Software decoders exist for the ETC and BC formats; ASTC textures can only be used on GPUs that support
+        // them natively.
+        bool canDecompress(PixelFormat format);
+
+        // Decodes a block-compressed image into tightly packed RGBA32 pixels. The source must hold
+        // imageDataSize(format, width, height) bytes. Large images are decoded on the background threads.
+        void decompress(const uint8_t* src, PixelFormat format, size_t width, size_t height, uint8_t* rgba);
+    }
+}
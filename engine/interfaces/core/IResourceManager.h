@@ -21,17 +21,57 @@
  */
 
 #pragma once
+#include "engine/core/ResourceFuture.h"
+#include "engine/interfaces/core/ITaskGroup.h"
+#include "engine/interfaces/font/IFont.h"
+#include "engine/interfaces/image/IImage.h"
 #include "engine/interfaces/material/IMaterial.h"
 #include "engine/interfaces/image/ISpriteSheet.h"
 #include "engine/interfaces/mesh/IMesh.h"
 #include "engine/interfaces/render/lowlevel/IShader.h"
 #include "engine/interfaces/render/lowlevel/ITexture.h"
 #include <memory>
+#include <cstdint>
 #include <vector>
 #include <string>
 
 namespace B3D
 {
+    enum class ResourceType
+    {
+        Material = 0,
+        Shader,
+        Texture,
+        SpriteSheet,
+        StaticMesh,
+        Font,
+
+        Count
+    };
+
+    struct ResourceCacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t retainedCount = 0;
+        size_t retainedBytes = 0;
+        size_t budgetBytes = 0;
+    };
+
+    struct TextureOptions
+    {
+        bool generateMipmaps = true;        // Only for images that do not carry their own mipmap levels
+        DownsampleFilter filter = DownsampleFilter::Box;
+        bool gammaCorrect = false;
+
+        // Textures up to this size (in both dimensions) are packed into shared atlas pages instead of getting a
+        // texture of their own, so that the canvas can batch them. Zero disables the atlas.
+        size_t atlasMaxTextureSize = 128;
+        size_t atlasPageSize = 1024;
+        size_t atlasPageCount = 4;
+    };
+
     class IResourceManager
     {
     public:
@@ -40,14 +80,75 @@ namespace B3D
         virtual bool resourcesAreLoading() const = 0;
         virtual float resourceLoadProgress() const = 0;
 
+        // Pending asynchronous loads are skipped at their next stage; the placeholders stay empty.
+        virtual void cancelPendingLoads() = 0;
+
+        // Recently used resources are kept alive after their last user releases them, as long as the estimated
+        // memory usage of the retained resources of each type fits into its budget. Zero disables retention.
+        virtual void setRetentionBudget(ResourceType type, size_t bytes) = 0;
+        virtual void releaseRetainedResources() = 0;
+        virtual ResourceCacheStats cacheStats(ResourceType type) const = 0;
+
+        // While a group is being recorded, every requested resource, including the dependencies of other resources,
+        // is added to the group's manifest. Prefetching a group starts loading everything recorded for it at once
+        // and keeps the resources alive until the group is released. Manifests are persisted in the manifest
+        // directory, if one has been set, so that the next run can prefetch them too.
+        virtual void setManifestDirectory(const std::string& path) = 0;
+        virtual void beginRecordingGroup(const std::string& group) = 0;
+        virtual void endRecordingGroup() = 0;
+        virtual size_t prefetchGroup(const std::string& group, TaskPriority priority = TaskPriority::Critical) = 0;
+        virtual void releaseGroup(const std::string& group) = 0;
+
+        // Decoded images and imported meshes are kept in the given directory, so that subsequent runs can map them
+        // back instead of decoding the source files again. The directory must exist; an empty path disables the
+        // cache. Statistics are logged when the cache is closed.
+        virtual void setDecodedAssetCache(const std::string& directory, size_t capacityBytes = 256 * 1024 * 1024) = 0;
+
+        // Mipmaps are generated on the loading thread, before the image is stored in the decoded asset cache.
+        // Textures that have already been requested keep the options they have been loaded with.
+        virtual void setTextureOptions(const TextureOptions& options) = 0;
+
+        // Textures that are sampled with repeating wrap modes, or only ever through a material, gain nothing from
+        // the atlas. Packed textures still work there, but need a standalone copy; this avoids the atlas entirely
+        // for textures that have not been requested yet.
+        virtual void excludeFromTextureAtlas(const std::string& fileName) = 0;
+
         virtual ShaderPtr compileShader(const std::vector<std::string>* source,
             const std::string& fileName = "<builtin>") = 0;
 
-        virtual MaterialPtr getMaterial(const std::string& fileName, bool async = true) = 0;
-        virtual ShaderPtr getShader(const std::string& fileName, bool async = true) = 0;
-        virtual TexturePtr getTexture(const std::string& fileName, bool async = true) = 0;
-        virtual SpriteSheetPtr getSpriteSheet(const std::string& fileName, bool async = true) = 0;
-        virtual MeshPtr getStaticMesh(const std::string& fileName, bool async = true) = 0;
+        // Asynchronous requests may be issued from any thread; synchronous loads must run on the render thread.
+        virtual MaterialPtr getMaterial(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual ShaderPtr getShader(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual TexturePtr getTexture(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        // Textures requested with different load hints are separate resources, even if they share the source file.
+        virtual TexturePtr getTexture(const std::string& fileName, const ImageLoadHint& hint, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual SpriteSheetPtr getSpriteSheet(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual MeshPtr getStaticMesh(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual FontPtr getFont(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+
+        // Same as the getters above, but the returned future also tells when the resource and everything it
+        // depends on (textures of a material, materials of a mesh, ...) has been loaded.
+        virtual ResourceFuture<MaterialPtr> loadMaterial(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual ResourceFuture<ShaderPtr> loadShader(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual ResourceFuture<TexturePtr> loadTexture(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual ResourceFuture<TexturePtr> loadTexture(const std::string& fileName, const ImageLoadHint& hint,
+            bool async = true, TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual ResourceFuture<SpriteSheetPtr> loadSpriteSheet(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual ResourceFuture<MeshPtr> loadStaticMesh(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
+        virtual ResourceFuture<FontPtr> loadFont(const std::string& fileName, bool async = true,
+            TaskPriority priority = TaskPriority::Visible) = 0;
     };
 
     using ResourceManagerPtr = std::shared_ptr<IResourceManager>;
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace B3D
+{
+    enum class TaskThread
+    {
+        Background,
+        Render,
+    };
+
+    enum class TaskPriority
+    {
+        Critical,
+        Visible,
+        Prefetch,
+    };
+
+    const size_t TaskPriorityCount = 3;
+
+    class ITask
+    {
+    public:
+        virtual ~ITask() = default;
+
+        virtual TaskThread thread() const = 0;
+        virtual bool isComplete() const = 0;
+    };
+
+    using TaskPtr = std::shared_ptr<ITask>;
+
+    class ITaskGroup
+    {
+    public:
+        virtual ~ITaskGroup() = default;
+
+        // The task is started as soon as all of its dependencies have completed.
+        virtual TaskPtr addTask(TaskThread thread, const std::function<void()>& action,
+            const std::vector<TaskPtr>& dependencies = std::vector<TaskPtr>()) = 0;
+        virtual TaskPtr addTask(TaskThread thread, std::function<void()>&& action,
+            const std::vector<TaskPtr>& dependencies = std::vector<TaskPtr>()) = 0;
+
+        // Applies to background tasks dispatched after the call.
+        virtual void setPriority(TaskPriority priority) = 0;
+
+        virtual size_t pendingTaskCount() const = 0;
+        virtual bool isComplete() const = 0;
+
+        // Blocks until all tasks added so far have completed. Must not be called from the render thread
+        // while the group contains unfinished render thread tasks.
+        virtual void wait() = 0;
+    };
+
+    using TaskGroupPtr = std::shared_ptr<ITaskGroup>;
+}
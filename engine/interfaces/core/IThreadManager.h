@@ -21,21 +21,73 @@
  */
 
 #pragma once
+#include "engine/interfaces/core/ITaskGroup.h"
+#include "engine/utility/InplaceAction.h"
 #include <functional>
 #include <memory>
+#include <cstdint>
 
 namespace B3D
 {
+    struct TaskQueueStats
+    {
+        // Bucket N counts tasks that took less than 2^N microseconds; the last bucket counts everything longer.
+        static const size_t HISTOGRAM_BUCKETS = 24;
+
+        size_t queueDepth = 0;
+        size_t maxQueueDepth = 0;
+        uint64_t tasksExecuted = 0;
+        uint64_t totalWaitMicroseconds = 0;
+        uint64_t maxWaitMicroseconds = 0;
+        uint64_t totalExecutionMicroseconds = 0;
+        uint64_t maxExecutionMicroseconds = 0;
+        uint64_t executionHistogram[HISTOGRAM_BUCKETS] = {};
+    };
+
+    struct ThreadManagerStats
+    {
+        bool enabled = false;
+        TaskQueueStats backgroundThreads;
+        TaskQueueStats renderThread;
+    };
+
     class IThreadManager
     {
     public:
         virtual ~IThreadManager() = default;
 
+        virtual size_t backgroundThreadCount() const = 0;
+
         virtual void performInRenderThread(const std::function<void()>& action) = 0;
         virtual void performInRenderThread(std::function<void()>&& action) = 0;
 
+        // Constructs the callable right in the render thread queue; ones that fit into InplaceAction::CAPACITY
+        // bytes are queued without allocating.
+        template <typename FUNC> void performInRenderThread(FUNC&& action)
+        {
+            using Type = typename std::remove_reference<FUNC>::type;
+            emplaceRenderThreadAction([](InplaceAction& target, void* source) {
+                target.emplace(std::forward<FUNC>(*static_cast<Type*>(source)));
+            }, const_cast<void*>(static_cast<const void*>(&action)));
+        }
+
         virtual void performInBackgroundThread(const std::function<void()>& action) = 0;
         virtual void performInBackgroundThread(std::function<void()>&& action) = 0;
+        virtual void performInBackgroundThread(TaskPriority priority, const std::function<void()>& action) = 0;
+        virtual void performInBackgroundThread(TaskPriority priority, std::function<void()>&& action) = 0;
+
+        virtual TaskGroupPtr createTaskGroup() = 0;
+
+        // Statistics are only gathered while enabled; queue depth is always reported.
+        virtual void setStatsEnabled(bool enabled) = 0;
+        virtual ThreadManagerStats stats() const = 0;
+        virtual void resetStats() = 0;
+
+    protected:
+        // Called once with the queue slot and the `source` passed to emplaceRenderThreadAction().
+        using RenderThreadActionConstructor = void (*)(InplaceAction& target, void* source);
+
+        virtual void emplaceRenderThreadAction(RenderThreadActionConstructor construct, void* source) = 0;
     };
 
     using ThreadManagerPtr = std::shared_ptr<IThreadManager>;
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/interfaces/render/lowlevel/ITexture.h"
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace B3D
+{
+    // Glyph quads of a string, in pixels relative to the top left corner of its first line. Rectangles are stored
+    // as (left, top, right, bottom).
+    struct TextLayout
+    {
+        struct Glyph
+        {
+            glm::vec4 rect;
+            glm::vec4 texCoords;
+        };
+
+        std::vector<Glyph> glyphs;
+        glm::vec2 size;
+        TexturePtr texture;
+    };
+
+    using TextLayoutPtr = std::shared_ptr<const TextLayout>;
+
+    class IFont
+    {
+    public:
+        virtual ~IFont() = default;
+
+        virtual float lineHeight() const = 0;
+        virtual float baseline() const = 0;
+
+        // Returns the layout of the string, which is cached, so that kerning and layout are only done once for
+        // strings that are drawn every frame. Glyphs that have not been used before are rasterized into the
+        // glyph texture, so this must be called on the render thread.
+        virtual TextLayoutPtr layoutText(const std::string& text) = 0;
+    };
+
+    using FontPtr = std::shared_ptr<IFont>;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/interfaces/image/IImage.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+
+namespace B3D
+{
+    // Measured in pixels. The offset is relative to the pen position and the top of the line.
+    struct GlyphMetrics
+    {
+        glm::vec2 offset;
+        glm::vec2 size;
+        float advance;
+    };
+
+    // Provides the glyphs of a font. Glyphs are only rasterized when they are first drawn, so that fonts with
+    // large character sets do not need all of them in memory.
+    class IGlyphSource
+    {
+    public:
+        virtual ~IGlyphSource() = default;
+
+        virtual float lineHeight() const = 0;
+        virtual float baseline() const = 0;
+
+        virtual bool glyphMetrics(uint32_t codepoint, GlyphMetrics& metrics) = 0;
+        virtual float kerning(uint32_t first, uint32_t second) = 0;
+
+        // Returns an image of the size given by the metrics. Luminance images are treated as coverage and drawn
+        // with the text color; other formats keep their own colors.
+        virtual ImagePtr rasterizeGlyph(uint32_t codepoint) = 0;
+    };
+}
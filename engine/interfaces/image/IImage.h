@@ -22,6 +22,7 @@
 
 #pragma once
 #include <cstdint>
+#include <cstddef>
 #include <memory>
 
 namespace B3D
@@ -32,11 +33,103 @@ namespace B3D
         LuminanceAlpha16,
         RGB24,
         RGBA32,
+        RGB565,
+        RGBA4444,
+
+        // Block-compressed formats; BC1 includes the 1-bit alpha mode.
+        ETC1,
+        ETC2_RGB8,
+        ETC2_RGBA8,
+        BC1,
+        BC2,
+        BC3,
+        ASTC_4x4,
+        ASTC_8x8,
 
         Invalid,
         Count = Invalid
     };
 
+    inline bool isCompressed(PixelFormat format)
+    {
+        return format >= PixelFormat::ETC1 && format < PixelFormat::Invalid;
+    }
+
+    // Zero for block-compressed formats.
+    inline size_t bytesPerPixel(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PixelFormat::Luminance8: return 1;
+        case PixelFormat::LuminanceAlpha16: return 2;
+        case PixelFormat::RGB24: return 3;
+        case PixelFormat::RGBA32: return 4;
+        case PixelFormat::RGB565: return 2;
+        case PixelFormat::RGBA4444: return 2;
+        default: break;
+        }
+        return 0;
+    }
+
+    // Uncompressed formats have 1x1 blocks of bytesPerPixel() bytes.
+    inline size_t blockSize(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PixelFormat::ASTC_8x8: return 8;
+        default: return (isCompressed(format) ? 4 : 1);
+        }
+    }
+
+    inline size_t bytesPerBlock(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PixelFormat::ETC1: return 8;
+        case PixelFormat::ETC2_RGB8: return 8;
+        case PixelFormat::ETC2_RGBA8: return 16;
+        case PixelFormat::BC1: return 8;
+        case PixelFormat::BC2: return 16;
+        case PixelFormat::BC3: return 16;
+        case PixelFormat::ASTC_4x4: return 16;
+        case PixelFormat::ASTC_8x8: return 16;
+        default: return bytesPerPixel(format);
+        }
+    }
+
+    // Number of bytes of a tightly packed image; partial blocks at the right and bottom edges count as whole ones.
+    inline size_t imageDataSize(PixelFormat format, size_t width, size_t height)
+    {
+        size_t block = blockSize(format);
+        return ((width + block - 1) / block) * ((height + block - 1) / block) * bytesPerBlock(format);
+    }
+
+    enum class DownsampleFilter
+    {
+        Box,        // 2x2 average
+        Kaiser,     // Kaiser-windowed sinc over 8x8 source pixels; sharper, but an order of magnitude slower
+    };
+
+    enum class DecodeQuality
+    {
+        Accurate,
+        Fast,       // Trades some accuracy for speed (e.g. integer IDCT and plain chroma upsampling for JPEG)
+    };
+
+    // Lets image loaders produce a smaller or cheaper image than the one stored in the file. Images larger than
+    // maxDimension (zero means no limit) are reduced by powers of two until both sides fit: loaders which can scale
+    // while decoding do so, other images are downscaled after decoding.
+    struct ImageLoadHint
+    {
+        size_t maxDimension;
+        DecodeQuality quality;
+
+        explicit ImageLoadHint(size_t maxDim = 0, DecodeQuality q = DecodeQuality::Accurate)
+            : maxDimension(maxDim), quality(q) {}
+
+        bool isDefault() const { return maxDimension == 0 && quality == DecodeQuality::Accurate; }
+    };
+
     class IImage
     {
     public:
@@ -49,6 +142,10 @@ namespace B3D
 
         virtual const uint8_t* data() const = 0;
         virtual size_t dataSize() const = 0;
+
+        // Level 0 is the image itself; each further level halves both dimensions (but not below 1).
+        virtual size_t mipLevelCount() const = 0;
+        virtual const IImage& mipLevel(size_t level) const = 0;
     };
 
     using ImagePtr = std::shared_ptr<IImage>;
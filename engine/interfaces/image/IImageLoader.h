@@ -23,15 +23,43 @@
 #pragma once
 #include "engine/interfaces/io/IFile.h"
 #include "engine/interfaces/image/IImage.h"
+#include <functional>
+#include <cstring>
 
 namespace B3D
 {
+    // Supplies memory for decoded pixels once the image header has been read. Returns where the first row goes and
+    // sets `stride` to the distance between rows in bytes (at least width * bytesPerPixel(format)); returning
+    // nullptr aborts decoding.
+    using ImageDecodeTarget = std::function<uint8_t*(PixelFormat format, size_t width, size_t height, size_t& stride)>;
+
     class IImageLoader
     {
     public:
         virtual ~IImageLoader() = default;
 
+        // Loaders may ignore the hint; Image::fromFile() and Image::decodeFile() downscale whatever they return.
         virtual bool canLoadImage(IFile* file) = 0;
-        virtual ImagePtr loadImage(IFile* file) = 0;
+        virtual ImagePtr loadImage(IFile* file, const ImageLoadHint& hint) = 0;
+
+        // Decodes the base level straight into caller-provided memory. Loaders which can write rows in place should
+        // override this; the fallback copies the result of loadImage() and fails for block-compressed images.
+        virtual bool decodeImage(IFile* file, const ImageLoadHint& hint, const ImageDecodeTarget& target)
+        {
+            ImagePtr image = loadImage(file, hint);
+            size_t rowSize = image->width() * bytesPerPixel(image->pixelFormat());
+            if (rowSize == 0 || image->dataSize() < rowSize * image->height())
+                return false;
+
+            size_t stride = rowSize;
+            uint8_t* pixels = target(image->pixelFormat(), image->width(), image->height(), stride);
+            if (!pixels)
+                return false;
+
+            for (size_t y = 0; y < image->height(); y++)
+                memcpy(pixels + y * stride, image->data() + y * rowSize, rowSize);
+
+            return true;
+        }
     };
 }
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/interfaces/core/ITaskGroup.h"
+#include "engine/interfaces/io/IFile.h"
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace B3D
+{
+    class IAsyncFileReader
+    {
+    public:
+        static const uint64_t WHOLE_FILE = std::numeric_limits<uint64_t>::max();
+
+        // The callback receives a file holding the requested bytes, or nullptr if the read has failed.
+        using Callback = std::function<void(const FilePtr&)>;
+
+        struct Request
+        {
+            std::string fileName;
+            uint64_t offset = 0;
+            uint64_t size = WHOLE_FILE;
+            TaskPriority priority = TaskPriority::Visible;
+            // Callbacks normally run on the background threads. Short non-blocking callbacks may ask to be invoked
+            // directly on the I/O thread instead, which also keeps them independent of a busy worker pool.
+            bool invokeOnIoThread = false;
+            Callback callback;
+        };
+
+        virtual ~IAsyncFileReader() = default;
+
+        // All requests in the batch are handed to the I/O layer together so that it can overlap them.
+        virtual void submit(std::vector<Request>&& requests) = 0;
+    };
+
+    using AsyncFileReaderPtr = std::shared_ptr<IAsyncFileReader>;
+}
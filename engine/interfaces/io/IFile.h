@@ -40,6 +40,15 @@ namespace B3D
         virtual bool seek(uint64_t pos) = 0;
 
         virtual size_t read(void* buffer, size_t bytes) = 0;
+
+        // Files backed by memory (e.g. memory-mapped files) expose their contents directly. The returned pointers
+        // remain valid while the file is open. Both return nullptr if the file does not support direct access.
+        virtual const uint8_t* mappedData() { return nullptr; }
+        virtual const uint8_t* mapRegion(uint64_t offset, size_t bytes)
+        {
+            const uint8_t* data = mappedData();
+            return (data && offset <= size() && bytes <= size() - offset ? data + offset : nullptr);
+        }
     };
 
     using FilePtr = std::shared_ptr<IFile>;
@@ -34,6 +34,7 @@ namespace B3D
         virtual ~IMesh() = default;
 
         virtual const BoundingBox& boundingBox() const = 0;
+        virtual size_t memoryUsage() const = 0;
         virtual void render(ICanvas* canvas) const = 0;
     };
 
@@ -25,6 +25,7 @@
 #include "engine/interfaces/mesh/IRawMeshElementData.h"
 #include <memory>
 #include <vector>
+#include <cstdint>
 
 namespace B3D
 {
@@ -33,8 +34,10 @@ namespace B3D
     public:
         virtual ~IRawMeshData() = default;
 
-        virtual const std::vector<uint8_t>& vertexData() const = 0;
-        virtual const std::vector<uint16_t>& indexData() const = 0;
+        virtual const uint8_t* vertexData() const = 0;
+        virtual size_t vertexDataSize() const = 0;
+        virtual const uint16_t* indexData() const = 0;
+        virtual size_t indexCount() const = 0;
 
         virtual const std::vector<RawMeshElementDataPtr>& elements() const = 0;
 
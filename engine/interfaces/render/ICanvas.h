@@ -25,6 +25,7 @@
 #include "engine/math/BoundingBox.h"
 #include "engine/math/Quad.h"
 #include "engine/interfaces/image/ISprite.h"
+#include "engine/interfaces/font/IFont.h"
 #include <glm/glm.hpp>
 
 namespace B3D
@@ -39,6 +40,11 @@ namespace B3D
         virtual void drawWireframeQuad(const Quad& quad, float z = 0.0f, const glm::vec4& color = glm::vec4(1.0f)) = 0;
         virtual void drawTexturedQuad(const Quad& quad, const Quad& tc, const TexturePtr& texture, float z = 0.0f) = 0;
 
+        // Draws the string with its top left corner at the given position. Consecutive strings drawn with the same
+        // font share a batch. Blending has to be enabled by the caller, as for sprites.
+        virtual void drawText(const glm::vec2& position, const FontPtr& font, const std::string& text,
+            const glm::vec4& color = glm::vec4(1.0f), float z = 0.0f) = 0;
+
         virtual void drawWireframeBoundingBox(const BoundingBox& box, const glm::vec4& colorVal = glm::vec4(1.0f)) = 0;
     };
 }
@@ -40,6 +40,10 @@ namespace B3D
         virtual VertexBufferPtr createVertexBuffer() = 0;
         virtual IndexBufferPtr createIndexBuffer() = 0;
         virtual VertexSourcePtr createVertexSource() = 0;
+
+        // Whether textures in the given format can be uploaded without decoding them first. May be called from any
+        // thread.
+        virtual bool supportsPixelFormat(PixelFormat format) const = 0;
     };
 
     using RendererResourceFactoryPtr = std::shared_ptr<IRendererResourceFactory>;
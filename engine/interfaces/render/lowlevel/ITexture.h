@@ -27,15 +27,70 @@
 
 namespace B3D
 {
+    enum class TextureFilter
+    {
+        Nearest,
+        Linear,
+    };
+
+    enum class MipmapFilter
+    {
+        None,
+        Nearest,
+        Linear,
+    };
+
+    enum class TextureWrap
+    {
+        Clamp,
+        Repeat,
+        MirroredRepeat,
+    };
+
+    // Sampling parameters are specified by whoever binds the texture (usually a material pass), so that textures
+    // shared between materials may be sampled differently. Mipmap filtering is ignored for textures without mipmaps.
+    struct SamplerState
+    {
+        TextureFilter minFilter = TextureFilter::Linear;
+        TextureFilter magFilter = TextureFilter::Linear;
+        MipmapFilter mipFilter = MipmapFilter::Linear;
+        TextureWrap wrapS = TextureWrap::Clamp;
+        TextureWrap wrapT = TextureWrap::Clamp;
+        float maxAnisotropy = 1.0f;
+
+        bool operator==(const SamplerState& other) const
+        {
+            return minFilter == other.minFilter && magFilter == other.magFilter && mipFilter == other.mipFilter
+                && wrapS == other.wrapS && wrapT == other.wrapT && maxAnisotropy == other.maxAnisotropy;
+        }
+
+        bool operator!=(const SamplerState& other) const { return !(*this == other); }
+    };
+
+    class ITexture;
+    using TexturePtr = std::shared_ptr<ITexture>;
+
     class ITexture
     {
     public:
         virtual ~ITexture() = default;
 
         virtual const glm::vec2& size() const = 0;
+        virtual PixelFormat pixelFormat() const = 0;
+        virtual size_t mipLevelCount() const = 0;
 
+        // Uploads all mipmap levels of the image.
         virtual void upload(const IImage& image) = 0;
-    };
 
-    using TexturePtr = std::shared_ptr<ITexture>;
+        // Replaces a rectangle of the base level with the image, which must have the pixel format of the texture.
+        // Other mipmap levels are left as they are.
+        virtual void uploadRegion(size_t x, size_t y, const IImage& image) = 0;
+
+        // Textures packed into a texture atlas return the page they live in, along with the offset and scale that map
+        // their texture coordinates into the page. Standalone textures return null.
+        virtual TexturePtr atlasPage(glm::vec2& offset, glm::vec2& scale) const = 0;
+
+        // The texture that is actually bound when this one is sampled by a shader.
+        virtual ITexture* samplerTexture() = 0;
+    };
 }
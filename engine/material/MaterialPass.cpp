@@ -46,20 +46,25 @@ namespace B3D
     class MaterialPass::UniformTexture : public UniformValue
     {
     public:
-        explicit UniformTexture(const std::string& path)
+        UniformTexture(const std::string& path, const SamplerState& sampler)
             : mTexturePath(new std::string(path))
+            , mSampler(sampler)
         {
         }
 
-        explicit UniformTexture(const TexturePtr& texture)
+        UniformTexture(const TexturePtr& texture, const SamplerState& sampler)
             : mTexture(texture)
+            , mSampler(sampler)
         {
         }
 
         void loadPendingResources(bool async) const final override
         {
             if (!mTexture && mTexturePath) {
-                mTexture = Services::resourceManager()->getTexture(*mTexturePath, async);
+                // Shaders sample the whole texture, possibly with repeating wrap modes
+                auto resourceManager = Services::resourceManager();
+                resourceManager->excludeFromTextureAtlas(*mTexturePath);
+                mTexture = resourceManager->getTexture(*mTexturePath, async);
                 mTexturePath.reset();
             }
         }
@@ -67,12 +72,13 @@ namespace B3D
         void upload(IRenderer* renderer, Atom name) const final override
         {
             loadPendingResources(true);
-            renderer->setUniform(name, mTexture);
+            renderer->setUniform(name, mTexture, mSampler);
         }
 
     private:
         mutable std::unique_ptr<std::string> mTexturePath;
         mutable TexturePtr mTexture;
+        SamplerState mSampler;
     };
 
 
@@ -133,14 +139,15 @@ namespace B3D
         setUniform(AtomTable::getAtom(name), value);
     }
 
-    void MaterialPass::setUniform(const std::string& name, const std::string& textureName)
+    void MaterialPass::setUniform(const std::string& name, const std::string& textureName,
+        const SamplerState& sampler)
     {
-        setUniform(AtomTable::getAtom(name), textureName);
+        setUniform(AtomTable::getAtom(name), textureName, sampler);
     }
 
-    void MaterialPass::setUniform(const std::string& name, const TexturePtr& texture)
+    void MaterialPass::setUniform(const std::string& name, const TexturePtr& texture, const SamplerState& sampler)
     {
-        setUniform(AtomTable::getAtom(name), texture);
+        setUniform(AtomTable::getAtom(name), texture, sampler);
     }
 
     void MaterialPass::unsetUniform(const std::string& name)
@@ -178,16 +185,16 @@ namespace B3D
         mUniforms[index].second.reset(new UniformValueT<glm::mat4>(value));
     }
 
-    void MaterialPass::setUniform(Atom name, const std::string& textureName)
+    void MaterialPass::setUniform(Atom name, const std::string& textureName, const SamplerState& sampler)
     {
         size_t index = uniformIndex(name);
-        mUniforms[index].second.reset(new UniformTexture(textureName));
+        mUniforms[index].second.reset(new UniformTexture(textureName, sampler));
     }
 
-    void MaterialPass::setUniform(Atom name, const TexturePtr& texture)
+    void MaterialPass::setUniform(Atom name, const TexturePtr& texture, const SamplerState& sampler)
     {
         size_t index = uniformIndex(name);
-        mUniforms[index].second.reset(new UniformTexture(texture));
+        mUniforms[index].second.reset(new UniformTexture(texture, sampler));
     }
 
     void MaterialPass::unsetUniform(Atom name)
@@ -62,8 +62,10 @@ namespace B3D
         void setUniform(const std::string& name, const glm::vec3& value);
         void setUniform(const std::string& name, const glm::vec4& value);
         void setUniform(const std::string& name, const glm::mat4& value);
-        void setUniform(const std::string& name, const std::string& textureName);
-        void setUniform(const std::string& name, const TexturePtr& texture);
+        void setUniform(const std::string& name, const std::string& textureName,
+            const SamplerState& sampler = SamplerState());
+        void setUniform(const std::string& name, const TexturePtr& texture,
+            const SamplerState& sampler = SamplerState());
         void unsetUniform(const std::string& name);
 
         void setUniform(Atom name, float value);
@@ -71,8 +73,8 @@ namespace B3D
         void setUniform(Atom name, const glm::vec3& value);
         void setUniform(Atom name, const glm::vec4& value);
         void setUniform(Atom name, const glm::mat4& value);
-        void setUniform(Atom name, const std::string& textureName);
-        void setUniform(Atom name, const TexturePtr& texture);
+        void setUniform(Atom name, const std::string& textureName, const SamplerState& sampler = SamplerState());
+        void setUniform(Atom name, const TexturePtr& texture, const SamplerState& sampler = SamplerState());
         void unsetUniform(Atom name);
 
         void apply(const RendererPtr& renderer) const override;
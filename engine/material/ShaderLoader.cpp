@@ -27,14 +27,11 @@
 
 namespace B3D
 {
-    static const std::string VERTEX = "%vertex";
-    static const std::string VERTEX_LF = "%vertex\n";
-    static const std::string FRAGMENT = "%fragment";
-    static const std::string FRAGMENT_LF = "%fragment\n";
-    static const std::string COMMON = "%common";
-    static const std::string COMMON_LF = "%common\n";
-    static const std::string INCLUDE = "%include ";
-    static const std::string LF = "\n";
+    static const StringView VERTEX = "%vertex";
+    static const StringView FRAGMENT = "%fragment";
+    static const StringView COMMON = "%common";
+    static const StringView INCLUDE = "%include ";
+    static const StringView COMMENT = "//";
 
     ShaderLoader::ShaderLoader()
     {
@@ -57,68 +54,90 @@ namespace B3D
 
     bool ShaderLoader::loadFile(IFile* file, std::vector<std::string>* what)
     {
-        return file && loadMemory(file->name(), FileUtils::loadFileLines(file, true), what);
+        if (!file)
+            return false;
+
+        FileUtils::FileContents contents = FileUtils::mapFile(file);
+        FileUtils::LineReader reader(contents);
+        const char* end = contents.data() + contents.size();
+        bool success = true;
+
+        StringView line;
+        while (reader.readLine(line))
+            success = processLine(file->name(), reader.lineNumber(), line, line.end() != end, what) && success;
+
+        if (!success)
+            B3D_LOGE("Unable to load shader \"" << file->name() << "\".");
+
+        return success;
     }
 
     bool ShaderLoader::loadMemory(const std::string& fileName, const std::vector<std::string>& lines,
         std::vector<std::string>* what)
     {
-        std::vector<std::string> linesCopy = lines;
-        return loadMemory(fileName, std::move(linesCopy), what);
+        bool success = true;
+        size_t lineNumber = 0;
+
+        for (const auto& line : lines) {
+            StringView view = line;
+            bool endOfLine = view.endsWith("\n");
+            if (endOfLine)
+                view = view.substr(0, view.size() - (view.endsWith("\r\n") ? 2 : 1));
+            success = processLine(fileName, ++lineNumber, view, endOfLine, what) && success;
+        }
+
+        if (!success)
+            B3D_LOGE("Unable to load shader \"" << fileName << "\".");
+
+        return success;
     }
 
     bool ShaderLoader::loadMemory(const std::string& fileName, std::vector<std::string>&& lines,
         std::vector<std::string>* what)
     {
-        bool success = true;
-        int lineNumber = 0;
-
-        for (auto& line : lines) {
-            ++lineNumber;
-
-            size_t index = line.find("//");
-            if (index != std::string::npos) {
-                bool endsWithLF = false;
-                size_t length = line.length();
-                if (length > 1 && line[length - 1] == '\n')
-                    endsWithLF = true;
-
-                line = line.substr(0, index);
-
-                if (endsWithLF)
-                    line += '\n';
-            }
+        return loadMemory(fileName, static_cast<const std::vector<std::string>&>(lines), what);
+    }
 
-            if (*line.c_str() == '%') {
-                if (line == VERTEX_LF || line == VERTEX)
-                    what = &mVertex;
-                else if (line == FRAGMENT_LF || line == FRAGMENT)
-                    what = &mFragment;
-                else if (line == COMMON_LF || line == COMMON)
-                    what = nullptr;
-                else if (line.substr(0, INCLUDE.length()) == INCLUDE) {
-                    auto include = openIncludeFile(line.substr(INCLUDE.length()), fileName);
-                    success = loadFile(include.get(), what) && success;
-                } else {
-                    B3D_LOGE(fileName << "(" << lineNumber << "): invalid directive.");
-                    what = nullptr;
-                    success = false;
-                }
-                continue;
+    bool ShaderLoader::processLine(const std::string& fileName, size_t lineNumber, StringView line, bool endOfLine,
+        std::vector<std::string>*& what)
+    {
+        size_t index = line.find(COMMENT);
+        if (index != StringView::npos)
+            line = line.substr(0, index);
+
+        if (!line.empty() && line[0] == '%') {
+            if (line == VERTEX)
+                what = &mVertex;
+            else if (line == FRAGMENT)
+                what = &mFragment;
+            else if (line == COMMON)
+                what = nullptr;
+            else if (line.startsWith(INCLUDE)) {
+                auto include = openIncludeFile(line.substr(INCLUDE.size()).toString(), fileName);
+                return loadFile(include.get(), what);
+            } else {
+                B3D_LOGE(fileName << "(" << lineNumber << "): invalid directive.");
+                what = nullptr;
+                return false;
             }
+            return true;
+        }
 
-            if (what)
-                what->emplace_back(std::move(line));
-            else {
-                mVertex.emplace_back(line);
-                mFragment.emplace_back(std::move(line));
-            }
+        if (what)
+            appendLine(*what, line, endOfLine);
+        else {
+            appendLine(mVertex, line, endOfLine);
+            appendLine(mFragment, line, endOfLine);
         }
 
-        if (!success)
-            B3D_LOGE("Unable to load shader \"" << fileName << "\".");
+        return true;
+    }
 
-        return success;
+    void ShaderLoader::appendLine(std::vector<std::string>& source, StringView line, bool endOfLine)
+    {
+        source.emplace_back(line.data(), line.size());
+        if (endOfLine)
+            source.back() += '\n';
     }
 
     ShaderPtr ShaderLoader::compile(const std::string& fileName, const std::vector<std::string>& lines)
@@ -149,14 +168,8 @@ namespace B3D
         return shader;
     }
 
-    FilePtr ShaderLoader::openIncludeFile(std::string fileName, const std::string& parentFileName) const
+    FilePtr ShaderLoader::openIncludeFile(const std::string& fileName, const std::string& parentFileName) const
     {
-        FilePtr file;
-
-        size_t length = fileName.length();
-        if (length > 0 && fileName[length - 1] == '\n')
-            fileName.resize(--length);
-
         std::string name = FileUtils::makeFullPath(fileName, parentFileName);
         if (Services::fileSystem()->fileExists(name))
             return Services::fileSystem()->openFile(name);
@@ -24,6 +24,7 @@
 #include "engine/core/macros.h"
 #include "engine/interfaces/render/lowlevel/IShader.h"
 #include "engine/interfaces/io/IFile.h"
+#include "engine/utility/StringView.h"
 #include <vector>
 #include <string>
 
@@ -35,6 +36,8 @@ namespace B3D
         ShaderLoader();
         ~ShaderLoader();
 
+        // One element per source line, ending with '\n' unless the line was the last one in its file and had no
+        // end of line marker. Comments and directives are stripped, and "\r\n" is normalized to '\n'.
         const std::vector<std::string>& vertexSource() const { return mVertex; }
         const std::vector<std::string>& fragmentSource() const { return mFragment; }
 
@@ -54,7 +57,11 @@ namespace B3D
         std::vector<std::string> mVertex;
         std::vector<std::string> mFragment;
 
-        FilePtr openIncludeFile(std::string fileName, const std::string& parentFileName) const;
+        bool processLine(const std::string& fileName, size_t lineNumber, StringView line, bool endOfLine,
+            std::vector<std::string>*& what);
+        FilePtr openIncludeFile(const std::string& fileName, const std::string& parentFileName) const;
+
+        static void appendLine(std::vector<std::string>& source, StringView line, bool endOfLine);
 
         B3D_DISABLE_COPY(ShaderLoader);
     };
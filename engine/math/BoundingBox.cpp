@@ -20,20 +20,33 @@
  * THE SOFTWARE.
  */
 #include "BoundingBox.h"
+#include "engine/utility/ParallelUtils.h"
 
 namespace B3D
 {
     void BoundingBox::initFromPoints(const std::vector<glm::vec3>& points)
     {
-        if (points.empty())
+        initFromPoints(points.data(), points.size());
+    }
+
+    void BoundingBox::initFromPoints(const glm::vec3* points, size_t count)
+    {
+        if (count == 0) {
             min = max = glm::vec3(0.0f);
-        else {
-            min = max = points[0];
-            for (size_t i = 1; i < points.size(); i++) {
-                min = glm::min(min, points[i]);
-                max = glm::max(max, points[i]);
-            }
+            return;
         }
+
+        *this = ParallelUtils::parallelReduce(size_t(0), count, BoundingBox(points[0], points[0]),
+            [points](size_t first, size_t last) {
+                BoundingBox box(points[first], points[first]);
+                for (size_t i = first + 1; i < last; i++)
+                    box.addPoint(points[i]);
+                return box;
+            },
+            [](BoundingBox a, const BoundingBox& b) {
+                a.addBoundingBox(b);
+                return a;
+            });
     }
 
     void BoundingBox::addPoint(const glm::vec3& point)
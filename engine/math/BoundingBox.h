@@ -41,6 +41,7 @@ namespace B3D
 
         void initFromPoint(const glm::vec3& point) { min = max = point; }
         void initFromPoints(const std::vector<glm::vec3>& points);
+        void initFromPoints(const glm::vec3* points, size_t count);
 
         void addPoint(const glm::vec3& point);
         void addBoundingBox(const BoundingBox& box);
@@ -34,6 +34,11 @@ namespace B3D
     {
     }
 
+    size_t Mesh::memoryUsage() const
+    {
+        return mVertexBuffer->currentSize() + mIndexBuffer->currentSize();
+    }
+
     void Mesh::setData(const RawMeshDataPtr& data, BufferUsage usage, bool async)
     {
         assert(data != nullptr);
@@ -42,13 +47,8 @@ namespace B3D
 
         mBoundingBox = data->boundingBox();
 
-        const auto& vertices = data->vertexData();
-        const size_t vertexElementSize = sizeof(std::remove_reference<decltype(vertices)>::type::value_type);
-        mVertexBuffer->setData(vertices.data(), vertices.size() * vertexElementSize, usage);
-
-        const auto& indices = data->indexData();
-        const size_t indexElementSize = sizeof(std::remove_reference<decltype(indices)>::type::value_type);
-        mIndexBuffer->setData(indices.data(), indices.size() * indexElementSize, usage);
+        mVertexBuffer->setData(data->vertexData(), data->vertexDataSize(), usage);
+        mIndexBuffer->setData(data->indexData(), data->indexCount() * sizeof(uint16_t), usage);
 
         mElements.reserve(data->elements().size());
         for (const auto& dataElement : data->elements()) {
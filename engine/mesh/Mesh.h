@@ -36,6 +36,7 @@ namespace B3D
         ~Mesh();
 
         const BoundingBox& boundingBox() const override { return mBoundingBox; }
+        size_t memoryUsage() const override;
 
         void setData(const RawMeshDataPtr& data, BufferUsage usage, bool async = true);
 
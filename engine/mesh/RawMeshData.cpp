@@ -23,6 +23,7 @@
 #include "engine/mesh/RawMeshElementData.h"
 #include "engine/core/Services.h"
 #include "engine/core/Log.h"
+#include <cassert>
 
 namespace B3D
 {
@@ -30,6 +31,10 @@ namespace B3D
     std::mutex RawMeshData::mMeshLoadersMutex;
 
     RawMeshData::RawMeshData()
+        : mExternalVertexData(nullptr)
+        , mExternalVertexDataSize(0)
+        , mExternalIndexData(nullptr)
+        , mExternalIndexCount(0)
     {
     }
 
@@ -37,8 +42,29 @@ namespace B3D
     {
     }
 
+    const uint8_t* RawMeshData::vertexData() const
+    {
+        return (mExternalVertexData ? mExternalVertexData : mVertexData.data());
+    }
+
+    size_t RawMeshData::vertexDataSize() const
+    {
+        return (mExternalVertexData ? mExternalVertexDataSize : mVertexData.size());
+    }
+
+    const uint16_t* RawMeshData::indexData() const
+    {
+        return (mExternalIndexData ? mExternalIndexData : mIndexData.data());
+    }
+
+    size_t RawMeshData::indexCount() const
+    {
+        return (mExternalIndexData ? mExternalIndexCount : mIndexData.size());
+    }
+
     size_t RawMeshData::appendVertices(size_t count, void** vertices, size_t vertexSize)
     {
+        assert(mExternalVertexData == nullptr);
         size_t offset = mVertexData.size();
         mVertexData.resize(offset + count * vertexSize);
         *vertices = &mVertexData[offset];
@@ -47,12 +73,25 @@ namespace B3D
 
     size_t RawMeshData::appendIndices(size_t count, uint16_t** indices)
     {
+        assert(mExternalIndexData == nullptr);
         size_t offset = mIndexData.size();
         mIndexData.resize(offset + count);
         *indices = &mIndexData[offset];
         return offset;
     }
 
+    void RawMeshData::setExternalData(const uint8_t* vertices, size_t vertexDataSize, const uint16_t* indices,
+        size_t indexCount, const std::shared_ptr<void>& owner)
+    {
+        std::vector<uint8_t>().swap(mVertexData);
+        std::vector<uint16_t>().swap(mIndexData);
+        mExternalDataOwner = owner;
+        mExternalVertexData = vertices;
+        mExternalVertexDataSize = vertexDataSize;
+        mExternalIndexData = indices;
+        mExternalIndexCount = indexCount;
+    }
+
     RawMeshDataPtr RawMeshData::fromFile(const std::string& name, bool loadSkeleton)
     {
         return fromFile(Services::fileSystem()->openFile(name).get(), loadSkeleton);
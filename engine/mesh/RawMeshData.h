@@ -46,16 +46,24 @@ namespace B3D
             mElements.emplace_back(element);
             return element;
         }
+        void addElement(RawMeshElementDataPtr&& element) { mElements.emplace_back(std::move(element)); }
 
         const BoundingBox& boundingBox() const override { return mBoundingBox; }
         void setBoundingBox(const BoundingBox& box) { mBoundingBox = box; }
 
-        const std::vector<uint8_t>& vertexData() const override { return mVertexData; }
-        const std::vector<uint16_t>& indexData() const override { return mIndexData; }
+        const uint8_t* vertexData() const override;
+        size_t vertexDataSize() const override;
+        const uint16_t* indexData() const override;
+        size_t indexCount() const override;
 
         size_t appendVertices(size_t count, void** vertices, size_t vertexSize);
         size_t appendIndices(size_t count, uint16_t** indices);
 
+        // References vertices and indices kept alive by the owner (e.g. a memory-mapped file) instead of holding
+        // a copy. Appending to the mesh afterwards is not supported.
+        void setExternalData(const uint8_t* vertices, size_t vertexDataSize, const uint16_t* indices,
+            size_t indexCount, const std::shared_ptr<void>& owner);
+
         static RawMeshDataPtr fromFile(const std::string& name, bool loadSkeleton);
         static RawMeshDataPtr fromFile(const FilePtr& file, bool loadSkeleton);
         static RawMeshDataPtr fromFile(IFile* file, bool loadSkeleton);
@@ -72,6 +80,11 @@ namespace B3D
         std::vector<RawMeshElementDataPtr> mElements;
         std::vector<uint8_t> mVertexData;
         std::vector<uint16_t> mIndexData;
+        std::shared_ptr<void> mExternalDataOwner;
+        const uint8_t* mExternalVertexData;
+        size_t mExternalVertexDataSize;
+        const uint16_t* mExternalIndexData;
+        size_t mExternalIndexCount;
 
         B3D_DISABLE_COPY(RawMeshData);
     };
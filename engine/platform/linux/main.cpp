@@ -23,6 +23,7 @@
 #include "engine/core/Log.h"
 #include "engine/input/InputManager.h"
 #include "engine/platform/shared/StdIoFileSystem.h"
+#include "engine/platform/shared/IoUringFileReader.h"
 #include "engine/platform/shared/CxxThreadManager.h"
 #include "engine/platform/shared/GlfwWrapper.h"
 #include "engine/platform/shared/PosixLogger.h"
@@ -40,7 +41,13 @@ int main()
 
     auto threadManager = std::make_shared<CxxThreadManager>();
     Services::setThreadManager(threadManager);
-    Services::setFileSystem(std::make_shared<StdIoFileSystem>("."));
+    auto fileSystem = std::make_shared<StdIoFileSystem>(".", true);
+    Services::setFileSystem(fileSystem);
+
+    AsyncFileReaderPtr asyncFileReader = IoUringFileReader::create(".", fileSystem);
+    if (!asyncFileReader)
+        asyncFileReader = std::make_shared<ThreadedFileReader>();
+    Services::setAsyncFileReader(asyncFileReader);
 
     auto inputManager = std::make_shared<InputManager>();
     inputManager->setHasKeyboard(true);
@@ -64,9 +71,13 @@ int main()
         }
     }
 
+    asyncFileReader.reset();
+    Services::setAsyncFileReader(nullptr);
+
     threadManager->stopWorkerThreads();
 
     threadManager.reset();
+    fileSystem.reset();
     inputManager.reset();
     Services::setInputManager(nullptr);
     Services::setFileSystem(nullptr);
@@ -22,6 +22,7 @@
 #include "engine/core/Services.h"
 #include "engine/input/InputManager.h"
 #include "engine/platform/shared/StdIoFileSystem.h"
+#include "engine/platform/shared/ThreadedFileReader.h"
 #include "engine/platform/shared/CxxThreadManager.h"
 #include "engine/platform/shared/GlfwWrapper.h"
 #include "engine/platform/shared/PosixLogger.h"
@@ -38,7 +39,9 @@ int main()
 
     auto threadManager = std::make_shared<CxxThreadManager>();
     Services::setThreadManager(threadManager);
-    Services::setFileSystem(std::make_shared<StdIoFileSystem>("."));
+    auto fileSystem = std::make_shared<StdIoFileSystem>(".");
+    Services::setFileSystem(fileSystem);
+    Services::setAsyncFileReader(std::make_shared<ThreadedFileReader>());
 
     auto inputManager = std::make_shared<InputManager>();
     inputManager->setHasKeyboard(true);
@@ -54,9 +57,12 @@ int main()
             glfwWrapper.run([threadManager](){ threadManager->flushRenderThreadQueue(); });
     }
 
+    Services::setAsyncFileReader(nullptr);
+
     threadManager->stopWorkerThreads();
 
     threadManager.reset();
+    fileSystem.reset();
     inputManager.reset();
     Services::setInputManager(nullptr);
     Services::setFileSystem(nullptr);
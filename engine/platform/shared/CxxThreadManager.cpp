@@ -20,11 +20,17 @@
  * THE SOFTWARE.
  */
 #include "CxxThreadManager.h"
+#include "engine/core/TaskGroup.h"
+#include "engine/core/Log.h"
 #include <cassert>
 
 namespace B3D
 {
-    CxxThreadManager::CxxThreadManager()
+    CxxThreadManager::CxxThreadManager(size_t workerCount)
+        : mRenderThreadQueue(RENDER_THREAD_QUEUE_CAPACITY)
+        , mRenderThreadOverflowCount(0)
+        , mThreadPool(workerCount)
+        , mStatsLogInterval(0)
     {
     }
 
@@ -34,42 +40,149 @@ namespace B3D
 
     void CxxThreadManager::stopWorkerThreads()
     {
-        mWorkerThread.stop();
-        while (!mWorkerThread.exited())
+        mThreadPool.stop();
+        while (!mThreadPool.exited())
             std::this_thread::yield();
-        mRenderThreadQueue.clear();
+        clearRenderThreadQueue();
     }
 
     void CxxThreadManager::flushRenderThreadQueue()
     {
-        std::function<void()> action;
-        while (mRenderThreadQueue.tryDequeue(action)) {
-            action();
-            action = nullptr;
+        RenderThreadTask batch[RENDER_THREAD_BATCH_SIZE];
+        for (;;) {
+            size_t count = mRenderThreadQueue.tryDequeue(batch, RENDER_THREAD_BATCH_SIZE);
+            if (count == 0) {
+                if (!mRenderThreadOverflowQueue.tryDequeue(batch[0]))
+                    break;
+                --mRenderThreadOverflowCount;
+                count = 1;
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                mRenderThreadStats.run(batch[i].action, batch[i].enqueueTime);
+                batch[i].action.reset();
+            }
+        }
+
+        if (mStatsLogInterval.count() > 0 && mRenderThreadStats.enabled()) {
+            auto now = TaskStats::Clock::now();
+            if (now >= mNextStatsLogTime) {
+                mNextStatsLogTime = now + mStatsLogInterval;
+                logStats();
+            }
         }
     }
 
+    void CxxThreadManager::setStatsLogInterval(std::chrono::milliseconds interval)
+    {
+        mStatsLogInterval = interval;
+        mNextStatsLogTime = TaskStats::Clock::now() + interval;
+    }
+
     void CxxThreadManager::performInRenderThread(const std::function<void()>& action)
     {
         assert(action != nullptr);
-        mRenderThreadQueue.enqueue(action);
+        IThreadManager::performInRenderThread<const std::function<void()>&>(action);
     }
 
     void CxxThreadManager::performInRenderThread(std::function<void()>&& action)
     {
         assert(action != nullptr);
-        mRenderThreadQueue.enqueue(std::move(action));
+        IThreadManager::performInRenderThread<std::function<void()>>(std::move(action));
     }
 
     void CxxThreadManager::performInBackgroundThread(const std::function<void()>& action)
     {
         assert(action != nullptr);
-        mWorkerThread.perform(action);
+        mThreadPool.perform(action);
     }
 
     void CxxThreadManager::performInBackgroundThread(std::function<void()>&& action)
     {
         assert(action != nullptr);
-        mWorkerThread.perform(std::move(action));
+        mThreadPool.perform(std::move(action));
+    }
+
+    void CxxThreadManager::performInBackgroundThread(TaskPriority priority, const std::function<void()>& action)
+    {
+        assert(action != nullptr);
+        mThreadPool.perform(priority, action);
+    }
+
+    void CxxThreadManager::performInBackgroundThread(TaskPriority priority, std::function<void()>&& action)
+    {
+        assert(action != nullptr);
+        mThreadPool.perform(priority, std::move(action));
+    }
+
+    TaskGroupPtr CxxThreadManager::createTaskGroup()
+    {
+        return std::make_shared<TaskGroup>(this);
+    }
+
+    void CxxThreadManager::setStatsEnabled(bool enabled)
+    {
+        mThreadPool.stats().setEnabled(enabled);
+        mRenderThreadStats.setEnabled(enabled);
+    }
+
+    ThreadManagerStats CxxThreadManager::stats() const
+    {
+        ThreadManagerStats stats;
+        stats.enabled = mRenderThreadStats.enabled();
+        stats.backgroundThreads = mThreadPool.stats().snapshot(mThreadPool.pendingTaskCount());
+        stats.renderThread = mRenderThreadStats.snapshot(
+            mRenderThreadQueue.size() + mRenderThreadOverflowQueue.size());
+        return stats;
+    }
+
+    void CxxThreadManager::resetStats()
+    {
+        mThreadPool.stats().reset();
+        mRenderThreadStats.reset();
+    }
+
+    void CxxThreadManager::emplaceRenderThreadAction(RenderThreadActionConstructor construct, void* source)
+    {
+        auto enqueueTime = mRenderThreadStats.enqueueTime();
+        auto fill = [construct, source, enqueueTime](RenderThreadTask& task) {
+            construct(task.action, source);
+            task.enqueueTime = enqueueTime;
+        };
+
+        // Once an action has spilled into the overflow queue, the following ones go there too until it has been
+        // drained: otherwise they could overtake it through the ring.
+        if (mRenderThreadOverflowCount.load() != 0 || !mRenderThreadQueue.tryEnqueueWith(fill)) {
+            RenderThreadTask task;
+            fill(task);
+            ++mRenderThreadOverflowCount;
+            mRenderThreadOverflowQueue.enqueue(std::move(task));
+        }
+
+        mRenderThreadStats.recordQueueDepth(mRenderThreadQueue.size() + mRenderThreadOverflowCount.load());
+    }
+
+    void CxxThreadManager::clearRenderThreadQueue()
+    {
+        RenderThreadTask task;
+        while (mRenderThreadQueue.tryDequeue(task))
+            task.action.reset();
+        mRenderThreadOverflowQueue.clear();
+        mRenderThreadOverflowCount.store(0);
+    }
+
+    void CxxThreadManager::logStats() const
+    {
+        auto log = [](const char* name, const TaskQueueStats& stats) {
+            uint64_t tasks = (stats.tasksExecuted > 0 ? stats.tasksExecuted : 1);
+            B3D_LOGI(name << ": " << stats.tasksExecuted << " tasks, queue depth " << stats.queueDepth
+                << " (max " << stats.maxQueueDepth << "), wait avg " << stats.totalWaitMicroseconds / tasks
+                << " us (max " << stats.maxWaitMicroseconds << " us), run avg "
+                << stats.totalExecutionMicroseconds / tasks << " us (max " << stats.maxExecutionMicroseconds << " us).");
+        };
+
+        ThreadManagerStats current = stats();
+        log("Background threads", current.backgroundThreads);
+        log("Render thread", current.renderThread);
     }
 }
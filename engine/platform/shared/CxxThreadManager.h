@@ -22,31 +22,68 @@
 
 #pragma once
 #include "engine/interfaces/core/IThreadManager.h"
-#include "engine/utility/WorkerThread.h"
+#include "engine/utility/ThreadPool.h"
+#include "engine/utility/LockFreeQueue.h"
 #include "engine/utility/ProducerConsumerQueue.h"
 #include <memory>
+#include <chrono>
+#include <atomic>
 
 namespace B3D
 {
     class CxxThreadManager : public IThreadManager
     {
     public:
-        CxxThreadManager();
+        static const size_t RENDER_THREAD_QUEUE_CAPACITY = 4096;
+        static const size_t RENDER_THREAD_BATCH_SIZE = 64;
+
+        explicit CxxThreadManager(size_t workerCount = 0);
         ~CxxThreadManager();
 
         void stopWorkerThreads();
 
         void flushRenderThreadQueue();
 
+        // Logs statistics from flushRenderThreadQueue() at the given interval while they are enabled; zero disables.
+        void setStatsLogInterval(std::chrono::milliseconds interval);
+
+        size_t backgroundThreadCount() const override { return mThreadPool.workerCount(); }
+
+        using IThreadManager::performInRenderThread;
         void performInRenderThread(const std::function<void()>& action) override;
         void performInRenderThread(std::function<void()>&& action) override;
 
         void performInBackgroundThread(const std::function<void()>& action) override;
         void performInBackgroundThread(std::function<void()>&& action) override;
+        void performInBackgroundThread(TaskPriority priority, const std::function<void()>& action) override;
+        void performInBackgroundThread(TaskPriority priority, std::function<void()>&& action) override;
+
+        TaskGroupPtr createTaskGroup() override;
+
+        void setStatsEnabled(bool enabled) override;
+        ThreadManagerStats stats() const override;
+        void resetStats() override;
+
+    protected:
+        void emplaceRenderThreadAction(RenderThreadActionConstructor construct, void* source) override;
 
     private:
-        ProducerConsumerQueue<std::function<void()>> mRenderThreadQueue;
-        WorkerThread mWorkerThread;
+        struct RenderThreadTask
+        {
+            InplaceAction action;
+            TaskStats::Clock::time_point enqueueTime;
+        };
+
+        LockFreeQueue<RenderThreadTask> mRenderThreadQueue;
+        mutable ProducerConsumerQueue<RenderThreadTask> mRenderThreadOverflowQueue;
+        std::atomic<size_t> mRenderThreadOverflowCount;
+        TaskStats mRenderThreadStats;
+        ThreadPool mThreadPool;
+        std::chrono::milliseconds mStatsLogInterval;
+        TaskStats::Clock::time_point mNextStatsLogTime;
+
+        void clearRenderThreadQueue();
+        void logStats() const;
 
         B3D_DISABLE_COPY(CxxThreadManager);
     };
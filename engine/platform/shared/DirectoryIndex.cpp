@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "DirectoryIndex.h"
+#include "engine/core/Log.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#ifdef B3D_PLATFORM_LINUX
+#include <sys/inotify.h>
+#define B3D_USE_INOTIFY
+#endif
+
+namespace B3D
+{
+    namespace
+    {
+        // Changes reported by inotify are picked up at most this often, so that most lookups don't need a syscall.
+        const std::chrono::milliseconds POLL_INTERVAL(100);
+
+        bool isValidPath(const std::string& name)
+        {
+            size_t start = 0;
+            for (;;) {
+                size_t end = name.find('/', start);
+                size_t length = (end == std::string::npos ? name.length() : end) - start;
+                if (length == 0)
+                    return false;
+                if (name[start] == '.' && (length == 1 || (length == 2 && name[start + 1] == '.')))
+                    return false;
+                if (end == std::string::npos)
+                    return true;
+                start = end + 1;
+            }
+        }
+
+      #ifdef B3D_USE_INOTIFY
+        std::string joinPath(const std::string& directory, const std::string& name)
+        {
+            return (directory.empty() ? name : directory + '/' + name);
+        }
+      #endif
+    }
+
+    DirectoryIndex::DirectoryIndex(const std::string& basePath)
+        : mBasePath(basePath)
+        , mNotifyHandle(-1)
+    {
+      #ifdef B3D_USE_INOTIFY
+        mNotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mNotifyHandle < 0) {
+            const char* error = strerror(errno);
+            B3D_LOGW("Unable to initialize inotify: " << error << ". File system changes will not be noticed.");
+        }
+      #endif
+    }
+
+    DirectoryIndex::~DirectoryIndex()
+    {
+        if (mNotifyHandle >= 0)
+            close(mNotifyHandle);
+    }
+
+    DirectoryIndex::Result DirectoryIndex::lookup(const std::string& name, uint64_t* size)
+    {
+        if (!isValidPath(name))
+            return Unknown;
+
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
+        pollChanges();
+
+        size_t slash = name.rfind('/');
+        const Directory& dir = directory(slash == std::string::npos ? std::string() : name.substr(0, slash));
+        if (!dir.exists)
+            return Missing;
+
+        auto it = dir.files.find(slash == std::string::npos ? name : name.substr(slash + 1));
+        if (it == dir.files.end())
+            return Missing;
+
+        if (size)
+            *size = it->second;
+
+        return Exists;
+    }
+
+    void DirectoryIndex::invalidate()
+    {
+        std::lock_guard<decltype(mMutex)> lock(mMutex);
+        dropDirectory(std::string(), true);
+    }
+
+    const DirectoryIndex::Directory& DirectoryIndex::directory(const std::string& path)
+    {
+        auto it = mDirectories.find(path);
+        if (it != mDirectories.end())
+            return it->second;
+
+        // Subdirectories are only listed if the parent directory has them, so that lookups in missing
+        // directories are answered without touching the file system.
+        Directory dir;
+        if (path.empty())
+            listDirectory(path, dir);
+        else {
+            size_t slash = path.rfind('/');
+            const Directory& parent = directory(slash == std::string::npos ? std::string() : path.substr(0, slash));
+            std::string name = (slash == std::string::npos ? path : path.substr(slash + 1));
+            if (parent.exists && parent.subdirectories.find(name) != parent.subdirectories.end())
+                listDirectory(path, dir);
+        }
+
+        return mDirectories.emplace(path, std::move(dir)).first->second;
+    }
+
+    void DirectoryIndex::listDirectory(const std::string& path, Directory& dir)
+    {
+        std::string fullPath = (path.empty() ? mBasePath : mBasePath + '/' + path);
+
+        // The watch is added before the directory is read, so that no change can slip in between.
+      #ifdef B3D_USE_INOTIFY
+        if (mNotifyHandle >= 0) {
+            const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE
+                | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+            dir.watch = inotify_add_watch(mNotifyHandle, fullPath.c_str(), mask);
+            if (dir.watch >= 0)
+                mWatches[dir.watch] = path;
+        }
+      #endif
+
+        DIR* handle = opendir(fullPath.c_str());
+        if (!handle)
+            return;
+
+        int fd = dirfd(handle);
+        while (dirent* entry = readdir(handle)) {
+            if (entry->d_name[0] == '.' && (!entry->d_name[1] || (entry->d_name[1] == '.' && !entry->d_name[2])))
+                continue;
+
+            struct stat st;
+            if (fstatat(fd, entry->d_name, &st, 0) < 0)
+                continue;
+
+            if (S_ISDIR(st.st_mode))
+                dir.subdirectories.insert(entry->d_name);
+            else if (S_ISREG(st.st_mode))
+                dir.files[entry->d_name] = uint64_t(st.st_size);
+        }
+
+        closedir(handle);
+        dir.exists = true;
+    }
+
+    void DirectoryIndex::pollChanges()
+    {
+      #ifdef B3D_USE_INOTIFY
+        if (mNotifyHandle < 0)
+            return;
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - mLastPollTime < POLL_INTERVAL)
+            return;
+        mLastPollTime = now;
+
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t bytesRead = read(mNotifyHandle, buffer, sizeof(buffer));
+            if (bytesRead <= 0)
+                break;
+
+            for (const char* p = buffer; p < buffer + bytesRead; ) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    dropDirectory(std::string(), true);
+                    continue;
+                }
+
+                auto it = mWatches.find(event->wd);
+                if (it == mWatches.end())
+                    continue;
+
+                std::string path = it->second;
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+                    dropDirectory(path, true);
+                else {
+                    dropDirectory(path, false);
+                    if (event->len > 0)
+                        dropDirectory(joinPath(path, event->name), true);
+                }
+            }
+        }
+      #endif
+    }
+
+    void DirectoryIndex::dropDirectory(const std::string& path, bool recursive)
+    {
+        for (auto it = mDirectories.begin(); it != mDirectories.end(); ) {
+            const std::string& key = it->first;
+            bool match = (key == path);
+            if (!match && recursive) {
+                match = path.empty() || (key.length() > path.length() && key[path.length()] == '/'
+                    && key.compare(0, path.length(), path) == 0);
+            }
+
+            if (!match) {
+                ++it;
+                continue;
+            }
+
+          #ifdef B3D_USE_INOTIFY
+            if (it->second.watch >= 0) {
+                inotify_rm_watch(mNotifyHandle, it->second.watch);
+                mWatches.erase(it->second.watch);
+            }
+          #endif
+
+            it = mDirectories.erase(it);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <mutex>
+
+namespace B3D
+{
+    // Lazily built index of the files below a directory, answering existence and size queries from memory.
+    // Each directory is listed on first access; names that are not in the listing are known to be missing.
+    // On Linux cached directories are watched with inotify and dropped from the index when they change.
+    class DirectoryIndex
+    {
+    public:
+        enum Result
+        {
+            Missing,
+            Exists,
+            Unknown,    // The name can't be resolved through the index; the caller should ask the OS.
+        };
+
+        explicit DirectoryIndex(const std::string& basePath);
+        ~DirectoryIndex();
+
+        Result lookup(const std::string& name, uint64_t* size = nullptr);
+
+        void invalidate();
+
+    private:
+        struct Directory
+        {
+            bool exists = false;
+            int watch = -1;
+            std::unordered_map<std::string, uint64_t> files;
+            std::unordered_set<std::string> subdirectories;
+        };
+
+        std::string mBasePath;
+        std::mutex mMutex;
+        std::unordered_map<std::string, Directory> mDirectories;
+        std::unordered_map<int, std::string> mWatches;
+        std::chrono::steady_clock::time_point mLastPollTime;
+        int mNotifyHandle;
+
+        const Directory& directory(const std::string& path);
+        void listDirectory(const std::string& path, Directory& directory);
+        void pollChanges();
+        void dropDirectory(const std::string& path, bool recursive);
+
+        B3D_DISABLE_COPY(DirectoryIndex);
+    };
+}
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "IoUringFileReader.h"
+#include "engine/core/Services.h"
+#include "engine/core/MountFileSystem.h"
+#include "engine/core/Log.h"
+#include "engine/utility/MemoryFile.h"
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#ifndef __NR_io_uring_setup
+ #define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+ #define __NR_io_uring_enter 426
+#endif
+
+namespace B3D
+{
+    static const uint64_t WAKEUP_USER_DATA = 0;
+
+    struct IoUringFileReader::Ring
+    {
+        int fd = -1;
+        int eventFd = -1;
+        void* sqRing = MAP_FAILED;
+        void* cqRing = MAP_FAILED;
+        size_t sqRingSize = 0;
+        size_t cqRingSize = 0;
+        io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        size_t sqesSize = 0;
+        unsigned* sqHead = nullptr;
+        unsigned* sqTail = nullptr;
+        unsigned* sqMask = nullptr;
+        unsigned* sqArray = nullptr;
+        unsigned sqEntries = 0;
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned* cqMask = nullptr;
+        io_uring_cqe* cqes = nullptr;
+        unsigned queuedSqes = 0;
+
+        ~Ring()
+        {
+            if (sqes != MAP_FAILED)
+                munmap(sqes, sqesSize);
+            if (cqRing != MAP_FAILED && cqRing != sqRing)
+                munmap(cqRing, cqRingSize);
+            if (sqRing != MAP_FAILED)
+                munmap(sqRing, sqRingSize);
+            if (eventFd >= 0)
+                close(eventFd);
+            if (fd >= 0)
+                close(fd);
+        }
+
+        bool init(unsigned entries)
+        {
+            io_uring_params params;
+            memset(&params, 0, sizeof(params));
+            fd = int(syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0)
+                return false;
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMmap)
+                sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED)
+                return false;
+            if (singleMmap)
+                cqRing = sqRing;
+            else {
+                cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cqRing == MAP_FAILED)
+                    return false;
+            }
+
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void* sqesPtr = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (sqesPtr == MAP_FAILED)
+                return false;
+            sqes = static_cast<io_uring_sqe*>(sqesPtr);
+
+            uint8_t* sq = static_cast<uint8_t*>(sqRing);
+            sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            sqEntries = params.sq_entries;
+
+            uint8_t* cq = static_cast<uint8_t*>(cqRing);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            eventFd = eventfd(0, EFD_CLOEXEC);
+            return eventFd >= 0;
+        }
+
+        io_uring_sqe* nextSqe()
+        {
+            unsigned tail = *sqTail + queuedSqes;
+            if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+                return nullptr;
+            unsigned index = tail & *sqMask;
+            sqArray[index] = index;
+            ++queuedSqes;
+            io_uring_sqe* sqe = &sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            return sqe;
+        }
+
+        int submitAndWait()
+        {
+            unsigned toSubmit = queuedSqes;
+            __atomic_store_n(sqTail, *sqTail + toSubmit, __ATOMIC_RELEASE);
+            queuedSqes = 0;
+            return int(syscall(__NR_io_uring_enter, fd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+        }
+
+        void armWakeup()
+        {
+            io_uring_sqe* sqe = nextSqe();
+            assert(sqe != nullptr);
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->fd = eventFd;
+            sqe->poll_events = POLLIN;
+            sqe->user_data = WAKEUP_USER_DATA;
+        }
+    };
+
+    struct IoUringFileReader::Operation
+    {
+        Request request;
+        int fd;
+        std::vector<uint8_t> buffer;
+        size_t bytesRead;
+        iovec iov;
+    };
+
+    std::shared_ptr<IoUringFileReader> IoUringFileReader::create(const std::string& basePath,
+        const FileSystemPtr& directory)
+    {
+        std::unique_ptr<Ring> ring(new Ring);
+        if (!ring->init(QUEUE_DEPTH)) {
+            B3D_LOGW("io_uring is not available: " << strerror(errno));
+            return nullptr;
+        }
+        return std::shared_ptr<IoUringFileReader>(new IoUringFileReader(std::move(ring), basePath, directory));
+    }
+
+    IoUringFileReader::IoUringFileReader(std::unique_ptr<Ring>&& ring, const std::string& basePath,
+            const FileSystemPtr& directory)
+        : mRing(std::move(ring))
+        , mBasePath(basePath)
+        , mDirectory(directory)
+        , mFallbackReader(1)
+        , mShouldExit(false)
+        , mInFlight(0)
+    {
+        mThread = std::thread(std::bind(&IoUringFileReader::thread, this));
+    }
+
+    IoUringFileReader::~IoUringFileReader()
+    {
+        mShouldExit.store(true);
+        wakeup();
+        mThread.join();
+    }
+
+    void IoUringFileReader::submit(std::vector<Request>&& requests)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto& request : requests) {
+                assert(request.callback != nullptr);
+                mPendingRequests.emplace_back(std::move(request));
+            }
+        }
+        wakeup();
+    }
+
+    bool IoUringFileReader::readsFromDirectory(const std::string& fileName) const
+    {
+        FileSystemPtr fileSystem = Services::fileSystem();
+        if (fileSystem == mDirectory)
+            return true;
+
+        auto mounts = dynamic_cast<MountFileSystem*>(fileSystem.get());
+        return mounts && mounts->resolve(fileName) == mDirectory;
+    }
+
+    void IoUringFileReader::wakeup()
+    {
+        uint64_t value = 1;
+        ssize_t result = write(mRing->eventFd, &value, sizeof(value));
+        (void)result;
+    }
+
+    void IoUringFileReader::start(Request&& request, std::vector<Request>& fallbackRequests)
+    {
+        if (!readsFromDirectory(request.fileName)) {
+            fallbackRequests.emplace_back(std::move(request));
+            return;
+        }
+
+        std::string path = mBasePath + '/' + request.fileName;
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            fallbackRequests.emplace_back(std::move(request));
+            return;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+            close(fd);
+            fallbackRequests.emplace_back(std::move(request));
+            return;
+        }
+
+        uint64_t fileSize = uint64_t(st.st_size);
+        uint64_t size = (request.offset <= fileSize ? std::min(request.size, fileSize - request.offset) : 0);
+        if (request.offset > fileSize || size > uint64_t(std::numeric_limits<size_t>::max())) {
+            B3D_LOGE("Invalid read of " << request.size << " bytes at offset " << request.offset
+                << " in file \"" << path << "\".");
+            close(fd);
+            ThreadedFileReader::complete(request, nullptr);
+            return;
+        }
+
+        Operation* operation = new Operation;
+        operation->request = std::move(request);
+        operation->fd = fd;
+        operation->buffer.resize(size_t(size));
+        operation->bytesRead = 0;
+
+        if (size == 0) {
+            finish(operation, true);
+            return;
+        }
+
+        ++mInFlight;
+        queueRead(operation);
+    }
+
+    void IoUringFileReader::queueRead(Operation* operation)
+    {
+        operation->iov.iov_base = operation->buffer.data() + operation->bytesRead;
+        operation->iov.iov_len = operation->buffer.size() - operation->bytesRead;
+
+        // The number of operations in flight never exceeds the queue depth, so there is always a free entry.
+        io_uring_sqe* sqe = mRing->nextSqe();
+        assert(sqe != nullptr);
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = operation->fd;
+        sqe->addr = uint64_t(reinterpret_cast<uintptr_t>(&operation->iov));
+        sqe->len = 1;
+        sqe->off = operation->request.offset + operation->bytesRead;
+        sqe->user_data = uint64_t(reinterpret_cast<uintptr_t>(operation));
+    }
+
+    void IoUringFileReader::finish(Operation* operation, bool success)
+    {
+        close(operation->fd);
+
+        FilePtr file;
+        if (success)
+            file = std::make_shared<MemoryFile>(operation->request.fileName, std::move(operation->buffer));
+
+        ThreadedFileReader::complete(operation->request, std::move(file));
+        delete operation;
+    }
+
+    void IoUringFileReader::thread()
+    {
+        std::vector<Request> fallbackRequests;
+        mRing->armWakeup();
+
+        for (;;) {
+            bool exiting = mShouldExit.load();
+            if (!exiting) {
+                std::deque<Request> requests;
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    // One entry is reserved for the wakeup poll.
+                    while (!mPendingRequests.empty() && mInFlight + requests.size() < QUEUE_DEPTH - 1) {
+                        requests.emplace_back(std::move(mPendingRequests.front()));
+                        mPendingRequests.pop_front();
+                    }
+                }
+
+                for (auto& request : requests)
+                    start(std::move(request), fallbackRequests);
+
+                if (!fallbackRequests.empty()) {
+                    mFallbackReader.submit(std::move(fallbackRequests));
+                    fallbackRequests.clear();
+                }
+            } else if (mInFlight == 0)
+                break;
+
+            if (mRing->submitAndWait() < 0 && errno != EINTR) {
+                B3D_LOGE("io_uring_enter failed: " << strerror(errno));
+                break;
+            }
+
+            unsigned head = *mRing->cqHead;
+            unsigned tail = __atomic_load_n(mRing->cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = mRing->cqes[head & *mRing->cqMask];
+
+                if (cqe.user_data == WAKEUP_USER_DATA) {
+                    uint64_t value;
+                    ssize_t result = read(mRing->eventFd, &value, sizeof(value));
+                    (void)result;
+                    if (!mShouldExit.load())
+                        mRing->armWakeup();
+                    continue;
+                }
+
+                Operation* operation = reinterpret_cast<Operation*>(uintptr_t(cqe.user_data));
+                if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                    queueRead(operation);
+                    continue;
+                }
+
+                if (cqe.res < 0) {
+                    B3D_LOGE("Unable to read file \"" << operation->request.fileName << "\": " << strerror(-cqe.res));
+                    --mInFlight;
+                    finish(operation, false);
+                    continue;
+                }
+
+                operation->bytesRead += size_t(cqe.res);
+                if (cqe.res == 0)
+                    operation->buffer.resize(operation->bytesRead);
+                if (cqe.res != 0 && operation->bytesRead < operation->buffer.size()) {
+                    queueRead(operation);
+                    continue;
+                }
+
+                --mInFlight;
+                finish(operation, true);
+            }
+            __atomic_store_n(mRing->cqHead, head, __ATOMIC_RELEASE);
+        }
+
+        // Requests that never reached the ring are reported as failed.
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto& request : mPendingRequests)
+            ThreadedFileReader::complete(request, nullptr);
+        mPendingRequests.clear();
+    }
+}
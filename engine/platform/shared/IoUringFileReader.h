@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/platform/shared/ThreadedFileReader.h"
+#include "engine/core/macros.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace B3D
+{
+    // Reader that keeps a batch of reads in flight at once through a Linux io_uring. Only files that
+    // Services::fileSystem() would open from `directory`, the file system serving the base path, are read through
+    // the ring; all other requests (e.g. files inside mounted archives or overridden by a later mount) are passed
+    // on to a threaded reader.
+    class IoUringFileReader : public IAsyncFileReader
+    {
+    public:
+        static const unsigned QUEUE_DEPTH = 64;
+
+        // Returns nullptr if io_uring is not supported by the running kernel.
+        static std::shared_ptr<IoUringFileReader> create(const std::string& basePath, const FileSystemPtr& directory);
+
+        ~IoUringFileReader();
+
+        void submit(std::vector<Request>&& requests) override;
+
+    private:
+        struct Ring;
+        struct Operation;
+
+        std::unique_ptr<Ring> mRing;
+        std::string mBasePath;
+        FileSystemPtr mDirectory;
+        ThreadedFileReader mFallbackReader;
+        std::mutex mMutex;
+        std::deque<Request> mPendingRequests;
+        std::thread mThread;
+        std::atomic<bool> mShouldExit;
+        size_t mInFlight;
+
+        IoUringFileReader(std::unique_ptr<Ring>&& ring, const std::string& basePath, const FileSystemPtr& directory);
+
+        bool readsFromDirectory(const std::string& fileName) const;
+        void wakeup();
+        void start(Request&& request, std::vector<Request>& fallbackRequests);
+        void queueRead(Operation* operation);
+        void finish(Operation* operation, bool success);
+        void thread();
+
+        B3D_DISABLE_COPY(IoUringFileReader);
+    };
+}
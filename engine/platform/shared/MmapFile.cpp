@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "MmapFile.h"
+#include "engine/core/Log.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+namespace B3D
+{
+    FilePtr MmapFile::open(const std::string& path, const std::string& name)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return nullptr;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+            close(fd);
+            return nullptr;
+        }
+
+        size_t size = size_t(st.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED) {
+            const char* error = strerror(errno);
+            B3D_LOGW("Unable to map file \"" << path << "\" into memory: " << error);
+            return nullptr;
+        }
+
+        // Assets are usually parsed from start to end right after they have been opened.
+        madvise(data, size, MADV_WILLNEED);
+
+        return std::shared_ptr<MmapFile>(new MmapFile(reinterpret_cast<const uint8_t*>(data), size, name));
+    }
+
+    MmapFile::MmapFile(const uint8_t* data, size_t size, const std::string& path)
+        : mData(data)
+        , mSize(size)
+        , mPosition(0)
+        , mPath(path)
+    {
+    }
+
+    MmapFile::~MmapFile()
+    {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+
+    const std::string& MmapFile::name() const
+    {
+        return mPath;
+    }
+
+    uint64_t MmapFile::size()
+    {
+        return uint64_t(mSize);
+    }
+
+    uint64_t MmapFile::position()
+    {
+        return uint64_t(mPosition);
+    }
+
+    bool MmapFile::seek(uint64_t pos)
+    {
+        if (pos > uint64_t(mSize)) {
+            B3D_LOGE("Seek failed in file \"" << mPath << "\": offset is beyond the end of file.");
+            return false;
+        }
+        mPosition = size_t(pos);
+        return true;
+    }
+
+    size_t MmapFile::read(void* buffer, size_t bytes)
+    {
+        size_t bytesRead = std::min(bytes, mSize - mPosition);
+        memcpy(buffer, mData + mPosition, bytesRead);
+        mPosition += bytesRead;
+        return bytesRead;
+    }
+
+    const uint8_t* MmapFile::mappedData()
+    {
+        return mData;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/io/IFile.h"
+
+namespace B3D
+{
+    class MmapFile : public IFile
+    {
+    public:
+        // Returns nullptr if the file can't be mapped (e.g. it is empty or is not a regular file).
+        static FilePtr open(const std::string& path, const std::string& name);
+
+        ~MmapFile();
+
+        const std::string& name() const override;
+
+        uint64_t size() override;
+
+        uint64_t position() override;
+        bool seek(uint64_t pos) override;
+
+        size_t read(void* buffer, size_t bytes) override;
+
+        const uint8_t* mappedData() override;
+
+    private:
+        const uint8_t* mData;
+        size_t mSize;
+        size_t mPosition;
+        std::string mPath;
+
+        MmapFile(const uint8_t* data, size_t size, const std::string& path);
+
+        B3D_DISABLE_COPY(MmapFile);
+    };
+}
@@ -21,7 +21,14 @@
  */
 #include "StdIoFileSystem.h"
 #include "StdIoFile.h"
+#if defined(B3D_PLATFORM_LINUX) || defined(B3D_PLATFORM_OSX)
+#include "MmapFile.h"
+#include "DirectoryIndex.h"
+#define B3D_USE_MMAP
+#define B3D_USE_DIRECTORY_INDEX
+#endif
 #include "engine/core/Log.h"
+#include "engine/utility/BufferedFile.h"
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -29,9 +36,16 @@
 
 namespace B3D
 {
-    StdIoFileSystem::StdIoFileSystem(const std::string& basePath)
+    StdIoFileSystem::StdIoFileSystem(const std::string& basePath, bool useIndex)
         : mBasePath(basePath)
+        , mReadAheadSize(BufferedFile::DEFAULT_BUFFER_SIZE)
     {
+      #ifdef B3D_USE_DIRECTORY_INDEX
+        if (useIndex)
+            mIndex.reset(new DirectoryIndex(basePath));
+      #else
+        (void)useIndex;
+      #endif
     }
 
     StdIoFileSystem::~StdIoFileSystem()
@@ -40,6 +54,14 @@ namespace B3D
 
     bool StdIoFileSystem::fileExists(const std::string& name)
     {
+      #ifdef B3D_USE_DIRECTORY_INDEX
+        if (mIndex) {
+            DirectoryIndex::Result result = mIndex->lookup(name);
+            if (result != DirectoryIndex::Unknown)
+                return result == DirectoryIndex::Exists;
+        }
+      #endif
+
         std::string path = mBasePath + '/' + name;
 
         FILE* file = fopen(path.c_str(), "rb");
@@ -55,6 +77,27 @@ namespace B3D
     {
         std::string path = mBasePath + '/' + name;
 
+      #ifdef B3D_USE_DIRECTORY_INDEX
+        // The index may lag behind the disk and is never refreshed where there is no inotify, so a file it
+        // believes to be missing is looked for once more; if it is there after all, the index starts over.
+        if (mIndex && mIndex->lookup(name) == DirectoryIndex::Missing) {
+            FILE* file = fopen(path.c_str(), "rb");
+            if (!file) {
+                const char* error = strerror(errno);
+                B3D_LOGE("Unable to open file \"" << path << "\": " << error);
+                return nullptr;
+            }
+            fclose(file);
+            mIndex->invalidate();
+        }
+      #endif
+
+      #ifdef B3D_USE_MMAP
+        FilePtr mappedFile = MmapFile::open(path, name);
+        if (mappedFile)
+            return mappedFile;
+      #endif
+
         FILE* file = fopen(path.c_str(), "rb");
         if (!file) {
             const char* error = strerror(errno);
@@ -62,6 +105,11 @@ namespace B3D
             return nullptr;
         }
 
-        return std::make_shared<StdIoFile>(file, name);
+        if (mReadAheadSize == 0)
+            return std::make_shared<StdIoFile>(file, name);
+
+        // The read-ahead buffer replaces the stdio one.
+        setvbuf(file, nullptr, _IONBF, 0);
+        return std::make_shared<BufferedFile>(std::make_shared<StdIoFile>(file, name), mReadAheadSize);
     }
 }
@@ -23,20 +23,32 @@
 #pragma once
 #include "engine/interfaces/io/IFileSystem.h"
 #include "engine/core/macros.h"
+#include <memory>
 
 namespace B3D
 {
+    class DirectoryIndex;
+
     class StdIoFileSystem : public IFileSystem
     {
     public:
-        explicit StdIoFileSystem(const std::string& basePath);
+        // With an index, existence checks are answered from an in-memory directory listing instead of a probe of
+        // the file system. Only available on POSIX platforms.
+        explicit StdIoFileSystem(const std::string& basePath, bool useIndex = false);
         ~StdIoFileSystem();
 
+        // Files that are not memory mapped are read through a buffer of the given size; zero disables buffering.
+        void setReadAheadSize(size_t bytes) { mReadAheadSize = bytes; }
+
         bool fileExists(const std::string& name) override;
         FilePtr openFile(const std::string& name) override;
 
     private:
         std::string mBasePath;
+      #if defined(B3D_PLATFORM_LINUX) || defined(B3D_PLATFORM_OSX)
+        std::unique_ptr<DirectoryIndex> mIndex;
+      #endif
+        size_t mReadAheadSize;
 
         B3D_DISABLE_COPY(StdIoFileSystem);
     };
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "ThreadedFileReader.h"
+#include "engine/core/Services.h"
+#include "engine/core/Log.h"
+#include "engine/utility/MemoryFile.h"
+#include <algorithm>
+#include <limits>
+#include <cassert>
+
+namespace B3D
+{
+    static const size_t PAGE_SIZE_HINT = 4096;
+
+    ThreadedFileReader::ThreadedFileReader(size_t threadCount)
+        : mThreadPool(threadCount)
+    {
+    }
+
+    ThreadedFileReader::~ThreadedFileReader()
+    {
+    }
+
+    void ThreadedFileReader::submit(std::vector<Request>&& requests)
+    {
+        for (auto& request : requests) {
+            assert(request.callback != nullptr);
+            auto sharedRequest = std::make_shared<Request>(std::move(request));
+            mThreadPool.perform(sharedRequest->priority, [sharedRequest]() {
+                FileSystemPtr fileSystem = Services::fileSystem();
+                complete(*sharedRequest, fileSystem ? readFile(fileSystem.get(), *sharedRequest) : nullptr);
+            });
+        }
+    }
+
+    FilePtr ThreadedFileReader::readFile(IFileSystem* fileSystem, const Request& request)
+    {
+        FilePtr file = fileSystem->openFile(request.fileName);
+        if (!file)
+            return nullptr;
+
+        uint64_t fileSize = file->size();
+        if (request.offset > fileSize) {
+            B3D_LOGE("Read offset " << request.offset << " is past the end of file \"" << file->name() << "\".");
+            return nullptr;
+        }
+
+        uint64_t size = std::min(request.size, fileSize - request.offset);
+        if (size > uint64_t(std::numeric_limits<size_t>::max())) {
+            B3D_LOGE("File \"" << file->name() << "\" is too large.");
+            return nullptr;
+        }
+
+        const uint8_t* mapped = file->mappedData();
+        if (mapped) {
+            // Fault the pages in here so that the consumer doesn't block on the disk.
+            const volatile uint8_t* p = mapped + request.offset;
+            for (size_t i = 0; i < size_t(size); i += PAGE_SIZE_HINT)
+                (void)p[i];
+            if (request.offset == 0 && size == fileSize)
+                return file;
+            return std::make_shared<MemoryFile>(file->name(), mapped + request.offset, size_t(size), file);
+        }
+
+        std::vector<uint8_t> buffer(static_cast<size_t>(size));
+        if (request.offset != 0 && !file->seek(request.offset))
+            return nullptr;
+        if (size != 0 && file->read(buffer.data(), buffer.size()) != buffer.size())
+            return nullptr;
+
+        return std::make_shared<MemoryFile>(file->name(), std::move(buffer));
+    }
+
+    void ThreadedFileReader::complete(Request& request, FilePtr&& file)
+    {
+        const auto& threadManager = Services::threadManager();
+        if (request.invokeOnIoThread || !threadManager) {
+            request.callback(file);
+            return;
+        }
+
+        auto callback = std::move(request.callback);
+        threadManager->performInBackgroundThread(request.priority, [callback, file]() {
+            callback(file);
+        });
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/interfaces/io/IAsyncFileReader.h"
+#include "engine/interfaces/io/IFileSystem.h"
+#include "engine/utility/ThreadPool.h"
+#include "engine/core/macros.h"
+
+namespace B3D
+{
+    // Portable reader that performs blocking reads on a small dedicated pool of I/O threads. Files are opened
+    // through Services::fileSystem(), like the synchronous loaders do.
+    class ThreadedFileReader : public IAsyncFileReader
+    {
+    public:
+        static const size_t DEFAULT_THREAD_COUNT = 4;
+
+        explicit ThreadedFileReader(size_t threadCount = DEFAULT_THREAD_COUNT);
+        ~ThreadedFileReader();
+
+        void submit(std::vector<Request>&& requests) override;
+
+        static FilePtr readFile(IFileSystem* fileSystem, const Request& request);
+        static void complete(Request& request, FilePtr&& file);
+
+    private:
+        ThreadPool mThreadPool;
+
+        B3D_DISABLE_COPY(ThreadedFileReader);
+    };
+}
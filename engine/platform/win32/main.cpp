@@ -25,6 +25,7 @@
 #include "engine/interfaces/core/IApplication.h"
 #include "engine/interfaces/io/IFileSystem.h"
 #include "engine/platform/shared/StdIoFileSystem.h"
+#include "engine/platform/shared/ThreadedFileReader.h"
 #include "engine/platform/shared/CxxThreadManager.h"
 #include "engine/platform/shared/GlfwWrapper.h"
 #include "engine/render/gles2/opengl.h"
@@ -51,7 +52,9 @@ static int win32Main()
 
     auto threadManager = std::make_shared<CxxThreadManager>();
     Services::setThreadManager(threadManager);
-    Services::setFileSystem(std::make_shared<StdIoFileSystem>("."));
+    auto fileSystem = std::make_shared<StdIoFileSystem>(".");
+    Services::setFileSystem(fileSystem);
+    Services::setAsyncFileReader(std::make_shared<ThreadedFileReader>());
 
     auto inputManager = std::make_shared<InputManager>();
     inputManager->setHasKeyboard(true);
@@ -81,9 +84,12 @@ static int win32Main()
         }
     }
 
+    Services::setAsyncFileReader(nullptr);
+
     threadManager->stopWorkerThreads();
 
     threadManager.reset();
+    fileSystem.reset();
     inputManager.reset();
     Services::setInputManager(nullptr);
     Services::setFileSystem(nullptr);
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "AtlasTexture.h"
+#include "engine/core/Services.h"
+
+namespace B3D
+{
+    AtlasTexture::AtlasTexture(const TextureAtlasPtr& atlas, bool generateMipmaps, DownsampleFilter filter,
+            bool gammaCorrect)
+        : mAtlas(atlas)
+        , mSize(0.0f)
+        , mMipmapFilter(filter)
+        , mGenerateMipmaps(generateMipmaps)
+        , mGammaCorrectMipmaps(gammaCorrect)
+    {
+    }
+
+    AtlasTexture::~AtlasTexture()
+    {
+    }
+
+    PixelFormat AtlasTexture::pixelFormat() const
+    {
+        if (mRegion)
+            return PixelFormat::RGBA32;
+        return (mTexture ? mTexture->pixelFormat() : PixelFormat::Invalid);
+    }
+
+    size_t AtlasTexture::mipLevelCount() const
+    {
+        if (mRegion)
+            return 1;
+        return (mTexture ? mTexture->mipLevelCount() : 0);
+    }
+
+    void AtlasTexture::upload(const IImage& image)
+    {
+        mRegion.reset();
+        mSize = glm::vec2(float(image.width()), float(image.height()));
+
+        if (mAtlas && mAtlas->canPack(image)) {
+            mRegion = mAtlas->pack(image);
+            if (mRegion) {
+                // A copy made for shaders would be stale now
+                if (mTexture)
+                    uploadStandalone(image);
+                return;
+            }
+        }
+
+        uploadStandalone(image);
+    }
+
+    void AtlasTexture::uploadRegion(size_t x, size_t y, const IImage& image)
+    {
+        // Partial updates go to the standalone copy, which then becomes the only one
+        samplerTexture();
+        mRegion.reset();
+        mTexture->uploadRegion(x, y, image);
+    }
+
+    TexturePtr AtlasTexture::atlasPage(glm::vec2& offset, glm::vec2& scale) const
+    {
+        if (!mRegion)
+            return nullptr;
+        return mAtlas->pageTexture(*mRegion, offset, scale);
+    }
+
+    ITexture* AtlasTexture::samplerTexture()
+    {
+        if (!mTexture) {
+            mTexture = Services::rendererResourceFactory()->createTexture();
+            if (mRegion)
+                uploadStandalone(*mAtlas->extract(*mRegion));
+        }
+        return mTexture->samplerTexture();
+    }
+
+    void AtlasTexture::uploadStandalone(const IImage& image)
+    {
+        if (!mTexture)
+            mTexture = Services::rendererResourceFactory()->createTexture();
+
+        // Images that fit into a page are loaded without mipmaps. They are small, so building the chain here when
+        // the image ends up in a texture of its own is cheap.
+        if (mGenerateMipmaps && (image.width() > 1 || image.height() > 1) && mAtlas && mAtlas->canPack(image)) {
+            Image copy(image.pixelFormat(), image.width(), image.height());
+            copy.setData(image.data(), image.dataSize());
+            if (copy.generateMipmaps(mMipmapFilter, mGammaCorrectMipmaps)) {
+                mTexture->upload(copy);
+                return;
+            }
+        }
+
+        mTexture->upload(image);
+    }
+}
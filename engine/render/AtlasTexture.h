@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/render/TextureAtlas.h"
+#include "engine/interfaces/render/lowlevel/ITexture.h"
+
+namespace B3D
+{
+    // Texture that lives in a texture atlas page when its image fits, and in a texture of its own otherwise.
+    // Binding a packed texture for a shader (which cannot remap texture coordinates) gives it a standalone copy.
+    class AtlasTexture : public ITexture
+    {
+    public:
+        // Images that fit into a page are expected without mipmaps. With `generateMipmaps`, a texture that ends up
+        // standalone (because packing failed or a shader needs it) gets a chain built with the given filter.
+        explicit AtlasTexture(const TextureAtlasPtr& atlas, bool generateMipmaps = false,
+            DownsampleFilter filter = DownsampleFilter::Box, bool gammaCorrect = false);
+        ~AtlasTexture();
+
+        bool isPacked() const { return mRegion != nullptr; }
+
+        const glm::vec2& size() const override { return mSize; }
+        PixelFormat pixelFormat() const override;
+        size_t mipLevelCount() const override;
+
+        void upload(const IImage& image) override;
+        void uploadRegion(size_t x, size_t y, const IImage& image) override;
+
+        TexturePtr atlasPage(glm::vec2& offset, glm::vec2& scale) const override;
+        ITexture* samplerTexture() override;
+
+    private:
+        TextureAtlasPtr mAtlas;
+        std::shared_ptr<TextureAtlas::Region> mRegion;
+        TexturePtr mTexture;
+        glm::vec2 mSize;
+        DownsampleFilter mMipmapFilter;
+        bool mGenerateMipmaps;
+        bool mGammaCorrectMipmaps;
+
+        void uploadStandalone(const IImage& image);
+
+        B3D_DISABLE_COPY(AtlasTexture);
+    };
+}
@@ -21,6 +21,7 @@
  */
 #include "Canvas.h"
 #include "engine/math/Quad.h"
+#include <algorithm>
 
 namespace B3D
 {
@@ -63,23 +64,59 @@ namespace B3D
     {
         if (!texture)
             return;
-        setTexture(texture);
+
+        // Textures packed into an atlas are drawn from their page, so that consecutive quads share one texture
+        glm::vec2 offset(0.0f), scale(1.0f);
+        TexturePtr page = texture->atlasPage(offset, scale);
+        setTexture(page ? page : texture);
+        reserveVertices(4);
 
         begin(PrimitiveType::Triangles);
             color(glm::vec4(1.0f));
 
             // Triangle #1
-            texCoord(tc.topLeft); vertex(quad.topLeft + PIXEL_PERFECTNESS_OFFSET, z);
-            texCoord(tc.topRight); auto i2 = vertex(quad.topRight + PIXEL_PERFECTNESS_OFFSET, z);
-            texCoord(tc.bottomLeft); auto i3 = vertex(quad.bottomLeft + PIXEL_PERFECTNESS_OFFSET, z);
+            texCoord(offset + tc.topLeft * scale); vertex(quad.topLeft + PIXEL_PERFECTNESS_OFFSET, z);
+            texCoord(offset + tc.topRight * scale); auto i2 = vertex(quad.topRight + PIXEL_PERFECTNESS_OFFSET, z);
+            texCoord(offset + tc.bottomLeft * scale); auto i3 = vertex(quad.bottomLeft + PIXEL_PERFECTNESS_OFFSET, z);
 
             // Triangle #2
             index(i3);
             index(i2);
-            texCoord(tc.bottomRight); vertex(quad.bottomRight + PIXEL_PERFECTNESS_OFFSET, z);
+            texCoord(offset + tc.bottomRight * scale); vertex(quad.bottomRight + PIXEL_PERFECTNESS_OFFSET, z);
         end();
     }
 
+    void Canvas::drawText(const glm::vec2& position, const FontPtr& font, const std::string& text,
+        const glm::vec4& colorVal, float z)
+    {
+        if (!font || text.empty())
+            return;
+
+        TextLayoutPtr layout = font->layoutText(text);
+        if (!layout || layout->glyphs.empty())
+            return;
+
+        setTexture(layout->texture);
+
+        const size_t maxGlyphsPerBatch = (MAX_INDEX + 1) / 4;
+        const size_t glyphCount = layout->glyphs.size();
+        glm::vec2 origin = position + PIXEL_PERFECTNESS_OFFSET;
+        glm::vec4 offset(origin, origin);
+
+        for (size_t first = 0; first < glyphCount; first += maxGlyphsPerBatch) {
+            size_t last = std::min(first + maxGlyphsPerBatch, glyphCount);
+            reserveVertices((last - first) * 4);
+
+            begin(PrimitiveType::Triangles);
+                color(colorVal);
+                for (size_t i = first; i < last; i++) {
+                    const auto& glyph = layout->glyphs[i];
+                    rectangle(glyph.rect + offset, glyph.texCoords, z);
+                }
+            end();
+        }
+    }
+
     void Canvas::drawWireframeBoundingBox(const BoundingBox& box, const glm::vec4& colorVal)
     {
         const auto& mn = box.min;
@@ -38,6 +38,9 @@ namespace B3D
         void drawWireframeQuad(const Quad& quad, float z = 0.0f, const glm::vec4& colorVal = glm::vec4(1.0f)) override;
         void drawTexturedQuad(const Quad& quad, const Quad& tc, const TexturePtr& texture, float z = 0.0f) override;
 
+        void drawText(const glm::vec2& position, const FontPtr& font, const std::string& text,
+            const glm::vec4& color = glm::vec4(1.0f), float z = 0.0f) override;
+
         void drawWireframeBoundingBox(const BoundingBox& box, const glm::vec4& colorVal = glm::vec4(1.0f)) override;
 
     private:
@@ -410,6 +410,36 @@ namespace B3D
         mIndexData.emplace_back(uint16_t(index));
     }
 
+    void ImmediateModeRenderer::rectangle(const glm::vec4& rect, const glm::vec4& texCoords, float z)
+    {
+        assert(mInBeginEnd);
+        assert(!mInDirectRendering);
+        assert(mPrimitiveType == PrimitiveType::Triangles);
+
+        size_t first = mVertexData.size();
+        assert(first + 3 <= MAX_INDEX);
+
+        Vertex vertex = mCurrentVertex;
+        vertex.position = glm::vec3(rect.x, rect.y, z);
+        vertex.texCoord = glm::vec2(texCoords.x, texCoords.y);
+        mVertexData.emplace_back(vertex);
+        vertex.position.x = rect.z;
+        vertex.texCoord.x = texCoords.z;
+        mVertexData.emplace_back(vertex);
+        vertex.position.y = rect.w;
+        vertex.texCoord.y = texCoords.w;
+        mVertexData.emplace_back(vertex);
+        vertex.position.x = rect.x;
+        vertex.texCoord.x = texCoords.x;
+        mVertexData.emplace_back(vertex);
+
+        const uint16_t indices[] = { 0, 1, 3, 3, 1, 2 };
+        for (uint16_t index : indices)
+            mIndexData.emplace_back(uint16_t(first + index));
+
+        mCurrentVertex = vertex;
+    }
+
     void ImmediateModeRenderer::end()
     {
         assert(mInBeginEnd);
@@ -456,6 +486,16 @@ namespace B3D
         }
     }
 
+    void ImmediateModeRenderer::reserveVertices(size_t count)
+    {
+        assert(!mInBeginEnd);
+        assert(!mInDirectRendering);
+        assert(count <= MAX_INDEX + 1);
+
+        if (mVertexData.size() + count > MAX_INDEX + 1)
+            flush(GeometryOnly);
+    }
+
     void ImmediateModeRenderer::setPrimitiveType(PrimitiveType primitive)
     {
         assert(!mInBeginEnd);
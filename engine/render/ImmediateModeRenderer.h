@@ -91,8 +91,17 @@ namespace B3D
         void index(size_t index) override;
         void end() override;
 
+        // Emits an axis-aligned rectangle, given as (left, top, right, bottom), as two triangles with the current
+        // color. Faster than individual vertices for runs of many quads; must be called between
+        // begin(PrimitiveType::Triangles) and end().
+        void rectangle(const glm::vec4& rect, const glm::vec4& texCoords, float z);
+
         void flush(bool geometryOnly);
 
+        // Flushes the batch if the given number of vertices would not fit into it. Must be called outside of
+        // begin() / end().
+        void reserveVertices(size_t count);
+
     private:
         B3D_VERTEX_FORMAT(Vertex,
             (glm::vec3) position,
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TextureAtlas.h"
+#include "engine/core/Services.h"
+#include "engine/image/PixelConversion.h"
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace B3D
+{
+    namespace
+    {
+        const size_t BYTES_PER_PIXEL = 4;
+
+        uint8_t* pixelAt(Image& image, size_t x, size_t y)
+        {
+            return image.data() + (y * image.width() + x) * BYTES_PER_PIXEL;
+        }
+
+        std::unique_ptr<Image> createPixels(size_t size)
+        {
+            std::unique_ptr<Image> pixels(new Image(PixelFormat::RGBA32, size, size));
+            pixels->setDataSize(size * size * BYTES_PER_PIXEL);
+            memset(pixels->data(), 0, pixels->dataSize());
+            return pixels;
+        }
+
+        void copyRect(Image& src, size_t srcX, size_t srcY, Image& dst, size_t dstX, size_t dstY,
+            size_t width, size_t height)
+        {
+            for (size_t row = 0; row < height; row++)
+                memcpy(pixelAt(dst, dstX, dstY + row), pixelAt(src, srcX, srcY + row), width * BYTES_PER_PIXEL);
+        }
+
+        // Textures can only be updated from tightly packed images, so the rectangle is copied out of the page first.
+        void uploadRect(ITexture& texture, Image& pixels, size_t x, size_t y, size_t width, size_t height)
+        {
+            Image rect(PixelFormat::RGBA32, width, height);
+            rect.setDataSize(width * height * BYTES_PER_PIXEL);
+            copyRect(pixels, x, y, rect, 0, 0, width, height);
+            texture.uploadRegion(x, y, rect);
+        }
+    }
+
+    TextureAtlas::TextureAtlas(size_t maxImageSize, size_t maxPageSize, size_t maxPageCount)
+        : mMaxImageSize(std::min(maxImageSize, maxPageSize > 2 * PADDING ? maxPageSize - 2 * PADDING : 0))
+        , mMaxPageSize(maxPageSize)
+        , mMaxPageCount(maxPageCount)
+        , mCompactions(0)
+        , mFailures(0)
+    {
+    }
+
+    TextureAtlas::~TextureAtlas()
+    {
+    }
+
+    bool TextureAtlas::canPack(const IImage& image) const
+    {
+        PixelFormat format = image.pixelFormat();
+        if (format == PixelFormat::Invalid || isCompressed(format) || !PixelConversion::canConvert(format,
+                PixelFormat::RGBA32))
+            return false;
+
+        size_t width = image.width(), height = image.height();
+        return image.mipLevelCount() <= 1 && width > 0 && height > 0
+            && width <= mMaxImageSize && height <= mMaxImageSize
+            && image.data() && image.dataSize() >= width * height * bytesPerPixel(format);
+    }
+
+    std::shared_ptr<TextureAtlas::Region> TextureAtlas::pack(const IImage& image)
+    {
+        if (!canPack(image))
+            return nullptr;
+
+        size_t width = image.width() + 2 * PADDING;
+        size_t height = image.height() + 2 * PADDING;
+        size_t x = 0, y = 0;
+
+        // Free space in the existing pages is used first, then the pages are grown, then a new page is created.
+        for (size_t i = 0; i < mPages.size(); i++) {
+            if (mPages[i].texture && mPages[i].packer.insert(width, height, x, y))
+                return place(i, x, y, image);
+        }
+
+        for (size_t i = 0; i < mPages.size(); i++) {
+            while (mPages[i].texture && growPage(mPages[i])) {
+                if (mPages[i].packer.insert(width, height, x, y))
+                    return place(i, x, y, image);
+            }
+        }
+
+        size_t index;
+        if (createPage(index)) {
+            do {
+                if (mPages[index].packer.insert(width, height, x, y))
+                    return place(index, x, y, image);
+            } while (growPage(mPages[index]));
+        }
+
+        // As a last resort, space left by released images is reclaimed, starting with the page that gains the most.
+        std::vector<std::pair<size_t, size_t>> candidates;
+        for (size_t i = 0; i < mPages.size(); i++) {
+            size_t reclaimable = (mPages[i].texture ? reclaimablePixels(mPages[i]) : 0);
+            if (reclaimable >= width * height)
+                candidates.emplace_back(reclaimable, i);
+        }
+        std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<size_t, size_t>>());
+
+        for (const auto& candidate : candidates) {
+            Page& page = mPages[candidate.second];
+            if (!compactPage(page))
+                continue;
+
+            if (page.texture) {
+                if (page.packer.insert(width, height, x, y))
+                    return place(candidate.second, x, y, image);
+            } else if (createPage(index)) {
+                do {
+                    if (mPages[index].packer.insert(width, height, x, y))
+                        return place(index, x, y, image);
+                } while (growPage(mPages[index]));
+            }
+        }
+
+        ++mFailures;
+        return nullptr;
+    }
+
+    TexturePtr TextureAtlas::pageTexture(const Region& region, glm::vec2& offset, glm::vec2& scale) const
+    {
+        assert(region.page < mPages.size());
+        const Page& page = mPages[region.page];
+
+        glm::vec2 size(float(page.packer.width()), float(page.packer.height()));
+        offset = glm::vec2(float(region.x), float(region.y)) / size;
+        scale = glm::vec2(float(region.width), float(region.height)) / size;
+
+        return page.texture;
+    }
+
+    ImagePtr TextureAtlas::extract(const Region& region) const
+    {
+        assert(region.page < mPages.size());
+        const Page& page = mPages[region.page];
+
+        auto image = std::make_shared<Image>(PixelFormat::RGBA32, region.width, region.height);
+        image->setDataSize(region.width * region.height * BYTES_PER_PIXEL);
+        copyRect(*page.pixels, region.x, region.y, *image, 0, 0, region.width, region.height);
+
+        return image;
+    }
+
+    TextureAtlas::Stats TextureAtlas::stats() const
+    {
+        Stats stats;
+        stats.pageCount = 0;
+        stats.regionCount = 0;
+        stats.usedPixels = 0;
+        stats.totalPixels = 0;
+        stats.compactions = mCompactions;
+        stats.failures = mFailures;
+
+        for (const auto& page : mPages) {
+            if (!page.texture)
+                continue;
+
+            ++stats.pageCount;
+            stats.totalPixels += page.packer.width() * page.packer.height();
+            for (const auto& weakRegion : page.regions) {
+                auto region = weakRegion.lock();
+                if (region) {
+                    ++stats.regionCount;
+                    stats.usedPixels += (region->width + 2 * PADDING) * (region->height + 2 * PADDING);
+                }
+            }
+        }
+
+        return stats;
+    }
+
+    std::shared_ptr<TextureAtlas::Region> TextureAtlas::place(size_t pageIndex, size_t x, size_t y,
+        const IImage& image)
+    {
+        Page& page = mPages[pageIndex];
+        Image& pixels = *page.pixels;
+
+        PixelFormat format = image.pixelFormat();
+        size_t width = image.width(), height = image.height();
+        size_t rowSize = width * bytesPerPixel(format);
+        for (size_t row = 0; row < height; row++) {
+            PixelConversion::convert(image.data() + row * rowSize, format,
+                pixelAt(pixels, x + PADDING, y + PADDING + row), PixelFormat::RGBA32, width);
+        }
+
+        // Edge pixels are repeated into the padding: columns first, then whole rows including the corners.
+        for (size_t row = 0; row < height; row++) {
+            uint8_t* first = pixelAt(pixels, x + PADDING, y + PADDING + row);
+            uint8_t* last = first + (width - 1) * BYTES_PER_PIXEL;
+            for (size_t i = 1; i <= PADDING; i++) {
+                memcpy(first - i * BYTES_PER_PIXEL, first, BYTES_PER_PIXEL);
+                memcpy(last + i * BYTES_PER_PIXEL, last, BYTES_PER_PIXEL);
+            }
+        }
+        size_t paddedWidth = width + 2 * PADDING;
+        for (size_t i = 0; i < PADDING; i++) {
+            memcpy(pixelAt(pixels, x, y + i), pixelAt(pixels, x, y + PADDING), paddedWidth * BYTES_PER_PIXEL);
+            memcpy(pixelAt(pixels, x, y + PADDING + height + i), pixelAt(pixels, x, y + PADDING + height - 1),
+                paddedWidth * BYTES_PER_PIXEL);
+        }
+
+        uploadRect(*page.texture, pixels, x, y, paddedWidth, height + 2 * PADDING);
+
+        auto region = std::make_shared<Region>();
+        region->page = pageIndex;
+        region->x = x + PADDING;
+        region->y = y + PADDING;
+        region->width = width;
+        region->height = height;
+        page.regions.emplace_back(region);
+
+        return region;
+    }
+
+    bool TextureAtlas::createPage(size_t& pageIndex)
+    {
+        pageIndex = 0;
+        while (pageIndex < mPages.size() && mPages[pageIndex].texture)
+            ++pageIndex;
+
+        if (pageIndex == mPages.size()) {
+            if (mPages.size() >= mMaxPageCount)
+                return false;
+            mPages.emplace_back();
+        }
+
+        size_t size = std::min(size_t(INITIAL_PAGE_SIZE), mMaxPageSize);
+
+        Page& page = mPages[pageIndex];
+        page.texture = Services::rendererResourceFactory()->createTexture();
+        page.pixels = createPixels(size);
+        page.packer.reset(size, size);
+        page.regions.clear();
+        page.texture->upload(*page.pixels);
+
+        return true;
+    }
+
+    bool TextureAtlas::growPage(Page& page)
+    {
+        size_t size = page.packer.width();
+        if (size >= mMaxPageSize)
+            return false;
+
+        size_t newSize = std::min(size * 2, mMaxPageSize);
+        std::unique_ptr<Image> pixels = createPixels(newSize);
+        copyRect(*page.pixels, 0, 0, *pixels, 0, 0, size, size);
+
+        page.pixels = std::move(pixels);
+        page.packer.grow(newSize, newSize);
+        page.texture->upload(*page.pixels);
+
+        return true;
+    }
+
+    bool TextureAtlas::compactPage(Page& page)
+    {
+        std::vector<std::shared_ptr<Region>> live;
+        live.reserve(page.regions.size());
+        for (const auto& weakRegion : page.regions) {
+            auto region = weakRegion.lock();
+            if (region)
+                live.emplace_back(std::move(region));
+        }
+
+        if (live.size() == page.regions.size())
+            return false;
+
+        ++mCompactions;
+
+        if (live.empty()) {
+            page.texture.reset();
+            page.pixels.reset();
+            page.packer.reset(0, 0);
+            page.regions.clear();
+            return true;
+        }
+
+        // Taller images go first, which keeps the skyline flat.
+        std::sort(live.begin(), live.end(), [](const std::shared_ptr<Region>& a, const std::shared_ptr<Region>& b) {
+            return a->height > b->height || (a->height == b->height && a->width > b->width);
+        });
+
+        size_t size = page.packer.width();
+        SkylinePacker packer(size, size);
+        std::vector<std::pair<size_t, size_t>> positions(live.size());
+        for (size_t i = 0; i < live.size(); i++) {
+            if (!packer.insert(live[i]->width + 2 * PADDING, live[i]->height + 2 * PADDING,
+                    positions[i].first, positions[i].second))
+                return false;
+        }
+
+        std::unique_ptr<Image> pixels = createPixels(size);
+        page.regions.clear();
+        for (size_t i = 0; i < live.size(); i++) {
+            Region& region = *live[i];
+            copyRect(*page.pixels, region.x - PADDING, region.y - PADDING, *pixels, positions[i].first,
+                positions[i].second, region.width + 2 * PADDING, region.height + 2 * PADDING);
+            region.x = positions[i].first + PADDING;
+            region.y = positions[i].second + PADDING;
+            page.regions.emplace_back(live[i]);
+        }
+
+        page.pixels = std::move(pixels);
+        page.packer = packer;
+        page.texture->upload(*page.pixels);
+
+        return true;
+    }
+
+    size_t TextureAtlas::reclaimablePixels(const Page& page) const
+    {
+        size_t livePixels = 0;
+        for (const auto& weakRegion : page.regions) {
+            auto region = weakRegion.lock();
+            if (region)
+                livePixels += (region->width + 2 * PADDING) * (region->height + 2 * PADDING);
+        }
+        return page.packer.usedArea() - livePixels;
+    }
+}
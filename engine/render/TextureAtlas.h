@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/image/Image.h"
+#include "engine/interfaces/render/lowlevel/ITexture.h"
+#include "engine/utility/SkylinePacker.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+
+namespace B3D
+{
+    // Packs small images into shared RGBA pages, so that the canvas can draw many of them without switching textures.
+    // Each page keeps a copy of its pixels. Full pages grow by uploading the copy into a larger texture, and space
+    // left by released images is reclaimed by packing the remaining ones again. Both move images within their page,
+    // so texture coordinates have to be looked up again whenever an image is drawn.
+    //
+    // canPack() may be called from any thread, everything else must run on the render thread.
+    class TextureAtlas
+    {
+    public:
+        // Border around each image, filled with its edge pixels so that filtering does not pick up the neighbours.
+        static const size_t PADDING = 1;
+        static const size_t INITIAL_PAGE_SIZE = 256;
+
+        // Position of the image within its page, without padding. Owned by whoever uses the image; the space is
+        // reclaimed after the region has been released.
+        struct Region
+        {
+            size_t page;
+            size_t x;
+            size_t y;
+            size_t width;
+            size_t height;
+        };
+
+        struct Stats
+        {
+            size_t pageCount;
+            size_t regionCount;
+            size_t usedPixels;          // Live regions, including padding
+            size_t totalPixels;
+            size_t compactions;
+            size_t failures;            // Images that did not fit
+        };
+
+        TextureAtlas(size_t maxImageSize, size_t maxPageSize, size_t maxPageCount);
+        ~TextureAtlas();
+
+        size_t maxImageSize() const { return mMaxImageSize; }
+
+        // Only uncompressed images without mipmaps, no larger than maxImageSize() in both dimensions, are packed.
+        bool canPack(const IImage& image) const;
+
+        // Returns null when there is no room even after reclaiming released space.
+        std::shared_ptr<Region> pack(const IImage& image);
+
+        // Returns the texture of the page, and the offset and scale that map texture coordinates of the image into it.
+        TexturePtr pageTexture(const Region& region, glm::vec2& offset, glm::vec2& scale) const;
+
+        // Copies the pixels of the region into a new RGBA32 image.
+        ImagePtr extract(const Region& region) const;
+
+        Stats stats() const;
+
+    private:
+        struct Page
+        {
+            TexturePtr texture;
+            std::unique_ptr<Image> pixels;
+            SkylinePacker packer;
+            std::vector<std::weak_ptr<Region>> regions;
+        };
+
+        std::vector<Page> mPages;
+        size_t mMaxImageSize;
+        size_t mMaxPageSize;
+        size_t mMaxPageCount;
+        size_t mCompactions;
+        size_t mFailures;
+
+        std::shared_ptr<Region> place(size_t pageIndex, size_t x, size_t y, const IImage& image);
+        bool createPage(size_t& pageIndex);
+        bool growPage(Page& page);
+        bool compactPage(Page& page);
+        size_t reclaimablePixels(const Page& page) const;
+
+        B3D_DISABLE_COPY(TextureAtlas);
+    };
+
+    using TextureAtlasPtr = std::shared_ptr<TextureAtlas>;
+}
@@ -27,22 +27,33 @@
 namespace B3D
 {
     GLES2Buffer::GLES2Buffer(size_t target)
-        : mSize(0)
+        : mHandle(0)
+        , mSize(0)
         , mTarget(target)
     {
-        GLuint handle = 0;
-        glGenBuffers(1, &handle);
-        mHandle = handle;
     }
 
     GLES2Buffer::~GLES2Buffer()
     {
+        if (!mHandle)
+            return;
+
         GLuint handle = GLuint(mHandle);
         Services::threadManager()->performInRenderThread([handle]() {
             glDeleteBuffers(1, &handle);
         });
     }
 
+    size_t GLES2Buffer::handle() const
+    {
+        if (!mHandle) {
+            GLuint handle = 0;
+            glGenBuffers(1, &handle);
+            mHandle = handle;
+        }
+        return mHandle;
+    }
+
     size_t GLES2Buffer::currentSize() const
     {
         return mSize;
@@ -50,7 +61,7 @@ namespace B3D
 
     void GLES2Buffer::initEmpty(size_t size, BufferUsage usage)
     {
-        if (!mHandle)
+        if (!handle())
             return;
         glBindBuffer(GLenum(mTarget), GLuint(mHandle));
         glBufferData(GLenum(mTarget), GLsizeiptr(size), nullptr, bufferUsageToGL(usage));
@@ -59,7 +70,7 @@ namespace B3D
 
     void GLES2Buffer::setData(const void* data, size_t size, BufferUsage usage)
     {
-        if (!mHandle)
+        if (!handle())
             return;
         glBindBuffer(GLenum(mTarget), GLuint(mHandle));
         glBufferData(GLenum(mTarget), GLsizeiptr(size), data, bufferUsageToGL(usage));
@@ -33,7 +33,8 @@ namespace B3D
         explicit GLES2Buffer(size_t target);
         ~GLES2Buffer();
 
-        size_t handle() const { return mHandle; }
+        // The GL object is created on first use, so that buffers can be constructed on any thread.
+        size_t handle() const;
 
         size_t currentSize() const override;
 
@@ -41,7 +42,7 @@ namespace B3D
         void setData(const void* data, size_t size, BufferUsage usage) override;
 
     private:
-        size_t mHandle;
+        mutable size_t mHandle;
         size_t mSize;
         size_t mTarget;
 
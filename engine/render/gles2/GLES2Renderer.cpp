@@ -34,6 +34,10 @@ namespace B3D
         : mShouldRebindUniforms(true)
         , mShouldRebindAttributes(true)
     {
+        for (size_t i = 0; i < size_t(PixelFormat::Count); i++) {
+            PixelFormat format = PixelFormat(i);
+            mSupportedPixelFormats[i] = (!isCompressed(format) || compressedPixelFormatToGL(format) != 0);
+        }
     }
 
     Renderer::~Renderer()
@@ -78,6 +82,11 @@ namespace B3D
         return std::make_shared<GLES2Texture>();
     }
 
+    bool Renderer::supportsPixelFormat(PixelFormat format) const
+    {
+        return format != PixelFormat::Invalid && mSupportedPixelFormats[size_t(format)];
+    }
+
     VertexBufferPtr Renderer::createVertexBuffer()
     {
         return std::make_shared<GLES2Buffer>(GL_ARRAY_BUFFER);
@@ -167,9 +176,9 @@ namespace B3D
         mShouldRebindUniforms = true;
     }
 
-    void Renderer::setUniform(const Atom& name, const TexturePtr& texture)
+    void Renderer::setUniform(const Atom& name, const TexturePtr& texture, const SamplerState& sampler)
     {
-        mUniforms[name].setTexture(texture);
+        mUniforms[name].setTexture(texture, sampler);
         mShouldRebindUniforms = true;
     }
 
@@ -51,6 +51,7 @@ namespace B3D
         VertexBufferPtr createVertexBuffer() override;
         IndexBufferPtr createIndexBuffer() override;
         VertexSourcePtr createVertexSource() override;
+        bool supportsPixelFormat(PixelFormat format) const override;
 
         void setCullFace(CullFace face) override;
         void setFrontFace(FrontFace face) override;
@@ -66,7 +67,7 @@ namespace B3D
         void setUniform(const Atom& name, const glm::vec3& value) override;
         void setUniform(const Atom& name, const glm::vec4& value) override;
         void setUniform(const Atom& name, const glm::mat4& value) override;
-        void setUniform(const Atom& name, const TexturePtr& texture) override;
+        void setUniform(const Atom& name, const TexturePtr& texture, const SamplerState& sampler) override;
 
         void useShader(const ShaderPtr& shader) override;
         void bindVertexSource(const VertexSourcePtr& source) override;
@@ -79,6 +80,7 @@ namespace B3D
         std::shared_ptr<GLES2VertexSource> mCurrentVertexSource;
         bool mShouldRebindUniforms;
         bool mShouldRebindAttributes;
+        bool mSupportedPixelFormats[size_t(PixelFormat::Count)];
 
         bool setupDrawCall();
         void bindUniforms();
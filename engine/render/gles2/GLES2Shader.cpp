@@ -32,18 +32,18 @@
 namespace B3D
 {
     GLES2Shader::GLES2Shader()
-        : mProgramCompiled(false)
+        : mVertexShader(0)
+        , mFragmentShader(0)
+        , mProgram(0)
+        , mProgramCompiled(false)
     {
-        mVertexShader = glCreateShader(GL_VERTEX_SHADER);
-        mFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-
-        mProgram = glCreateProgram();
-        glAttachShader(GLuint(mProgram), GLuint(mVertexShader));
-        glAttachShader(GLuint(mProgram), GLuint(mFragmentShader));
     }
 
     GLES2Shader::~GLES2Shader()
     {
+        if (!mProgram)
+            return;
+
         GLuint program = GLuint(mProgram);
         GLuint fragmentShader = GLuint(mFragmentShader);
         GLuint vertexShader = GLuint(mVertexShader);
@@ -57,12 +57,14 @@ namespace B3D
 
     void GLES2Shader::setVertexSource(const std::vector<std::string>& source)
     {
+        createObjects();
         resetToUncompiledState();
         setSource(mVertexShader, source, false);
     }
 
     void GLES2Shader::setFragmentSource(const std::vector<std::string>& source)
     {
+        createObjects();
         resetToUncompiledState();
         setSource(mFragmentShader, source, true);
     }
@@ -96,6 +98,7 @@ namespace B3D
 
     bool GLES2Shader::compile()
     {
+        createObjects();
         mProgramCompiled = true;
 
         if (!compileShader(mVertexShader, "vertex"))
@@ -264,6 +267,19 @@ namespace B3D
         }
     }
 
+    void GLES2Shader::createObjects() const
+    {
+        if (mProgram)
+            return;
+
+        mVertexShader = glCreateShader(GL_VERTEX_SHADER);
+        mFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+        mProgram = glCreateProgram();
+        glAttachShader(GLuint(mProgram), GLuint(mVertexShader));
+        glAttachShader(GLuint(mProgram), GLuint(mFragmentShader));
+    }
+
     void GLES2Shader::resetToUncompiledState()
     {
         mProgramCompiled = false;
@@ -37,7 +37,8 @@ namespace B3D
         GLES2Shader();
         ~GLES2Shader();
 
-        size_t handle() const { return mProgram; }
+        // GL objects are created on first use, so that shaders can be constructed on any thread.
+        size_t handle() const { createObjects(); return mProgram; }
 
         const UniformList& uniforms() const { return mUniforms; }
         const AttributeList& attributes() const { return mAttributes; }
@@ -50,9 +51,9 @@ namespace B3D
         bool compile() override;
 
     private:
-        size_t mVertexShader;
-        size_t mFragmentShader;
-        size_t mProgram;
+        mutable size_t mVertexShader;
+        mutable size_t mFragmentShader;
+        mutable size_t mProgram;
         UniformList mUniforms;
         AttributeList mAttributes;
         bool mProgramCompiled;
@@ -62,6 +63,7 @@ namespace B3D
         static void setSource(size_t shaderHandle, const std::vector<std::string>& source, bool fragment);
         static void formatSource(size_t shaderHandle, std::stringstream& stream);
 
+        void createObjects() const;
         void collectUniformsAndAttributes();
 
         void resetToUncompiledState();
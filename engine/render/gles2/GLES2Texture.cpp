@@ -21,76 +21,249 @@
  */
 #include "GLES2Texture.h"
 #include "engine/core/Services.h"
+#include "engine/core/Log.h"
+#include "engine/image/TextureCompression.h"
 #include "opengl.h"
+#include <algorithm>
 #include <cassert>
+#include <vector>
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
 
 namespace B3D
 {
-    GLES2Texture::GLES2Texture()
-        : mSize(0.0f)
+#ifdef GL_ES_VERSION_2_0
+    static bool isPowerOfTwo(size_t value)
     {
-        GLuint handle = 0;
-        glGenTextures(1, &handle);
-        mHandle = handle;
+        return value != 0 && (value & (value - 1)) == 0;
     }
+#endif
 
-    GLES2Texture::~GLES2Texture()
+    // Zero if anisotropic filtering is not supported. Only called on the render thread.
+    static float maxSupportedAnisotropy()
     {
-        GLuint handle = GLuint(mHandle);
-        Services::threadManager()->performInRenderThread([handle]() {
-            glDeleteTextures(1, &handle);
-        });
+        static float maxAnisotropy = -1.0f;
+        if (maxAnisotropy < 0.0f) {
+            maxAnisotropy = 0.0f;
+            if (hasGLExtension("GL_EXT_texture_filter_anisotropic"))
+                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+        }
+        return maxAnisotropy;
     }
 
-    void GLES2Texture::upload(const IImage& image)
+    // Returns false for compressed formats.
+    static bool pixelFormatToGL(PixelFormat pixelFormat, GLint& internalFormat, GLenum& format, GLenum& type)
     {
-        if (!image.data() || !mHandle)
-            return;
-
-        GLenum format = 0, type = 0;
-        GLint internalFormat = 0;
-        switch (image.pixelFormat())
+        switch (pixelFormat)
         {
-        case PixelFormat::Invalid:
-            return;
-
         case PixelFormat::Luminance8:
             type = GL_UNSIGNED_BYTE;
             format = internalFormat = GL_LUMINANCE;
-            break;
+            return true;
 
         case PixelFormat::LuminanceAlpha16:
             type = GL_UNSIGNED_BYTE;
             format = internalFormat = GL_LUMINANCE_ALPHA;
-            break;
+            return true;
 
         case PixelFormat::RGB24:
             type = GL_UNSIGNED_BYTE;
             format = internalFormat = GL_RGB;
-            break;
+            return true;
 
         case PixelFormat::RGBA32:
             type = GL_UNSIGNED_BYTE;
             format = internalFormat = GL_RGBA;
-            break;
+            return true;
+
+        case PixelFormat::RGB565:
+            type = GL_UNSIGNED_SHORT_5_6_5;
+            format = internalFormat = GL_RGB;
+            return true;
+
+        case PixelFormat::RGBA4444:
+            type = GL_UNSIGNED_SHORT_4_4_4_4;
+            format = internalFormat = GL_RGBA;
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    GLES2Texture::GLES2Texture()
+        : mHandle(0)
+        , mSize(0.0f)
+        , mPixelFormat(PixelFormat::Invalid)
+        , mLevelCount(0)
+        , mHasMipmaps(false)
+        , mCanRepeat(true)
+    {
+    }
+
+    GLES2Texture::~GLES2Texture()
+    {
+        if (!mHandle)
+            return;
+
+        GLuint handle = GLuint(mHandle);
+        Services::threadManager()->performInRenderThread([handle]() {
+            glDeleteTextures(1, &handle);
+        });
+    }
+
+    size_t GLES2Texture::handle() const
+    {
+        if (!mHandle) {
+            GLuint handle = 0;
+            glGenTextures(1, &handle);
+            mHandle = handle;
+        }
+        return mHandle;
+    }
+
+    void GLES2Texture::upload(const IImage& image)
+    {
+        if (!image.data() || !handle())
+            return;
+
+        PixelFormat pixelFormat = image.pixelFormat();
+        size_t levelCount = image.mipLevelCount();
+        for (size_t level = 0; level < levelCount; level++) {
+            const IImage& mip = image.mipLevel(level);
+            if (mip.pixelFormat() != pixelFormat || !mip.data()
+                    || mip.dataSize() < imageDataSize(pixelFormat, mip.width(), mip.height())) {
+                B3D_LOGE("Unable to upload texture: mip level " << level << " is inconsistent with the base image.");
+                return;
+            }
         }
 
-        assert(format != 0 && internalFormat != 0 && type != 0);
+        // Compressed formats the GPU cannot sample are decoded here as a last resort; the resource manager normally
+        // does that on the loading thread before the image gets here.
+        GLenum compressedFormat = 0;
+        bool decode = false;
+        if (isCompressed(pixelFormat)) {
+            compressedFormat = compressedPixelFormatToGL(pixelFormat);
+            if (compressedFormat == 0) {
+                if (!TextureCompression::canDecompress(pixelFormat)) {
+                    B3D_LOGE("Unable to upload texture: compressed pixel format is not supported by the GPU.");
+                    return;
+                }
+                decode = true;
+                pixelFormat = PixelFormat::RGBA32;
+            }
+        }
+
+        GLenum format = 0, type = 0;
+        GLint internalFormat = 0;
+        if (!pixelFormatToGL(pixelFormat, internalFormat, format, type))
+            assert(compressedFormat != 0);
 
         GLint previousTexture = 0;
         glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
         glBindTexture(GL_TEXTURE_2D, GLuint(mHandle));
 
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, GLsizei(image.width()), GLsizei(image.height()),
-            0, format, type, image.data());
+        std::vector<uint8_t> decoded;
+        for (size_t level = 0; level < levelCount; level++) {
+            const IImage& mip = image.mipLevel(level);
+            GLsizei width = GLsizei(mip.width()), height = GLsizei(mip.height());
+            if (decode) {
+                decoded.resize(mip.width() * mip.height() * 4);
+                TextureCompression::decompress(mip.data(), mip.pixelFormat(), mip.width(), mip.height(),
+                    decoded.data());
+                glTexImage2D(GL_TEXTURE_2D, GLint(level), internalFormat, width, height, 0, format, type,
+                    decoded.data());
+            } else if (compressedFormat != 0) {
+                GLsizei size = GLsizei(imageDataSize(pixelFormat, mip.width(), mip.height()));
+                glCompressedTexImage2D(GL_TEXTURE_2D, GLint(level), compressedFormat, width, height, 0, size,
+                    mip.data());
+            } else
+                glTexImage2D(GL_TEXTURE_2D, GLint(level), internalFormat, width, height, 0, format, type, mip.data());
+        }
+
+        // Mipmapped filtering requires the complete chain down to 1x1. OpenGL ES 2.0 does not support mipmaps or
+        // repeating for textures with non-power-of-two dimensions.
+        size_t fullChainLength = 1;
+        for (size_t size = std::max(image.width(), image.height()); size > 1; size /= 2)
+            ++fullChainLength;
+        mLevelCount = levelCount;
+        mHasMipmaps = levelCount >= fullChainLength;
+        mCanRepeat = true;
+      #ifdef GL_ES_VERSION_2_0
+        if (!isPowerOfTwo(image.width()) || !isPowerOfTwo(image.height())) {
+            mHasMipmaps = false;
+            mCanRepeat = false;
+        }
+      #endif
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        mSampler = SamplerState();
+        applySamplerState(mSampler);
 
         glBindTexture(GL_TEXTURE_2D, GLuint(previousTexture));
         mSize = glm::vec2(float(image.width()), float(image.height()));
+        mPixelFormat = pixelFormat;
+    }
+
+    void GLES2Texture::uploadRegion(size_t x, size_t y, const IImage& image)
+    {
+        if (!image.data() || !mHandle)
+            return;
+
+        GLenum format = 0, type = 0;
+        GLint internalFormat = 0;
+        if (image.pixelFormat() != mPixelFormat || !pixelFormatToGL(mPixelFormat, internalFormat, format, type)) {
+            B3D_LOGE("Unable to update texture: pixel format of the image does not match the texture.");
+            return;
+        }
+
+        if (x + image.width() > size_t(mSize.x) || y + image.height() > size_t(mSize.y)
+                || image.dataSize() < imageDataSize(mPixelFormat, image.width(), image.height())) {
+            B3D_LOGE("Unable to update texture: region is out of bounds.");
+            return;
+        }
+
+        GLint previousTexture = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+        glBindTexture(GL_TEXTURE_2D, GLuint(mHandle));
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, GLint(x), GLint(y), GLsizei(image.width()), GLsizei(image.height()),
+            format, type, image.data());
+
+        glBindTexture(GL_TEXTURE_2D, GLuint(previousTexture));
+    }
+
+    void GLES2Texture::bind(const SamplerState& sampler)
+    {
+        glBindTexture(GL_TEXTURE_2D, GLuint(handle()));
+        if (sampler != mSampler) {
+            mSampler = sampler;
+            applySamplerState(sampler);
+        }
+    }
+
+    void GLES2Texture::applySamplerState(const SamplerState& sampler)
+    {
+        MipmapFilter mipFilter = (mHasMipmaps ? sampler.mipFilter : MipmapFilter::None);
+        TextureWrap wrapS = (mCanRepeat ? sampler.wrapS : TextureWrap::Clamp);
+        TextureWrap wrapT = (mCanRepeat ? sampler.wrapT : TextureWrap::Clamp);
+
+        GLenum minFilter = textureMinFilterToGL(sampler.minFilter, mipFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GLint(minFilter));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GLint(textureFilterToGL(sampler.magFilter)));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GLint(textureWrapToGL(wrapS)));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GLint(textureWrapToGL(wrapT)));
+
+        float maxAnisotropy = maxSupportedAnisotropy();
+        if (maxAnisotropy > 0.0f) {
+            float anisotropy = std::min(std::max(sampler.maxAnisotropy, 1.0f), maxAnisotropy);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+        }
     }
 }
@@ -32,15 +32,33 @@ namespace B3D
         GLES2Texture();
         ~GLES2Texture();
 
-        size_t handle() const { return mHandle; }
+        // The GL object is created on first use, so that textures can be constructed on any thread.
+        size_t handle() const;
 
         const glm::vec2& size() const override { return mSize; }
+        PixelFormat pixelFormat() const override { return mPixelFormat; }
+        size_t mipLevelCount() const override { return mLevelCount; }
 
         void upload(const IImage& image) override;
+        void uploadRegion(size_t x, size_t y, const IImage& image) override;
+
+        TexturePtr atlasPage(glm::vec2&, glm::vec2&) const override { return nullptr; }
+        ITexture* samplerTexture() override { return this; }
+
+        // Binds the texture to the active texture unit. Sampler parameters are only changed when they differ from
+        // the ones the texture was last bound with.
+        void bind(const SamplerState& sampler);
 
     private:
-        size_t mHandle;
+        mutable size_t mHandle;
         glm::vec2 mSize;
+        PixelFormat mPixelFormat;
+        size_t mLevelCount;
+        bool mHasMipmaps;
+        bool mCanRepeat;
+        SamplerState mSampler;
+
+        void applySamplerState(const SamplerState& sampler);
 
         B3D_DISABLE_COPY(GLES2Texture);
     };
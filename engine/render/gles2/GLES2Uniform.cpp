@@ -52,12 +52,21 @@ namespace B3D
         B3D_UNIFORM_VALUE(Vec4Value, glm::vec4, glUniform4fv(location, 1, &value[0]));
         B3D_UNIFORM_VALUE(Mat4Value, glm::mat4, glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]));
 
-        B3D_UNIFORM_VALUE(TextureValue, TexturePtr, {
-            glActiveTexture(GLenum(GL_TEXTURE0 + *textureCount));
-            glBindTexture(GL_TEXTURE_2D, GLuint(static_cast<GLES2Texture&>(*value).handle()));
-            glUniform1i(location, *textureCount);
-            ++*textureCount;
-        });
+        struct TextureValue : public GLES2Uniform::IUniformValue
+        {
+            const TexturePtr texture;
+            const SamplerState sampler;
+
+            TextureValue(const TexturePtr& t, const SamplerState& s) : texture(t), sampler(s) {}
+
+            void upload(int location, int* textureCount) override
+            {
+                glActiveTexture(GLenum(GL_TEXTURE0 + *textureCount));
+                static_cast<GLES2Texture*>(texture->samplerTexture())->bind(sampler);
+                glUniform1i(location, *textureCount);
+                ++*textureCount;
+            }
+        };
 
         union ValueUnion
         {
@@ -145,10 +154,10 @@ namespace B3D
         mValue = new Mat4Value(value);
     }
 
-    void GLES2Uniform::setTexture(const TexturePtr& texture)
+    void GLES2Uniform::setTexture(const TexturePtr& texture, const SamplerState& sampler)
     {
         reset();
-        mValue = new TextureValue(texture);
+        mValue = new TextureValue(texture, sampler);
     }
 
     bool GLES2Uniform::upload(int location, int* textureCount)
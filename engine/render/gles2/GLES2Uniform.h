@@ -46,7 +46,7 @@ namespace B3D
         void setVec3(const glm::vec3& value);
         void setVec4(const glm::vec4& value);
         void setMat4(const glm::mat4& value);
-        void setTexture(const TexturePtr& texture);
+        void setTexture(const TexturePtr& texture, const SamplerState& sampler);
 
         bool upload(int location, int* textureCount);
 
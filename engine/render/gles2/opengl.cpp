@@ -21,6 +21,32 @@
  */
 #include "opengl.h"
 #include <cassert>
+#include <cstring>
+
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+#define GL_COMPRESSED_RGBA_ASTC_8x8_KHR 0x93B7
+#endif
 
 namespace B3D
 {
@@ -97,4 +123,111 @@ namespace B3D
         assert(false);
         return GL_STATIC_DRAW;
     }
+
+    GLenum textureFilterToGL(TextureFilter filter)
+    {
+        switch (filter)
+        {
+        case TextureFilter::Nearest: return GL_NEAREST;
+        case TextureFilter::Linear: return GL_LINEAR;
+        }
+
+        assert(false);
+        return GL_LINEAR;
+    }
+
+    GLenum textureMinFilterToGL(TextureFilter filter, MipmapFilter mipFilter)
+    {
+        switch (mipFilter)
+        {
+        case MipmapFilter::None:
+            return textureFilterToGL(filter);
+        case MipmapFilter::Nearest:
+            return (filter == TextureFilter::Nearest ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_NEAREST);
+        case MipmapFilter::Linear:
+            return (filter == TextureFilter::Nearest ? GL_NEAREST_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_LINEAR);
+        }
+
+        assert(false);
+        return GL_LINEAR;
+    }
+
+    GLenum textureWrapToGL(TextureWrap wrap)
+    {
+        switch (wrap)
+        {
+        case TextureWrap::Clamp: return GL_CLAMP_TO_EDGE;
+        case TextureWrap::Repeat: return GL_REPEAT;
+        case TextureWrap::MirroredRepeat: return GL_MIRRORED_REPEAT;
+        }
+
+        assert(false);
+        return GL_CLAMP_TO_EDGE;
+    }
+
+    bool hasGLExtension(const char* name)
+    {
+        const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+        if (!extensions)
+            return false;
+
+        size_t length = strlen(name);
+        for (const char* p = extensions; (p = strstr(p, name)) != nullptr; p += length) {
+            if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == 0))
+                return true;
+        }
+
+        return false;
+    }
+
+    namespace
+    {
+        struct CompressedFormats
+        {
+            GLenum formats[size_t(PixelFormat::Count)];
+
+            CompressedFormats()
+            {
+                for (auto& format : formats)
+                    format = 0;
+
+                // ETC2 is part of OpenGL ES 3.0; ETC1 textures are valid ETC2 textures.
+                const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+                bool es3 = version && strncmp(version, "OpenGL ES ", 10) == 0 && version[10] >= '3';
+                if (es3 || hasGLExtension("GL_ARB_ES3_compatibility")) {
+                    set(PixelFormat::ETC1, GL_COMPRESSED_RGB8_ETC2);
+                    set(PixelFormat::ETC2_RGB8, GL_COMPRESSED_RGB8_ETC2);
+                    set(PixelFormat::ETC2_RGBA8, GL_COMPRESSED_RGBA8_ETC2_EAC);
+                }
+                if (hasGLExtension("GL_OES_compressed_ETC1_RGB8_texture"))
+                    set(PixelFormat::ETC1, GL_ETC1_RGB8_OES);
+
+                if (hasGLExtension("GL_EXT_texture_compression_s3tc")) {
+                    set(PixelFormat::BC1, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
+                    set(PixelFormat::BC2, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT);
+                    set(PixelFormat::BC3, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+                }
+                if (hasGLExtension("GL_EXT_texture_compression_dxt1"))
+                    set(PixelFormat::BC1, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
+                if (hasGLExtension("GL_ANGLE_texture_compression_dxt3"))
+                    set(PixelFormat::BC2, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT);
+                if (hasGLExtension("GL_ANGLE_texture_compression_dxt5"))
+                    set(PixelFormat::BC3, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+
+                if (hasGLExtension("GL_KHR_texture_compression_astc_ldr")) {
+                    set(PixelFormat::ASTC_4x4, GL_COMPRESSED_RGBA_ASTC_4x4_KHR);
+                    set(PixelFormat::ASTC_8x8, GL_COMPRESSED_RGBA_ASTC_8x8_KHR);
+                }
+            }
+
+            void set(PixelFormat format, GLenum glFormat) { formats[size_t(format)] = glFormat; }
+        };
+    }
+
+    GLenum compressedPixelFormatToGL(PixelFormat format)
+    {
+        assert(format != PixelFormat::Invalid);
+        static const CompressedFormats supported;
+        return supported.formats[size_t(format)];
+    }
 }
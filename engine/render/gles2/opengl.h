@@ -43,6 +43,7 @@
 
 #include "engine/interfaces/render/lowlevel/IRenderer.h"
 #include "engine/interfaces/render/lowlevel/IBuffer.h"
+#include "engine/interfaces/render/lowlevel/ITexture.h"
 
 namespace B3D
 {
@@ -51,4 +52,12 @@ namespace B3D
     GLenum frontFaceToGL(FrontFace face);
     GLenum blendFuncToGL(BlendFunc func);
     GLenum bufferUsageToGL(BufferUsage usage);
+    GLenum textureFilterToGL(TextureFilter filter);
+    GLenum textureMinFilterToGL(TextureFilter filter, MipmapFilter mipFilter);
+    GLenum textureWrapToGL(TextureWrap wrap);
+
+    // Both must be called with a current context. Support for compressed formats is queried on the first call; the
+    // result is zero for formats that cannot be uploaded as they are.
+    bool hasGLExtension(const char* name);
+    GLenum compressedPixelFormatToGL(PixelFormat format);
 }
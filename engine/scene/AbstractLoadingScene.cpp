@@ -32,6 +32,7 @@ namespace B3D
         , mCurrentProgress(0.0f)
         , mAutoSwitchScene(true)
         , mLoadingComplete(false)
+        , mRecordingGroup(false)
     {
     }
 
@@ -49,9 +50,50 @@ namespace B3D
         mLoadingComplete = false;
     }
 
+    void AbstractLoadingScene::beginLoading(const std::string& resourceGroup,
+        const std::function<ScenePtr()>& sceneFactory)
+    {
+        endRecordingGroup();
+        if (!mResourceGroup.empty())
+            Services::resourceManager()->releaseGroup(mResourceGroup);
+
+        mResourceGroup = resourceGroup;
+        Services::resourceManager()->prefetchGroup(mResourceGroup);
+        Services::resourceManager()->beginRecordingGroup(mResourceGroup);
+        mRecordingGroup = true;
+
+        beginLoading(sceneFactory());
+    }
+
+    void AbstractLoadingScene::waitFor(const ResourceFutureBase& resource)
+    {
+        mPendingResources.emplace_back(resource);
+    }
+
+    void AbstractLoadingScene::waitFor(const std::vector<ResourceFutureBase>& resources)
+    {
+        mPendingResources.insert(mPendingResources.end(), resources.begin(), resources.end());
+    }
+
     void AbstractLoadingScene::switchToNextScene()
     {
+        mPendingResources.clear();
         Services::sceneManager()->setCurrentScene(mNextScene);
+
+        // The scene now owns its resources, so the group does not need to keep them alive any longer.
+        endRecordingGroup();
+        if (!mResourceGroup.empty()) {
+            Services::resourceManager()->releaseGroup(mResourceGroup);
+            mResourceGroup.clear();
+        }
+    }
+
+    void AbstractLoadingScene::endRecordingGroup()
+    {
+        if (mRecordingGroup) {
+            Services::resourceManager()->endRecordingGroup();
+            mRecordingGroup = false;
+        }
     }
 
     void AbstractLoadingScene::update(double)
@@ -59,10 +101,25 @@ namespace B3D
         if (!mNextScene)
             return;
 
-        float progress = Services::resourceManager()->resourceLoadProgress();
+        float progress;
+        bool loading;
+        if (mPendingResources.empty()) {
+            progress = Services::resourceManager()->resourceLoadProgress();
+            loading = Services::resourceManager()->resourcesAreLoading();
+        } else {
+            size_t ready = 0;
+            for (const auto& resource : mPendingResources) {
+                if (resource.isReady())
+                    ++ready;
+            }
+            progress = float(ready) / float(mPendingResources.size());
+            loading = (ready != mPendingResources.size());
+        }
+
         mCurrentProgress = std::max(mCurrentProgress, progress);
 
-        if (!Services::resourceManager()->resourcesAreLoading()) {
+        if (!loading) {
+            endRecordingGroup();
             mLoadingComplete = true;
             if (mAutoSwitchScene)
                 switchToNextScene();
@@ -22,6 +22,10 @@
 
 #pragma once
 #include "engine/ui/UIScene.h"  // FIXME
+#include "engine/core/ResourceFuture.h"
+#include <functional>
+#include <vector>
+#include <string>
 
 namespace B3D
 {
@@ -35,6 +39,15 @@ namespace B3D
         template <class SCENE, class... ARGS> void beginLoading(ARGS&&... args)
             { beginLoading(std::make_shared<SCENE>(std::forward<ARGS>(args)...)); }
 
+        // Prefetches the resources recorded for the group before the scene is created, and records the resources
+        // requested while the scene is being loaded to keep the group's manifest up to date.
+        void beginLoading(const std::string& resourceGroup, const std::function<ScenePtr()>& sceneFactory);
+
+        // When resources are given, loading completes as soon as they are ready instead of waiting for
+        // every resource being loaded in the process.
+        void waitFor(const ResourceFutureBase& resource);
+        void waitFor(const std::vector<ResourceFutureBase>& resources);
+
         const ScenePtr& nextScene() const { return mNextScene; }
         void switchToNextScene();
 
@@ -49,8 +62,13 @@ namespace B3D
 
     private:
         ScenePtr mNextScene;
+        std::vector<ResourceFutureBase> mPendingResources;
+        std::string mResourceGroup;
         float mCurrentProgress;
         bool mAutoSwitchScene;
         bool mLoadingComplete;
+        bool mRecordingGroup;
+
+        void endRecordingGroup();
     };
 }
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "BufferedFile.h"
+#include "engine/core/Log.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace B3D
+{
+    BufferedFile::BufferedFile(const FilePtr& file, size_t bufferSize)
+        : mFile(file)
+        , mBuffer(bufferSize)
+        , mSize(file->size())
+        , mPosition(file->position())
+        , mFilePosition(mPosition)
+        , mBufferStart(0)
+        , mBufferLength(0)
+    {
+        assert(bufferSize > 0);
+    }
+
+    BufferedFile::~BufferedFile()
+    {
+    }
+
+    const std::string& BufferedFile::name() const
+    {
+        return mFile->name();
+    }
+
+    uint64_t BufferedFile::size()
+    {
+        return mSize;
+    }
+
+    uint64_t BufferedFile::position()
+    {
+        return mPosition;
+    }
+
+    bool BufferedFile::seek(uint64_t pos)
+    {
+        if (pos > mSize) {
+            B3D_LOGE("Seek failed in file \"" << mFile->name() << "\": offset is beyond the end of file.");
+            return false;
+        }
+        mPosition = pos;
+        return true;
+    }
+
+    size_t BufferedFile::read(void* buffer, size_t bytes)
+    {
+        uint8_t* out = static_cast<uint8_t*>(buffer);
+        size_t bytesRead = 0;
+
+        while (bytes > 0) {
+            if (mPosition >= mBufferStart && mPosition < mBufferStart + mBufferLength) {
+                size_t offset = size_t(mPosition - mBufferStart);
+                size_t length = std::min(bytes, mBufferLength - offset);
+                memcpy(out, mBuffer.data() + offset, length);
+                out += length;
+                bytes -= length;
+                bytesRead += length;
+                mPosition += length;
+                continue;
+            }
+
+            if (mPosition >= mSize || !syncFilePosition())
+                break;
+
+            // Large reads go straight into the caller's buffer.
+            if (bytes >= mBuffer.size()) {
+                size_t length = mFile->read(out, bytes);
+                mFilePosition += length;
+                mPosition += length;
+                bytesRead += length;
+                break;
+            }
+
+            mBufferStart = mPosition;
+            mBufferLength = mFile->read(mBuffer.data(), mBuffer.size());
+            mFilePosition += mBufferLength;
+            if (mBufferLength == 0)
+                break;
+        }
+
+        return bytesRead;
+    }
+
+    const uint8_t* BufferedFile::mappedData()
+    {
+        return mFile->mappedData();
+    }
+
+    bool BufferedFile::syncFilePosition()
+    {
+        if (mFilePosition == mPosition)
+            return true;
+        if (!mFile->seek(mPosition))
+            return false;
+        mFilePosition = mPosition;
+        return true;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/io/IFile.h"
+#include <vector>
+
+namespace B3D
+{
+    // Read-ahead buffer in front of another file. The size is queried once when the file is wrapped, and seeks
+    // that land inside the buffered range do not touch the underlying file.
+    class BufferedFile : public IFile
+    {
+    public:
+        static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+        explicit BufferedFile(const FilePtr& file, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+        ~BufferedFile();
+
+        const std::string& name() const override;
+
+        uint64_t size() override;
+
+        uint64_t position() override;
+        bool seek(uint64_t pos) override;
+
+        size_t read(void* buffer, size_t bytes) override;
+
+        const uint8_t* mappedData() override;
+
+    private:
+        FilePtr mFile;
+        std::vector<uint8_t> mBuffer;
+        uint64_t mSize;
+        uint64_t mPosition;
+        uint64_t mFilePosition;
+        uint64_t mBufferStart;
+        size_t mBufferLength;
+
+        bool syncFilePosition();
+
+        B3D_DISABLE_COPY(BufferedFile);
+    };
+}
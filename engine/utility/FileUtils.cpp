@@ -22,7 +22,7 @@
 #include "FileUtils.h"
 #include "engine/interfaces/io/IFileSystem.h"
 #include "engine/core/Services.h"
-#include <sstream>
+#include <cstring>
 
 namespace B3D
 {
@@ -71,6 +71,14 @@ namespace B3D
 
         size_t fileSize = size_t(file->size());
         result.reserve(fileSize + 1);
+
+        const uint8_t* mapped = file->mappedData();
+        if (mapped) {
+            result.assign(mapped, mapped + fileSize);
+            file->seek(fileSize);
+            return result;
+        }
+
         result.resize(fileSize);
 
         size_t offset = 0;
@@ -87,6 +95,59 @@ namespace B3D
         return result;
     }
 
+    FileUtils::FileContents::FileContents(FileContents&& other)
+        : mFile(std::move(other.mFile))
+        , mBuffer(std::move(other.mBuffer))
+        , mData(other.mData)
+        , mSize(other.mSize)
+    {
+        other.mData = nullptr;
+        other.mSize = 0;
+    }
+
+    FileUtils::FileContents& FileUtils::FileContents::operator=(FileContents&& other)
+    {
+        mFile = std::move(other.mFile);
+        mBuffer = std::move(other.mBuffer);
+        mData = other.mData;
+        mSize = other.mSize;
+        other.mData = nullptr;
+        other.mSize = 0;
+        return *this;
+    }
+
+    FileUtils::FileContents FileUtils::mapFile(const std::string& fileName)
+    {
+        return mapFile(Services::fileSystem()->openFile(fileName));
+    }
+
+    FileUtils::FileContents FileUtils::mapFile(const FilePtr& file)
+    {
+        FileContents contents = mapFile(file.get());
+        if (file && file->mappedData())
+            contents.mFile = file;
+        return contents;
+    }
+
+    FileUtils::FileContents FileUtils::mapFile(IFile* file)
+    {
+        FileContents contents;
+        if (!file)
+            return contents;
+
+        const uint8_t* mapped = file->mappedData();
+        if (mapped) {
+            contents.mData = reinterpret_cast<const char*>(mapped);
+            contents.mSize = size_t(file->size());
+        } else {
+            contents.mBuffer = loadFile(file);
+            contents.mData = contents.mBuffer.data();
+            contents.mSize = contents.mBuffer.size();
+        }
+
+        return contents;
+    }
+
     std::vector<std::string> FileUtils::loadFileLines(const std::string& fileName, bool includeEolMarker)
     {
         FilePtr file = Services::fileSystem()->openFile(fileName);
@@ -100,36 +161,39 @@ namespace B3D
 
     std::vector<std::string> FileUtils::loadFileLines(IFile* file, bool includeEolMarker)
     {
-        std::vector<char> fileData = loadFile(file);
+        FileContents fileData = mapFile(file);
         std::vector<std::string> result;
 
-        for (auto it = fileData.begin(); it != fileData.end(); ) {
-            std::stringstream ss;
-            do {
-                if (*it == '\n') {
-                    if (includeEolMarker)
-                        ss << *it;
-                    ++it;
-                    break;
-                }
-                ss << *it++;
-            } while (it != fileData.end());
-
-            std::string str = ss.str();
-            size_t length = str.length();
-            if (!includeEolMarker) {
-                if (length > 0 && str[length - 1] == '\r')
-                    str.resize(length - 1);
-            } else {
-                if (length > 1 && str[length - 2] == '\r' && str[length - 1] == '\n') {
-                    str[length - 2] = '\n';
-                    str.resize(length - 1);
-                }
-            }
-
-            result.emplace_back(std::move(str));
+        const char* end = fileData.data() + fileData.size();
+        LineReader reader(fileData);
+        StringView line;
+        while (reader.readLine(line)) {
+            result.emplace_back(line.data(), line.size());
+            if (includeEolMarker && line.end() != end)
+                result.back() += '\n';
         }
 
         return result;
     }
+
+    bool FileUtils::LineReader::readLine(StringView& line)
+    {
+        if (mPos == mEnd)
+            return false;
+
+        const char* start = mPos;
+        const char* eol = static_cast<const char*>(memchr(start, '\n', size_t(mEnd - start)));
+        if (!eol)
+            eol = mPos = mEnd;
+        else
+            mPos = eol + 1;
+
+        if (eol != start && eol[-1] == '\r')
+            --eol;
+
+        line = StringView(start, size_t(eol - start));
+        ++mLineNumber;
+
+        return true;
+    }
 }
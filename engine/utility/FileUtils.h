@@ -23,6 +23,7 @@
 #pragma once
 #include "engine/core/macros.h"
 #include "engine/interfaces/io/IFile.h"
+#include "engine/utility/StringView.h"
 #include <vector>
 #include <string>
 
@@ -30,6 +31,46 @@ namespace B3D
 {
     namespace FileUtils
     {
+        // Contents of a file: either a view of the file's memory mapping or a copy read into memory.
+        class FileContents
+        {
+        public:
+            FileContents() : mData(nullptr), mSize(0) {}
+            FileContents(FileContents&& other);
+            FileContents& operator=(FileContents&& other);
+
+            const char* data() const { return mData; }
+            size_t size() const { return mSize; }
+            bool empty() const { return mSize == 0; }
+
+        private:
+            FilePtr mFile;
+            std::vector<char> mBuffer;
+            const char* mData;
+            size_t mSize;
+
+            friend FileContents mapFile(const FilePtr& file);
+            friend FileContents mapFile(IFile* file);
+
+            B3D_DISABLE_COPY(FileContents);
+        };
+
+        // Splits text into lines without copying. Returned lines do not include the end of line marker.
+        class LineReader
+        {
+        public:
+            LineReader(const char* data, size_t size) : mPos(data), mEnd(data + size), mLineNumber(0) {}
+            explicit LineReader(const FileContents& contents) : LineReader(contents.data(), contents.size()) {}
+
+            bool readLine(StringView& line);
+            size_t lineNumber() const { return mLineNumber; }
+
+        private:
+            const char* mPos;
+            const char* mEnd;
+            size_t mLineNumber;
+        };
+
         std::string makeFullPath(const std::string& fileName, const std::string& parentFileName);
         std::string extractBaseName(const std::string& fileName);
 
@@ -37,6 +78,12 @@ namespace B3D
         std::vector<char> loadFile(const FilePtr& file);
         std::vector<char> loadFile(IFile* file);
 
+        // Avoids copying files which support direct access to their contents. When given a raw pointer, the
+        // returned contents are only valid as long as the file remains open.
+        FileContents mapFile(const std::string& fileName);
+        FileContents mapFile(const FilePtr& file);
+        FileContents mapFile(IFile* file);
+
         std::vector<std::string> loadFileLines(const std::string& fileName, bool includeEolMarker = true);
         std::vector<std::string> loadFileLines(const FilePtr& file, bool includeEolMarker = true);
         std::vector<std::string> loadFileLines(IFile* file, bool includeEolMarker = true);
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace B3D
+{
+    // Move-only `void()` callable that keeps callables of up to CAPACITY bytes inside the object itself, so that
+    // storing a typical lambda does not allocate. Larger callables are stored on the heap.
+    class InplaceAction
+    {
+    public:
+        static const size_t CAPACITY = 48;
+
+        InplaceAction() : mOps(nullptr) {}
+        InplaceAction(InplaceAction&& other) : mOps(nullptr) { moveFrom(other); }
+        ~InplaceAction() { reset(); }
+
+        InplaceAction& operator=(InplaceAction&& other)
+        {
+            if (this != &other) {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        explicit operator bool() const { return mOps != nullptr; }
+
+        void operator()() { mOps->invoke(&mStorage); }
+
+        template <typename FUNC> void emplace(FUNC&& func)
+        {
+            using Type = typename std::decay<FUNC>::type;
+            using Ops = typename std::conditional<fitsInline<Type>(), InlineOps<Type>, HeapOps<Type>>::type;
+            reset();
+            Ops::construct(&mStorage, std::forward<FUNC>(func));
+            mOps = &Ops::ops;
+        }
+
+        void reset()
+        {
+            if (mOps) {
+                mOps->destroy(&mStorage);
+                mOps = nullptr;
+            }
+        }
+
+    private:
+        using Storage = std::aligned_storage<CAPACITY, alignof(std::max_align_t)>::type;
+
+        struct Ops
+        {
+            void (*invoke)(void* storage);
+            void (*move)(void* from, void* to);     // Leaves `from` destroyed
+            void (*destroy)(void* storage);
+        };
+
+        template <typename TYPE> static constexpr bool fitsInline()
+        {
+            return sizeof(TYPE) <= CAPACITY && alignof(TYPE) <= alignof(Storage)
+                && std::is_nothrow_move_constructible<TYPE>::value;
+        }
+
+        template <typename TYPE> struct InlineOps
+        {
+            static const Ops ops;
+
+            template <typename FUNC> static void construct(void* storage, FUNC&& func)
+                { new (storage) TYPE(std::forward<FUNC>(func)); }
+
+            static void invoke(void* storage) { (*static_cast<TYPE*>(storage))(); }
+            static void destroy(void* storage) { static_cast<TYPE*>(storage)->~TYPE(); }
+
+            static void move(void* from, void* to)
+            {
+                new (to) TYPE(std::move(*static_cast<TYPE*>(from)));
+                destroy(from);
+            }
+        };
+
+        template <typename TYPE> struct HeapOps
+        {
+            static const Ops ops;
+
+            template <typename FUNC> static void construct(void* storage, FUNC&& func)
+                { *static_cast<TYPE**>(storage) = new TYPE(std::forward<FUNC>(func)); }
+
+            static void invoke(void* storage) { (**static_cast<TYPE**>(storage))(); }
+            static void destroy(void* storage) { delete *static_cast<TYPE**>(storage); }
+            static void move(void* from, void* to) { *static_cast<TYPE**>(to) = *static_cast<TYPE**>(from); }
+        };
+
+        Storage mStorage;
+        const Ops* mOps;
+
+        void moveFrom(InplaceAction& other)
+        {
+            if (other.mOps) {
+                other.mOps->move(&other.mStorage, &mStorage);
+                mOps = other.mOps;
+                other.mOps = nullptr;
+            }
+        }
+
+        B3D_DISABLE_COPY(InplaceAction);
+    };
+
+    template <typename TYPE> const InplaceAction::Ops InplaceAction::InlineOps<TYPE>::ops = {
+        &InplaceAction::InlineOps<TYPE>::invoke,
+        &InplaceAction::InlineOps<TYPE>::move,
+        &InplaceAction::InlineOps<TYPE>::destroy,
+    };
+
+    template <typename TYPE> const InplaceAction::Ops InplaceAction::HeapOps<TYPE>::ops = {
+        &InplaceAction::HeapOps<TYPE>::invoke,
+        &InplaceAction::HeapOps<TYPE>::move,
+        &InplaceAction::HeapOps<TYPE>::destroy,
+    };
+}
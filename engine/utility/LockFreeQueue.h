@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include <atomic>
+#include <memory>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+namespace B3D
+{
+    // Bounded multi-producer / single-consumer queue. Enqueue and dequeue never lock and never allocate;
+    // tryEnqueue() fails when the ring is full and it is up to the caller to handle the overflow.
+    template <typename ITEM> class LockFreeQueue
+    {
+    public:
+        explicit LockFreeQueue(size_t capacity)
+            : mCells(new Cell[capacity])
+            , mMask(capacity - 1)
+            , mEnqueuePosition(0)
+            , mDequeuePosition(0)
+        {
+            assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+            for (size_t i = 0; i < capacity; i++)
+                mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        ~LockFreeQueue() {}
+
+        size_t capacity() const { return mMask + 1; }
+
+        // Approximate when called concurrently with enqueue or dequeue.
+        size_t size() const
+        {
+            size_t dequeuePosition = mDequeuePosition.load(std::memory_order_relaxed);
+            size_t enqueuePosition = mEnqueuePosition.load(std::memory_order_relaxed);
+            return (enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0);
+        }
+
+        bool tryEnqueue(ITEM&& item)
+        {
+            return tryEnqueueWith([&item](ITEM& slot) { slot = std::move(item); });
+        }
+
+        // Lets `fill(ITEM&)` write the item straight into the claimed slot. It must not throw: the slot is already
+        // taken and the consumer would wait for it forever.
+        template <typename FUNC> bool tryEnqueueWith(FUNC&& fill)
+        {
+            Cell* cell;
+            size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &mCells[position & mMask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                ptrdiff_t diff = ptrdiff_t(sequence) - ptrdiff_t(position);
+                if (diff == 0) {
+                    if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0)
+                    return false;
+                else
+                    position = mEnqueuePosition.load(std::memory_order_relaxed);
+            }
+
+            fill(cell->item);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Must only be called from the consumer thread.
+        bool tryDequeue(ITEM& item)
+        {
+            size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+            Cell* cell = &mCells[position & mMask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            if (ptrdiff_t(sequence) - ptrdiff_t(position + 1) < 0)
+                return false;
+
+            mDequeuePosition.store(position + 1, std::memory_order_relaxed);
+            item = std::move(cell->item);
+            cell->item = ITEM();
+            cell->sequence.store(position + mMask + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Must only be called from the consumer thread.
+        size_t tryDequeue(ITEM* items, size_t maxCount)
+        {
+            size_t count = 0;
+            while (count < maxCount && tryDequeue(items[count]))
+                ++count;
+            return count;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            ITEM item;
+        };
+
+        std::unique_ptr<Cell[]> mCells;
+        size_t mMask;
+        char mPadding1[64];
+        std::atomic<size_t> mEnqueuePosition;
+        char mPadding2[64];
+        std::atomic<size_t> mDequeuePosition;
+
+        B3D_DISABLE_COPY(LockFreeQueue);
+    };
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "MemoryFile.h"
+#include "engine/core/Log.h"
+#include <algorithm>
+#include <cstring>
+
+namespace B3D
+{
+    MemoryFile::MemoryFile(const std::string& name, std::vector<uint8_t>&& data)
+        : mName(name)
+        , mBuffer(std::move(data))
+        , mData(mBuffer.data())
+        , mSize(mBuffer.size())
+        , mPosition(0)
+    {
+    }
+
+    MemoryFile::MemoryFile(const std::string& name, const uint8_t* data, size_t size,
+            const std::shared_ptr<void>& owner)
+        : mName(name)
+        , mOwner(owner)
+        , mData(data)
+        , mSize(size)
+        , mPosition(0)
+    {
+    }
+
+    MemoryFile::~MemoryFile()
+    {
+    }
+
+    const std::string& MemoryFile::name() const
+    {
+        return mName;
+    }
+
+    uint64_t MemoryFile::size()
+    {
+        return uint64_t(mSize);
+    }
+
+    uint64_t MemoryFile::position()
+    {
+        return uint64_t(mPosition);
+    }
+
+    bool MemoryFile::seek(uint64_t pos)
+    {
+        if (pos > uint64_t(mSize)) {
+            B3D_LOGE("Seek failed in file \"" << mName << "\": offset is beyond the end of file.");
+            return false;
+        }
+        mPosition = size_t(pos);
+        return true;
+    }
+
+    size_t MemoryFile::read(void* buffer, size_t bytes)
+    {
+        size_t bytesRead = std::min(bytes, mSize - mPosition);
+        memcpy(buffer, mData + mPosition, bytesRead);
+        mPosition += bytesRead;
+        return bytesRead;
+    }
+
+    const uint8_t* MemoryFile::mappedData()
+    {
+        return mData;
+    }
+}
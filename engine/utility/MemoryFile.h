@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/io/IFile.h"
+#include <vector>
+
+namespace B3D
+{
+    // File backed by a block of memory, either owned by the file or kept alive by the given owner object.
+    class MemoryFile : public IFile
+    {
+    public:
+        MemoryFile(const std::string& name, std::vector<uint8_t>&& data);
+        MemoryFile(const std::string& name, const uint8_t* data, size_t size, const std::shared_ptr<void>& owner);
+        ~MemoryFile();
+
+        const std::string& name() const override;
+
+        uint64_t size() override;
+
+        uint64_t position() override;
+        bool seek(uint64_t pos) override;
+
+        size_t read(void* buffer, size_t bytes) override;
+
+        const uint8_t* mappedData() override;
+
+    private:
+        std::string mName;
+        std::vector<uint8_t> mBuffer;
+        std::shared_ptr<void> mOwner;
+        const uint8_t* mData;
+        size_t mSize;
+        size_t mPosition;
+
+        B3D_DISABLE_COPY(MemoryFile);
+    };
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "ParallelUtils.h"
+#include "engine/core/Services.h"
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cassert>
+
+namespace B3D
+{
+    namespace ParallelUtils
+    {
+        namespace
+        {
+            struct Context
+            {
+                const std::function<void(size_t, size_t, size_t)>* body;
+                size_t begin;
+                size_t end;
+                size_t grainSize;
+                size_t chunkCount;
+                std::atomic<size_t> nextChunk;
+                size_t completeChunks;
+                std::mutex mutex;
+                std::condition_variable condition;
+
+                // Returns false when there are no chunks left to take.
+                bool runNextChunk()
+                {
+                    size_t chunk = nextChunk.fetch_add(1);
+                    if (chunk >= chunkCount)
+                        return false;
+
+                    size_t first = begin + chunk * grainSize;
+                    size_t last = std::min(first + grainSize, end);
+                    (*body)(chunk, first, last);
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (++completeChunks == chunkCount)
+                        condition.notify_all();
+                    return true;
+                }
+            };
+        }
+
+        size_t chunkCount(size_t begin, size_t end, size_t grainSize)
+        {
+            assert(grainSize > 0);
+            return (end > begin ? (end - begin + grainSize - 1) / grainSize : 0);
+        }
+
+        void forEachChunk(size_t begin, size_t end, size_t grainSize,
+            const std::function<void(size_t, size_t, size_t)>& body)
+        {
+            size_t chunks = chunkCount(begin, end, grainSize);
+            if (chunks == 0)
+                return;
+
+            const auto& threadManager = Services::threadManager();
+            size_t helperCount = (threadManager ? std::min(threadManager->backgroundThreadCount(), chunks - 1) : 0);
+            if (helperCount == 0) {
+                for (size_t chunk = 0; chunk < chunks; chunk++) {
+                    size_t first = begin + chunk * grainSize;
+                    body(chunk, first, std::min(first + grainSize, end));
+                }
+                return;
+            }
+
+            auto context = std::make_shared<Context>();
+            context->body = &body;
+            context->begin = begin;
+            context->end = end;
+            context->grainSize = grainSize;
+            context->chunkCount = chunks;
+            context->nextChunk.store(0);
+            context->completeChunks = 0;
+
+            // Helpers that start after all chunks have been taken return immediately, so the calling thread never
+            // waits for a task that is still sitting in a queue. This makes it safe to call from a worker thread.
+            for (size_t i = 0; i < helperCount; i++) {
+                threadManager->performInBackgroundThread(TaskPriority::Critical, [context]() {
+                    while (context->runNextChunk())
+                        ;
+                });
+            }
+
+            while (context->runNextChunk())
+                ;
+
+            std::unique_lock<std::mutex> lock(context->mutex);
+            while (context->completeChunks != context->chunkCount)
+                context->condition.wait(lock);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace B3D
+{
+    namespace ParallelUtils
+    {
+        const size_t DEFAULT_GRAIN_SIZE = 4096;
+
+        size_t chunkCount(size_t begin, size_t end, size_t grainSize);
+
+        // Splits [begin, end) into chunks of `grainSize` elements and runs `body(chunkIndex, first, last)` for each
+        // of them on the background threads. The calling thread takes part in the work and the call returns when
+        // every chunk has been processed. Small ranges are processed inline.
+        void forEachChunk(size_t begin, size_t end, size_t grainSize,
+            const std::function<void(size_t, size_t, size_t)>& body);
+
+        template <typename FUNC>
+        void parallelFor(size_t begin, size_t end, FUNC&& func, size_t grainSize = DEFAULT_GRAIN_SIZE)
+        {
+            forEachChunk(begin, end, grainSize, [&func](size_t, size_t first, size_t last) {
+                for (size_t i = first; i < last; i++)
+                    func(i);
+            });
+        }
+
+        // `map(first, last)` computes the partial result for a chunk, `reduce(a, b)` combines two partial results.
+        // Partial results are combined in order, so the outcome does not depend on scheduling.
+        template <typename TYPE, typename MAP, typename REDUCE>
+        TYPE parallelReduce(size_t begin, size_t end, const TYPE& identity, MAP&& map, REDUCE&& reduce,
+            size_t grainSize = DEFAULT_GRAIN_SIZE)
+        {
+            std::vector<TYPE> partial(chunkCount(begin, end, grainSize), identity);
+            forEachChunk(begin, end, grainSize, [&partial, &map](size_t chunk, size_t first, size_t last) {
+                partial[chunk] = map(first, last);
+            });
+
+            TYPE result = identity;
+            for (const auto& value : partial)
+                result = reduce(result, value);
+            return result;
+        }
+
+        template <typename ITERATOR, typename COMPARE>
+        void parallelSort(ITERATOR first, ITERATOR last, COMPARE compare, size_t grainSize = DEFAULT_GRAIN_SIZE)
+        {
+            size_t count = size_t(std::distance(first, last));
+            forEachChunk(0, count, grainSize, [first, &compare](size_t, size_t from, size_t to) {
+                std::sort(first + ptrdiff_t(from), first + ptrdiff_t(to), compare);
+            });
+
+            for (size_t width = grainSize; width < count; width *= 2) {
+                size_t pairs = (count + 2 * width - 1) / (2 * width);
+                forEachChunk(0, pairs, 1, [first, count, width, &compare](size_t, size_t from, size_t to) {
+                    for (size_t pair = from; pair < to; pair++) {
+                        size_t begin = pair * 2 * width;
+                        size_t middle = std::min(begin + width, count);
+                        size_t end = std::min(begin + 2 * width, count);
+                        std::inplace_merge(first + ptrdiff_t(begin), first + ptrdiff_t(middle),
+                            first + ptrdiff_t(end), compare);
+                    }
+                });
+            }
+        }
+
+        template <typename ITERATOR> void parallelSort(ITERATOR first, ITERATOR last)
+        {
+            parallelSort(first, last, std::less<typename std::iterator_traits<ITERATOR>::value_type>());
+        }
+    }
+}
@@ -55,6 +55,12 @@ namespace B3D
         ProducerConsumerQueue() {}
         ~ProducerConsumerQueue() {}
 
+        size_t size()
+        {
+            LockGuard lock(mMutex);
+            return mQueue.size();
+        }
+
         void clear()
         {
             UniqueLock lock(mMutex);
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "SkylinePacker.h"
+#include <algorithm>
+#include <cassert>
+
+namespace B3D
+{
+    SkylinePacker::SkylinePacker()
+        : mWidth(0)
+        , mHeight(0)
+        , mUsedArea(0)
+    {
+    }
+
+    SkylinePacker::SkylinePacker(size_t width, size_t height)
+    {
+        reset(width, height);
+    }
+
+    void SkylinePacker::reset(size_t width, size_t height)
+    {
+        mWidth = width;
+        mHeight = height;
+        mUsedArea = 0;
+
+        mSkyline.clear();
+        if (width > 0)
+            mSkyline.push_back({ 0, 0, width });
+    }
+
+    void SkylinePacker::grow(size_t width, size_t height)
+    {
+        assert(width >= mWidth && height >= mHeight);
+
+        if (width > mWidth) {
+            if (!mSkyline.empty() && mSkyline.back().y == 0)
+                mSkyline.back().width += width - mWidth;
+            else
+                mSkyline.push_back({ mWidth, 0, width - mWidth });
+        }
+
+        mWidth = width;
+        mHeight = height;
+    }
+
+    bool SkylinePacker::fits(size_t index, size_t width, size_t height, size_t& y) const
+    {
+        size_t x = mSkyline[index].x;
+        if (x + width > mWidth)
+            return false;
+
+        // The rectangle rests on the highest segment below it.
+        y = 0;
+        size_t remaining = width;
+        for (size_t i = index; remaining > 0; i++) {
+            assert(i < mSkyline.size());
+            y = std::max(y, mSkyline[i].y);
+            if (y + height > mHeight)
+                return false;
+            remaining -= std::min(remaining, mSkyline[i].width);
+        }
+
+        return true;
+    }
+
+    bool SkylinePacker::insert(size_t width, size_t height, size_t& x, size_t& y)
+    {
+        if (width == 0 || height == 0)
+            return false;
+
+        size_t bestIndex = mSkyline.size();
+        size_t bestBottom = mHeight + 1;
+        size_t bestWidth = 0;
+        for (size_t i = 0; i < mSkyline.size(); i++) {
+            size_t top;
+            if (!fits(i, width, height, top))
+                continue;
+
+            // Ties go to the narrower segment, which leaves the wider gaps for larger rectangles.
+            size_t bottom = top + height;
+            if (bottom < bestBottom || (bottom == bestBottom && mSkyline[i].width < bestWidth)) {
+                bestIndex = i;
+                bestBottom = bottom;
+                bestWidth = mSkyline[i].width;
+                y = top;
+            }
+        }
+
+        if (bestIndex == mSkyline.size())
+            return false;
+
+        x = mSkyline[bestIndex].x;
+        mSkyline.insert(mSkyline.begin() + ptrdiff_t(bestIndex), Segment{ x, bestBottom, width });
+
+        // Segments covered by the new one are shortened or removed.
+        size_t right = x + width;
+        size_t next = bestIndex + 1;
+        while (next < mSkyline.size() && mSkyline[next].x < right) {
+            Segment& segment = mSkyline[next];
+            size_t segmentRight = segment.x + segment.width;
+            if (segmentRight <= right) {
+                mSkyline.erase(mSkyline.begin() + ptrdiff_t(next));
+                continue;
+            }
+            segment.width = segmentRight - right;
+            segment.x = right;
+            break;
+        }
+
+        // Neighbours of the same height are merged.
+        for (size_t i = 1; i < mSkyline.size(); ) {
+            if (mSkyline[i - 1].y == mSkyline[i].y) {
+                mSkyline[i - 1].width += mSkyline[i].width;
+                mSkyline.erase(mSkyline.begin() + ptrdiff_t(i));
+            } else
+                ++i;
+        }
+
+        mUsedArea += width * height;
+        return true;
+    }
+}
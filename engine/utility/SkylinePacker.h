@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include <vector>
+#include <cstddef>
+
+namespace B3D
+{
+    // Packs rectangles into a fixed area by tracking the top edge ("skyline") of the rectangles placed so far. Each
+    // rectangle goes where its bottom edge ends up lowest (the bottom-left heuristic), which wastes little space for
+    // the similarly sized images of texture atlases. Rectangles can not be removed individually; reset() the packer
+    // and insert the remaining ones again to reclaim space.
+    class SkylinePacker
+    {
+    public:
+        SkylinePacker();
+        SkylinePacker(size_t width, size_t height);
+
+        size_t width() const { return mWidth; }
+        size_t height() const { return mHeight; }
+        size_t usedArea() const { return mUsedArea; }
+
+        void reset(size_t width, size_t height);
+
+        // Enlarges the area without moving any of the rectangles already placed.
+        void grow(size_t width, size_t height);
+
+        // Returns false if there is no room for the rectangle.
+        bool insert(size_t width, size_t height, size_t& x, size_t& y);
+
+    private:
+        struct Segment
+        {
+            size_t x;
+            size_t y;
+            size_t width;
+        };
+
+        std::vector<Segment> mSkyline;
+        size_t mWidth;
+        size_t mHeight;
+        size_t mUsedArea;
+
+        bool fits(size_t index, size_t width, size_t height, size_t& y) const;
+    };
+}
@@ -21,6 +21,9 @@
  */
 #include "StringUtils.h"
 #include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <cassert>
 
 namespace B3D
 {
@@ -35,4 +38,69 @@ namespace B3D
         const char* p = string.c_str() + stringLength - whatLength;
         return !memcmp(p, what.data(), whatLength);
     }
+
+    bool StringUtils::parseFloat(StringView string, float& value)
+    {
+        if (string.empty())
+            return false;
+
+        char buffer[64];
+        std::string longString;
+        const char* p = buffer;
+        if (string.size() < sizeof(buffer)) {
+            memcpy(buffer, string.data(), string.size());
+            buffer[string.size()] = 0;
+        } else {
+            longString = string.toString();
+            p = longString.c_str();
+        }
+
+        char* end = nullptr;
+        errno = 0;
+        value = strtof(p, &end);
+
+        return errno == 0 && end == p + string.size();
+    }
+
+    uint32_t StringUtils::decodeUtf8(StringView string, size_t& pos)
+    {
+        const uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+        assert(pos < string.size());
+        uint8_t lead = uint8_t(string[pos++]);
+        if (lead < 0x80)
+            return lead;
+
+        size_t length;
+        uint32_t codepoint, minimum;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 1;
+            codepoint = lead & 0x1F;
+            minimum = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 2;
+            codepoint = lead & 0x0F;
+            minimum = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 3;
+            codepoint = lead & 0x07;
+            minimum = 0x10000;
+        } else
+            return REPLACEMENT_CHARACTER;
+
+        if (length > string.size() - pos)
+            return REPLACEMENT_CHARACTER;
+        for (size_t i = 0; i < length; i++) {
+            uint8_t ch = uint8_t(string[pos + i]);
+            if ((ch & 0xC0) != 0x80)
+                return REPLACEMENT_CHARACTER;
+            codepoint = (codepoint << 6) | (ch & 0x3F);
+        }
+
+        if (codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+            return REPLACEMENT_CHARACTER;
+
+        pos += length;
+        return codepoint;
+    }
 }
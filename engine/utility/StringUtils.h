@@ -21,12 +21,21 @@
  */
 
 #pragma once
+#include "engine/utility/StringView.h"
 #include <string>
+#include <cstdint>
 
 namespace B3D
 {
     namespace StringUtils
     {
         bool endsWith(const std::string& string, const std::string& what);
+
+        // Parses the whole view as a floating-point number without allocating a temporary string.
+        bool parseFloat(StringView string, float& value);
+
+        // Decodes the character at the given position and advances the position past it. Malformed sequences
+        // decode as U+FFFD, one byte at a time.
+        uint32_t decodeUtf8(StringView string, size_t& pos);
     }
 }
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include <string>
+#include <cstring>
+#include <cstddef>
+
+namespace B3D
+{
+    // Non-owning reference to a range of characters, e.g. a line within a loaded or memory-mapped file.
+    // The referenced characters are not required to be NUL-terminated and must outlive the view.
+    class StringView
+    {
+    public:
+        static const size_t npos = size_t(-1);
+
+        StringView() : mData(nullptr), mSize(0) {}
+        StringView(const char* data, size_t size) : mData(data), mSize(size) {}
+        StringView(const char* string) : mData(string), mSize(strlen(string)) {}
+        StringView(const std::string& string) : mData(string.data()), mSize(string.length()) {}
+
+        const char* data() const { return mData; }
+        size_t size() const { return mSize; }
+        bool empty() const { return mSize == 0; }
+
+        const char* begin() const { return mData; }
+        const char* end() const { return mData + mSize; }
+
+        char operator[](size_t index) const { return mData[index]; }
+        char front() const { return mData[0]; }
+        char back() const { return mData[mSize - 1]; }
+
+        StringView substr(size_t pos, size_t count = npos) const
+        {
+            if (pos > mSize)
+                pos = mSize;
+            if (count > mSize - pos)
+                count = mSize - pos;
+            return StringView(mData + pos, count);
+        }
+
+        size_t find(char ch, size_t from = 0) const
+        {
+            if (from >= mSize)
+                return npos;
+            const void* p = memchr(mData + from, ch, mSize - from);
+            return (p ? size_t(static_cast<const char*>(p) - mData) : npos);
+        }
+
+        size_t find(StringView what, size_t from = 0) const
+        {
+            if (what.mSize == 0)
+                return (from <= mSize ? from : npos);
+            while (what.mSize <= mSize && from <= mSize - what.mSize) {
+                size_t index = find(what.mData[0], from);
+                if (index == npos || index > mSize - what.mSize)
+                    break;
+                if (!memcmp(mData + index, what.mData, what.mSize))
+                    return index;
+                from = index + 1;
+            }
+            return npos;
+        }
+
+        bool startsWith(StringView prefix) const
+        {
+            return prefix.mSize <= mSize && !memcmp(mData, prefix.mData, prefix.mSize);
+        }
+
+        bool endsWith(StringView suffix) const
+        {
+            return suffix.mSize <= mSize && !memcmp(mData + mSize - suffix.mSize, suffix.mData, suffix.mSize);
+        }
+
+        std::string toString() const { return std::string(mData, mSize); }
+
+        bool operator==(StringView other) const
+        {
+            return mSize == other.mSize && (mSize == 0 || !memcmp(mData, other.mData, mSize));
+        }
+
+        bool operator!=(StringView other) const { return !(*this == other); }
+
+    private:
+        const char* mData;
+        size_t mSize;
+    };
+}
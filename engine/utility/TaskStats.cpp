@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TaskStats.h"
+
+namespace B3D
+{
+    namespace
+    {
+        template <typename TYPE> void atomicMax(std::atomic<TYPE>& value, TYPE newValue)
+        {
+            TYPE current = value.load(std::memory_order_relaxed);
+            while (current < newValue && !value.compare_exchange_weak(current, newValue, std::memory_order_relaxed))
+                ;
+        }
+
+        uint64_t toMicroseconds(TaskStats::Clock::duration duration)
+        {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+            return uint64_t(us > 0 ? us : 0);
+        }
+
+        size_t histogramBucket(uint64_t microseconds)
+        {
+            size_t bucket = 0;
+            while (bucket < TaskQueueStats::HISTOGRAM_BUCKETS - 1 && microseconds >= (uint64_t(1) << bucket))
+                ++bucket;
+            return bucket;
+        }
+    }
+
+    TaskStats::TaskStats()
+        : mEnabled(false)
+    {
+        reset();
+    }
+
+    TaskStats::~TaskStats()
+    {
+    }
+
+    void TaskStats::setEnabled(bool enabled)
+    {
+        mEnabled.store(enabled);
+    }
+
+    void TaskStats::reset()
+    {
+        mMaxQueueDepth.store(0);
+        mTasksExecuted.store(0);
+        mTotalWaitMicroseconds.store(0);
+        mMaxWaitMicroseconds.store(0);
+        mTotalExecutionMicroseconds.store(0);
+        mMaxExecutionMicroseconds.store(0);
+        for (auto& bucket : mExecutionHistogram)
+            bucket.store(0);
+    }
+
+    void TaskStats::recordQueueDepth(size_t depth)
+    {
+        if (enabled())
+            atomicMax(mMaxQueueDepth, depth);
+    }
+
+    TaskStats::Clock::time_point TaskStats::beginRun(Clock::time_point enqueueTime)
+    {
+        Clock::time_point startTime = Clock::now();
+        if (enqueueTime != Clock::time_point()) {
+            uint64_t wait = toMicroseconds(startTime - enqueueTime);
+            mTotalWaitMicroseconds.fetch_add(wait, std::memory_order_relaxed);
+            atomicMax(mMaxWaitMicroseconds, wait);
+        }
+        return startTime;
+    }
+
+    void TaskStats::endRun(Clock::time_point startTime)
+    {
+        uint64_t execution = toMicroseconds(Clock::now() - startTime);
+        mTasksExecuted.fetch_add(1, std::memory_order_relaxed);
+        mTotalExecutionMicroseconds.fetch_add(execution, std::memory_order_relaxed);
+        atomicMax(mMaxExecutionMicroseconds, execution);
+        mExecutionHistogram[histogramBucket(execution)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    TaskQueueStats TaskStats::snapshot(size_t queueDepth) const
+    {
+        TaskQueueStats stats;
+        stats.queueDepth = queueDepth;
+        stats.maxQueueDepth = mMaxQueueDepth.load(std::memory_order_relaxed);
+        stats.tasksExecuted = mTasksExecuted.load(std::memory_order_relaxed);
+        stats.totalWaitMicroseconds = mTotalWaitMicroseconds.load(std::memory_order_relaxed);
+        stats.maxWaitMicroseconds = mMaxWaitMicroseconds.load(std::memory_order_relaxed);
+        stats.totalExecutionMicroseconds = mTotalExecutionMicroseconds.load(std::memory_order_relaxed);
+        stats.maxExecutionMicroseconds = mMaxExecutionMicroseconds.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < TaskQueueStats::HISTOGRAM_BUCKETS; i++)
+            stats.executionHistogram[i] = mExecutionHistogram[i].load(std::memory_order_relaxed);
+        return stats;
+    }
+}
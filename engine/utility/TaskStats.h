@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/core/IThreadManager.h"
+#include <functional>
+#include <chrono>
+#include <atomic>
+
+namespace B3D
+{
+    class TaskStats
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TaskStats();
+        ~TaskStats();
+
+        bool enabled() const { return mEnabled.load(std::memory_order_relaxed); }
+        void setEnabled(bool enabled);
+
+        void reset();
+
+        // Returns a null time point when statistics are disabled, so that no clock is read.
+        Clock::time_point enqueueTime() const { return (enabled() ? Clock::now() : Clock::time_point()); }
+
+        void recordQueueDepth(size_t depth);
+
+        template <typename ACTION> void run(ACTION&& action, Clock::time_point enqueueTime)
+        {
+            if (!enabled()) {
+                action();
+                return;
+            }
+
+            Clock::time_point startTime = beginRun(enqueueTime);
+            action();
+            endRun(startTime);
+        }
+
+        TaskQueueStats snapshot(size_t queueDepth) const;
+
+    private:
+        std::atomic<bool> mEnabled;
+        std::atomic<size_t> mMaxQueueDepth;
+        std::atomic<uint64_t> mTasksExecuted;
+        std::atomic<uint64_t> mTotalWaitMicroseconds;
+        std::atomic<uint64_t> mMaxWaitMicroseconds;
+        std::atomic<uint64_t> mTotalExecutionMicroseconds;
+        std::atomic<uint64_t> mMaxExecutionMicroseconds;
+        std::atomic<uint64_t> mExecutionHistogram[TaskQueueStats::HISTOGRAM_BUCKETS];
+
+        Clock::time_point beginRun(Clock::time_point enqueueTime);
+        void endRun(Clock::time_point startTime);
+
+        B3D_DISABLE_COPY(TaskStats);
+    };
+
+    struct TimedAction
+    {
+        std::function<void()> action;
+        TaskStats::Clock::time_point enqueueTime;
+
+        TimedAction() = default;
+        TimedAction(std::function<void()>&& act, TaskStats::Clock::time_point time)
+            : action(std::move(act)), enqueueTime(time) {}
+    };
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+
+namespace B3D
+{
+    namespace
+    {
+        thread_local const ThreadPool* gCurrentPool;
+        thread_local size_t gCurrentWorker;
+
+        // Idle workers that know about tasks they could not take recheck after this long, doubling every time.
+        const std::chrono::microseconds MIN_RETRY_INTERVAL(20);
+        const std::chrono::microseconds MAX_RETRY_INTERVAL(2000);
+    }
+
+    ThreadPool::ThreadPool(size_t workerCount)
+        : mPendingTasks(0)
+        , mNextWorker(0)
+        , mExitedWorkers(0)
+        , mShouldExit(false)
+    {
+        if (workerCount == 0)
+            workerCount = defaultWorkerCount();
+
+        mWorkers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++)
+            mWorkers.emplace_back(new Worker);
+
+        for (size_t i = 0; i < workerCount; i++)
+            mWorkers[i]->thread = std::thread(std::bind(&ThreadPool::thread, this, i));
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        stop();
+        for (const auto& worker : mWorkers)
+            worker->thread.join();
+    }
+
+    size_t ThreadPool::defaultWorkerCount()
+    {
+        size_t count = std::thread::hardware_concurrency();
+        return (count > 0 ? count : 1);
+    }
+
+    void ThreadPool::stop()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mShouldExit.store(true);
+        mCondition.notify_all();
+    }
+
+    void ThreadPool::perform(const std::function<void()>& action)
+    {
+        perform(TaskPriority::Visible, action);
+    }
+
+    void ThreadPool::perform(std::function<void()>&& action)
+    {
+        perform(TaskPriority::Visible, std::move(action));
+    }
+
+    void ThreadPool::perform(TaskPriority priority, const std::function<void()>& action)
+    {
+        assert(action != nullptr);
+        push(size_t(priority), std::function<void()>(action));
+    }
+
+    void ThreadPool::perform(TaskPriority priority, std::function<void()>&& action)
+    {
+        assert(action != nullptr);
+        push(size_t(priority), std::move(action));
+    }
+
+    void ThreadPool::push(size_t lane, std::function<void()>&& action)
+    {
+        mStats.recordQueueDepth(++mPendingTasks);
+
+        // Tasks spawned by a worker stay on that worker's deque; everything else is spread round-robin.
+        bool spawned = (gCurrentPool == this);
+        size_t index = (spawned ? gCurrentWorker : mNextWorker.fetch_add(1) % mWorkers.size());
+
+        Worker* worker = mWorkers[index].get();
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            auto& queue = (spawned ? worker->queues[lane] : worker->injected[lane]);
+            queue.emplace_back(std::move(action), mStats.enqueueTime());
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCondition.notify_one();
+    }
+
+    bool ThreadPool::pop(size_t index, size_t lane, TimedAction& action)
+    {
+        Worker* worker = mWorkers[index].get();
+        std::lock_guard<std::mutex> lock(worker->mutex);
+
+        auto& queue = worker->queues[lane];
+        if (!queue.empty()) {
+            action = std::move(queue.back());
+            queue.pop_back();
+            return true;
+        }
+
+        auto& injected = worker->injected[lane];
+        if (!injected.empty()) {
+            action = std::move(injected.front());
+            injected.pop_front();
+            return true;
+        }
+
+        return false;
+    }
+
+    bool ThreadPool::steal(size_t index, size_t lane, TimedAction& action)
+    {
+        size_t count = mWorkers.size();
+        for (size_t i = 1; i < count; i++) {
+            Worker* victim = mWorkers[(index + i) % count].get();
+            std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+            if (!lock.owns_lock())
+                continue;
+
+            // The oldest external submissions go first, then the oldest spawned tasks.
+            for (auto* queue : { &victim->injected[lane], &victim->queues[lane] }) {
+                if (!queue->empty()) {
+                    action = std::move(queue->front());
+                    queue->pop_front();
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool ThreadPool::take(size_t index, TimedAction& action)
+    {
+        for (size_t lane = 0; lane < TaskPriorityCount; lane++) {
+            if (pop(index, lane, action) || steal(index, lane, action))
+                return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::thread(size_t index)
+    {
+        gCurrentPool = this;
+        gCurrentWorker = index;
+
+        TimedAction task;
+        std::chrono::microseconds retryInterval = MIN_RETRY_INTERVAL;
+        for (;;) {
+            if (take(index, task)) {
+                --mPendingTasks;
+                mStats.run(task.action, task.enqueueTime);
+                task.action = nullptr;
+                retryInterval = MIN_RETRY_INTERVAL;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (mPendingTasks.load() != 0) {
+                // Either a victim was busy when we tried to steal from it or a task is being pushed right now.
+                // push() notifies once the task is in its queue; a busy victim is only noticed by the timeout.
+                mCondition.wait_for(lock, retryInterval);
+                retryInterval = std::min(retryInterval * 2, MAX_RETRY_INTERVAL);
+                continue;
+            }
+            if (mShouldExit.load())
+                break;
+            mCondition.wait(lock);
+            retryInterval = MIN_RETRY_INTERVAL;
+        }
+
+        gCurrentPool = nullptr;
+        ++mExitedWorkers;
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/core/ITaskGroup.h"
+#include "engine/utility/TaskStats.h"
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+
+namespace B3D
+{
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(size_t workerCount = 0);
+        ~ThreadPool();
+
+        static size_t defaultWorkerCount();
+
+        size_t workerCount() const { return mWorkers.size(); }
+        size_t pendingTaskCount() const { return mPendingTasks.load(); }
+
+        TaskStats& stats() { return mStats; }
+        const TaskStats& stats() const { return mStats; }
+
+        void stop();
+        bool exited() const { return mExitedWorkers.load() == mWorkers.size(); }
+
+        void perform(const std::function<void()>& action);
+        void perform(std::function<void()>&& action);
+        void perform(TaskPriority priority, const std::function<void()>& action);
+        void perform(TaskPriority priority, std::function<void()>&& action);
+
+    private:
+        // Tasks spawned by the worker itself are taken by it in LIFO order, while tasks submitted from other
+        // threads are kept in a separate queue and run in the order they were submitted.
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<TimedAction> queues[TaskPriorityCount];
+            std::deque<TimedAction> injected[TaskPriorityCount];
+            std::thread thread;
+        };
+
+        std::vector<std::unique_ptr<Worker>> mWorkers;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::atomic<size_t> mPendingTasks;
+        std::atomic<size_t> mNextWorker;
+        std::atomic<size_t> mExitedWorkers;
+        std::atomic<bool> mShouldExit;
+        TaskStats mStats;
+
+        void push(size_t lane, std::function<void()>&& action);
+        bool pop(size_t index, size_t lane, TimedAction& action);
+        bool steal(size_t index, size_t lane, TimedAction& action);
+        bool take(size_t index, TimedAction& action);
+
+        void thread(size_t index);
+
+        B3D_DISABLE_COPY(ThreadPool);
+    };
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "ZipFileSystem.h"
+#include "engine/core/Log.h"
+#include "engine/utility/MemoryFile.h"
+#include <unzip.h>
+#include <zlib.h>
+#include <climits>
+#include <cstring>
+#include <vector>
+
+namespace B3D
+{
+    namespace
+    {
+        const unsigned METHOD_STORED = 0;
+        const unsigned METHOD_DEFLATED = 8;
+        const unsigned FLAG_ENCRYPTED = 1;
+
+        const size_t LOCAL_HEADER_SIZE = 30;
+        const uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+        const size_t MAX_FILE_NAME_LENGTH = 0xFFFF;
+
+        uint16_t readUInt16(const uint8_t* p)
+        {
+            return uint16_t(p[0] | (p[1] << 8));
+        }
+
+        uint32_t readUInt32(const uint8_t* p)
+        {
+            return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        }
+
+        // minizip I/O callbacks over the archive IFile; only used while the central directory is being read.
+
+        voidpf ZCALLBACK archiveOpen(voidpf opaque, const void*, int)
+        {
+            return opaque;
+        }
+
+        voidpf ZCALLBACK archiveOpenDisk(voidpf, voidpf, int, int)
+        {
+            return nullptr;
+        }
+
+        uLong ZCALLBACK archiveRead(voidpf, voidpf stream, void* buffer, uLong size)
+        {
+            return uLong(static_cast<IFile*>(stream)->read(buffer, size_t(size)));
+        }
+
+        uLong ZCALLBACK archiveWrite(voidpf, voidpf, const void*, uLong)
+        {
+            return 0;
+        }
+
+        ZPOS64_T ZCALLBACK archiveTell(voidpf, voidpf stream)
+        {
+            return ZPOS64_T(static_cast<IFile*>(stream)->position());
+        }
+
+        long ZCALLBACK archiveSeek(voidpf, voidpf stream, ZPOS64_T offset, int origin)
+        {
+            IFile* file = static_cast<IFile*>(stream);
+            switch (origin)
+            {
+            case ZLIB_FILEFUNC_SEEK_SET: break;
+            case ZLIB_FILEFUNC_SEEK_CUR: offset += file->position(); break;
+            case ZLIB_FILEFUNC_SEEK_END: offset += file->size(); break;
+            default: return -1;
+            }
+            return (file->seek(uint64_t(offset)) ? 0 : -1);
+        }
+
+        int ZCALLBACK archiveClose(voidpf, voidpf)
+        {
+            return 0;
+        }
+
+        int ZCALLBACK archiveError(voidpf, voidpf)
+        {
+            return 0;
+        }
+    }
+
+    std::shared_ptr<ZipFileSystem> ZipFileSystem::fromFile(const FilePtr& archive)
+    {
+        if (!archive)
+            return nullptr;
+
+        std::shared_ptr<ZipFileSystem> fileSystem(new ZipFileSystem(archive));
+        if (!fileSystem->readDirectory())
+            return nullptr;
+
+        B3D_LOGI("Mounted archive \"" << archive->name() << "\" (" << fileSystem->fileCount() << " files).");
+        return fileSystem;
+    }
+
+    ZipFileSystem::ZipFileSystem(const FilePtr& archive)
+        : mArchive(archive)
+        , mArchiveData(archive->mappedData())
+        , mArchiveSize(archive->size())
+    {
+    }
+
+    ZipFileSystem::~ZipFileSystem()
+    {
+    }
+
+    bool ZipFileSystem::fileExists(const std::string& name)
+    {
+        return mEntries.find(name) != mEntries.end();
+    }
+
+    FilePtr ZipFileSystem::openFile(const std::string& name)
+    {
+        auto it = mEntries.find(name);
+        if (it == mEntries.end()) {
+            B3D_LOGE("Unable to open file \"" << name << "\": file not found in archive \""
+                << mArchive->name() << "\".");
+            return nullptr;
+        }
+
+        const Entry& entry = it->second;
+
+        uint8_t header[LOCAL_HEADER_SIZE];
+        if (!readArchive(entry.localHeaderOffset, header, sizeof(header))
+                || readUInt32(header) != LOCAL_HEADER_SIGNATURE) {
+            B3D_LOGE("Unable to open file \"" << name << "\": archive \"" << mArchive->name() << "\" is corrupt.");
+            return nullptr;
+        }
+
+        uint64_t dataOffset = entry.localHeaderOffset + LOCAL_HEADER_SIZE + readUInt16(header + 26)
+            + readUInt16(header + 28);
+        if (dataOffset > mArchiveSize || entry.compressedSize > mArchiveSize - dataOffset
+                || entry.compressedSize > UINT_MAX || entry.uncompressedSize > UINT_MAX) {
+            B3D_LOGE("Unable to open file \"" << name << "\": archive \"" << mArchive->name() << "\" is corrupt.");
+            return nullptr;
+        }
+
+        switch (entry.compressionMethod)
+        {
+        case METHOD_STORED:
+            // Only the compressed size has been checked against the archive
+            if (entry.uncompressedSize != entry.compressedSize) {
+                B3D_LOGE("Unable to open file \"" << name << "\": archive \"" << mArchive->name()
+                    << "\" is corrupt.");
+                return nullptr;
+            }
+            if (mArchiveData) {
+                return std::make_shared<MemoryFile>(name, mArchiveData + dataOffset, size_t(entry.compressedSize),
+                    shared_from_this());
+            } else {
+                std::vector<uint8_t> data(size_t(entry.compressedSize));
+                if (!readArchive(dataOffset, data.data(), data.size())) {
+                    B3D_LOGE("Unable to read file \"" << name << "\" from archive \"" << mArchive->name() << "\".");
+                    return nullptr;
+                }
+                return std::make_shared<MemoryFile>(name, std::move(data));
+            }
+
+        case METHOD_DEFLATED: {
+            std::vector<uint8_t> compressedData;
+            const uint8_t* compressed = nullptr;
+            if (mArchiveData)
+                compressed = mArchiveData + dataOffset;
+            else {
+                compressedData.resize(size_t(entry.compressedSize));
+                if (!readArchive(dataOffset, compressedData.data(), compressedData.size())) {
+                    B3D_LOGE("Unable to read file \"" << name << "\" from archive \"" << mArchive->name() << "\".");
+                    return nullptr;
+                }
+                compressed = compressedData.data();
+            }
+
+            std::vector<uint8_t> data(size_t(entry.uncompressedSize));
+            if (data.empty())
+                return std::make_shared<MemoryFile>(name, std::move(data));
+
+            z_stream stream;
+            memset(&stream, 0, sizeof(stream));
+            if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+                B3D_LOGE("Unable to decompress file \"" << name << "\": " << (stream.msg ? stream.msg : "zlib error."));
+                return nullptr;
+            }
+
+            stream.next_in = const_cast<Bytef*>(compressed);
+            stream.avail_in = uInt(entry.compressedSize);
+            stream.next_out = data.data();
+            stream.avail_out = uInt(data.size());
+
+            int result = inflate(&stream, Z_FINISH);
+            bool success = (result == Z_STREAM_END && stream.total_out == data.size());
+            if (!success) {
+                B3D_LOGE("Unable to decompress file \"" << name << "\" from archive \"" << mArchive->name()
+                    << "\": " << (stream.msg ? stream.msg : "unexpected end of stream."));
+            }
+
+            inflateEnd(&stream);
+            return (success ? std::make_shared<MemoryFile>(name, std::move(data)) : nullptr);
+        }
+
+        default:
+            B3D_LOGE("Unable to open file \"" << name << "\": unsupported compression method ("
+                << entry.compressionMethod << ") in archive \"" << mArchive->name() << "\".");
+            return nullptr;
+        }
+    }
+
+    bool ZipFileSystem::readDirectory()
+    {
+        zlib_filefunc64_def functions;
+        functions.zopen64_file = archiveOpen;
+        functions.zopendisk64_file = archiveOpenDisk;
+        functions.zread_file = archiveRead;
+        functions.zwrite_file = archiveWrite;
+        functions.ztell64_file = archiveTell;
+        functions.zseek64_file = archiveSeek;
+        functions.zclose_file = archiveClose;
+        functions.zerror_file = archiveError;
+        functions.opaque = mArchive.get();
+
+        unzFile zip = unzOpen2_64(mArchive->name().c_str(), &functions);
+        if (!zip) {
+            B3D_LOGE("Unable to open archive \"" << mArchive->name() << "\": file is not a valid ZIP archive.");
+            return false;
+        }
+
+        unz_global_info64 globalInfo;
+        if (unzGetGlobalInfo64(zip, &globalInfo) == UNZ_OK)
+            mEntries.reserve(size_t(globalInfo.number_entry));
+
+        std::vector<char> fileName(MAX_FILE_NAME_LENGTH + 1);
+        unz_file_info64 info;
+
+        int result = unzGoToFirstFile2(zip, &info, fileName.data(), uLong(fileName.size()), nullptr, 0, nullptr, 0);
+        while (result == UNZ_OK) {
+            std::string name(fileName.data(), size_t(info.size_filename));
+            if (!name.empty() && name[name.length() - 1] != '/') {
+                if (info.flag & FLAG_ENCRYPTED)
+                    B3D_LOGW("Ignoring encrypted file \"" << name << "\" in archive \"" << mArchive->name() << "\".");
+                else {
+                    Entry& entry = mEntries[name];
+                    entry.localHeaderOffset = uint64_t(info.disk_offset);
+                    entry.compressedSize = uint64_t(info.compressed_size);
+                    entry.uncompressedSize = uint64_t(info.uncompressed_size);
+                    entry.compressionMethod = unsigned(info.compression_method);
+                }
+            }
+            result = unzGoToNextFile2(zip, &info, fileName.data(), uLong(fileName.size()), nullptr, 0, nullptr, 0);
+        }
+
+        unzClose(zip);
+
+        if (result != UNZ_END_OF_LIST_OF_FILE) {
+            B3D_LOGE("Unable to read directory of archive \"" << mArchive->name() << "\" (error " << result << ").");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool ZipFileSystem::readArchive(uint64_t offset, void* buffer, size_t size)
+    {
+        if (offset > mArchiveSize || size > mArchiveSize - offset)
+            return false;
+
+        if (mArchiveData) {
+            memcpy(buffer, mArchiveData + offset, size);
+            return true;
+        }
+
+        std::lock_guard<decltype(mArchiveMutex)> lock(mArchiveMutex);
+        return mArchive->seek(offset) && mArchive->read(buffer, size) == size;
+    }
+}
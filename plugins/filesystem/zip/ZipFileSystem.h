@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/io/IFileSystem.h"
+#include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <mutex>
+
+namespace B3D
+{
+    // Read-only file system over a ZIP archive. The central directory is read once into a hash index, so
+    // lookups never touch the archive. Stored entries of a memory-mapped archive are returned as views of the
+    // mapping; deflated entries are decompressed on the calling thread.
+    class ZipFileSystem : public IFileSystem, public std::enable_shared_from_this<ZipFileSystem>
+    {
+    public:
+        // Returns nullptr if the archive can't be read.
+        static std::shared_ptr<ZipFileSystem> fromFile(const FilePtr& archive);
+
+        ~ZipFileSystem();
+
+        size_t fileCount() const { return mEntries.size(); }
+
+        bool fileExists(const std::string& name) override;
+        FilePtr openFile(const std::string& name) override;
+
+    private:
+        struct Entry
+        {
+            uint64_t localHeaderOffset;
+            uint64_t compressedSize;
+            uint64_t uncompressedSize;
+            unsigned compressionMethod;
+        };
+
+        FilePtr mArchive;
+        const uint8_t* mArchiveData;
+        uint64_t mArchiveSize;
+        std::mutex mArchiveMutex;
+        std::unordered_map<std::string, Entry> mEntries;
+
+        explicit ZipFileSystem(const FilePtr& archive);
+
+        bool readDirectory();
+        bool readArchive(uint64_t offset, void* buffer, size_t size);
+
+        B3D_DISABLE_COPY(ZipFileSystem);
+    };
+}
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "BMFontLoader.h"
+#include "engine/core/Log.h"
+#include "engine/image/Image.h"
+#include "engine/utility/FileUtils.h"
+#include "engine/utility/StringUtils.h"
+#include <unordered_map>
+#include <cstring>
+#include <cstdlib>
+
+namespace B3D
+{
+    namespace
+    {
+        class BMFontGlyphSource : public IGlyphSource
+        {
+        public:
+            struct Char
+            {
+                GlyphMetrics metrics;
+                size_t x;
+                size_t y;
+                size_t page;
+            };
+
+            float mLineHeight = 0.0f;
+            float mBaseline = 0.0f;
+            std::vector<ImagePtr> mPages;
+            std::unordered_map<uint32_t, Char> mChars;
+            std::unordered_map<uint64_t, float> mKerning;
+
+            float lineHeight() const override { return mLineHeight; }
+            float baseline() const override { return mBaseline; }
+
+            bool glyphMetrics(uint32_t codepoint, GlyphMetrics& metrics) override
+            {
+                auto it = mChars.find(codepoint);
+                if (it == mChars.end())
+                    return false;
+                metrics = it->second.metrics;
+                return true;
+            }
+
+            float kerning(uint32_t first, uint32_t second) override
+            {
+                auto it = mKerning.find(kerningKey(first, second));
+                return (it != mKerning.end() ? it->second : 0.0f);
+            }
+
+            ImagePtr rasterizeGlyph(uint32_t codepoint) override
+            {
+                auto it = mChars.find(codepoint);
+                if (it == mChars.end())
+                    return nullptr;
+
+                const Char& ch = it->second;
+                const IImage& page = *mPages[ch.page];
+                size_t width = size_t(ch.metrics.size.x);
+                size_t height = size_t(ch.metrics.size.y);
+
+                PixelFormat format = page.pixelFormat();
+                size_t pixelSize = bytesPerPixel(format);
+                auto image = std::make_shared<Image>(format, width, height);
+                image->setDataSize(width * height * pixelSize);
+                for (size_t row = 0; row < height; row++) {
+                    memcpy(image->data() + row * width * pixelSize,
+                        page.data() + ((ch.y + row) * page.width() + ch.x) * pixelSize, width * pixelSize);
+                }
+
+                return image;
+            }
+
+            static uint64_t kerningKey(uint32_t first, uint32_t second)
+            {
+                return (uint64_t(first) << 32) | second;
+            }
+        };
+
+        // Lines look like: tag key=value key="quoted value" ...
+        class Line
+        {
+        public:
+            explicit Line(const std::string& line)
+            {
+                StringView view(line);
+                size_t pos = skipSpaces(view, 0);
+                size_t end = skipWord(view, pos);
+                mTag = view.substr(pos, end - pos);
+
+                pos = skipSpaces(view, end);
+                while (pos < view.size()) {
+                    size_t equals = view.find('=', pos);
+                    if (equals == StringView::npos)
+                        break;
+                    StringView key = view.substr(pos, equals - pos);
+
+                    StringView value;
+                    pos = equals + 1;
+                    if (pos < view.size() && view[pos] == '"') {
+                        size_t quote = view.find('"', pos + 1);
+                        if (quote == StringView::npos)
+                            quote = view.size();
+                        value = view.substr(pos + 1, quote - pos - 1);
+                        pos = quote + 1;
+                    } else {
+                        end = skipWord(view, pos);
+                        value = view.substr(pos, end - pos);
+                        pos = end;
+                    }
+
+                    mValues.emplace_back(key, value);
+                    pos = skipSpaces(view, pos);
+                }
+            }
+
+            StringView tag() const { return mTag; }
+
+            std::string string(const char* key) const
+            {
+                for (const auto& it : mValues) {
+                    if (it.first == key)
+                        return it.second.toString();
+                }
+                return std::string();
+            }
+
+            long integer(const char* key, long def = 0) const
+            {
+                for (const auto& it : mValues) {
+                    if (it.first == key) {
+                        std::string value = it.second.toString();
+                        char* end = nullptr;
+                        long result = strtol(value.c_str(), &end, 10);
+                        return (!value.empty() && *end == 0 ? result : def);
+                    }
+                }
+                return def;
+            }
+
+        private:
+            StringView mTag;
+            std::vector<std::pair<StringView, StringView>> mValues;
+
+            static size_t skipSpaces(StringView view, size_t pos)
+            {
+                while (pos < view.size() && (view[pos] == ' ' || view[pos] == '\t' || view[pos] == '\r'))
+                    ++pos;
+                return pos;
+            }
+
+            static size_t skipWord(StringView view, size_t pos)
+            {
+                while (pos < view.size() && view[pos] != ' ' && view[pos] != '\t' && view[pos] != '\r')
+                    ++pos;
+                return pos;
+            }
+        };
+    }
+
+    bool BMFontLoader::canLoadFont(IFile* file)
+    {
+        return file && StringUtils::endsWith(file->name(), ".fnt");
+    }
+
+    bool BMFontLoader::loadFont(IFile* file, Font* font)
+    {
+        if (!file)
+            return false;
+
+        std::unique_ptr<BMFontGlyphSource> source(new BMFontGlyphSource);
+        std::vector<std::string> pageFiles;
+
+        for (const auto& text : FileUtils::loadFileLines(file, false)) {
+            Line line(text);
+            if (line.tag() == "common") {
+                source->mLineHeight = float(line.integer("lineHeight"));
+                source->mBaseline = float(line.integer("base"));
+                if (line.integer("packed") != 0) {
+                    B3D_LOGE("Font \"" << file->name() << "\" has glyphs packed into color channels, "
+                        "which is not supported.");
+                    return false;
+                }
+            } else if (line.tag() == "page") {
+                long id = line.integer("id", -1);
+                if (id < 0 || id > 255) {
+                    B3D_LOGE("Invalid page id in font \"" << file->name() << "\".");
+                    return false;
+                }
+                if (size_t(id) >= pageFiles.size())
+                    pageFiles.resize(size_t(id) + 1);
+                pageFiles[size_t(id)] = FileUtils::makeFullPath(line.string("file"), file->name());
+            } else if (line.tag() == "char") {
+                long id = line.integer("id", -1);
+                if (id < 0)
+                    continue;
+
+                BMFontGlyphSource::Char ch;
+                ch.x = size_t(std::max(line.integer("x"), 0L));
+                ch.y = size_t(std::max(line.integer("y"), 0L));
+                ch.page = size_t(std::max(line.integer("page"), 0L));
+                ch.metrics.offset = glm::vec2(float(line.integer("xoffset")), float(line.integer("yoffset")));
+                ch.metrics.size = glm::vec2(float(std::max(line.integer("width"), 0L)),
+                    float(std::max(line.integer("height"), 0L)));
+                ch.metrics.advance = float(line.integer("xadvance"));
+                source->mChars[uint32_t(id)] = ch;
+            } else if (line.tag() == "kerning") {
+                uint32_t first = uint32_t(line.integer("first"));
+                uint32_t second = uint32_t(line.integer("second"));
+                source->mKerning[BMFontGlyphSource::kerningKey(first, second)] = float(line.integer("amount"));
+            }
+        }
+
+        for (const auto& pageFile : pageFiles) {
+            ImagePtr page = (pageFile.empty() ? nullptr : Image::fromFile(pageFile));
+            if (!page || !page->data() || isCompressed(page->pixelFormat())
+                    || page->pixelFormat() == PixelFormat::Invalid) {
+                B3D_LOGE("Unable to load page \"" << pageFile << "\" of font \"" << file->name() << "\".");
+                return false;
+            }
+            source->mPages.emplace_back(std::move(page));
+        }
+
+        // Glyphs that reach outside of their page are dropped rather than read out of bounds
+        for (auto it = source->mChars.begin(); it != source->mChars.end(); ) {
+            const auto& ch = it->second;
+            bool valid = ch.page < source->mPages.size()
+                && ch.x + size_t(ch.metrics.size.x) <= source->mPages[ch.page]->width()
+                && ch.y + size_t(ch.metrics.size.y) <= source->mPages[ch.page]->height();
+            if (valid)
+                ++it;
+            else {
+                B3D_LOGW("Glyph " << it->first << " of font \"" << file->name() << "\" is outside of its page.");
+                it = source->mChars.erase(it);
+            }
+        }
+
+        font->setGlyphSource(std::move(source));
+        return true;
+    }
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "DdsImageLoader.h"
+#include "engine/image/Image.h"
+#include "engine/image/PixelConversion.h"
+#include "engine/core/Log.h"
+#include <algorithm>
+#include <cstring>
+
+namespace B3D
+{
+    static const uint8_t DDS_MAGIC[4] = { 'D', 'D', 'S', ' ' };
+    static const size_t DDS_HEADER_SIZE = 124;
+    static const size_t DDS_HEADER_DXT10_SIZE = 20;
+    static const size_t MAX_DIMENSION = 16384;
+    static const size_t MAX_MIP_LEVELS = 15;
+
+    static const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    static const uint32_t DDSD_DEPTH = 0x800000;
+    static const uint32_t DDPF_ALPHAPIXELS = 0x1;
+    static const uint32_t DDPF_FOURCC = 0x4;
+    static const uint32_t DDPF_RGB = 0x40;
+    static const uint32_t DDPF_LUMINANCE = 0x20000;
+    static const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+    static const uint32_t DDSCAPS2_VOLUME = 0x200000;
+    static const uint32_t D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+    static const uint32_t D3D10_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+    namespace
+    {
+        // Layout of DDS_HEADER and DDS_PIXELFORMAT, flattened into 32-bit fields.
+        enum HeaderField
+        {
+            Flags = 1,
+            Height = 2,
+            Width = 3,
+            Depth = 5,
+            MipMapCount = 6,
+            PixelFormatFlags = 19,
+            FourCC = 20,
+            RGBBitCount = 21,
+            RedMask = 22,
+            GreenMask = 23,
+            BlueMask = 24,
+            AlphaMask = 25,
+            Caps2 = 27,
+            FieldCount = DDS_HEADER_SIZE / 4
+        };
+
+        // What to do with pixels after reading them.
+        enum class Fixup
+        {
+            None,
+            SwapRedBlue,
+            SwapRedBlueOpaque,
+            Opaque,
+        };
+    }
+
+    static uint32_t readLE32(const uint8_t* p)
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    static uint32_t makeFourCC(char a, char b, char c, char d)
+    {
+        return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16)
+            | (uint32_t(uint8_t(d)) << 24);
+    }
+
+    static PixelFormat formatFromDXGI(uint32_t dxgiFormat, Fixup& fixup)
+    {
+        switch (dxgiFormat)
+        {
+        case 28: return PixelFormat::RGBA32;                                    // DXGI_FORMAT_R8G8B8A8_UNORM
+        case 29: return PixelFormat::RGBA32;                                    // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+        case 61: return PixelFormat::Luminance8;                                // DXGI_FORMAT_R8_UNORM
+        case 71: return PixelFormat::BC1;                                       // DXGI_FORMAT_BC1_UNORM
+        case 72: return PixelFormat::BC1;                                       // DXGI_FORMAT_BC1_UNORM_SRGB
+        case 74: return PixelFormat::BC2;                                       // DXGI_FORMAT_BC2_UNORM
+        case 75: return PixelFormat::BC2;                                       // DXGI_FORMAT_BC2_UNORM_SRGB
+        case 77: return PixelFormat::BC3;                                       // DXGI_FORMAT_BC3_UNORM
+        case 78: return PixelFormat::BC3;                                       // DXGI_FORMAT_BC3_UNORM_SRGB
+        case 85: return PixelFormat::RGB565;                                    // DXGI_FORMAT_B5G6R5_UNORM
+        case 87: fixup = Fixup::SwapRedBlue; return PixelFormat::RGBA32;        // DXGI_FORMAT_B8G8R8A8_UNORM
+        case 88: fixup = Fixup::SwapRedBlueOpaque; return PixelFormat::RGBA32;  // DXGI_FORMAT_B8G8R8X8_UNORM
+        case 91: fixup = Fixup::SwapRedBlue; return PixelFormat::RGBA32;        // DXGI_FORMAT_B8G8R8A8_UNORM_SRGB
+        default: return PixelFormat::Invalid;
+        }
+    }
+
+    static PixelFormat formatFromMasks(const uint32_t* header, Fixup& fixup)
+    {
+        uint32_t flags = header[PixelFormatFlags];
+        uint32_t bitCount = header[RGBBitCount];
+        uint32_t redMask = header[RedMask];
+        uint32_t greenMask = header[GreenMask];
+        uint32_t blueMask = header[BlueMask];
+        uint32_t alphaMask = (flags & DDPF_ALPHAPIXELS ? header[AlphaMask] : 0);
+
+        if (flags & DDPF_LUMINANCE) {
+            if (bitCount == 8 && redMask == 0xFF && alphaMask == 0)
+                return PixelFormat::Luminance8;
+            if (bitCount == 16 && redMask == 0xFF && alphaMask == 0xFF00)
+                return PixelFormat::LuminanceAlpha16;
+            return PixelFormat::Invalid;
+        }
+
+        if (!(flags & DDPF_RGB))
+            return PixelFormat::Invalid;
+
+        switch (bitCount)
+        {
+        case 16:
+            if (redMask == 0xF800 && greenMask == 0x07E0 && blueMask == 0x001F && alphaMask == 0)
+                return PixelFormat::RGB565;
+            return PixelFormat::Invalid;
+
+        case 24:
+            if (greenMask != 0x00FF00 || alphaMask != 0)
+                return PixelFormat::Invalid;
+            if (redMask == 0x0000FF && blueMask == 0xFF0000)
+                return PixelFormat::RGB24;
+            if (redMask == 0xFF0000 && blueMask == 0x0000FF) {
+                fixup = Fixup::SwapRedBlue;
+                return PixelFormat::RGB24;
+            }
+            return PixelFormat::Invalid;
+
+        case 32:
+            if (greenMask != 0x0000FF00 || (alphaMask != 0 && alphaMask != 0xFF000000))
+                return PixelFormat::Invalid;
+            if (redMask == 0x000000FF && blueMask == 0x00FF0000) {
+                fixup = (alphaMask ? Fixup::None : Fixup::Opaque);
+                return PixelFormat::RGBA32;
+            }
+            if (redMask == 0x00FF0000 && blueMask == 0x000000FF) {
+                fixup = (alphaMask ? Fixup::SwapRedBlue : Fixup::SwapRedBlueOpaque);
+                return PixelFormat::RGBA32;
+            }
+            return PixelFormat::Invalid;
+
+        default:
+            return PixelFormat::Invalid;
+        }
+    }
+
+    static void applyFixup(Image& image, Fixup fixup)
+    {
+        uint8_t* pixels = image.data();
+        size_t count = image.width() * image.height();
+        if (fixup == Fixup::SwapRedBlue || fixup == Fixup::SwapRedBlueOpaque)
+            PixelConversion::swapRedBlue(pixels, image.pixelFormat(), count);
+        if (fixup == Fixup::Opaque || fixup == Fixup::SwapRedBlueOpaque) {
+            for (size_t i = 0; i < count; i++)
+                pixels[i * 4 + 3] = 0xFF;
+        }
+    }
+
+    bool DdsImageLoader::canLoadImage(IFile* file)
+    {
+        uint64_t pos = file->position();
+        uint8_t buf[sizeof(DDS_MAGIC)];
+        if (file->read(buf, sizeof(buf)) != sizeof(buf) || memcmp(buf, DDS_MAGIC, sizeof(buf)) != 0) {
+            file->seek(pos);
+            return false;
+        }
+        return true;
+    }
+
+    ImagePtr DdsImageLoader::loadImage(IFile* file, const ImageLoadHint&)
+    {
+        if (!file)
+            return std::make_shared<Image>();
+
+        uint8_t buf[DDS_HEADER_SIZE];
+        if (file->read(buf, sizeof(buf)) != sizeof(buf)) {
+            B3D_LOGE("Unable to decode DDS file \"" << file->name() << "\": unexpected end of stream.");
+            return std::make_shared<Image>();
+        }
+
+        uint32_t header[FieldCount];
+        for (size_t i = 0; i < FieldCount; i++)
+            header[i] = readLE32(buf + i * 4);
+
+        if (header[0] != DDS_HEADER_SIZE) {
+            B3D_LOGE("Unable to decode DDS file \"" << file->name() << "\": invalid header size.");
+            return std::make_shared<Image>();
+        }
+
+        PixelFormat format = PixelFormat::Invalid;
+        Fixup fixup = Fixup::None;
+        bool is2D = !(header[Caps2] & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))
+            && !((header[Flags] & DDSD_DEPTH) && header[Depth] > 1);
+
+        uint32_t fourCC = (header[PixelFormatFlags] & DDPF_FOURCC ? header[FourCC] : 0);
+        if (fourCC == makeFourCC('D', 'X', '1', '0')) {
+            uint8_t ext[DDS_HEADER_DXT10_SIZE];
+            if (file->read(ext, sizeof(ext)) != sizeof(ext)) {
+                B3D_LOGE("Unable to decode DDS file \"" << file->name() << "\": unexpected end of stream.");
+                return std::make_shared<Image>();
+            }
+            format = formatFromDXGI(readLE32(ext), fixup);
+            if (readLE32(ext + 4) != D3D10_RESOURCE_DIMENSION_TEXTURE2D
+                    || (readLE32(ext + 8) & D3D10_RESOURCE_MISC_TEXTURECUBE) || readLE32(ext + 12) > 1)
+                is2D = false;
+        } else if (fourCC == makeFourCC('D', 'X', 'T', '1'))
+            format = PixelFormat::BC1;
+        else if (fourCC == makeFourCC('D', 'X', 'T', '3'))
+            format = PixelFormat::BC2;
+        else if (fourCC == makeFourCC('D', 'X', 'T', '5'))
+            format = PixelFormat::BC3;
+        else if (fourCC == 0)
+            format = formatFromMasks(header, fixup);
+
+        // Cube maps, texture arrays and volume textures are not supported by the engine.
+        if (!is2D) {
+            B3D_LOGE("Unable to decode DDS file \"" << file->name() << "\": only 2D textures are supported.");
+            return std::make_shared<Image>();
+        }
+        if (format == PixelFormat::Invalid) {
+            B3D_LOGE("Unable to decode DDS file \"" << file->name() << "\": unsupported pixel format.");
+            return std::make_shared<Image>();
+        }
+
+        size_t width = header[Width];
+        size_t height = header[Height];
+        if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+            B3D_LOGE("Unable to decode DDS file \"" << file->name() << "\": invalid image dimensions.");
+            return std::make_shared<Image>();
+        }
+
+        size_t levelCount = 1;
+        if (header[Flags] & DDSD_MIPMAPCOUNT)
+            levelCount = std::max<size_t>(header[MipMapCount], 1);
+        if (levelCount > MAX_MIP_LEVELS) {
+            B3D_LOGE("Unable to decode DDS file \"" << file->name() << "\": invalid number of mipmap levels.");
+            return std::make_shared<Image>();
+        }
+
+        // Levels are stored one after another without padding; rows of uncompressed levels are tightly packed.
+        std::shared_ptr<Image> image;
+        for (size_t level = 0; level < levelCount; level++) {
+            size_t levelWidth = std::max<size_t>(width >> level, 1);
+            size_t levelHeight = std::max<size_t>(height >> level, 1);
+            size_t dataSize = imageDataSize(format, levelWidth, levelHeight);
+
+            auto mip = std::make_shared<Image>(format, levelWidth, levelHeight);
+            mip->setDataSize(dataSize);
+            if (file->read(mip->data(), dataSize) != dataSize) {
+                B3D_LOGE("Unable to decode DDS file \"" << file->name() << "\": unexpected end of stream.");
+                return std::make_shared<Image>();
+            }
+
+            if (fixup != Fixup::None)
+                applyFixup(*mip, fixup);
+
+            if (!image)
+                image = mip;
+            else
+                image->addMipLevel(mip);
+        }
+
+        return image;
+    }
+}
@@ -21,10 +21,17 @@
  */
 #include "JpegImageLoader.h"
 #include "engine/core/Log.h"
+#include "engine/core/Services.h"
+#include "engine/utility/ParallelUtils.h"
 #include "engine/utility/StringUtils.h"
 #include <jerror.h>
 #include <jpeglib.h>
 #include <setjmp.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <cassert>
 
 #ifdef _MSC_VER
 #pragma warning(disable:4611)   // interaction between _strjmp and C++ object destruction is non-portable
@@ -45,6 +52,7 @@ namespace B3D
             IFile* file;
             JOCTET* buffer;
             bool atStart;
+            bool mapped;
         };
 
         static const size_t INPUT_BUFFER_SIZE = 4096;
@@ -69,14 +77,15 @@ namespace B3D
         static void jpegInitSource(j_decompress_ptr cinfo)
         {
             JpegSourceMgr* src = reinterpret_cast<JpegSourceMgr*>(cinfo->src);
-            src->atStart = true;
+            src->atStart = (src->bytes_in_buffer == 0);
         }
 
         static boolean jpegFillInputBuffer(j_decompress_ptr cinfo)
         {
             JpegSourceMgr* src = reinterpret_cast<JpegSourceMgr*>(cinfo->src);
 
-            size_t bytesRead = src->file->read(src->buffer, INPUT_BUFFER_SIZE);
+            // Mapped files are handed to the decoder as a whole, so there is nothing more to read.
+            size_t bytesRead = (src->mapped ? 0 : src->file->read(src->buffer, INPUT_BUFFER_SIZE));
             if (bytesRead == 0) {
                 if (src->atStart)
                     ERREXIT(cinfo, JERR_INPUT_EMPTY);
@@ -113,6 +122,318 @@ namespace B3D
         static void jpegTermSource(j_decompress_ptr)
         {
         }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        // Restart markers split the entropy-coded data of a scan into intervals that do not depend on each other.
+        // When an interval boundary falls on the start of an MCU row, everything below it can be decoded as if it
+        // was a separate image: a copy of the headers with the frame height patched, followed by the intervals of
+        // the band with their restart markers renumbered from zero.
+
+        static const uint8_t JPEG_SOI = 0xD8;
+        static const uint8_t JPEG_SOF0 = 0xC0;
+        static const uint8_t JPEG_SOF1 = 0xC1;
+        static const uint8_t JPEG_SOS = 0xDA;
+
+        static const size_t MIN_PARALLEL_PIXELS = 1024 * 1024;
+        static const size_t MIN_BAND_MCU_ROWS = 4;
+        static const size_t BANDS_PER_THREAD = 2;
+
+        struct JpegBand
+        {
+            size_t firstInterval;
+            size_t lastInterval;
+            size_t imageHeight;
+            size_t firstRow;
+            size_t rowCount;
+        };
+
+        struct JpegBandSet
+        {
+            const jpeg_decompress_struct* cinfo;
+            IFile* file;
+            const uint8_t* data;
+            size_t headerSize;
+            size_t frameHeaderOffset;
+            std::vector<const uint8_t*> intervalBegin;
+            std::vector<const uint8_t*> intervalEnd;
+            std::vector<JpegBand> bands;
+            uint8_t* imageData;
+            size_t rowStride;
+        };
+
+        struct JpegBandSourceMgr : jpeg_source_mgr
+        {
+            const JpegBandSet* set;
+            const JpegBand* band;
+            const std::vector<uint8_t>* header;
+            size_t nextChunk;
+        };
+
+        static const JOCTET JPEG_MARKERS[] = {
+            0xFF, JPEG_RST0, 0xFF, JPEG_RST0 + 1, 0xFF, JPEG_RST0 + 2, 0xFF, JPEG_RST0 + 3,
+            0xFF, JPEG_RST0 + 4, 0xFF, JPEG_RST0 + 5, 0xFF, JPEG_RST0 + 6, 0xFF, JPEG_RST0 + 7,
+            0xFF, JPEG_EOI,
+        };
+
+        static const size_t JPEG_EOI_INDEX = 8;
+
+        static void jpegBandInitSource(j_decompress_ptr)
+        {
+        }
+
+        // Chunks are the patched headers, then the data of each interval followed by a restart marker; the data of
+        // the last interval is followed by an end of image marker instead.
+        static boolean jpegBandFillInputBuffer(j_decompress_ptr cinfo)
+        {
+            JpegBandSourceMgr* src = reinterpret_cast<JpegBandSourceMgr*>(cinfo->src);
+            size_t intervalCount = src->band->lastInterval - src->band->firstInterval;
+
+            do {
+                size_t chunk = src->nextChunk++;
+                if (chunk == 0) {
+                    src->next_input_byte = src->header->data();
+                    src->bytes_in_buffer = src->header->size();
+                } else if (chunk <= 2 * intervalCount && (chunk & 1) != 0) {
+                    size_t interval = src->band->firstInterval + chunk / 2;
+                    src->next_input_byte = src->set->intervalBegin[interval];
+                    src->bytes_in_buffer = size_t(src->set->intervalEnd[interval] - src->set->intervalBegin[interval]);
+                } else {
+                    size_t marker = chunk / 2 - 1;
+                    if (chunk > 2 * intervalCount)
+                        WARNMS(cinfo, JWRN_JPEG_EOF);
+                    marker = (marker + 1 >= intervalCount ? JPEG_EOI_INDEX : marker & 7);
+                    src->next_input_byte = JPEG_MARKERS + 2 * marker;
+                    src->bytes_in_buffer = 2;
+                }
+            } while (src->bytes_in_buffer == 0);
+
+            return TRUE;
+        }
+
+        static size_t findFrameHeader(const uint8_t* data, size_t size)
+        {
+            if (size < 4 || data[0] != 0xFF || data[1] != JPEG_SOI)
+                return 0;
+
+            size_t offset = 2;
+            while (offset + 4 <= size) {
+                if (data[offset] != 0xFF)
+                    return 0;
+
+                uint8_t marker = data[offset + 1];
+                if (marker == 0xFF) {
+                    ++offset;
+                    continue;
+                }
+
+                // Only baseline and extended sequential Huffman frames are split.
+                if (marker == JPEG_SOF0 || marker == JPEG_SOF1)
+                    return (offset + 9 <= size ? offset : 0);
+                if (marker == JPEG_SOS)
+                    return 0;
+
+                offset += 2 + ((size_t(data[offset + 2]) << 8) | data[offset + 3]);
+            }
+
+            return 0;
+        }
+
+        static bool findIntervals(JpegBandSet& set, const uint8_t* begin, const uint8_t* end)
+        {
+            const uint8_t* p = begin;
+            set.intervalBegin.emplace_back(begin);
+            for (;;) {
+                p = reinterpret_cast<const uint8_t*>(memchr(p, 0xFF, size_t(end - p)));
+                if (!p || p + 1 >= end)
+                    return false;
+
+                uint8_t marker = p[1];
+                if (marker == 0 || marker == 0xFF)
+                    ++p;
+                else if (marker >= JPEG_RST0 && marker <= JPEG_RST0 + 7) {
+                    set.intervalEnd.emplace_back(p);
+                    set.intervalBegin.emplace_back(p + 2);
+                    p += 2;
+                } else {
+                    set.intervalEnd.emplace_back(p);
+                    return true;
+                }
+            }
+        }
+
+        static size_t greatestCommonDivisor(size_t a, size_t b)
+        {
+            while (b != 0) {
+                size_t remainder = a % b;
+                a = b;
+                b = remainder;
+            }
+            return a;
+        }
+
+        static bool planBands(JpegBandSet& set, const uint8_t* entropyData, const uint8_t* end, size_t threadCount)
+        {
+            const jpeg_decompress_struct& cinfo = *set.cinfo;
+            if (cinfo.progressive_mode || cinfo.arith_code || cinfo.restart_interval == 0)
+                return false;
+            if (cinfo.comps_in_scan != cinfo.num_components)
+                return false;
+            if (size_t(cinfo.image_width) * cinfo.image_height < MIN_PARALLEL_PIXELS)
+                return false;
+
+            // An MCU of a single component scan is one block of that component.
+            size_t mcuHeight = size_t(cinfo.max_v_samp_factor * cinfo.block_size);
+            if (cinfo.comps_in_scan == 1) {
+                size_t vertical = size_t(cinfo.cur_comp_info[0]->v_samp_factor);
+                if (mcuHeight % vertical != 0)
+                    return false;
+                mcuHeight /= vertical;
+            }
+
+            size_t outputRowsPerMcu = mcuHeight * size_t(cinfo.min_DCT_v_scaled_size);
+            if (outputRowsPerMcu % size_t(cinfo.block_size) != 0)
+                return false;
+            outputRowsPerMcu /= size_t(cinfo.block_size);
+
+            size_t mcusPerRow = cinfo.MCUs_per_row;
+            size_t mcuRows = cinfo.MCU_rows_in_scan;
+            size_t restartInterval = cinfo.restart_interval;
+            size_t intervalCount = (mcusPerRow * mcuRows + restartInterval - 1) / restartInterval;
+
+            set.frameHeaderOffset = findFrameHeader(set.data, set.headerSize);
+            if (set.frameHeaderOffset == 0)
+                return false;
+            if (!findIntervals(set, entropyData, end) || set.intervalEnd.size() != intervalCount)
+                return false;
+
+            // Bands may only start on MCU rows that begin a new interval.
+            size_t rowStep = restartInterval / greatestCommonDivisor(mcusPerRow, restartInterval);
+            size_t bandCount = std::min(threadCount * BANDS_PER_THREAD, mcuRows / std::max(rowStep, MIN_BAND_MCU_ROWS));
+            if (bandCount < 2)
+                return false;
+
+            size_t firstRow = 0;
+            for (size_t i = 1; i <= bandCount && firstRow < mcuRows; i++) {
+                size_t lastRow = mcuRows;
+                if (i < bandCount)
+                    lastRow = std::min((mcuRows * i / bandCount + rowStep - 1) / rowStep * rowStep, mcuRows);
+                if (lastRow <= firstRow)
+                    continue;
+
+                JpegBand band;
+                band.firstInterval = firstRow * mcusPerRow / restartInterval;
+                band.lastInterval = (lastRow == mcuRows ? intervalCount : lastRow * mcusPerRow / restartInterval);
+                band.imageHeight = std::min(lastRow * mcuHeight, size_t(cinfo.image_height)) - firstRow * mcuHeight;
+                band.firstRow = firstRow * outputRowsPerMcu;
+                band.rowCount = (lastRow == mcuRows ? cinfo.output_height - band.firstRow
+                    : (lastRow - firstRow) * outputRowsPerMcu);
+                set.bands.emplace_back(band);
+
+                firstRow = lastRow;
+            }
+
+            return set.bands.size() > 1;
+        }
+
+        static bool decodeBand(const JpegBandSet& set, const JpegBand& band)
+        {
+            const jpeg_decompress_struct& main = *set.cinfo;
+
+            std::vector<uint8_t> header(set.data, set.data + set.headerSize);
+            header[set.frameHeaderOffset + 5] = uint8_t(band.imageHeight >> 8);
+            header[set.frameHeaderOffset + 6] = uint8_t(band.imageHeight);
+
+            jpeg_decompress_struct cinfo;
+            JpegErrorMgr jerr;
+
+            cinfo.err = jpeg_std_error(&jerr);
+            jerr.file = set.file;
+            jerr.error_exit = jpegErrorExit;
+            jerr.output_message = jpegOutputMessage;
+            if (setjmp(jerr.jmpbuf) != 0) {
+                jpeg_destroy_decompress(&cinfo);
+                return false;
+            }
+
+            jpeg_create_decompress(&cinfo);
+
+            JpegBandSourceMgr jsrc;
+            jsrc.set = &set;
+            jsrc.band = &band;
+            jsrc.header = &header;
+            jsrc.nextChunk = 0;
+            jsrc.init_source = jpegBandInitSource;
+            jsrc.fill_input_buffer = jpegBandFillInputBuffer;
+            jsrc.skip_input_data = jpegSkipInputData;
+            jsrc.resync_to_restart = jpeg_resync_to_restart;
+            jsrc.term_source = jpegTermSource;
+            jsrc.bytes_in_buffer = 0;
+            jsrc.next_input_byte = nullptr;
+            cinfo.src = &jsrc;
+
+            jpeg_read_header(&cinfo, TRUE);
+
+            cinfo.out_color_space = main.out_color_space;
+            cinfo.scale_num = main.scale_num;
+            cinfo.scale_denom = main.scale_denom;
+            cinfo.dct_method = main.dct_method;
+            cinfo.do_fancy_upsampling = main.do_fancy_upsampling;
+
+            jpeg_start_decompress(&cinfo);
+
+            if (cinfo.output_width != main.output_width || cinfo.output_height != band.rowCount
+                    || cinfo.output_components != main.output_components) {
+                jpeg_destroy_decompress(&cinfo);
+                return false;
+            }
+
+            uint8_t* imageData = set.imageData + band.firstRow * set.rowStride;
+            while (cinfo.output_scanline < cinfo.output_height) {
+                JSAMPROW line[1] = { reinterpret_cast<JSAMPLE*>(imageData + cinfo.output_scanline * set.rowStride) };
+                jpeg_read_scanlines(&cinfo, line, 1);
+            }
+
+            jpeg_finish_decompress(&cinfo);
+            jpeg_destroy_decompress(&cinfo);
+
+            return true;
+        }
+
+        // The decompressor must have started and must not have read any scanlines yet. Returns false if the image
+        // cannot be split or one of the bands fails to decode; the caller then decodes it serially.
+        static bool decodeInBands(const jpeg_decompress_struct& cinfo, IFile* file, const uint8_t* data, size_t size,
+            uint8_t* imageData, size_t rowStride)
+        {
+            const auto& threadManager = Services::threadManager();
+            size_t threadCount = (threadManager ? threadManager->backgroundThreadCount() : 0);
+            if (threadCount == 0)
+                return false;
+
+            const uint8_t* entropyData = reinterpret_cast<const uint8_t*>(cinfo.src->next_input_byte);
+            if (entropyData < data || entropyData > data + size)
+                return false;
+
+            JpegBandSet set;
+            set.cinfo = &cinfo;
+            set.file = file;
+            set.data = data;
+            set.headerSize = size_t(entropyData - data);
+            set.imageData = imageData;
+            set.rowStride = rowStride;
+            if (!planBands(set, entropyData, data + size, threadCount + 1))
+                return false;
+
+            std::atomic<bool> failed(false);
+            ParallelUtils::forEachChunk(0, set.bands.size(), 1, [&set, &failed](size_t, size_t first, size_t last) {
+                for (size_t i = first; i < last && !failed.load(); i++) {
+                    if (!decodeBand(set, set.bands[i]))
+                        failed.store(true);
+                }
+            });
+
+            return !failed.load();
+        }
     }
 
     bool JpegImageLoader::canLoadImage(IFile* file)
@@ -120,10 +441,16 @@ namespace B3D
         return file && (StringUtils::endsWith(file->name(), ".jpg") || StringUtils::endsWith(file->name(), ".jpeg"));
     }
 
-    ImagePtr JpegImageLoader::loadImage(IFile* file)
+    ImagePtr JpegImageLoader::loadImage(IFile* file, const ImageLoadHint& hint)
+    {
+        return Image::decodeWith(this, file, hint);
+    }
+
+    bool JpegImageLoader::decodeImage(IFile* file, const ImageLoadHint& hint,
+        const ImageDecodeTarget& target)
     {
         if (!file)
-            return std::make_shared<Image>();
+            return false;
 
         jpeg_decompress_struct cinfo;
         JpegErrorMgr jerr;
@@ -134,7 +461,7 @@ namespace B3D
         jerr.output_message = jpegOutputMessage;
         if (setjmp(jerr.jmpbuf) != 0) {
             jpeg_destroy_decompress(&cinfo);
-            return std::make_shared<Image>();
+            return false;
         }
 
         jpeg_create_decompress(&cinfo);
@@ -150,9 +477,38 @@ namespace B3D
         jsrc.term_source = jpegTermSource;
         jsrc.bytes_in_buffer = 0;
         jsrc.next_input_byte = nullptr;
+        jsrc.mapped = false;
         cinfo.src = &jsrc;
 
+        uint64_t position = file->position();
+        uint64_t fileSize = file->size();
+        const uint8_t* mapped = nullptr;
+        if (position < fileSize)
+            mapped = file->mapRegion(position, size_t(fileSize - position));
+        if (mapped) {
+            jsrc.mapped = true;
+            jsrc.next_input_byte = reinterpret_cast<const JOCTET*>(mapped);
+            jsrc.bytes_in_buffer = size_t(fileSize - position);
+        }
+
         jpeg_read_header(&cinfo, TRUE);
+
+        // Scaling in the DCT domain shrinks the image up to 8 times for a fraction of the cost of a full decode;
+        // Image::reduceToFit() takes care of anything beyond that.
+        if (hint.maxDimension != 0) {
+            size_t largest = std::max(cinfo.image_width, cinfo.image_height);
+            unsigned denom = 1;
+            while (denom < 8 && largest > hint.maxDimension * denom)
+                denom *= 2;
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = denom;
+        }
+
+        if (hint.quality == DecodeQuality::Fast) {
+            cinfo.dct_method = JDCT_IFAST;
+            cinfo.do_fancy_upsampling = FALSE;
+        }
+
         jpeg_start_decompress(&cinfo);
 
         size_t width = cinfo.output_width;
@@ -189,12 +545,20 @@ namespace B3D
             longjmp(jerr.jmpbuf, 1);
         }
 
-        auto image = std::make_shared<Image>(format, width, height);
-
         size_t rowStride = width * numChannels;
-        image->setDataSize(rowStride * height);
+        uint8_t* imageData = target(format, width, height, rowStride);
+        if (!imageData) {
+            jpeg_destroy_decompress(&cinfo);
+            return false;
+        }
+        assert(rowStride >= width * numChannels);
+
+        // Large images with restart markers are decoded in bands on the background threads.
+        if (mapped && decodeInBands(cinfo, file, mapped, size_t(fileSize - position), imageData, rowStride)) {
+            jpeg_destroy_decompress(&cinfo);
+            return true;
+        }
 
-        uint8_t* imageData = image->data();
         while (cinfo.output_scanline < cinfo.output_height) {
             JSAMPROW line[1] = { reinterpret_cast<JSAMPLE*>(imageData + cinfo.output_scanline * rowStride) };
             jpeg_read_scanlines(&cinfo, line, 1);
@@ -203,6 +567,6 @@ namespace B3D
         jpeg_finish_decompress(&cinfo);
         jpeg_destroy_decompress(&cinfo);
 
-        return image;
+        return true;
     }
 }
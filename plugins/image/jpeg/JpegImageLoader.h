@@ -32,6 +32,7 @@ namespace B3D
         JpegImageLoader() = default;
 
         bool canLoadImage(IFile* file) override;
-        ImagePtr loadImage(IFile* file) override;
+        ImagePtr loadImage(IFile* file, const ImageLoadHint& hint) override;
+        bool decodeImage(IFile* file, const ImageLoadHint& hint, const ImageDecodeTarget& target) override;
     };
 }
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "KtxImageLoader.h"
+#include "engine/image/Image.h"
+#include "engine/core/Log.h"
+#include <algorithm>
+#include <cstring>
+
+namespace B3D
+{
+    static const uint8_t KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    static const uint32_t KTX_ENDIANNESS = 0x04030201;
+    static const uint32_t KTX_ENDIANNESS_SWAPPED = 0x01020304;
+    static const size_t MAX_DIMENSION = 16384;
+    static const size_t MAX_MIP_LEVELS = 15;
+
+    static const uint32_t GL_UNSIGNED_BYTE_ = 0x1401;
+    static const uint32_t GL_UNSIGNED_SHORT_4_4_4_4_ = 0x8033;
+    static const uint32_t GL_UNSIGNED_SHORT_5_6_5_ = 0x8363;
+    static const uint32_t GL_RGB_ = 0x1907;
+    static const uint32_t GL_RGBA_ = 0x1908;
+    static const uint32_t GL_LUMINANCE_ = 0x1909;
+    static const uint32_t GL_LUMINANCE_ALPHA_ = 0x190A;
+
+    namespace
+    {
+        struct KtxHeader
+        {
+            uint32_t endianness;
+            uint32_t glType;
+            uint32_t glTypeSize;
+            uint32_t glFormat;
+            uint32_t glInternalFormat;
+            uint32_t glBaseInternalFormat;
+            uint32_t pixelWidth;
+            uint32_t pixelHeight;
+            uint32_t pixelDepth;
+            uint32_t numberOfArrayElements;
+            uint32_t numberOfFaces;
+            uint32_t numberOfMipmapLevels;
+            uint32_t bytesOfKeyValueData;
+        };
+    }
+
+    static uint32_t swapBytes(uint32_t value)
+    {
+        return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+    }
+
+    static PixelFormat compressedFormatFromGL(uint32_t internalFormat)
+    {
+        switch (internalFormat)
+        {
+        case 0x8D64: return PixelFormat::ETC1;          // GL_ETC1_RGB8_OES
+        case 0x9274: return PixelFormat::ETC2_RGB8;     // GL_COMPRESSED_RGB8_ETC2
+        case 0x9278: return PixelFormat::ETC2_RGBA8;    // GL_COMPRESSED_RGBA8_ETC2_EAC
+        case 0x83F0: return PixelFormat::BC1;           // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+        case 0x83F1: return PixelFormat::BC1;           // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+        case 0x83F2: return PixelFormat::BC2;           // GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+        case 0x83F3: return PixelFormat::BC3;           // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+        case 0x93B0: return PixelFormat::ASTC_4x4;      // GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+        case 0x93B7: return PixelFormat::ASTC_8x8;      // GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+        default: return PixelFormat::Invalid;
+        }
+    }
+
+    static PixelFormat uncompressedFormatFromGL(uint32_t type, uint32_t format)
+    {
+        switch (type)
+        {
+        case GL_UNSIGNED_BYTE_:
+            switch (format)
+            {
+            case GL_LUMINANCE_: return PixelFormat::Luminance8;
+            case GL_LUMINANCE_ALPHA_: return PixelFormat::LuminanceAlpha16;
+            case GL_RGB_: return PixelFormat::RGB24;
+            case GL_RGBA_: return PixelFormat::RGBA32;
+            default: return PixelFormat::Invalid;
+            }
+
+        case GL_UNSIGNED_SHORT_5_6_5_:
+            return (format == GL_RGB_ ? PixelFormat::RGB565 : PixelFormat::Invalid);
+
+        case GL_UNSIGNED_SHORT_4_4_4_4_:
+            return (format == GL_RGBA_ ? PixelFormat::RGBA4444 : PixelFormat::Invalid);
+
+        default:
+            return PixelFormat::Invalid;
+        }
+    }
+
+    bool KtxImageLoader::canLoadImage(IFile* file)
+    {
+        uint64_t pos = file->position();
+        uint8_t buf[sizeof(KTX_IDENTIFIER)];
+        if (file->read(buf, sizeof(buf)) != sizeof(buf) || memcmp(buf, KTX_IDENTIFIER, sizeof(buf)) != 0) {
+            file->seek(pos);
+            return false;
+        }
+        return true;
+    }
+
+    ImagePtr KtxImageLoader::loadImage(IFile* file, const ImageLoadHint&)
+    {
+        if (!file)
+            return std::make_shared<Image>();
+
+        KtxHeader header;
+        if (file->read(&header, sizeof(header)) != sizeof(header)) {
+            B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": unexpected end of stream.");
+            return std::make_shared<Image>();
+        }
+
+        bool swap = (header.endianness == KTX_ENDIANNESS_SWAPPED);
+        if (!swap && header.endianness != KTX_ENDIANNESS) {
+            B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": invalid endianness marker.");
+            return std::make_shared<Image>();
+        }
+        if (swap) {
+            uint32_t* fields = reinterpret_cast<uint32_t*>(&header);
+            for (size_t i = 0; i < sizeof(header) / sizeof(uint32_t); i++)
+                fields[i] = swapBytes(fields[i]);
+        }
+
+        // Cube maps, texture arrays and 3D textures are not supported by the engine.
+        size_t width = header.pixelWidth;
+        size_t height = std::max<size_t>(header.pixelHeight, 1);
+        if (header.pixelDepth > 1 || header.numberOfArrayElements > 1 || header.numberOfFaces != 1) {
+            B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": only 2D textures are supported.");
+            return std::make_shared<Image>();
+        }
+        if (width == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+            B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": invalid image dimensions.");
+            return std::make_shared<Image>();
+        }
+
+        PixelFormat format;
+        if (header.glType == 0 && header.glFormat == 0)
+            format = compressedFormatFromGL(header.glInternalFormat);
+        else
+            format = uncompressedFormatFromGL(header.glType, header.glFormat);
+        if (format == PixelFormat::Invalid) {
+            B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": unsupported pixel format (type 0x"
+                << std::hex << header.glType << ", format 0x" << header.glFormat << ", internal format 0x"
+                << header.glInternalFormat << std::dec << ").");
+            return std::make_shared<Image>();
+        }
+
+        // Zero levels means that the application should generate the mipmaps.
+        size_t levelCount = std::max<size_t>(header.numberOfMipmapLevels, 1);
+        if (levelCount > MAX_MIP_LEVELS) {
+            B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": invalid number of mipmap levels.");
+            return std::make_shared<Image>();
+        }
+
+        uint64_t dataOffset = file->position() + header.bytesOfKeyValueData;
+        if (!file->seek(dataOffset)) {
+            B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": unexpected end of stream.");
+            return std::make_shared<Image>();
+        }
+
+        std::shared_ptr<Image> image;
+        for (size_t level = 0; level < levelCount; level++) {
+            size_t levelWidth = std::max<size_t>(width >> level, 1);
+            size_t levelHeight = std::max<size_t>(height >> level, 1);
+
+            uint32_t imageSize = 0;
+            if (file->read(&imageSize, sizeof(imageSize)) != sizeof(imageSize)) {
+                B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": unexpected end of stream.");
+                return std::make_shared<Image>();
+            }
+            if (swap)
+                imageSize = swapBytes(imageSize);
+
+            // Rows of uncompressed images are padded to GL_UNPACK_ALIGNMENT, which is 4 in KTX files.
+            size_t dataSize = imageDataSize(format, levelWidth, levelHeight);
+            size_t rowSize = levelWidth * bytesPerPixel(format);
+            size_t paddedRowSize = (rowSize + 3) & ~size_t(3);
+            if (imageSize != (isCompressed(format) ? dataSize : paddedRowSize * levelHeight)) {
+                B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": invalid size of mipmap level "
+                    << level << ".");
+                return std::make_shared<Image>();
+            }
+
+            auto mip = std::make_shared<Image>(format, levelWidth, levelHeight);
+            mip->setDataSize(imageSize);
+            uint8_t* pixels = mip->data();
+            if (file->read(pixels, imageSize) != imageSize) {
+                B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": unexpected end of stream.");
+                return std::make_shared<Image>();
+            }
+
+            if (paddedRowSize != rowSize) {
+                for (size_t y = 1; y < levelHeight; y++)
+                    memmove(pixels + y * rowSize, pixels + y * paddedRowSize, rowSize);
+                mip->setDataSize(dataSize);
+            }
+
+            if (swap && header.glTypeSize == 2) {
+                for (size_t i = 0; i + 1 < dataSize; i += 2)
+                    std::swap(pixels[i], pixels[i + 1]);
+            }
+
+            size_t padding = 3 - ((imageSize + 3) % 4);
+            if (padding != 0 && level + 1 < levelCount && !file->seek(file->position() + padding)) {
+                B3D_LOGE("Unable to decode KTX file \"" << file->name() << "\": unexpected end of stream.");
+                return std::make_shared<Image>();
+            }
+
+            if (!image)
+                image = mip;
+            else
+                image->addMipLevel(mip);
+        }
+
+        return image;
+    }
+}
@@ -24,6 +24,9 @@
 #include "engine/core/Log.h"
 #include <png.h>
 #include <setjmp.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 
 #ifdef _MSC_VER
 #pragma warning(disable:4611)   // interaction between _strjmp and C++ object destruction is non-portable
@@ -33,6 +36,17 @@ namespace B3D
 {
     static const size_t PNG_SIGNATURE_SIZE = 8;
 
+    namespace
+    {
+        struct PngSource
+        {
+            IFile* file;
+            const uint8_t* mappedData;
+            size_t mappedSize;
+            size_t offset;
+        };
+    }
+
     static void pngError(png_structp pngp, png_const_charp message)
     {
         IFile* file = reinterpret_cast<IFile*>(png_get_error_ptr(pngp));
@@ -55,10 +69,19 @@ namespace B3D
 
     static void pngRead(png_structp pngp, png_bytep data, png_size_t length)
     {
-        IFile* file = reinterpret_cast<IFile*>(png_get_io_ptr(pngp));
-        size_t bytesRead = file->read(data, length);
+        PngSource* source = reinterpret_cast<PngSource*>(png_get_io_ptr(pngp));
+
+        size_t bytesRead;
+        if (!source->mappedData)
+            bytesRead = source->file->read(data, length);
+        else {
+            bytesRead = std::min(size_t(length), source->mappedSize - source->offset);
+            memcpy(data, source->mappedData + source->offset, bytesRead);
+            source->offset += bytesRead;
+        }
+
         if (bytesRead != length) {
-            B3D_LOGE("Unable to decode PNG file \"" << file->name() << "\": unexpected end of stream.");
+            B3D_LOGE("Unable to decode PNG file \"" << source->file->name() << "\": unexpected end of stream.");
             longjmp(png_jmpbuf(pngp), 1);
         }
     }
@@ -74,7 +97,12 @@ namespace B3D
         return true;
     }
 
-    ImagePtr PngImageLoader::loadImage(IFile* file)
+    ImagePtr PngImageLoader::loadImage(IFile* file, const ImageLoadHint& hint)
+    {
+        return Image::decodeWith(this, file, hint);
+    }
+
+    bool PngImageLoader::decodeImage(IFile* file, const ImageLoadHint&, const ImageDecodeTarget& target)
     {
         struct Context
         {
@@ -84,26 +112,35 @@ namespace B3D
         };
 
         if (!file)
-            return std::make_shared<Image>();
+            return false;
 
         volatile Context context;
         png_structp pngp = context.pngp = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
         if (!pngp) {
             B3D_LOGE("Unable to decode PNG file \"" << file->name() << "\": out of memory.");
-            return std::make_shared<Image>();
+            return false;
         }
 
         if (setjmp(png_jmpbuf(pngp)))
-            return std::make_shared<Image>();
+            return false;
+
+        // Mapped files are read straight from memory, bypassing the file object.
+        PngSource source;
+        source.file = file;
+        source.mappedData = file->mappedData();
+        source.mappedSize = (source.mappedData ? size_t(file->size()) : 0);
+        source.offset = size_t(file->position());
+        if (source.offset > source.mappedSize)
+            source.mappedData = nullptr;
 
         png_set_error_fn(pngp, file, pngError, pngWarning);
-        png_set_read_fn(pngp, file, pngRead);
+        png_set_read_fn(pngp, &source, pngRead);
         png_set_sig_bytes(pngp, PNG_SIGNATURE_SIZE);
 
         png_infop infop = context.infop = png_create_info_struct(pngp);
         if (!infop) {
             B3D_LOGE("Unable to decode PNG file \"" << file->name() << "\": out of memory.");
-            return std::make_shared<Image>();
+            return false;
         }
 
         png_read_info(pngp, infop);
@@ -152,7 +189,7 @@ namespace B3D
         if (depth != 8) {
             B3D_LOGE("Unable to decode PNG file \"" << file->name()
                 << "\": image has invalid bit depth (" << depth << ").");
-            return std::make_shared<Image>();
+            return false;
         }
 
         PixelFormat format;
@@ -165,23 +202,31 @@ namespace B3D
         default:
             B3D_LOGE("Unable to decode PNG file \"" << file->name()
                 << "\": image has unsupported number of channels (" << channels << ").");
-            return std::make_shared<Image>();
+            return false;
         }
 
-        auto image = std::make_shared<Image>(format, width, height);
-        image->setDataSize((width * height + (rowbytes - width)) * channels);
-        uint8_t* imageData = image->data();
+        size_t rowSize = size_t(width) * channels;
+        if (rowbytes != rowSize) {
+            B3D_LOGE("Unable to decode PNG file \"" << file->name() << "\": unexpected row size.");
+            return false;
+        }
+
+        size_t stride = rowSize;
+        uint8_t* imageData = target(format, width, height, stride);
+        if (!imageData)
+            return false;
+        assert(stride >= rowSize);
 
         for (int i = 0; i < numPasses; i++) {
             uint8_t* row = imageData;
             for (png_uint_32 y = 0; y < height; y++) {
                 png_read_row(pngp, reinterpret_cast<png_bytep>(row), nullptr);
-                row += width * channels;
+                row += stride;
             }
         }
 
         png_read_end(pngp, nullptr);
 
-        return image;
+        return true;
     }
 }
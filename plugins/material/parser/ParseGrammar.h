@@ -31,14 +31,21 @@ struct Whitespace : plus<WhitespaceElement> {};
 struct OptionalWhitespace : star<WhitespaceElement> {};
 
 struct BACK : string<'B','a','c','k'> {};
+struct ANISOTROPY : string<'A','n','i','s','o','t','r','o','p','y'> {};
 struct BLEND_FUNC : string<'B','l','e','n','d','F','u','n','c'> {};
+struct CLAMP : string<'C','l','a','m','p'> {};
 struct CULL_FACE : string<'C','u','l','l','F','a','c','e'> {};
 struct DEPTH_TEST : string<'D','e','p','t','h','T','e','s','t'> {};
 struct DEPTH_WRITE : string<'D','e','p','t','h','W','r','i','t','e'> {};
 struct DISABLED : string<'D','i','s','a','b','l','e','d'> {};
 struct DST_ALPHA : string<'D','s','t','A','l','p','h','a'> {};
 struct DST_COLOR : string<'D','s','t','C','o','l','o','r'> {};
+struct FILTER : string<'F','i','l','t','e','r'> {};
 struct FRONT : string<'F','r','o','n','t'> {};
+struct LINEAR : string<'L','i','n','e','a','r'> {};
+struct MIP_FILTER : string<'M','i','p','F','i','l','t','e','r'> {};
+struct MIRRORED_REPEAT : string<'M','i','r','r','o','r','e','d','R','e','p','e','a','t'> {};
+struct NEAREST : string<'N','e','a','r','e','s','t'> {};
 struct NONE : string<'N','o','n','e'> {};
 struct OFF : string<'O','f','f'> {};
 struct ON : string<'O','n'> {};
@@ -48,12 +55,14 @@ struct ONE_MINUS_DST_COLOR : string<'O','n','e','M','i','n','u','s','D','s','t',
 struct ONE_MINUS_SRC_ALPHA : string<'O','n','e','M','i','n','u','s','S','r','c','A','l','p','h','a'> {};
 struct ONE_MINUS_SRC_COLOR : string<'O','n','e','M','i','n','u','s','S','r','c','C','o','l','o','r'> {};
 struct PASS : string<'p','a','s','s'> {};
+struct REPEAT : string<'R','e','p','e','a','t'> {};
 struct SET_UNIFORM : string<'S','e','t','U','n','i','f','o','r','m'> {};
 struct SHADER : string<'S','h','a','d','e','r'> {};
 struct SRC_ALPHA : string<'S','r','c','A','l','p','h','a'> {};
 struct SRC_ALPHA_SATURATE : string<'S','r','c','A','l','p','h','a','S','a','t','u','r','a','t','e'> {};
 struct SRC_COLOR : string<'S','r','c','C','o','l','o','r'> {};
 struct TECHNIQUE : string<'t','e','c','h','n','i','q','u','e'> {};
+struct WRAP : string<'W','r','a','p'> {};
 struct ZERO : string<'Z','e','r','o'> {};
 
 
@@ -146,6 +155,45 @@ struct Option : seq<sor<
 >, OptionalWhitespace> {};
 
 
+//////////////////////////////////////////////////////////////////////////////
+// Sampler state
+
+struct TextureFilterNearest : NEAREST {};
+struct TextureFilterLinear : LINEAR {};
+struct TextureFilterValue : seq<sor<TextureFilterNearest, TextureFilterLinear>, OptionalWhitespace> {};
+struct SamplerFilterOption : seq<FILTER, NameValueSeparator, TextureFilterValue> {};
+
+struct MipFilterNone : NONE {};
+struct MipFilterNearest : NEAREST {};
+struct MipFilterLinear : LINEAR {};
+struct MipFilterValue : seq<sor<MipFilterNone, MipFilterNearest, MipFilterLinear>, OptionalWhitespace> {};
+struct SamplerMipFilterOption : seq<MIP_FILTER, NameValueSeparator, MipFilterValue> {};
+
+struct TextureWrapClamp : CLAMP {};
+struct TextureWrapRepeat : REPEAT {};
+struct TextureWrapMirroredRepeat : MIRRORED_REPEAT {};
+struct TextureWrapValue : seq<sor<
+    TextureWrapClamp,
+    TextureWrapRepeat,
+    TextureWrapMirroredRepeat
+>, OptionalWhitespace> {};
+struct SamplerWrapValue : seq<TextureWrapValue, opt<ValueSeparator, TextureWrapValue>> {};
+struct SamplerWrapOption : seq<WRAP, NameValueSeparator, SamplerWrapValue> {};
+
+struct SamplerAnisotropyOption : seq<ANISOTROPY, NameValueSeparator, FloatValue> {};
+
+struct SamplerOption : seq<sor<
+    SamplerMipFilterOption,
+    SamplerFilterOption,
+    SamplerWrapOption,
+    SamplerAnisotropyOption
+>, OptionalWhitespace> {};
+
+struct SamplerBegin : seq<one<'{'>, OptionalWhitespace> {};
+struct SamplerEnd : seq<one<'}'>, OptionalWhitespace> {};
+struct Sampler : seq<SamplerBegin, star<SamplerOption>, SamplerEnd> {};
+
+
 //////////////////////////////////////////////////////////////////////////////
 // Uniforms
 
@@ -157,7 +205,7 @@ struct UniformFloatValue : FloatValue {};
 struct UniformVec2Value : seq<LParen, FloatValue, Comma, FloatValue, RParen> {};
 struct UniformVec3Value : seq<LParen, FloatValue, Comma, FloatValue, Comma, FloatValue, RParen> {};
 struct UniformVec4Value : seq<LParen, FloatValue, Comma, FloatValue, Comma, FloatValue, Comma, FloatValue, RParen> {};
-struct UniformTextureValue : StringValue {};
+struct UniformTextureValue : seq<StringValue, opt<Sampler>> {};
 
 struct UniformValue : sor<
     UniformVec4Value,
@@ -41,22 +41,27 @@ ACTION(BoolTrue, context.boolValues.push_back(true));
 
 ACTION(IdentifierText, context.stringValues.emplace_back(input.string()));
 
-ACTION(FloatingPointNumber, context.floatValues.emplace_back(std::stof(input.string())));
+ACTION(FloatingPointNumber, {
+    float value = 0.0f;
+    StringUtils::parseFloat(StringView(input.begin(), input.size()), value);
+    context.floatValues.emplace_back(value);
+});
 
 ACTION(StringLiteral, {
-    std::stringstream result;
-    const auto& literal = input.string();
-    size_t literalLength = literal.size();
+    std::string result;
+    const char* literal = input.begin();
+    size_t literalLength = input.size();
     assert(literalLength >= 2);
     assert(literal[0] == '"');
     assert(literal[literalLength - 1] == '"');
+    result.reserve(literalLength - 2);
     for (size_t i = 1; i < literalLength - 1; i++) {
         if (literal[i] != '\\')
-            result << literal[i];
+            result += literal[i];
         else
-            result << literal[++i];
+            result += literal[++i];
     }
-    context.stringValues.emplace_back(result.str());
+    context.stringValues.emplace_back(std::move(result));
 });
 
 //////////////////////////////////////////////////////////////////////////////
@@ -106,6 +111,36 @@ ACTION(ShaderOption, {
     context.emitOption<Tree::ShaderOption>(fileName);
 });
 
+//////////////////////////////////////////////////////////////////////////////
+// Sampler state
+
+ACTION(TextureFilterNearest, context.textureFilterValue = TextureFilter::Nearest);
+ACTION(TextureFilterLinear, context.textureFilterValue = TextureFilter::Linear);
+ACTION(SamplerFilterOption, {
+    context.samplerState.minFilter = context.textureFilterValue;
+    context.samplerState.magFilter = context.textureFilterValue;
+});
+
+ACTION(MipFilterNone, context.samplerState.mipFilter = MipmapFilter::None);
+ACTION(MipFilterNearest, context.samplerState.mipFilter = MipmapFilter::Nearest);
+ACTION(MipFilterLinear, context.samplerState.mipFilter = MipmapFilter::Linear);
+
+ACTION(TextureWrapClamp, context.textureWrapValues.emplace_back(TextureWrap::Clamp));
+ACTION(TextureWrapRepeat, context.textureWrapValues.emplace_back(TextureWrap::Repeat));
+ACTION(TextureWrapMirroredRepeat, context.textureWrapValues.emplace_back(TextureWrap::MirroredRepeat));
+ACTION(SamplerWrapOption, {
+    assert(context.textureWrapValues.size() == 1 || context.textureWrapValues.size() == 2);
+    context.samplerState.wrapT = pop(context.textureWrapValues);
+    context.samplerState.wrapS = context.samplerState.wrapT;
+    if (!context.textureWrapValues.empty())
+        context.samplerState.wrapS = pop(context.textureWrapValues);
+});
+
+ACTION(SamplerAnisotropyOption, {
+    float value = pop(context.floatValues);
+    context.samplerState.maxAnisotropy = (value > 1.0f ? value : 1.0f);
+});
+
 //////////////////////////////////////////////////////////////////////////////
 // Uniforms
 
@@ -137,8 +172,11 @@ ACTION(UniformVec4Value, {
 
 ACTION(UniformTextureValue, {
     std::string textureName = pop(context.stringValues);
-    std::string fileName = FileUtils::makeFullPath(textureName, context.materialFileName);
-    context.uniformValue.reset(new Tree::UniformTexture(std::move(fileName)));
+    Tree::TextureReference reference;
+    reference.fileName = FileUtils::makeFullPath(textureName, context.materialFileName);
+    reference.sampler = context.samplerState;
+    context.uniformValue.reset(new Tree::UniformTexture(std::move(reference)));
+    context.samplerState = SamplerState();
 });
 
 ACTION(Uniform, {
@@ -28,6 +28,9 @@ struct Context
     std::vector<std::string> stringValues;
     std::vector<float> floatValues;
     std::vector<BlendFunc> blendFuncValues;
+    TextureFilter textureFilterValue;
+    std::vector<TextureWrap> textureWrapValues;
+    SamplerState samplerState;
     std::unique_ptr<Tree::Uniform> uniformValue;
     std::unique_ptr<std::string> techniqueName;
     std::unique_ptr<std::string> passName;
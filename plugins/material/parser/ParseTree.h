@@ -132,10 +132,15 @@ template<> void UniformVec4::applyToPass(MaterialPass& pass, const std::string&
     pass.setUniform(name, value);
 }
 
-using UniformTexture = UniformValue<Uniform::Texture, std::string>;
+struct TextureReference
+{
+    std::string fileName;
+    SamplerState sampler;
+};
+using UniformTexture = UniformValue<Uniform::Texture, TextureReference>;
 template<> void UniformTexture::applyToPass(MaterialPass& pass, const std::string& name) const
 {
-    pass.setUniform(name, value);
+    pass.setUniform(name, value.fileName, value.sampler);
 }
 
 
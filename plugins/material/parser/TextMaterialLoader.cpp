@@ -65,7 +65,7 @@ namespace B3D
         if (!file)
             return false;
 
-        std::vector<char> data = FileUtils::loadFile(file);
+        FileUtils::FileContents data = FileUtils::mapFile(file);
 
         const char* p = data.data();
         size_t size = data.size();
@@ -94,6 +94,7 @@ namespace B3D
         assert(context.stringValues.empty());
         assert(context.floatValues.empty());
         assert(context.blendFuncValues.empty());
+        assert(context.textureWrapValues.empty());
         assert(context.uniformValue == nullptr);
         assert(context.techniqueName == nullptr);
         assert(context.passName == nullptr);
@@ -31,6 +31,7 @@
 #include "engine/core/Services.h"
 #include "engine/utility/StringUtils.h"
 #include "engine/utility/FileUtils.h"
+#include "engine/utility/ParallelUtils.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -188,37 +189,46 @@ namespace B3D
                 ));
             }
 
-            for (size_t i = 0; i < vertexCount; i++) {
-                if (hasPositions) {
-                    vertices->position.x = sceneMesh->mVertices[i].x;
-                    vertices->position.y = sceneMesh->mVertices[i].y;
-                    vertices->position.z = sceneMesh->mVertices[i].z;
-                    elementBoundingBox.addPoint(vertices->position);
-                }
-
-                if (hasNormals) {
-                    vertices->normal.x = sceneMesh->mNormals[i].x;
-                    vertices->normal.y = sceneMesh->mNormals[i].y;
-                    vertices->normal.z = sceneMesh->mNormals[i].z;
-                }
+            elementBoundingBox = ParallelUtils::parallelReduce(size_t(0), vertexCount, elementBoundingBox,
+                [=](size_t first, size_t last) {
+                    BoundingBox chunkBoundingBox = elementBoundingBox;
+                    for (size_t i = first; i < last; i++) {
+                        Vertex* vertex = &vertices[i];
+
+                        if (hasPositions) {
+                            vertex->position.x = sceneMesh->mVertices[i].x;
+                            vertex->position.y = sceneMesh->mVertices[i].y;
+                            vertex->position.z = sceneMesh->mVertices[i].z;
+                            chunkBoundingBox.addPoint(vertex->position);
+                        }
 
-                if (hasTangents) {
-                    vertices->tangent.x = sceneMesh->mTangents[i].x;
-                    vertices->tangent.y = sceneMesh->mTangents[i].y;
-                    vertices->tangent.z = sceneMesh->mTangents[i].z;
+                        if (hasNormals) {
+                            vertex->normal.x = sceneMesh->mNormals[i].x;
+                            vertex->normal.y = sceneMesh->mNormals[i].y;
+                            vertex->normal.z = sceneMesh->mNormals[i].z;
+                        }
 
-                    vertices->bitangent.x = sceneMesh->mBitangents[i].x;
-                    vertices->bitangent.y = sceneMesh->mBitangents[i].y;
-                    vertices->bitangent.z = sceneMesh->mBitangents[i].z;
-                }
+                        if (hasTangents) {
+                            vertex->tangent.x = sceneMesh->mTangents[i].x;
+                            vertex->tangent.y = sceneMesh->mTangents[i].y;
+                            vertex->tangent.z = sceneMesh->mTangents[i].z;
 
-                if (hasTexCoords) {
-                    vertices->texCoord.x = sceneMesh->mTextureCoords[0][i].x;
-                    vertices->texCoord.y = sceneMesh->mTextureCoords[0][i].y;
-                }
+                            vertex->bitangent.x = sceneMesh->mBitangents[i].x;
+                            vertex->bitangent.y = sceneMesh->mBitangents[i].y;
+                            vertex->bitangent.z = sceneMesh->mBitangents[i].z;
+                        }
 
-                ++vertices;
-            }
+                        if (hasTexCoords) {
+                            vertex->texCoord.x = sceneMesh->mTextureCoords[0][i].x;
+                            vertex->texCoord.y = sceneMesh->mTextureCoords[0][i].y;
+                        }
+                    }
+                    return chunkBoundingBox;
+                },
+                [](BoundingBox a, const BoundingBox& b) {
+                    a.addBoundingBox(b);
+                    return a;
+                });
 
             element->setBoundingBox(elementBoundingBox);
             if (vertexCount > 0 && hasPositions) {
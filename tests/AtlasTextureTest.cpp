@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "tests/common/TestUtils.h"
+#include "tests/common/NullRenderer.h"
+#include "engine/render/AtlasTexture.h"
+
+using namespace B3D;
+
+namespace
+{
+    const size_t IMAGE_SIZE = 64;
+    const size_t FULL_MIP_CHAIN = 7;    // 64x64 down to 1x1
+
+    ImagePtr makeImage()
+    {
+        auto image = std::make_shared<Image>(PixelFormat::RGBA32, IMAGE_SIZE, IMAGE_SIZE);
+        std::vector<uint8_t> pixels(IMAGE_SIZE * IMAGE_SIZE * 4, 0x80);
+        image->setData(pixels);
+        return image;
+    }
+
+    // Images that fit into the atlas are loaded without mipmaps. The ones that end up in a texture of their own
+    // anyway, because the atlas is full or a shader samples them, must still get a full chain.
+    void testMipmapsOutsideOfAtlas(bool generateMipmaps)
+    {
+        auto atlas = std::make_shared<TextureAtlas>(IMAGE_SIZE, size_t(TextureAtlas::INITIAL_PAGE_SIZE), 1);
+        ImagePtr image = makeImage();
+        B3D_CHECK(atlas->canPack(*image));
+
+        std::vector<std::shared_ptr<AtlasTexture>> textures;
+        for (;;) {
+            auto texture = std::make_shared<AtlasTexture>(atlas, generateMipmaps);
+            texture->upload(*image);
+            textures.emplace_back(texture);
+            if (!texture->isPacked())
+                break;
+            B3D_CHECK(textures.size() < 100);
+            if (textures.size() >= 100)
+                return;
+        }
+
+        size_t expectedLevels = (generateMipmaps ? FULL_MIP_CHAIN : 1);
+
+        ITexture* fallback = textures.back()->samplerTexture();
+        B3D_CHECK(fallback->mipLevelCount() == expectedLevels);
+        B3D_CHECK(textures.back()->mipLevelCount() == expectedLevels);
+
+        // Packed textures have a single level until a shader needs a standalone copy.
+        auto& packed = textures.front();
+        B3D_CHECK(packed->mipLevelCount() == 1);
+        B3D_CHECK(packed->samplerTexture()->mipLevelCount() == expectedLevels);
+        B3D_CHECK(packed->samplerTexture()->size() == glm::vec2(float(IMAGE_SIZE)));
+    }
+}
+
+int main()
+{
+    Services::setRendererResourceFactory(std::make_shared<Test::NullRenderer>());
+
+    testMipmapsOutsideOfAtlas(true);
+    testMipmapsOutsideOfAtlas(false);
+
+    Services::setRendererResourceFactory(nullptr);
+    return Test::result();
+}
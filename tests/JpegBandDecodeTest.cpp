@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "tests/common/TestUtils.h"
+#include "tests/common/JpegEncoder.h"
+#include "plugins/image/jpeg/JpegImageLoader.h"
+
+using namespace B3D;
+
+namespace
+{
+    // Large enough to be split into bands (JpegImageLoader only splits images of a megapixel or more).
+    const size_t IMAGE_WIDTH = 1280;
+    const size_t IMAGE_HEIGHT = 1032;
+
+    struct Sampling
+    {
+        const char* name;
+        int components;
+        int horizontal;
+        int vertical;
+    };
+
+    const Sampling SAMPLINGS[] = {
+        { "4:4:4", 3, 1, 1 },
+        { "4:2:2", 3, 2, 1 },
+        { "4:2:0", 3, 2, 2 },
+        { "4:4:0", 3, 1, 2 },
+        { "4:1:1", 3, 4, 1 },
+        { "gray", 1, 1, 1 },
+    };
+
+    struct Restarts
+    {
+        const char* name;
+        unsigned interval;
+        int inRows;
+    };
+
+    // Intervals that do not divide the row length only allow bands on some MCU rows.
+    const Restarts RESTARTS[] = {
+        { "none", 0, 0 },
+        { "every row", 0, 1 },
+        { "every 3 rows", 0, 3 },
+        { "every 7 MCUs", 7, 0 },
+        { "every 64 MCUs", 64, 0 },
+    };
+
+    std::vector<uint8_t> encode(const Sampling& sampling, const Restarts& restarts)
+    {
+        Test::JpegEncodeOptions options;
+        options.width = IMAGE_WIDTH;
+        options.height = IMAGE_HEIGHT;
+        options.components = sampling.components;
+        options.horizontalSampling = sampling.horizontal;
+        options.verticalSampling = sampling.vertical;
+        options.restartInterval = restarts.interval;
+        options.restartInRows = restarts.inRows;
+        return Test::encodeJpeg(options);
+    }
+
+    struct Decoded
+    {
+        bool success = false;
+        PixelFormat format = PixelFormat::Invalid;
+        size_t width = 0;
+        size_t height = 0;
+        std::vector<uint8_t> pixels;
+
+        bool operator==(const Decoded& other) const
+        {
+            return success == other.success && format == other.format && width == other.width
+                && height == other.height && pixels == other.pixels;
+        }
+    };
+
+    Decoded decode(IFile* file, const ImageLoadHint& hint)
+    {
+        Decoded result;
+        JpegImageLoader loader;
+        result.success = loader.decodeImage(file, hint,
+            [&result](PixelFormat format, size_t width, size_t height, size_t& stride) -> uint8_t* {
+                result.format = format;
+                result.width = width;
+                result.height = height;
+                stride = width * bytesPerPixel(format);
+                result.pixels.resize(stride * height);
+                return result.pixels.data();
+            });
+        if (!result.success)
+            result.pixels.clear();
+        return result;
+    }
+
+    uint64_t backgroundTasksExecuted(Test::Environment& environment)
+    {
+        return environment.threadManager->stats().backgroundThreads.tasksExecuted;
+    }
+
+    // Decodes the data through a mapped file, which allows the band decoder to kick in, and through a stream,
+    // which does not; both must produce exactly the same result. Returns true if bands were used.
+    bool compare(Test::Environment& environment, const std::vector<uint8_t>& data, const ImageLoadHint& hint,
+        const std::string& description)
+    {
+        environment.threadManager->resetStats();
+
+        MemoryFile mapped("test.jpg", std::vector<uint8_t>(data));
+        Decoded banded = decode(&mapped, hint);
+
+        // Helpers that found no band left to decode may still be finishing when the decoder returns.
+        bool usedBands = environment.runUntil([&environment]() { return backgroundTasksExecuted(environment) != 0; },
+            std::chrono::milliseconds(100));
+
+        Test::StreamFile stream("test.jpg", data);
+        Decoded serial = decode(&stream, hint);
+
+        if (!(banded == serial)) {
+            fprintf(stderr, "%s: band decoding differs from serial decoding.\n", description.c_str());
+            B3D_CHECK(banded == serial);
+        }
+
+        return usedBands;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    void testValidImages(Test::Environment& environment)
+    {
+        const ImageLoadHint hints[] = {
+            ImageLoadHint(),
+            ImageLoadHint(0, DecodeQuality::Fast),
+            ImageLoadHint(IMAGE_WIDTH / 2),
+            ImageLoadHint(IMAGE_WIDTH / 4, DecodeQuality::Fast),
+            ImageLoadHint(IMAGE_WIDTH / 8),
+        };
+
+        for (const auto& sampling : SAMPLINGS) {
+            for (const auto& restarts : RESTARTS) {
+                std::vector<uint8_t> data = encode(sampling, restarts);
+                for (const auto& hint : hints) {
+                    std::string description = std::string(sampling.name) + ", restarts " + restarts.name
+                        + ", max dimension " + std::to_string(hint.maxDimension)
+                        + (hint.quality == DecodeQuality::Fast ? ", fast" : "");
+
+                    // Every image with restart markers can be split, whatever the subsampling and scale.
+                    bool hasRestarts = (restarts.interval != 0 || restarts.inRows != 0);
+                    if (compare(environment, data, hint, description) != hasRestarts) {
+                        fprintf(stderr, "%s: band decoder was %s.\n", description.c_str(),
+                            (hasRestarts ? "not used" : "used without restart markers"));
+                        B3D_CHECK(!"band decoder usage");
+                    }
+                }
+            }
+        }
+    }
+
+    // Start of the entropy-coded data of the only scan.
+    size_t scanDataOffset(const std::vector<uint8_t>& data)
+    {
+        size_t offset = 2;
+        while (offset + 4 <= data.size() && data[offset] == 0xFF) {
+            size_t length = (size_t(data[offset + 2]) << 8) | data[offset + 3];
+            if (data[offset + 1] == 0xDA)
+                return offset + 2 + length;
+            offset += 2 + length;
+        }
+        return 0;
+    }
+
+    void testDamagedImages(Test::Environment& environment)
+    {
+        const Sampling& sampling = SAMPLINGS[2];
+        const Restarts& restarts = RESTARTS[1];
+        std::vector<uint8_t> data = encode(sampling, restarts);
+        size_t scanData = scanDataOffset(data);
+        B3D_CHECK(scanData != 0);
+        if (scanData == 0)
+            return;
+
+        // Truncated at the headers, in the middle of the scan and right before the end of image marker.
+        const size_t truncations[] = { scanData / 2, scanData + 1, (scanData + data.size()) / 2, data.size() - 2 };
+        for (size_t size : truncations) {
+            std::vector<uint8_t> truncated(data.begin(), data.begin() + ptrdiff_t(size));
+            compare(environment, truncated, ImageLoadHint(), "truncated to " + std::to_string(size) + " bytes");
+        }
+
+        // Garbage inside a few intervals; bytes that could turn into a marker are left alone.
+        std::vector<uint8_t> corrupted = data;
+        for (size_t i = scanData + 1000; i < corrupted.size() - 2; i += corrupted.size() / 7) {
+            for (size_t j = i; j < i + 16; j++) {
+                if (corrupted[j - 1] != 0xFF && corrupted[j] != 0xFF && (corrupted[j] ^ 0x5A) != 0xFF)
+                    corrupted[j] ^= 0x5A;
+            }
+        }
+        compare(environment, corrupted, ImageLoadHint(), "corrupted entropy-coded data");
+
+        // A restart marker that went missing shifts every interval after it.
+        std::vector<uint8_t> missingMarker = data;
+        for (size_t i = (scanData + data.size()) / 2; i + 1 < missingMarker.size(); i++) {
+            uint8_t marker = missingMarker[i + 1];
+            if (missingMarker[i] == 0xFF && marker >= JPEG_RST0 && marker <= JPEG_RST0 + 7) {
+                missingMarker.erase(missingMarker.begin() + ptrdiff_t(i), missingMarker.begin() + ptrdiff_t(i + 2));
+                break;
+            }
+        }
+        compare(environment, missingMarker, ImageLoadHint(), "missing restart marker");
+
+        // Frame header claiming a different height than the data provides.
+        std::vector<uint8_t> wrongHeight = data;
+        for (size_t offset = 2; offset + 9 <= wrongHeight.size() && wrongHeight[offset] == 0xFF; ) {
+            if (wrongHeight[offset + 1] == 0xC0) {
+                wrongHeight[offset + 5] = uint8_t((IMAGE_HEIGHT + 64) >> 8);
+                wrongHeight[offset + 6] = uint8_t(IMAGE_HEIGHT + 64);
+                break;
+            }
+            offset += 2 + ((size_t(wrongHeight[offset + 2]) << 8) | wrongHeight[offset + 3]);
+        }
+        compare(environment, wrongHeight, ImageLoadHint(), "frame taller than the scan");
+    }
+}
+
+int main()
+{
+    Test::Environment environment;
+    environment.threadManager->setStatsEnabled(true);
+
+    testValidImages(environment);
+    testDamagedImages(environment);
+
+    return Test::result();
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "tests/common/TestUtils.h"
+#include "engine/utility/InplaceAction.h"
+#include <array>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t PRODUCER_COUNT = 8;
+    const size_t TASKS_PER_PRODUCER = 20000;
+
+    void testInplaceAction()
+    {
+        auto counter = std::make_shared<int>(0);
+
+        InplaceAction small;
+        B3D_CHECK(!small);
+        small.emplace([counter]() { ++*counter; });
+        B3D_CHECK(bool(small));
+        small();
+        B3D_CHECK(*counter == 1);
+
+        // Too large to be kept inline.
+        std::array<int, 64> values;
+        values.fill(1);
+        InplaceAction large;
+        large.emplace([counter, values]() { *counter += values[63]; });
+        large();
+        B3D_CHECK(*counter == 2);
+
+        InplaceAction moved(std::move(small));
+        B3D_CHECK(!small);
+        moved();
+        B3D_CHECK(*counter == 3);
+
+        small = std::move(large);
+        B3D_CHECK(!large);
+        small();
+        B3D_CHECK(*counter == 4);
+
+        // Captures are released as soon as the action is reset.
+        B3D_CHECK(counter.use_count() == 3);
+        moved.reset();
+        small.reset();
+        B3D_CHECK(counter.use_count() == 1);
+    }
+
+    // Producers post far more tasks than the ring holds, through every overload, while the render thread drains
+    // the queue: each task must run exactly once and the tasks of each producer must run in order.
+    void testOrdering()
+    {
+        CxxThreadManager threadManager(1);
+        std::vector<std::vector<size_t>> executed(PRODUCER_COUNT);
+        std::atomic<size_t> executedCount(0);
+        auto token = std::make_shared<int>(0);
+        std::array<size_t, 16> padding;
+        padding.fill(0);
+
+        std::atomic<size_t> finishedProducers(0);
+        std::vector<std::thread> producers;
+        for (size_t producer = 0; producer < PRODUCER_COUNT; producer++) {
+            producers.emplace_back([&, producer]() {
+                auto& log = executed[producer];
+                for (size_t i = 0; i < TASKS_PER_PRODUCER; i++) {
+                    switch (i % 4)
+                    {
+                    case 0:
+                        threadManager.performInRenderThread([&log, &executedCount, i]() {
+                            log.push_back(i);
+                            ++executedCount;
+                        });
+                        break;
+                    case 1:
+                        threadManager.performInRenderThread([&log, &executedCount, i, token, padding]() {
+                            log.push_back(i + padding[0]);
+                            ++executedCount;
+                        });
+                        break;
+                    case 2: {
+                        const std::function<void()> action = [&log, &executedCount, i]() {
+                            log.push_back(i);
+                            ++executedCount;
+                        };
+                        threadManager.performInRenderThread(action);
+                        break;
+                    }
+                    default:
+                        threadManager.performInRenderThread(std::function<void()>([&log, &executedCount, i]() {
+                            log.push_back(i);
+                            ++executedCount;
+                        }));
+                    }
+                }
+                ++finishedProducers;
+            });
+        }
+
+        const size_t totalTasks = PRODUCER_COUNT * TASKS_PER_PRODUCER;
+        while (finishedProducers.load() != PRODUCER_COUNT || executedCount.load() != totalTasks) {
+            threadManager.flushRenderThreadQueue();
+            std::this_thread::yield();
+        }
+        for (auto& thread : producers)
+            thread.join();
+        threadManager.flushRenderThreadQueue();
+
+        B3D_CHECK(executedCount.load() == totalTasks);
+        for (const auto& log : executed) {
+            bool inOrder = (log.size() == TASKS_PER_PRODUCER);
+            for (size_t i = 0; inOrder && i < log.size(); i++)
+                inOrder = (log[i] == i);
+            B3D_CHECK(inOrder);
+        }
+
+        B3D_CHECK(token.use_count() == 1);
+        threadManager.stopWorkerThreads();
+    }
+
+    // Tasks that spilled past the ring still count towards the queue depth.
+    void testQueueDepth()
+    {
+        CxxThreadManager threadManager(1);
+        threadManager.setStatsEnabled(true);
+
+        size_t count = CxxThreadManager::RENDER_THREAD_QUEUE_CAPACITY * 2;
+        size_t executed = 0;
+        for (size_t i = 0; i < count; i++)
+            threadManager.performInRenderThread([&executed]() { ++executed; });
+
+        ThreadManagerStats stats = threadManager.stats();
+        B3D_CHECK(stats.renderThread.queueDepth == count);
+        B3D_CHECK(stats.renderThread.maxQueueDepth == count);
+
+        threadManager.flushRenderThreadQueue();
+        B3D_CHECK(executed == count);
+        B3D_CHECK(threadManager.stats().renderThread.queueDepth == 0);
+        threadManager.stopWorkerThreads();
+    }
+}
+
+int main()
+{
+    testInplaceAction();
+    testOrdering();
+    testQueueDepth();
+
+    return Test::result();
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "tests/common/TestUtils.h"
+#include "engine/core/ResourceCache.h"
+#include "engine/core/ResourceManager.h"
+#include "engine/image/SpriteSheet.h"
+#include <condition_variable>
+#include <set>
+
+using namespace B3D;
+
+namespace
+{
+    const size_t THREAD_COUNT = 8;
+    const size_t SHARED_KEY_COUNT = 4;
+    const size_t DISTINCT_KEYS_PER_THREAD = 64;
+    const size_t ROUNDS = 200;
+
+    // Starts all threads at once, so that they really contend for the same shards.
+    void runThreads(const std::function<void(size_t)>& body)
+    {
+        std::atomic<bool> start(false);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < THREAD_COUNT; i++) {
+            threads.emplace_back([&start, &body, i]() {
+                while (!start.load())
+                    std::this_thread::yield();
+                body(i);
+            });
+        }
+        start.store(true);
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    std::string sharedKey(size_t index) { return "shared" + std::to_string(index) + ".test"; }
+    std::string distinctKey(size_t thread, size_t index)
+        { return "thread" + std::to_string(thread) + "_" + std::to_string(index) + ".test"; }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    struct Resource
+    {
+        std::string key;
+    };
+
+    // Every thread asks for the shared keys and its own keys over and over while keeping what it got alive, so
+    // each key must have been created exactly once and every thread must see the same object for it.
+    void testFindOrCreate()
+    {
+        ResourceCache<Resource> cache;
+        std::mutex mutex;
+        std::unordered_map<std::string, size_t> creations;
+        std::vector<std::vector<std::shared_ptr<Resource>>> results(THREAD_COUNT);
+
+        runThreads([&](size_t thread) {
+            auto& held = results[thread];
+            for (size_t round = 0; round < ROUNDS; round++) {
+                for (size_t i = 0; i < SHARED_KEY_COUNT + DISTINCT_KEYS_PER_THREAD; i++) {
+                    std::string key = (i < SHARED_KEY_COUNT ? sharedKey(i) : distinctKey(thread, i));
+                    std::shared_ptr<Resource> resource;
+                    ResourceLoadStatePtr state;
+                    cache.findOrCreate(key, resource, state,
+                        [&](std::shared_ptr<Resource>& res, ResourceLoadStatePtr& st) {
+                            res = std::make_shared<Resource>();
+                            res->key = key;
+                            st = std::make_shared<ResourceLoadState>();
+                            std::lock_guard<decltype(mutex)> lock(mutex);
+                            ++creations[key];
+                        });
+                    B3D_CHECK(resource != nullptr && resource->key == key);
+                    B3D_CHECK(state != nullptr);
+                    if (round == 0)
+                        held.emplace_back(std::move(resource));
+                    else
+                        B3D_CHECK(held[i] == resource);
+                }
+            }
+        });
+
+        B3D_CHECK(creations.size() == SHARED_KEY_COUNT + THREAD_COUNT * DISTINCT_KEYS_PER_THREAD);
+        for (const auto& it : creations)
+            B3D_CHECK(it.second == 1);
+        for (size_t i = 0; i < SHARED_KEY_COUNT; i++) {
+            for (size_t thread = 1; thread < THREAD_COUNT; thread++)
+                B3D_CHECK(results[thread][i] == results[0][i]);
+        }
+
+        uint64_t requests = THREAD_COUNT * ROUNDS * (SHARED_KEY_COUNT + DISTINCT_KEYS_PER_THREAD);
+        B3D_CHECK(cache.misses() == creations.size());
+        B3D_CHECK(cache.hits() + cache.misses() == requests);
+
+        // A failed load is not handed out again while its placeholder is still alive, so that the next request
+        // retries it.
+        auto create = [](std::shared_ptr<Resource>& res, ResourceLoadStatePtr& st) {
+            res = std::make_shared<Resource>();
+            st = std::make_shared<ResourceLoadState>();
+        };
+        std::shared_ptr<Resource> failed, retried;
+        ResourceLoadStatePtr failedState, retriedState;
+        B3D_CHECK(cache.findOrCreate("failed.test", failed, failedState, create));
+        failedState->complete(false);
+        B3D_CHECK(!cache.contains("failed.test"));
+        B3D_CHECK(cache.findOrCreate("failed.test", retried, retriedState, create));
+        B3D_CHECK(retried != failed && retriedState != failedState);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Loads every file with a ".test" extension, counting the loads per file. While the gate is closed the loads
+    // block, which lets the test cancel them while they are in flight.
+    class GatedSpriteSheetLoader : public ISpriteSheetLoader
+    {
+    public:
+        GatedSpriteSheetLoader() : mOpen(true) {}
+
+        void close() { std::lock_guard<decltype(mMutex)> lock(mMutex); mOpen = false; }
+        void open() { std::lock_guard<decltype(mMutex)> lock(mMutex); mOpen = true; mCondition.notify_all(); }
+
+        size_t loadCount(const std::string& name)
+        {
+            std::lock_guard<decltype(mMutex)> lock(mMutex);
+            auto it = mLoads.find(name);
+            return (it != mLoads.end() ? it->second : 0);
+        }
+
+        bool canLoadSpriteSheet(IFile* file) override
+        {
+            const std::string& name = file->name();
+            return name.length() > 5 && name.compare(name.length() - 5, 5, ".test") == 0;
+        }
+
+        bool loadSpriteSheet(IFile* file, SpriteSheet*) override
+        {
+            std::unique_lock<decltype(mMutex)> lock(mMutex);
+            ++mLoads[file->name()];
+            mCondition.wait(lock, [this]() { return mOpen; });
+            return true;
+        }
+
+    private:
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::unordered_map<std::string, size_t> mLoads;
+        bool mOpen;
+    };
+
+    using SpriteSheetFutures = std::vector<ResourceFuture<SpriteSheetPtr>>;
+
+    SpriteSheetFutures requestSpriteSheets(const std::shared_ptr<ResourceManager>& resourceManager)
+    {
+        std::vector<SpriteSheetFutures> perThread(THREAD_COUNT);
+        runThreads([&](size_t thread) {
+            for (size_t i = 0; i < SHARED_KEY_COUNT; i++)
+                perThread[thread].emplace_back(resourceManager->loadSpriteSheet(sharedKey(i)));
+            for (size_t i = 0; i < DISTINCT_KEYS_PER_THREAD; i++)
+                perThread[thread].emplace_back(resourceManager->loadSpriteSheet(distinctKey(thread, i)));
+        });
+
+        SpriteSheetFutures futures;
+        for (auto& list : perThread)
+            futures.insert(futures.end(), list.begin(), list.end());
+        return futures;
+    }
+
+    bool allReady(const SpriteSheetFutures& futures)
+    {
+        for (const auto& future : futures) {
+            if (!future.isReady())
+                return false;
+        }
+        return true;
+    }
+
+    void testConcurrentLoads(Test::Environment& environment, GatedSpriteSheetLoader* loader)
+    {
+        for (size_t i = 0; i < SHARED_KEY_COUNT; i++)
+            environment.fileSystem->add(sharedKey(i), "sheet");
+        for (size_t thread = 0; thread < THREAD_COUNT; thread++) {
+            for (size_t i = 0; i < DISTINCT_KEYS_PER_THREAD; i++)
+                environment.fileSystem->add(distinctKey(thread, i), "sheet");
+        }
+
+        auto resourceManager = std::make_shared<ResourceManager>();
+        Services::setResourceManager(resourceManager);
+
+        // Requests for the same file share one load and one object.
+        SpriteSheetFutures futures = requestSpriteSheets(resourceManager);
+        B3D_CHECK(environment.runUntil([&futures]() { return allReady(futures); }));
+        for (const auto& future : futures)
+            B3D_CHECK(future.succeeded());
+        const size_t keysPerThread = SHARED_KEY_COUNT + DISTINCT_KEYS_PER_THREAD;
+        for (size_t i = 0; i < SHARED_KEY_COUNT; i++) {
+            B3D_CHECK(loader->loadCount(sharedKey(i)) == 1);
+            for (size_t thread = 1; thread < THREAD_COUNT; thread++)
+                B3D_CHECK(futures[thread * keysPerThread + i].get() == futures[i].get());
+        }
+        for (size_t i = 0; i < DISTINCT_KEYS_PER_THREAD; i++)
+            B3D_CHECK(loader->loadCount(distinctKey(THREAD_COUNT - 1, i)) == 1);
+        futures.clear();
+        resourceManager->releaseRetainedResources();
+
+        // Loads cancelled while they are queued or running fail, whichever thread has started them...
+        loader->close();
+        futures = requestSpriteSheets(resourceManager);
+        resourceManager->cancelPendingLoads();
+        loader->open();
+        B3D_CHECK(environment.runUntil([&futures]() { return allReady(futures); }));
+        for (const auto& future : futures)
+            B3D_CHECK(!future.succeeded());
+        B3D_CHECK(!resourceManager->resourcesAreLoading());
+
+        // ...and are not reused by later requests for the same files.
+        SpriteSheetFutures retried = requestSpriteSheets(resourceManager);
+        B3D_CHECK(environment.runUntil([&retried]() { return allReady(retried); }));
+        for (const auto& future : retried)
+            B3D_CHECK(future.succeeded());
+        for (size_t i = 0; i < SHARED_KEY_COUNT; i++)
+            B3D_CHECK(loader->loadCount(sharedKey(i)) >= 2);
+
+        futures.clear();
+        retried.clear();
+        Services::setResourceManager(nullptr);
+    }
+}
+
+int main()
+{
+    testFindOrCreate();
+
+    {
+        Test::Environment environment;
+        auto loader = new GatedSpriteSheetLoader;
+        SpriteSheet::registerLoader(std::unique_ptr<ISpriteSheetLoader>(loader));
+        testConcurrentLoads(environment, loader);
+    }
+
+    return Test::result();
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "tests/common/TestUtils.h"
+#include "engine/material/ShaderLoader.h"
+#include "engine/utility/FileUtils.h"
+
+using namespace B3D;
+
+namespace
+{
+    const char MAIN_SHADER[] =
+        "varying vec2 vTexCoord;\r\n"
+        "%vertex\n"
+        "attribute vec3 position;   // comment\n"
+        "%include common.glsl\n"
+        "void main() {}\n"
+        "%fragment\n"
+        "// comment\n"
+        "void main() {}";
+
+    const char INCLUDED_SHADER[] =
+        "uniform mat4 uProjection;\n"
+        "uniform mat4 uModelView;";
+
+    const std::vector<std::string> EXPECTED_VERTEX = {
+        "varying vec2 vTexCoord;\n",
+        "attribute vec3 position;   \n",
+        "uniform mat4 uProjection;\n",
+        "uniform mat4 uModelView;",
+        "void main() {}\n",
+    };
+
+    const std::vector<std::string> EXPECTED_FRAGMENT = {
+        "varying vec2 vTexCoord;\n",
+        "\n",
+        "void main() {}",
+    };
+
+    // Shaders and materials expect one element per line, so that line numbers in compiler messages match.
+    void testLoadFile()
+    {
+        ShaderLoader loader;
+        B3D_CHECK(loader.loadFile("shaders/main.glsl"));
+        B3D_CHECK(loader.vertexSource() == EXPECTED_VERTEX);
+        B3D_CHECK(loader.fragmentSource() == EXPECTED_FRAGMENT);
+    }
+
+    void testLoadMemory()
+    {
+        auto lines = FileUtils::loadFileLines("shaders/main.glsl");
+        B3D_CHECK(lines.size() == 8);
+
+        ShaderLoader loader;
+        B3D_CHECK(loader.loadMemory("shaders/main.glsl", lines));
+        B3D_CHECK(loader.vertexSource() == EXPECTED_VERTEX);
+        B3D_CHECK(loader.fragmentSource() == EXPECTED_FRAGMENT);
+    }
+
+    void testInvalidDirective()
+    {
+        ShaderLoader loader;
+        B3D_CHECK(!loader.loadMemory("invalid.glsl", std::vector<std::string>{ "%unknown\n", "void main() {}\n" }));
+    }
+}
+
+int main()
+{
+    auto fileSystem = std::make_shared<Test::MemoryFileSystem>();
+    fileSystem->add("shaders/main.glsl", MAIN_SHADER);
+    fileSystem->add("shaders/common.glsl", INCLUDED_SHADER);
+    Services::setFileSystem(fileSystem);
+
+    testLoadFile();
+    testLoadMemory();
+    testInvalidDirective();
+
+    Services::setFileSystem(nullptr);
+    return Test::result();
+}
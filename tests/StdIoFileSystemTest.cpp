@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "tests/common/TestUtils.h"
+#include "engine/platform/shared/StdIoFileSystem.h"
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace B3D;
+
+namespace
+{
+    bool writeFile(const std::string& path, const std::string& contents)
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        bool success = (fwrite(contents.data(), 1, contents.size(), file) == contents.size());
+        return fclose(file) == 0 && success;
+    }
+
+    // A file created right after the index has listed its directory must open, even before the index notices it.
+    void testFileCreatedAfterLookup(const std::string& directory)
+    {
+        StdIoFileSystem fileSystem(directory, true);
+        B3D_CHECK(!fileSystem.fileExists("new.txt"));
+        B3D_CHECK(fileSystem.openFile("new.txt") == nullptr);
+
+        B3D_CHECK(writeFile(directory + "/new.txt", "hello"));
+
+        FilePtr file = fileSystem.openFile("new.txt");
+        B3D_CHECK(file != nullptr);
+        if (file)
+            B3D_CHECK(file->size() == 5);
+        B3D_CHECK(fileSystem.fileExists("new.txt"));
+
+        unlink((directory + "/new.txt").c_str());
+    }
+}
+
+int main()
+{
+    char directory[] = "/tmp/b3d-test-XXXXXX";
+    if (!mkdtemp(directory)) {
+        fprintf(stderr, "Unable to create a temporary directory.\n");
+        return EXIT_FAILURE;
+    }
+
+    testFileCreatedAfterLookup(directory);
+
+    rmdir(directory);
+    return Test::result();
+}
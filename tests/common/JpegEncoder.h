@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <jpeglib.h>
+
+namespace B3D
+{
+    namespace Test
+    {
+        struct JpegEncodeOptions
+        {
+            size_t width = 1024;
+            size_t height = 1024;
+            int components = 3;             // 3 for RGB, 1 for grayscale
+            int horizontalSampling = 2;     // Luminance sampling factors; chroma is always sampled at 1x1
+            int verticalSampling = 2;
+            unsigned restartInterval = 0;   // In MCUs
+            int restartInRows = 0;          // In MCU rows; takes precedence over restartInterval
+            int quality = 90;
+        };
+
+        // Smooth gradients with some noise, so that neither the chroma upsampling nor the entropy coder have it
+        // easy. The result is the same on every run.
+        inline std::vector<uint8_t> makeTestPixels(size_t width, size_t height, int components)
+        {
+            std::vector<uint8_t> pixels(width * height * size_t(components));
+            uint32_t seed = 12345;
+            uint8_t* p = pixels.data();
+            for (size_t y = 0; y < height; y++) {
+                for (size_t x = 0; x < width; x++) {
+                    seed = seed * 1103515245 + 12345;
+                    uint8_t noise = uint8_t((seed >> 16) & 31);
+                    for (int c = 0; c < components; c++)
+                        *p++ = uint8_t((x * size_t(c + 1) + y * size_t(3 - c)) / 8 + noise);
+                }
+            }
+            return pixels;
+        }
+
+        // Encodes the test pixels into a baseline JPEG file in memory.
+        inline std::vector<uint8_t> encodeJpeg(const JpegEncodeOptions& options)
+        {
+            std::vector<uint8_t> pixels = makeTestPixels(options.width, options.height, options.components);
+
+            jpeg_compress_struct cinfo;
+            jpeg_error_mgr jerr;
+            cinfo.err = jpeg_std_error(&jerr);
+            jpeg_create_compress(&cinfo);
+
+            unsigned char* buffer = nullptr;
+            unsigned long size = 0;
+            jpeg_mem_dest(&cinfo, &buffer, &size);
+
+            cinfo.image_width = JDIMENSION(options.width);
+            cinfo.image_height = JDIMENSION(options.height);
+            cinfo.input_components = options.components;
+            cinfo.in_color_space = (options.components == 1 ? JCS_GRAYSCALE : JCS_RGB);
+            jpeg_set_defaults(&cinfo);
+            jpeg_set_quality(&cinfo, options.quality, TRUE);
+            cinfo.comp_info[0].h_samp_factor = options.horizontalSampling;
+            cinfo.comp_info[0].v_samp_factor = options.verticalSampling;
+            for (int i = 1; i < cinfo.num_components; i++) {
+                cinfo.comp_info[i].h_samp_factor = 1;
+                cinfo.comp_info[i].v_samp_factor = 1;
+            }
+            cinfo.restart_interval = options.restartInterval;
+            cinfo.restart_in_rows = options.restartInRows;
+
+            jpeg_start_compress(&cinfo, TRUE);
+            size_t rowSize = options.width * size_t(options.components);
+            while (cinfo.next_scanline < cinfo.image_height) {
+                JSAMPROW row[1] = { pixels.data() + cinfo.next_scanline * rowSize };
+                jpeg_write_scanlines(&cinfo, row, 1);
+            }
+            jpeg_finish_compress(&cinfo);
+
+            std::vector<uint8_t> result(buffer, buffer + size);
+            jpeg_destroy_compress(&cinfo);
+            free(buffer);
+
+            return result;
+        }
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/interfaces/render/lowlevel/IRenderer.h"
+#include <atomic>
+#include <memory>
+
+namespace B3D
+{
+    namespace Test
+    {
+        // Texture that only remembers what was uploaded to it.
+        class NullTexture : public ITexture
+        {
+        public:
+            NullTexture() : mSize(0.0f), mPixelFormat(PixelFormat::Invalid), mMipLevelCount(0), mUploadCount(0) {}
+
+            const glm::vec2& size() const override { return mSize; }
+            PixelFormat pixelFormat() const override { return mPixelFormat; }
+            size_t mipLevelCount() const override { return mMipLevelCount; }
+
+            size_t uploadCount() const { return mUploadCount; }
+
+            void upload(const IImage& image) override
+            {
+                mSize = glm::vec2(float(image.width()), float(image.height()));
+                mPixelFormat = image.pixelFormat();
+                mMipLevelCount = image.mipLevelCount();
+                ++mUploadCount;
+            }
+
+            void uploadRegion(size_t, size_t, const IImage&) override { ++mUploadCount; }
+
+            TexturePtr atlasPage(glm::vec2&, glm::vec2&) const override { return nullptr; }
+            ITexture* samplerTexture() override { return this; }
+
+        private:
+            glm::vec2 mSize;
+            PixelFormat mPixelFormat;
+            size_t mMipLevelCount;
+            size_t mUploadCount;
+
+            B3D_DISABLE_COPY(NullTexture);
+        };
+
+        class NullBuffer : public IVertexBuffer, public IIndexBuffer
+        {
+        public:
+            NullBuffer() : mSize(0) {}
+
+            size_t currentSize() const override { return mSize; }
+            void initEmpty(size_t size, BufferUsage) override { mSize = size; }
+            void setData(const void*, size_t size, BufferUsage) override { mSize = size; }
+
+        private:
+            size_t mSize;
+
+            B3D_DISABLE_COPY(NullBuffer);
+        };
+
+        class NullVertexSource : public IVertexSource
+        {
+        public:
+            NullVertexSource() {}
+
+            void setAttribute(const Atom&, VertexAttributeType, const VertexBufferPtr&, size_t, size_t,
+                bool) override {}
+            void setAttributes(const IVertexFormatAttributeList&, const VertexBufferPtr&, size_t) override {}
+            void setIndexBuffer(const IndexBufferPtr&) override {}
+
+        private:
+            B3D_DISABLE_COPY(NullVertexSource);
+        };
+
+        class NullShader : public IShader
+        {
+        public:
+            NullShader() {}
+
+            void setVertexSource(const std::vector<std::string>&) override {}
+            void setFragmentSource(const std::vector<std::string>&) override {}
+            bool compile() override { return true; }
+
+        private:
+            B3D_DISABLE_COPY(NullShader);
+        };
+
+        // Renderer that draws nothing but counts draw calls, so that batching can be measured without a GPU.
+        class NullRenderer : public IRenderer
+        {
+        public:
+            NullRenderer() : mDrawCalls(0), mDrawnVertices(0) {}
+
+            size_t drawCalls() const { return mDrawCalls.load(); }
+            size_t drawnVertices() const { return mDrawnVertices.load(); }
+            void resetCounters() { mDrawCalls.store(0); mDrawnVertices.store(0); }
+
+            ShaderPtr createShader() override { return std::make_shared<NullShader>(); }
+            TexturePtr createTexture() override { return std::make_shared<NullTexture>(); }
+            VertexBufferPtr createVertexBuffer() override { return std::make_shared<NullBuffer>(); }
+            IndexBufferPtr createIndexBuffer() override { return std::make_shared<NullBuffer>(); }
+            VertexSourcePtr createVertexSource() override { return std::make_shared<NullVertexSource>(); }
+            bool supportsPixelFormat(PixelFormat format) const override { return !isCompressed(format); }
+
+            void beginFrame() override {}
+            void endFrame() override {}
+
+            void setViewport(int, int, int, int) override {}
+
+            void setClearColor(const glm::vec4&) override {}
+            void clear() override {}
+
+            void setCullFace(CullFace) override {}
+            void setFrontFace(FrontFace) override {}
+
+            void setBlendingEnabled(bool) override {}
+            void setBlendFunc(BlendFunc, BlendFunc) override {}
+
+            void setDepthTestingEnabled(bool) override {}
+            void setDepthWritingEnabled(bool) override {}
+
+            void setUniform(const Atom&, float) override {}
+            void setUniform(const Atom&, const glm::vec2&) override {}
+            void setUniform(const Atom&, const glm::vec3&) override {}
+            void setUniform(const Atom&, const glm::vec4&) override {}
+            void setUniform(const Atom&, const glm::mat4&) override {}
+            void setUniform(const Atom&, const TexturePtr&, const SamplerState&) override {}
+
+            void useShader(const ShaderPtr&) override {}
+            void bindVertexSource(const VertexSourcePtr&) override {}
+
+            void drawPrimitive(PrimitiveType, size_t, size_t count) override
+            {
+                ++mDrawCalls;
+                mDrawnVertices += count;
+            }
+
+        private:
+            std::atomic<size_t> mDrawCalls;
+            std::atomic<size_t> mDrawnVertices;
+
+            B3D_DISABLE_COPY(NullRenderer);
+        };
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2015 Nikolay Zapolnov (zapolnov@gmail.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+#include "engine/core/macros.h"
+#include "engine/core/Services.h"
+#include "engine/interfaces/io/IFileSystem.h"
+#include "engine/platform/shared/CxxThreadManager.h"
+#include "engine/utility/MemoryFile.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Records a failure and carries on, so that a single run reports every broken check.
+#define B3D_CHECK(condition) \
+    ((condition) ? (void)0 : ::B3D::Test::fail(__FILE__, __LINE__, #condition))
+
+namespace B3D
+{
+    namespace Test
+    {
+        inline std::atomic<int>& failureCount()
+        {
+            static std::atomic<int> count(0);
+            return count;
+        }
+
+        inline void fail(const char* file, int line, const char* expression)
+        {
+            fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+            ++failureCount();
+        }
+
+        // Value to return from main().
+        inline int result()
+        {
+            int failures = failureCount().load();
+            if (failures != 0) {
+                fprintf(stderr, "%d check(s) failed.\n", failures);
+                return EXIT_FAILURE;
+            }
+            printf("All checks passed.\n");
+            return EXIT_SUCCESS;
+        }
+
+        // Memory file that does not expose its contents directly, so readers have to go through read().
+        class StreamFile : public IFile
+        {
+        public:
+            StreamFile(const std::string& name, const std::vector<uint8_t>& data)
+                : mFile(name, std::vector<uint8_t>(data))
+            {
+            }
+
+            const std::string& name() const override { return mFile.name(); }
+            uint64_t size() override { return mFile.size(); }
+            uint64_t position() override { return mFile.position(); }
+            bool seek(uint64_t pos) override { return mFile.seek(pos); }
+            size_t read(void* buffer, size_t bytes) override { return mFile.read(buffer, bytes); }
+
+        private:
+            MemoryFile mFile;
+
+            B3D_DISABLE_COPY(StreamFile);
+        };
+
+        // File system serving files added by the test from memory.
+        class MemoryFileSystem : public IFileSystem
+        {
+        public:
+            MemoryFileSystem() {}
+
+            void add(const std::string& name, const std::string& contents)
+            {
+                std::lock_guard<decltype(mMutex)> lock(mMutex);
+                mFiles[name] = std::vector<uint8_t>(contents.begin(), contents.end());
+            }
+
+            bool fileExists(const std::string& name) override
+            {
+                std::lock_guard<decltype(mMutex)> lock(mMutex);
+                return mFiles.find(name) != mFiles.end();
+            }
+
+            FilePtr openFile(const std::string& name) override
+            {
+                std::vector<uint8_t> data;
+                {
+                    std::lock_guard<decltype(mMutex)> lock(mMutex);
+                    auto it = mFiles.find(name);
+                    if (it == mFiles.end())
+                        return nullptr;
+                    data = it->second;
+                }
+                return std::make_shared<MemoryFile>(name, std::move(data));
+            }
+
+        private:
+            std::mutex mMutex;
+            std::unordered_map<std::string, std::vector<uint8_t>> mFiles;
+
+            B3D_DISABLE_COPY(MemoryFileSystem);
+        };
+
+        // Installs a thread manager and a memory file system for the lifetime of the object. The thread that
+        // creates it plays the part of the render thread.
+        class Environment
+        {
+        public:
+            explicit Environment(size_t workerCount = 4)
+                : threadManager(std::make_shared<CxxThreadManager>(workerCount))
+                , fileSystem(std::make_shared<MemoryFileSystem>())
+            {
+                Services::setThreadManager(threadManager);
+                Services::setFileSystem(fileSystem);
+            }
+
+            ~Environment()
+            {
+                threadManager->stopWorkerThreads();
+                Services::setFileSystem(nullptr);
+                Services::setThreadManager(nullptr);
+            }
+
+            // Runs render thread actions until `done` returns true. Returns false on timeout.
+            bool runUntil(const std::function<bool()>& done,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds(30000))
+            {
+                auto deadline = std::chrono::steady_clock::now() + timeout;
+                for (;;) {
+                    threadManager->flushRenderThreadQueue();
+                    if (done())
+                        return true;
+                    if (std::chrono::steady_clock::now() > deadline)
+                        return false;
+                    std::this_thread::yield();
+                }
+            }
+
+            const std::shared_ptr<CxxThreadManager> threadManager;
+            const std::shared_ptr<MemoryFileSystem> fileSystem;
+
+        private:
+            B3D_DISABLE_COPY(Environment);
+        };
+    }
+}